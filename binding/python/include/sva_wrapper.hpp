@@ -4,11 +4,168 @@
 
 #include <SpaceVecAlg/SpaceVecAlg>
 
+#include <algorithm>
 #include <sstream>
+#include <vector>
 
 namespace sva
 {
 
+// std::vector of these types are exposed to Python as (N, 12) and (N, 6) arrays of double
+static_assert(sizeof(PTransformd) == 12 * sizeof(double), "PTransformd is not 12 contiguous double");
+static_assert(sizeof(MotionVecd) == 6 * sizeof(double), "MotionVecd is not 6 contiguous double");
+static_assert(sizeof(ForceVecd) == 6 * sizeof(double), "ForceVecd is not 6 contiguous double");
+
+// The pickled form of these types is their coefficients
+static_assert(sizeof(RBInertiad) == 13 * sizeof(double), "RBInertiad is not 13 contiguous double");
+static_assert(sizeof(ABInertiad) == 27 * sizeof(double), "ABInertiad is not 27 contiguous double");
+
+template<typename T>
+void objectFromArray(T & x, const double * data)
+{
+  std::copy(data, data + sizeof(T) / sizeof(double), reinterpret_cast<double *>(&x));
+}
+
+template<typename T>
+double * vectorData(std::vector<T> & v)
+{
+  return reinterpret_cast<double *>(v.data());
+}
+
+template<typename T>
+void vectorFromArray(std::vector<T> & v, const double * data, std::size_t size)
+{
+  v.resize(size);
+  std::copy(data, data + size * sizeof(T) / sizeof(double), vectorData(v));
+}
+
+template<typename T>
+const T & vectorElement(const std::vector<T> & v, std::size_t i)
+{
+  return v[i];
+}
+
+/// A single transformation is applied to every element of the other operand.
+const PTransformd & vectorElement(const PTransformd & X, std::size_t)
+{
+  return X;
+}
+
+template<typename T>
+std::size_t vectorSize(const std::vector<T> & v)
+{
+  return v.size();
+}
+
+std::size_t vectorSize(const PTransformd &)
+{
+  return 0;
+}
+
+/// result[i] = op(lhs[i], rhs[i]), vector operands must have the same size.
+template<typename Lhs, typename Rhs, typename Result, typename Op>
+void transformVector(const Lhs & lhs, const Rhs & rhs, std::vector<Result> & result, Op op)
+{
+  const std::size_t size = std::max(vectorSize(lhs), vectorSize(rhs));
+  result.resize(size);
+  for(std::size_t i = 0; i < size; ++i)
+  {
+    result[i] = op(vectorElement(lhs, i), vectorElement(rhs, i));
+  }
+}
+
+struct VectorMul
+{
+  template<typename A, typename B>
+  auto operator()(const A & a, const B & b) const -> decltype(a * b)
+  {
+    return a * b;
+  }
+};
+
+struct VectorInvMul
+{
+  MotionVecd operator()(const PTransformd & X, const MotionVecd & mv) const
+  {
+    return X.invMul(mv);
+  }
+};
+
+struct VectorDualMul
+{
+  ForceVecd operator()(const PTransformd & X, const ForceVecd & fv) const
+  {
+    return X.dualMul(fv);
+  }
+};
+
+struct VectorTransMul
+{
+  ForceVecd operator()(const PTransformd & X, const ForceVecd & fv) const
+  {
+    return X.transMul(fv);
+  }
+};
+
+struct VectorTransformError
+{
+  MotionVecd operator()(const PTransformd & X_a_b, const PTransformd & X_a_c) const
+  {
+    return transformError(X_a_b, X_a_c);
+  }
+};
+
+template<typename Lhs, typename Rhs, typename Result>
+void mulVector(const Lhs & lhs, const Rhs & rhs, std::vector<Result> & result)
+{
+  transformVector(lhs, rhs, result, VectorMul());
+}
+
+template<typename Lhs>
+void invMulVector(const Lhs & lhs, const std::vector<MotionVecd> & rhs, std::vector<MotionVecd> & result)
+{
+  transformVector(lhs, rhs, result, VectorInvMul());
+}
+
+template<typename Lhs>
+void dualMulVector(const Lhs & lhs, const std::vector<ForceVecd> & rhs, std::vector<ForceVecd> & result)
+{
+  transformVector(lhs, rhs, result, VectorDualMul());
+}
+
+template<typename Lhs>
+void transMulVector(const Lhs & lhs, const std::vector<ForceVecd> & rhs, std::vector<ForceVecd> & result)
+{
+  transformVector(lhs, rhs, result, VectorTransMul());
+}
+
+void invVector(const std::vector<PTransformd> & X, std::vector<PTransformd> & result)
+{
+  result.resize(X.size());
+  for(std::size_t i = 0; i < X.size(); ++i)
+  {
+    result[i] = X[i].inv();
+  }
+}
+
+void transformErrorVector(const std::vector<PTransformd> & X_a_b,
+                          const std::vector<PTransformd> & X_a_c,
+                          std::vector<MotionVecd> & result)
+{
+  transformVector(X_a_b, X_a_c, result, VectorTransformError());
+}
+
+/// E is a C contiguous (size, 3, 3) array and r a C contiguous (size, 3) array.
+void PTransformdVectorFromArrays(std::vector<PTransformd> & v, const double * E, const double * r, std::size_t size)
+{
+  typedef Eigen::Map<const Eigen::Matrix<double, 3, 3, Eigen::RowMajor>> rotation_map_t;
+  v.resize(size);
+  for(std::size_t i = 0; i < size; ++i)
+  {
+    v[i] = PTransformd(Eigen::Matrix3d(rotation_map_t(E + 9 * i)), Eigen::Vector3d::Map(r + 3 * i));
+  }
+}
+
 std::string AdmittanceVecdToString(const sva::AdmittanceVecd & av)
 {
   std::stringstream ss;
@@ -61,3 +61,23 @@ cdef extern from "sva_wrapper.hpp" namespace "sva":
 
   PTransformd & const_cast_ptd(const PTransformd &)
   vector[PTransformd]& const_cast_pt_vec(const vector[PTransformd]&)
+
+  void objectFromArray[T](T &, const double *)
+  double * vectorData[T](vector[T] &)
+  void vectorFromArray[T](vector[T] &, const double *, size_t) nogil
+  void PTransformdVectorFromArrays(vector[PTransformd] &, const double *, const double *, size_t) nogil
+
+  # element-wise operations, a single PTransformd is applied to every element
+  void mulVector(const vector[PTransformd] &, const vector[PTransformd] &, vector[PTransformd] &) nogil
+  void mulVector(const vector[PTransformd] &, const PTransformd &, vector[PTransformd] &) nogil
+  void mulVector(const PTransformd &, const vector[PTransformd] &, vector[PTransformd] &) nogil
+  void mulVector(const vector[PTransformd] &, const vector[MotionVecd] &, vector[MotionVecd] &) nogil
+  void mulVector(const PTransformd &, const vector[MotionVecd] &, vector[MotionVecd] &) nogil
+  void invMulVector(const vector[PTransformd] &, const vector[MotionVecd] &, vector[MotionVecd] &) nogil
+  void invMulVector(const PTransformd &, const vector[MotionVecd] &, vector[MotionVecd] &) nogil
+  void dualMulVector(const vector[PTransformd] &, const vector[ForceVecd] &, vector[ForceVecd] &) nogil
+  void dualMulVector(const PTransformd &, const vector[ForceVecd] &, vector[ForceVecd] &) nogil
+  void transMulVector(const vector[PTransformd] &, const vector[ForceVecd] &, vector[ForceVecd] &) nogil
+  void transMulVector(const PTransformd &, const vector[ForceVecd] &, vector[ForceVecd] &) nogil
+  void invVector(const vector[PTransformd] &, vector[PTransformd] &) nogil
+  void transformErrorVector(const vector[PTransformd] &, const vector[PTransformd] &, vector[MotionVecd] &) nogil
@@ -25,6 +25,9 @@ cdef ForceVecd ForceVecdFromC(const c_sva.ForceVecd&, cppbool copy=?)
 
 cdef class ForceVecdVector(object):
   cdef vector[c_sva.ForceVecd] v
+  cdef Py_ssize_t __shape[2]
+  cdef Py_ssize_t __strides[2]
+  cdef int __nexports
 
 cdef class MotionVecd(object):
   cdef c_sva.MotionVecd * impl
@@ -34,6 +37,9 @@ cdef MotionVecd MotionVecdFromC(const c_sva.MotionVecd&, cppbool copy=?)
 
 cdef class MotionVecdVector(object):
   cdef vector[c_sva.MotionVecd] v
+  cdef Py_ssize_t __shape[2]
+  cdef Py_ssize_t __strides[2]
+  cdef int __nexports
 
 cdef class MotionVecdVectorVector(object):
   cdef vector[vector[c_sva.MotionVecd]] v
@@ -59,6 +65,9 @@ cdef PTransformd PTransformdFromC(const c_sva.PTransformd&, cppbool copy=?)
 cdef class PTransformdVector(object):
   cdef vector[c_sva.PTransformd] * v
   cdef cppbool __own_impl
+  cdef Py_ssize_t __shape[2]
+  cdef Py_ssize_t __strides[2]
+  cdef int __nexports
 
 cdef PTransformdVector PTransformdVectorFromC(const vector[c_sva.PTransformd]&,
     cppbool copy=?)
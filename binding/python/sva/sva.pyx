@@ -11,6 +11,54 @@ cimport sva.c_sva_private as c_sva_private
 cimport eigen.eigen as eigen
 from libcpp.vector cimport vector
 from cython.operator cimport dereference as deref
+from cpython cimport Py_buffer
+
+import numpy as np
+import pickle
+
+# Export the size x width doubles at data as a writable 2D buffer of obj
+cdef exportVector(Py_buffer * buffer, object obj, double * data, Py_ssize_t size, Py_ssize_t width,
+                  Py_ssize_t * shape, Py_ssize_t * strides):
+  shape[0] = size
+  shape[1] = width
+  strides[0] = width * sizeof(double)
+  strides[1] = sizeof(double)
+  buffer.buf = data
+  buffer.format = 'd'
+  buffer.internal = NULL
+  buffer.itemsize = sizeof(double)
+  buffer.len = size * width * sizeof(double)
+  buffer.ndim = 2
+  buffer.obj = obj
+  buffer.readonly = 0
+  buffer.shape = shape
+  buffer.strides = strides
+  buffer.suboffsets = NULL
+
+cdef checkSameSize(lhs, rhs):
+  if len(lhs) != len(rhs):
+    raise ValueError("Element-wise operation on vectors of different sizes ({0} and {1})".format(len(lhs), len(rhs)))
+
+# Pickled form of the size doubles at data, an out-of-band buffer for protocol 5
+cdef reduceBuffer(const double * data, Py_ssize_t size, int protocol):
+  buf = (<const char *>data)[:size * sizeof(double)]
+  if protocol >= 5:
+    return pickle.PickleBuffer(buf)
+  return buf
+
+# Double array of the pickled form of an object of size doubles
+cdef loadBuffer(buf, Py_ssize_t size, name):
+  array = np.frombuffer(buf, dtype = np.float64)
+  if array.shape[0] != size:
+    raise pickle.UnpicklingError("Invalid {0} buffer".format(name))
+  return array
+
+# C contiguous double array of shape (N, width), array is copied only if needed
+def asVectorArray(array, Py_ssize_t width, name):
+  array = np.ascontiguousarray(array, dtype = np.float64)
+  if array.ndim != 2 or array.shape[1] != width:
+    raise TypeError("{0} requires a (N, {1}) array".format(name, width))
+  return array
 
 cdef class AdmittanceVecd(object):
   def __copyctor__(self, AdmittanceVecd other):
@@ -288,6 +336,14 @@ cdef class ForceVecd(object):
   @staticmethod
   def pickle(fv):
     return ForceVecd, (list(fv.couple()), list(fv.force()))
+  def __reduce_ex__(self, protocol):
+    return ForceVecd.fromBuffer, (reduceBuffer(<const double *>self.impl, 6, protocol),)
+  @staticmethod
+  def fromBuffer(buf):
+    cdef const double[::1] a = loadBuffer(buf, 6, "ForceVecd")
+    cdef ForceVecd ret = ForceVecd()
+    c_sva_private.objectFromArray[c_sva.ForceVecd](deref(ret.impl), &a[0])
+    return ret
 
 cdef ForceVecd ForceVecdFromC(const c_sva.ForceVecd& fv, cppbool copy = True):
   cdef ForceVecd ret = ForceVecd(skip_alloc = True)
@@ -300,16 +356,51 @@ cdef ForceVecd ForceVecdFromC(const c_sva.ForceVecd& fv, cppbool copy = True):
 
 cdef class ForceVecdVector(object):
   def __addForceVecd(self, ForceVecd pt):
+    if self.__nexports > 0:
+      raise BufferError("ForceVecdVector cannot be resized while its buffer is exported")
     self.v.push_back(deref(pt.impl))
+  def __arrayctor__(self, array):
+    cdef const double[:, ::1] a = asVectorArray(array, 6, "ForceVecdVector")
+    if a.shape[0] > 0:
+      c_sva_private.vectorFromArray[c_sva.ForceVecd](self.v, &a[0, 0], a.shape[0])
   def __cinit__(self, *args):
     if len(args) == 1 and isinstance(args[0], list):
       for pt in args[0]:
         self.__addForceVecd(pt)
     elif len(args) == 1 and isinstance(args[0], ForceVecd):
       self.__addForceVecd(args[0])
+    elif len(args) == 1 and isinstance(args[0], np.ndarray):
+      self.__arrayctor__(args[0])
     else:
       for pt in args:
         self.__addForceVecd(pt)
+  def append(self, ForceVecd pt):
+    self.__addForceVecd(pt)
+  def __iter__(self):
+    for fv in self.v:
+      yield ForceVecdFromC(fv, copy = False)
+  def __len__(self):
+    return self.v.size()
+  def __getbuffer__(self, Py_buffer * buffer, int flags):
+    exportVector(buffer, self, c_sva_private.vectorData[c_sva.ForceVecd](self.v), self.v.size(), 6,
+                 self.__shape, self.__strides)
+    self.__nexports += 1
+  def __releasebuffer__(self, Py_buffer * buffer):
+    self.__nexports -= 1
+  def __reduce_ex__(self, protocol):
+    if protocol >= 5:
+      return ForceVecdVector.fromBuffer, (pickle.PickleBuffer(self),)
+    return ForceVecdVector.fromBuffer, (memoryview(self).tobytes(),)
+  @staticmethod
+  def fromBuffer(buf):
+    cdef const double[:, ::1] a = np.frombuffer(buf, dtype = np.float64).reshape(-1, 6)
+    cdef ForceVecdVector ret = ForceVecdVector()
+    if a.shape[0] > 0:
+      c_sva_private.vectorFromArray[c_sva.ForceVecd](ret.v, &a[0, 0], a.shape[0])
+    return ret
+  # (N, 6) NumPy view of the couples and forces
+  def array(self):
+    return np.asarray(self)
 
 cdef class MotionVecd(object):
   def __dealloc__(self):
@@ -408,6 +499,14 @@ cdef class MotionVecd(object):
   @staticmethod
   def pickle(mv):
     return MotionVecd, (list(mv.angular()), list(mv.linear()))
+  def __reduce_ex__(self, protocol):
+    return MotionVecd.fromBuffer, (reduceBuffer(<const double *>self.impl, 6, protocol),)
+  @staticmethod
+  def fromBuffer(buf):
+    cdef const double[::1] a = loadBuffer(buf, 6, "MotionVecd")
+    cdef MotionVecd ret = MotionVecd()
+    c_sva_private.objectFromArray[c_sva.MotionVecd](deref(ret.impl), &a[0])
+    return ret
 
 cdef MotionVecd MotionVecdFromC(const c_sva.MotionVecd& mv, cppbool copy = True):
   cdef MotionVecd ret = MotionVecd(skip_alloc = True)
@@ -420,13 +519,21 @@ cdef MotionVecd MotionVecdFromC(const c_sva.MotionVecd& mv, cppbool copy = True)
 
 cdef class MotionVecdVector(object):
   def __addMotionVecd(self, MotionVecd pt):
+    if self.__nexports > 0:
+      raise BufferError("MotionVecdVector cannot be resized while its buffer is exported")
     self.v.push_back(deref(pt.impl))
+  def __arrayctor__(self, array):
+    cdef const double[:, ::1] a = asVectorArray(array, 6, "MotionVecdVector")
+    if a.shape[0] > 0:
+      c_sva_private.vectorFromArray[c_sva.MotionVecd](self.v, &a[0, 0], a.shape[0])
   def __cinit__(self, *args):
     if len(args) == 1 and isinstance(args[0], list):
       for pt in args[0]:
         self.__addMotionVecd(pt)
     elif len(args) == 1 and isinstance(args[0], MotionVecd):
       self.__addMotionVecd(args[0])
+    elif len(args) == 1 and isinstance(args[0], np.ndarray):
+      self.__arrayctor__(args[0])
     else:
       for pt in args:
         self.__addMotionVecd(pt)
@@ -437,6 +544,26 @@ cdef class MotionVecdVector(object):
       yield MotionVecdFromC(mv, copy = False)
   def __len__(self):
     return self.v.size()
+  def __getbuffer__(self, Py_buffer * buffer, int flags):
+    exportVector(buffer, self, c_sva_private.vectorData[c_sva.MotionVecd](self.v), self.v.size(), 6,
+                 self.__shape, self.__strides)
+    self.__nexports += 1
+  def __releasebuffer__(self, Py_buffer * buffer):
+    self.__nexports -= 1
+  def __reduce_ex__(self, protocol):
+    if protocol >= 5:
+      return MotionVecdVector.fromBuffer, (pickle.PickleBuffer(self),)
+    return MotionVecdVector.fromBuffer, (memoryview(self).tobytes(),)
+  @staticmethod
+  def fromBuffer(buf):
+    cdef const double[:, ::1] a = np.frombuffer(buf, dtype = np.float64).reshape(-1, 6)
+    cdef MotionVecdVector ret = MotionVecdVector()
+    if a.shape[0] > 0:
+      c_sva_private.vectorFromArray[c_sva.MotionVecd](ret.v, &a[0, 0], a.shape[0])
+    return ret
+  # (N, 6) NumPy view of the angular and linear parts
+  def array(self):
+    return np.asarray(self)
 
 cdef class MotionVecdVectorVector(object):
   def __addMotionVecd(self, int i, MotionVecd pt):
@@ -527,6 +654,14 @@ cdef class RBInertiad(object):
   @staticmethod
   def pickle(rb):
     return RBInertiad, (rb.mass(), list(rb.momentum()), list(rb.inertia()))
+  def __reduce_ex__(self, protocol):
+    return RBInertiad.fromBuffer, (reduceBuffer(<const double *>self.impl, 13, protocol),)
+  @staticmethod
+  def fromBuffer(buf):
+    cdef const double[::1] a = loadBuffer(buf, 13, "RBInertiad")
+    cdef RBInertiad ret = RBInertiad()
+    c_sva_private.objectFromArray[c_sva.RBInertiad](deref(ret.impl), &a[0])
+    return ret
 
 cdef RBInertiad RBInertiadFromC(const c_sva.RBInertiad& fv, cppbool copy=True):
   cdef RBInertiad ret = RBInertiad(skip_alloc = True)
@@ -640,6 +775,14 @@ cdef class ABInertiad(object):
   @staticmethod
   def pickle(ab):
     return ABInertiad, (list(ab.massMatrix()), list(ab.gInertia()), list(ab.inertia()))
+  def __reduce_ex__(self, protocol):
+    return ABInertiad.fromBuffer, (reduceBuffer(<const double *>self.impl, 27, protocol),)
+  @staticmethod
+  def fromBuffer(buf):
+    cdef const double[::1] a = loadBuffer(buf, 27, "ABInertiad")
+    cdef ABInertiad ret = ABInertiad()
+    c_sva_private.objectFromArray[c_sva.ABInertiad](deref(ret.impl), &a[0])
+    return ret
 
 cdef ABInertiad ABInertiadFromC(const c_sva.ABInertiad& fv, cppbool copy=True):
   cdef ABInertiad ret = ABInertiad(skip_alloc = True)
@@ -720,21 +863,49 @@ cdef class PTransformd(object):
     return PTransformdFromC(deref(self.impl)*deref(pt.impl))
   def __mvec_mul(self, MotionVecd mv):
     return MotionVecdFromC(deref(self.impl)*deref(mv.impl))
+  def __ptv_mul(self, PTransformdVector ptv):
+    cdef PTransformdVector ret = PTransformdVector()
+    with nogil:
+      c_sva_private.mulVector(deref(self.impl), deref(ptv.v), deref(ret.v))
+    return ret
+  def __mvv_mul(self, MotionVecdVector mvv):
+    cdef MotionVecdVector ret = MotionVecdVector()
+    with nogil:
+      c_sva_private.mulVector(deref(self.impl), mvv.v, ret.v)
+    return ret
   def __mul__(self, other):
     if isinstance(self, PTransformd):
       if isinstance(other, MotionVecd):
         return self.__mvec_mul(other)
       elif isinstance(other, PTransformd):
         return self.__pt_mul(other)
+      elif isinstance(other, PTransformdVector):
+        return self.__ptv_mul(other)
+      elif isinstance(other, MotionVecdVector):
+        return self.__mvv_mul(other)
       else:
         raise TypeError("Unsupported operands PTransformd and {0}".format(type(other)))
     else:
       return other.__mul__(self)
 
-  def invMul(self, MotionVecd other):
+  def __mv_invMul(self, MotionVecd other):
     return MotionVecdFromC(self.impl.invMul(deref(other.impl)))
+  def __mvv_invMul(self, MotionVecdVector other):
+    cdef MotionVecdVector ret = MotionVecdVector()
+    with nogil:
+      c_sva_private.invMulVector(deref(self.impl), other.v, ret.v)
+    return ret
+  def invMul(self, other):
+    if isinstance(other, MotionVecdVector):
+      return self.__mvv_invMul(other)
+    return self.__mv_invMul(other)
   def __fv_dualMul(self, ForceVecd other):
     return ForceVecdFromC(self.impl.dualMul(deref(other.impl)))
+  def __fvv_dualMul(self, ForceVecdVector other):
+    cdef ForceVecdVector ret = ForceVecdVector()
+    with nogil:
+      c_sva_private.dualMulVector(deref(self.impl), other.v, ret.v)
+    return ret
   def __rbi_dualMul(self, RBInertiad other):
     return RBInertiadFromC(self.impl.dualMul(deref(other.impl)))
   def __abi_dualMul(self, ABInertiad other):
@@ -742,6 +913,8 @@ cdef class PTransformd(object):
   def dualMul(self, other):
     if isinstance(other, ForceVecd):
       return self.__fv_dualMul(other)
+    elif isinstance(other, ForceVecdVector):
+      return self.__fvv_dualMul(other)
     elif isinstance(other, RBInertiad):
       return self.__rbi_dualMul(other)
     elif isinstance(other, ABInertiad):
@@ -751,6 +924,11 @@ cdef class PTransformd(object):
 
   def __fv_transMul(self, ForceVecd other):
     return ForceVecdFromC(self.impl.transMul(deref(other.impl)))
+  def __fvv_transMul(self, ForceVecdVector other):
+    cdef ForceVecdVector ret = ForceVecdVector()
+    with nogil:
+      c_sva_private.transMulVector(deref(self.impl), other.v, ret.v)
+    return ret
   def __rbi_transMul(self, RBInertiad other):
     return RBInertiadFromC(self.impl.transMul(deref(other.impl)))
   def __abi_transMul(self, ABInertiad other):
@@ -758,6 +936,8 @@ cdef class PTransformd(object):
   def transMul(self, other):
     if isinstance(other, ForceVecd):
       return self.__fv_transMul(other)
+    elif isinstance(other, ForceVecdVector):
+      return self.__fvv_transMul(other)
     elif isinstance(other, RBInertiad):
       return self.__rbi_transMul(other)
     elif isinstance(other, ABInertiad):
@@ -803,6 +983,14 @@ cdef class PTransformd(object):
   @staticmethod
   def pickle(pt):
     return PTransformd, (list(pt.rotation()), list(pt.translation()))
+  def __reduce_ex__(self, protocol):
+    return PTransformd.fromBuffer, (reduceBuffer(<const double *>self.impl, 12, protocol),)
+  @staticmethod
+  def fromBuffer(buf):
+    cdef const double[::1] a = loadBuffer(buf, 12, "PTransformd")
+    cdef PTransformd ret = PTransformd()
+    c_sva_private.objectFromArray[c_sva.PTransformd](deref(ret.impl), &a[0])
+    return ret
 
 cdef PTransformd PTransformdFromC(const c_sva.PTransformd & pt, cppbool
         copy=True):
@@ -819,7 +1007,18 @@ cdef class PTransformdVector(object):
     if self.__own_impl:
       del self.v
   def __addPTransformd(self, PTransformd pt):
+    if self.__nexports > 0:
+      raise BufferError("PTransformdVector cannot be resized while its buffer is exported")
     self.v.push_back(deref(pt.impl))
+  def __arraysctor__(self, rotations, translations):
+    rotations = np.ascontiguousarray(rotations, dtype = np.float64)
+    translations = asVectorArray(translations, 3, "PTransformdVector")
+    if rotations.shape != (translations.shape[0], 3, 3):
+      raise TypeError("PTransformdVector requires (N, 3, 3) rotations and (N, 3) translations")
+    cdef const double[:, :, ::1] E = rotations
+    cdef const double[:, ::1] r = translations
+    if E.shape[0] > 0:
+      c_sva_private.PTransformdVectorFromArrays(deref(self.v), &E[0, 0, 0], &r[0, 0], E.shape[0])
   def __cinit__(self, *args, skip_alloc = False):
     self.__own_impl = True
     if not skip_alloc:
@@ -829,6 +1028,8 @@ cdef class PTransformdVector(object):
         self.__addPTransformd(pt)
     elif len(args) == 1 and isinstance(args[0], PTransformd):
       self.__addPTransformd(args[0])
+    elif len(args) == 2 and isinstance(args[0], np.ndarray) and isinstance(args[1], np.ndarray):
+      self.__arraysctor__(args[0], args[1])
     else:
       for pt in args:
         self.__addPTransformd(pt)
@@ -839,6 +1040,85 @@ cdef class PTransformdVector(object):
       yield PTransformdFromC(pt, copy = False)
   def __len__(self):
     return self.v.size()
+  # (N, 12) buffer, each row is the column major rotation followed by the translation
+  def __getbuffer__(self, Py_buffer * buffer, int flags):
+    exportVector(buffer, self, c_sva_private.vectorData[c_sva.PTransformd](deref(self.v)), self.v.size(), 12,
+                 self.__shape, self.__strides)
+    self.__nexports += 1
+  def __releasebuffer__(self, Py_buffer * buffer):
+    self.__nexports -= 1
+  def __reduce_ex__(self, protocol):
+    if protocol >= 5:
+      return PTransformdVector.fromBuffer, (pickle.PickleBuffer(self),)
+    return PTransformdVector.fromBuffer, (memoryview(self).tobytes(),)
+  @staticmethod
+  def fromBuffer(buf):
+    cdef const double[:, ::1] a = np.frombuffer(buf, dtype = np.float64).reshape(-1, 12)
+    cdef PTransformdVector ret = PTransformdVector()
+    if a.shape[0] > 0:
+      c_sva_private.vectorFromArray[c_sva.PTransformd](deref(ret.v), &a[0, 0], a.shape[0])
+    return ret
+
+  # Element-wise operations, they run without the GIL
+  def __ptv_mul(self, PTransformdVector other):
+    checkSameSize(self, other)
+    cdef PTransformdVector ret = PTransformdVector()
+    with nogil:
+      c_sva_private.mulVector(deref(self.v), deref(other.v), deref(ret.v))
+    return ret
+  def __pt_mul(self, PTransformd other):
+    cdef PTransformdVector ret = PTransformdVector()
+    with nogil:
+      c_sva_private.mulVector(deref(self.v), deref(other.impl), deref(ret.v))
+    return ret
+  def __mvv_mul(self, MotionVecdVector other):
+    checkSameSize(self, other)
+    cdef MotionVecdVector ret = MotionVecdVector()
+    with nogil:
+      c_sva_private.mulVector(deref(self.v), other.v, ret.v)
+    return ret
+  def __mul__(self, other):
+    if isinstance(self, PTransformdVector):
+      if isinstance(other, PTransformdVector):
+        return self.__ptv_mul(other)
+      elif isinstance(other, PTransformd):
+        return self.__pt_mul(other)
+      elif isinstance(other, MotionVecdVector):
+        return self.__mvv_mul(other)
+      else:
+        raise TypeError("Unsupported operands PTransformdVector and {0}".format(type(other)))
+    else:
+      return other.__mul__(self)
+  def invMul(self, MotionVecdVector other):
+    checkSameSize(self, other)
+    cdef MotionVecdVector ret = MotionVecdVector()
+    with nogil:
+      c_sva_private.invMulVector(deref(self.v), other.v, ret.v)
+    return ret
+  def dualMul(self, ForceVecdVector other):
+    checkSameSize(self, other)
+    cdef ForceVecdVector ret = ForceVecdVector()
+    with nogil:
+      c_sva_private.dualMulVector(deref(self.v), other.v, ret.v)
+    return ret
+  def transMul(self, ForceVecdVector other):
+    checkSameSize(self, other)
+    cdef ForceVecdVector ret = ForceVecdVector()
+    with nogil:
+      c_sva_private.transMulVector(deref(self.v), other.v, ret.v)
+    return ret
+  def inv(self):
+    cdef PTransformdVector ret = PTransformdVector()
+    with nogil:
+      c_sva_private.invVector(deref(self.v), deref(ret.v))
+    return ret
+
+  # (N, 3, 3) NumPy view of the rotations
+  def rotations(self):
+    return np.asarray(self)[:, :9].reshape(len(self), 3, 3).transpose(0, 2, 1)
+  # (N, 3) NumPy view of the translations
+  def translations(self):
+    return np.asarray(self)[:, 9:]
 
 cdef PTransformdVector PTransformdVectorFromC(const vector[c_sva.PTransformd]&v,
     cppbool copy=True):
@@ -865,10 +1145,22 @@ def rotationError(eigen.Matrix3d E_a_b, eigen.Matrix3d E_a_c):
 def rotationVelocity(eigen.Matrix3d E_a_b):
   return eigen.Vector3dFromC(<c_eigen.Vector3d>(c_sva.rotationVelocity[double](E_a_b.impl)))
 
-def transformError(PTransformd X_a_b, PTransformd X_a_c):
+cdef transformErrorPTransformd(PTransformd X_a_b, PTransformd X_a_c):
   return MotionVecdFromC(c_sva.transformError[double](deref(X_a_b.impl),
       deref(X_a_c.impl)))
 
+cdef transformErrorVector(PTransformdVector X_a_b, PTransformdVector X_a_c):
+  checkSameSize(X_a_b, X_a_c)
+  cdef MotionVecdVector ret = MotionVecdVector()
+  with nogil:
+    c_sva_private.transformErrorVector(deref(X_a_b.v), deref(X_a_c.v), ret.v)
+  return ret
+
+def transformError(X_a_b, X_a_c):
+  if isinstance(X_a_b, PTransformdVector):
+    return transformErrorVector(X_a_b, X_a_c)
+  return transformErrorPTransformd(X_a_b, X_a_c)
+
 def transformVelocity(PTransformd X_a_b):
   return MotionVecdFromC(c_sva.transformVelocity[double](deref(X_a_b.impl)))
 
@@ -893,12 +1185,6 @@ def sinc_inv(double x):
   return c_sva.sinc_inv[double](x)
 
 def copy_reg_pickle():
-  # Python 2/3 support
-  # Try to import copyreg first (Python 3)
-  # Otherwise import copy_reg (Python 2)
-  try:
-    import copyreg
-  except ImportError:
-    import copy_reg as copyreg
-  for c in [MotionVecd, ForceVecd, PTransformd, RBInertiad, ABInertiad]:
-    copyreg.pickle(c, c.pickle)
+  # Kept for compatibility: the types define __reduce_ex__ and the reducers
+  # of copyreg would take precedence over it
+  pass
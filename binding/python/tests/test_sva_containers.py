@@ -69,8 +69,109 @@ class TestSVAMotionVecdVector(unittest.TestCase):
     v4 = sva.MotionVecdVector([mv]*100)
     assert(all([mv == vi for vi in v4]))
 
+class TestSVAVectorNumPy(unittest.TestCase):
+  def test_ptransform(self):
+    rot = np.array([np.array(sva.RotX(0.1*i) * sva.RotZ(0.3*i)) for i in range(10)])
+    trans = np.random.rand(10, 3)
+
+    # Check creation from arrays
+    v = sva.PTransformdVector(rot, trans)
+    assert(len(v) == 10)
+    for i, pt in enumerate(v):
+      assert(np.allclose(np.array(pt.rotation()), rot[i]))
+      assert(np.allclose(np.array(pt.translation()), trans[i]))
+
+    # Check the views share the memory of the vector
+    assert(np.array_equal(v.rotations(), rot))
+    assert(np.array_equal(v.translations(), trans))
+    assert(np.asarray(v).shape == (10, 12))
+    v.translations()[3] = [1., 2., 3.]
+    v.rotations()[3] = np.eye(3)
+    assert(list(v)[3] == sva.PTransformd(eigen.Vector3d(1., 2., 3.)))
+
+    # The vector can not grow while it is viewed
+    view = v.rotations()
+    with self.assertRaises(BufferError):
+      v.append(sva.PTransformd.Identity())
+    del view
+    v.append(sva.PTransformd.Identity())
+    assert(len(v) == 11)
+
+    # Check an empty vector
+    assert(sva.PTransformdVector().rotations().shape == (0, 3, 3))
+
+  def test_vec(self):
+    for Vector, Vec in [(sva.MotionVecdVector, sva.MotionVecd), (sva.ForceVecdVector, sva.ForceVecd)]:
+      a = np.random.rand(20, 6)
+      v = Vector(a)
+      assert(len(v) == 20)
+      for i, vi in enumerate(v):
+        assert(np.allclose(np.array(vi.vector()).ravel(), a[i]))
+      assert(np.array_equal(v.array(), a))
+      assert(np.array_equal(np.array(memoryview(v)), a))
+
+      v.array()[0] = 0.
+      assert(list(v)[0] == Vec.Zero())
+
+      with self.assertRaises(TypeError):
+        Vector(np.random.rand(20, 3))
+
+class TestSVAVectorBatch(unittest.TestCase):
+  def test(self):
+    create_random_pt = lambda: sva.PTransformd(eigen.Quaterniond(eigen.Vector4d.Random().normalized()), eigen.Vector3d().Random()*100)
+    create_random_mv = lambda: sva.MotionVecd(eigen.Vector6d().Random())
+    create_random_fv = lambda: sva.ForceVecd(eigen.Vector6d().Random())
+
+    pts1 = [create_random_pt() for i in range(100)]
+    pts2 = [create_random_pt() for i in range(100)]
+    mvs = [create_random_mv() for i in range(100)]
+    fvs = [create_random_fv() for i in range(100)]
+    pt = create_random_pt()
+    v1 = sva.PTransformdVector(pts1)
+    v2 = sva.PTransformdVector(pts2)
+    mvv = sva.MotionVecdVector(mvs)
+    fvv = sva.ForceVecdVector(fvs)
+
+    # Check the batch operations against the element-wise ones
+    def check(res, expected):
+      assert(len(res) == len(expected))
+      assert(all([r == e for r, e in zip(res, expected)]))
+
+    check(v1 * v2, [X1 * X2 for X1, X2 in zip(pts1, pts2)])
+    check(v1 * pt, [X1 * pt for X1 in pts1])
+    check(pt * v1, [pt * X1 for X1 in pts1])
+    check(v1 * mvv, [X1 * mv for X1, mv in zip(pts1, mvs)])
+    check(pt * mvv, [pt * mv for mv in mvs])
+    check(v1.invMul(mvv), [X1.invMul(mv) for X1, mv in zip(pts1, mvs)])
+    check(pt.invMul(mvv), [pt.invMul(mv) for mv in mvs])
+    check(v1.dualMul(fvv), [X1.dualMul(fv) for X1, fv in zip(pts1, fvs)])
+    check(pt.dualMul(fvv), [pt.dualMul(fv) for fv in fvs])
+    check(v1.transMul(fvv), [X1.transMul(fv) for X1, fv in zip(pts1, fvs)])
+    check(pt.transMul(fvv), [pt.transMul(fv) for fv in fvs])
+    check(v1.inv(), [X1.inv() for X1 in pts1])
+    check(sva.transformError(v1, v2), [sva.transformError(X1, X2) for X1, X2 in zip(pts1, pts2)])
+
+    with self.assertRaises(ValueError):
+      v1 * sva.PTransformdVector(pts2[:10])
+
+    # The batch operations release the GIL, run them from several threads
+    import threading
+    results = [None] * 4
+    def work(i):
+      results[i] = sva.transformError(v1, v2)
+    threads = [threading.Thread(target = work, args = (i,)) for i in range(len(results))]
+    for t in threads:
+      t.start()
+    for t in threads:
+      t.join()
+    for r in results:
+      check(r, list(results[0]))
+
 if __name__ == "__main__":
   suite = unittest.TestSuite()
   suite.addTest(TestSVAPTransformdVector('test'))
   suite.addTest(TestSVAMotionVecdVector('test'))
+  suite.addTest(TestSVAVectorNumPy('test_ptransform'))
+  suite.addTest(TestSVAVectorNumPy('test_vec'))
+  suite.addTest(TestSVAVectorBatch('test'))
   unittest.TextTestRunner(verbosity=2).run(suite)
@@ -34,3 +34,38 @@ class TestSVAPickle(unittest.TestCase):
     test_pickle(pt)
     test_pickle(rb)
     test_pickle(ab)
+
+  def test_protocols(self):
+    mv = sva.MotionVecd(e3.Vector6d.Random())
+    fv = sva.ForceVecd(e3.Vector6d.Random())
+    pt = sva.PTransformd(e3.Quaterniond(e3.Vector4d.Random().normalized()),
+                                        e3.Vector3d.Random())
+    rb = sva.RBInertiad(3., e3.Vector3d.Random(), e3.Matrix3d.Random())
+    ab = sva.ABInertiad(e3.Matrix3d.Random(), e3.Matrix3d.Random(),
+                        e3.Matrix3d.Random())
+    ptv = sva.PTransformdVector([pt, pt.inv(), sva.PTransformd.Identity()])
+    mvv = sva.MotionVecdVector([mv, -mv])
+    fvv = sva.ForceVecdVector([fv, -fv])
+
+    def test_pickle(v, protocol):
+      v2 = pickle.loads(pickle.dumps(v, protocol = protocol))
+      if isinstance(v, (sva.PTransformdVector, sva.MotionVecdVector, sva.ForceVecdVector)):
+        self.assertEqual(list(v), list(v2))
+      else:
+        self.assertEqual(v, v2)
+
+    for protocol in range(pickle.HIGHEST_PROTOCOL + 1):
+      for v in [mv, fv, pt, rb, ab, ptv, mvv, fvv, sva.MotionVecdVector()]:
+        test_pickle(v, protocol)
+
+    # protocol 5 ships the coefficients out-of-band
+    if pickle.HIGHEST_PROTOCOL >= 5:
+      for v in [pt, rb, ptv, mvv, fvv]:
+        buffers = []
+        data = pickle.dumps(v, protocol = 5, buffer_callback = buffers.append)
+        self.assertEqual(len(buffers), 1)
+        v2 = pickle.loads(data, buffers = buffers)
+        if isinstance(v, (sva.PTransformdVector, sva.MotionVecdVector, sva.ForceVecdVector)):
+          self.assertEqual(list(v), list(v2))
+        else:
+          self.assertEqual(v, v2)
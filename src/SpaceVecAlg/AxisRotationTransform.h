@@ -0,0 +1,237 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+#include "EigenTypedef.h"
+#include "fwd.h"
+
+namespace sva
+{
+
+namespace sva_internal
+{
+
+/**
+ * result = E*m where E is the rotation about the Axis axis of cosine c and sine s.
+ * Only the two rows of m orthogonal to the axis are combined.
+ * m and result must not alias.
+ */
+template<int Axis, typename T, typename Derived1, typename Derived2>
+inline void axisRotationMul(T c,
+                            T s,
+                            const Eigen::MatrixBase<Derived1> & m,
+                            Eigen::MatrixBase<Derived2> const & result)
+{
+  static_assert(Derived1::RowsAtCompileTime == 3, "m must have exactly 3 rows");
+  constexpr int I = (Axis + 1) % 3;
+  constexpr int J = (Axis + 2) % 3;
+  Eigen::MatrixBase<Derived2> & result_nc = const_cast<Eigen::MatrixBase<Derived2> &>(result);
+  result_nc.row(Axis) = m.row(Axis);
+  result_nc.row(I) = c * m.row(I) + s * m.row(J);
+  result_nc.row(J) = c * m.row(J) - s * m.row(I);
+}
+
+/// @return E*v where E is the rotation about the Axis axis of cosine c and sine s.
+template<int Axis, typename T>
+inline Eigen::Vector3<T> axisRotationMul(T c, T s, const Eigen::Vector3<T> & v)
+{
+  constexpr int I = (Axis + 1) % 3;
+  constexpr int J = (Axis + 2) % 3;
+  Eigen::Vector3<T> ret;
+  ret(Axis) = v(Axis);
+  ret(I) = c * v(I) + s * v(J);
+  ret(J) = c * v(J) - s * v(I);
+  return ret;
+}
+
+} // namespace sva_internal
+
+/**
+ * Plücker transform of a rotation about the X (Axis = 0), Y (Axis = 1) or
+ * Z (Axis = 2) axis.
+ * Only the cosine and sine of the angle are stored and the operators only
+ * combine the two rows (or columns) orthogonal to the axis.
+ * The rotation is exprimed in successor frame (rotation() == RotX(theta) for Axis = 0).
+ */
+template<typename T, int Axis>
+class AxisRotationTransform
+{
+  static_assert(Axis >= 0 && Axis < 3, "Axis must be 0 (X), 1 (Y) or 2 (Z)");
+
+  typedef Eigen::Vector3<T> vector3_t;
+  typedef Eigen::Matrix3<T> matrix3_t;
+  typedef Eigen::Matrix6<T> matrix6_t;
+
+public:
+  /// Identity transformation.
+  static AxisRotationTransform<T, Axis> Identity()
+  {
+    return AxisRotationTransform<T, Axis>(T(1), T(0));
+  }
+
+public:
+  // Constructors
+  /// Default constructor. Angle is uninitialized.
+  AxisRotationTransform() : c_(), s_() {}
+
+  /// Copy constructor.
+  template<typename T2>
+  AxisRotationTransform(const AxisRotationTransform<T2, Axis> & art) : c_(T(art.cos())), s_(T(art.sin()))
+  {
+  }
+
+  /// @param theta Rotation angle in radian.
+  explicit AxisRotationTransform(T theta)
+  {
+    using std::cos;
+    using std::sin;
+    c_ = cos(theta);
+    s_ = sin(theta);
+  }
+
+  /**
+   * @param c Cosine of the rotation angle.
+   * @param s Sine of the rotation angle.
+   */
+  AxisRotationTransform(T c, T s) : c_(c), s_(s) {}
+
+  // Accessor
+  /// @return Cosine of the rotation angle.
+  T cos() const
+  {
+    return c_;
+  }
+
+  /// @return Sine of the rotation angle.
+  T sin() const
+  {
+    return s_;
+  }
+
+  /// @return Rotation matrix.
+  matrix3_t rotation() const
+  {
+    constexpr int I = (Axis + 1) % 3;
+    constexpr int J = (Axis + 2) % 3;
+    matrix3_t E = matrix3_t::Zero();
+    E(Axis, Axis) = T(1);
+    E(I, I) = c_;
+    E(I, J) = s_;
+    E(J, I) = -s_;
+    E(J, J) = c_;
+    return E;
+  }
+
+  /// @return Equivalent PTransform.
+  PTransform<T> ptransform() const;
+
+  /// @return Equivalent RotationTransform.
+  RotationTransform<T> rotationTransform() const;
+
+  /// @return Non compact Plücker transformation matrix.
+  matrix6_t matrix() const
+  {
+    const matrix3_t E = rotation();
+    matrix6_t m;
+    m << E, matrix3_t::Zero(), matrix3_t::Zero(), E;
+    return m;
+  }
+
+  /// @return Non compact dual Plücker transformation matrix.
+  matrix6_t dualMatrix() const
+  {
+    return matrix();
+  }
+
+  template<typename T2>
+  AxisRotationTransform<T2, Axis> cast() const
+  {
+    return AxisRotationTransform<T2, Axis>(*this);
+  }
+
+  // Operators
+  /// @return X*X
+  AxisRotationTransform<T, Axis> operator*(const AxisRotationTransform<T, Axis> & art) const
+  {
+    return AxisRotationTransform<T, Axis>(c_ * art.c_ - s_ * art.s_, s_ * art.c_ + c_ * art.s_);
+  }
+
+  /// @return X*X
+  PTransform<T> operator*(const PTransform<T> & pt) const;
+
+  /// @return Xv
+  MotionVec<T> operator*(const MotionVec<T> & mv) const;
+  /// @see operator*(const MotionVec<T>& mv) const;
+  template<typename Derived>
+  void mul(const Eigen::MatrixBase<Derived> & mv, Eigen::MatrixBase<Derived> & result) const;
+
+  /// @return X^-1 v
+  MotionVec<T> invMul(const MotionVec<T> & mv) const;
+  /// @see invMul
+  template<typename Derived>
+  void invMul(const Eigen::MatrixBase<Derived> & mv, Eigen::MatrixBase<Derived> & result) const;
+
+  /// @return X*v
+  ForceVec<T> dualMul(const ForceVec<T> & fv) const;
+  /// @see dualMul
+  template<typename Derived>
+  void dualMul(const Eigen::MatrixBase<Derived> & fv, Eigen::MatrixBase<Derived> & result) const;
+
+  /// @return Xtv
+  ForceVec<T> transMul(const ForceVec<T> & fv) const;
+  /// @see transMul
+  template<typename Derived>
+  void transMul(const Eigen::MatrixBase<Derived> & fv, Eigen::MatrixBase<Derived> & result) const;
+
+  /// @return X*IX^-1
+  RBInertia<T> dualMul(const RBInertia<T> & rbI) const;
+  /// @return XtIX
+  RBInertia<T> transMul(const RBInertia<T> & rbI) const;
+
+  /// @return X*IX^-1
+  ABInertia<T> dualMul(const ABInertia<T> & rbI) const;
+  /// @return XtIX
+  ABInertia<T> transMul(const ABInertia<T> & rbI) const;
+
+  /// @return Inverse Plücker transformation.
+  AxisRotationTransform<T, Axis> inv() const
+  {
+    return AxisRotationTransform<T, Axis>(c_, -s_);
+  }
+
+  bool operator==(const AxisRotationTransform<T, Axis> & art) const
+  {
+    return c_ == art.c_ && s_ == art.s_;
+  }
+
+  bool operator!=(const AxisRotationTransform<T, Axis> & art) const
+  {
+    return !(*this == art);
+  }
+
+private:
+  T c_, s_;
+};
+
+/// Rotation about the X axis, see RotX.
+template<typename T>
+using RotXTransform = AxisRotationTransform<T, 0>;
+
+/// Rotation about the Y axis, see RotY.
+template<typename T>
+using RotYTransform = AxisRotationTransform<T, 1>;
+
+/// Rotation about the Z axis, see RotZ.
+template<typename T>
+using RotZTransform = AxisRotationTransform<T, 2>;
+
+template<typename T, int Axis>
+inline std::ostream & operator<<(std::ostream & out, const AxisRotationTransform<T, Axis> & art)
+{
+  out << art.matrix();
+  return out;
+}
+
+} // namespace sva
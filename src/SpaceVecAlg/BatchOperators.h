@@ -0,0 +1,1142 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+#include "SpaceVecAlg"
+
+#include <utility>
+
+namespace sva
+{
+
+// Batch operators implementation
+
+namespace sva_internal
+{
+
+/// Coefficients of a single transformation broadcast over a block of a batch.
+template<typename T>
+class BroadcastLanes
+{
+public:
+  typedef typename PTransformBatch<T>::index_t index_t;
+
+public:
+  BroadcastLanes(const PTransform<T> & pt) : pt_(pt) {}
+
+  void setBlock(index_t /* start */, index_t /* n */) {}
+
+  T E(int row, int col) const
+  {
+    return pt_.rotation()(row, col);
+  }
+
+  T r(int i) const
+  {
+    return pt_.translation()(i);
+  }
+
+private:
+  const PTransform<T> & pt_;
+};
+
+/// Coefficients of the transformations of a block of a batch.
+template<typename T>
+class BatchLanes
+{
+public:
+  typedef typename PTransformBatch<T>::index_t index_t;
+  typedef decltype(std::declval<typename PTransformBatch<T>::const_lane_t>().segment(0, 0).array()) lane_t;
+
+public:
+  BatchLanes(const PTransformBatch<T> & ptb) : ptb_(ptb), start_(0), n_(0) {}
+
+  void setBlock(index_t start, index_t n)
+  {
+    start_ = start;
+    n_ = n;
+  }
+
+  lane_t E(int row, int col) const
+  {
+    return ptb_.rotation(row, col).segment(start_, n_).array();
+  }
+
+  lane_t r(int i) const
+  {
+    return ptb_.translation(i).segment(start_, n_).array();
+  }
+
+private:
+  const PTransformBatch<T> & ptb_;
+  index_t start_;
+  index_t n_;
+};
+
+/// out = E*v where v and out are n x 3 blocks of lanes.
+template<typename Lanes, typename Derived1, typename Derived2>
+inline void lanesRotationMul(const Lanes & X,
+                             const Eigen::MatrixBase<Derived1> & v,
+                             Eigen::MatrixBase<Derived2> const & out)
+{
+  Eigen::MatrixBase<Derived2> & out_nc = const_cast<Eigen::MatrixBase<Derived2> &>(out);
+  for(int i = 0; i < 3; ++i)
+  {
+    out_nc.col(i).array() =
+        X.E(i, 0) * v.col(0).array() + X.E(i, 1) * v.col(1).array() + X.E(i, 2) * v.col(2).array();
+  }
+}
+
+/// out = E^T*v where v and out are n x 3 blocks of lanes.
+template<typename Lanes, typename Derived1, typename Derived2>
+inline void lanesRotationTransMul(const Lanes & X,
+                                  const Eigen::MatrixBase<Derived1> & v,
+                                  Eigen::MatrixBase<Derived2> const & out)
+{
+  Eigen::MatrixBase<Derived2> & out_nc = const_cast<Eigen::MatrixBase<Derived2> &>(out);
+  for(int i = 0; i < 3; ++i)
+  {
+    out_nc.col(i).array() =
+        X.E(0, i) * v.col(0).array() + X.E(1, i) * v.col(1).array() + X.E(2, i) * v.col(2).array();
+  }
+}
+
+/// out += r x v where v and out are n x 3 blocks of lanes.
+template<typename Lanes, typename Derived1, typename Derived2>
+inline void lanesTranslationCrossPlusEq(const Lanes & X,
+                                        const Eigen::MatrixBase<Derived1> & v,
+                                        Eigen::MatrixBase<Derived2> const & out)
+{
+  Eigen::MatrixBase<Derived2> & out_nc = const_cast<Eigen::MatrixBase<Derived2> &>(out);
+  out_nc.col(0).array() += X.r(1) * v.col(2).array() - X.r(2) * v.col(1).array();
+  out_nc.col(1).array() += X.r(2) * v.col(0).array() - X.r(0) * v.col(2).array();
+  out_nc.col(2).array() += X.r(0) * v.col(1).array() - X.r(1) * v.col(0).array();
+}
+
+/// out -= r x v where v and out are n x 3 blocks of lanes.
+template<typename Lanes, typename Derived1, typename Derived2>
+inline void lanesTranslationCrossMinusEq(const Lanes & X,
+                                         const Eigen::MatrixBase<Derived1> & v,
+                                         Eigen::MatrixBase<Derived2> const & out)
+{
+  Eigen::MatrixBase<Derived2> & out_nc = const_cast<Eigen::MatrixBase<Derived2> &>(out);
+  out_nc.col(0).array() -= X.r(1) * v.col(2).array() - X.r(2) * v.col(1).array();
+  out_nc.col(1).array() -= X.r(2) * v.col(0).array() - X.r(0) * v.col(2).array();
+  out_nc.col(2).array() -= X.r(0) * v.col(1).array() - X.r(1) * v.col(0).array();
+}
+
+/// out = a x b where a, b and out are n x 3 blocks of lanes.
+template<typename Derived1, typename Derived2, typename Derived3>
+inline void lanesCrossEq(const Eigen::MatrixBase<Derived1> & a,
+                         const Eigen::MatrixBase<Derived2> & b,
+                         Eigen::MatrixBase<Derived3> const & out)
+{
+  Eigen::MatrixBase<Derived3> & out_nc = const_cast<Eigen::MatrixBase<Derived3> &>(out);
+  out_nc.col(0).array() = a.col(1).array() * b.col(2).array() - a.col(2).array() * b.col(1).array();
+  out_nc.col(1).array() = a.col(2).array() * b.col(0).array() - a.col(0).array() * b.col(2).array();
+  out_nc.col(2).array() = a.col(0).array() * b.col(1).array() - a.col(1).array() * b.col(0).array();
+}
+
+/// out += a x b where a, b and out are n x 3 blocks of lanes.
+template<typename Derived1, typename Derived2, typename Derived3>
+inline void lanesCrossPlusEq(const Eigen::MatrixBase<Derived1> & a,
+                             const Eigen::MatrixBase<Derived2> & b,
+                             Eigen::MatrixBase<Derived3> const & out)
+{
+  Eigen::MatrixBase<Derived3> & out_nc = const_cast<Eigen::MatrixBase<Derived3> &>(out);
+  out_nc.col(0).array() += a.col(1).array() * b.col(2).array() - a.col(2).array() * b.col(1).array();
+  out_nc.col(1).array() += a.col(2).array() * b.col(0).array() - a.col(0).array() * b.col(2).array();
+  out_nc.col(2).array() += a.col(0).array() * b.col(1).array() - a.col(1).array() * b.col(0).array();
+}
+
+/// Xv on a block of motion vectors.
+struct MotionMulKernel
+{
+  template<typename Lanes, typename In, typename Out>
+  void operator()(const Lanes & X, const In & mv, Out & res) const
+  {
+    // linear = E*(l - r x a), r x a is subtracted in place in res
+    res.template rightCols<3>() = mv.template rightCols<3>();
+    lanesTranslationCrossMinusEq(X, mv.template leftCols<3>(), res.template rightCols<3>());
+    BatchBlock<typename Out::Scalar, 3> w = res.template rightCols<3>();
+
+    lanesRotationMul(X, mv.template leftCols<3>(), res.template leftCols<3>());
+    lanesRotationMul(X, w, res.template rightCols<3>());
+  }
+};
+
+/// X^-1 v on a block of motion vectors.
+struct MotionInvMulKernel
+{
+  template<typename Lanes, typename In, typename Out>
+  void operator()(const Lanes & X, const In & mv, Out & res) const
+  {
+    lanesRotationTransMul(X, mv.template leftCols<3>(), res.template leftCols<3>());
+    lanesRotationTransMul(X, mv.template rightCols<3>(), res.template rightCols<3>());
+    lanesTranslationCrossPlusEq(X, res.template leftCols<3>(), res.template rightCols<3>());
+  }
+};
+
+/// X*f on a block of force vectors.
+struct ForceDualMulKernel
+{
+  template<typename Lanes, typename In, typename Out>
+  void operator()(const Lanes & X, const In & fv, Out & res) const
+  {
+    // couple = E*(n - r x f), r x f is subtracted in place in res
+    res.template leftCols<3>() = fv.template leftCols<3>();
+    lanesTranslationCrossMinusEq(X, fv.template rightCols<3>(), res.template leftCols<3>());
+    BatchBlock<typename Out::Scalar, 3> w = res.template leftCols<3>();
+
+    lanesRotationMul(X, w, res.template leftCols<3>());
+    lanesRotationMul(X, fv.template rightCols<3>(), res.template rightCols<3>());
+  }
+};
+
+/// Xtf on a block of force vectors.
+struct ForceTransMulKernel
+{
+  template<typename Lanes, typename In, typename Out>
+  void operator()(const Lanes & X, const In & fv, Out & res) const
+  {
+    lanesRotationTransMul(X, fv.template rightCols<3>(), res.template rightCols<3>());
+    lanesRotationTransMul(X, fv.template leftCols<3>(), res.template leftCols<3>());
+    lanesTranslationCrossPlusEq(X, res.template rightCols<3>(), res.template leftCols<3>());
+  }
+};
+
+/**
+ * Apply kernel block by block to the rows [begin, end) of the 6 lanes vectors
+ * batch in and store the result in out, that must already have the size of in.
+ * Each block is computed in a scratch buffer so in and out can be the same batch.
+ */
+template<typename Kernel, typename Lanes, typename Batch>
+inline void batchApply(Lanes X,
+                       const Batch & in,
+                       Batch & out,
+                       typename Batch::index_t begin,
+                       typename Batch::index_t end)
+{
+  typedef typename Batch::storage_t::Scalar T;
+  typedef typename Batch::index_t index_t;
+
+  BatchBlock<T, 6> res;
+  Kernel kernel;
+  for(index_t start = begin; start < end; start += batchBlockSize)
+  {
+    const index_t n = std::min<index_t>(batchBlockSize, end - start);
+    X.setBlock(start, n);
+    res.resize(n, 6);
+    kernel(X, in.data().middleRows(start, n), res);
+    out.data().middleRows(start, n) = res;
+  }
+}
+
+/// Apply kernel to the whole batch in, out is resized if needed.
+template<typename Kernel, typename Lanes, typename Batch>
+inline void batchApply(Lanes X, const Batch & in, Batch & out)
+{
+  out.resize(in.size());
+  batchApply<Kernel>(X, in, out, 0, in.size());
+}
+
+/**
+ * out = rotationVelocity(E) where the lane 3*i + j of E holds E(i, j) and out
+ * is a n x 3 block of lanes.
+ * The regular formula is evaluated on whole lanes. The small angle and near pi
+ * cases are rare, when a block contains some of them only these elements go
+ * through the scalar rotationVelocity.
+ */
+template<typename Derived1, typename Derived2>
+inline void lanesRotationVelocity(const Eigen::MatrixBase<Derived1> & E, Eigen::MatrixBase<Derived2> const & out)
+{
+  typedef typename Derived1::Scalar T;
+  typedef Eigen::Array<T, Eigen::Dynamic, 1, Eigen::ColMajor, batchBlockSize, 1> lane_t;
+  // same bounds as sinc_inv and rotationVelocity
+  constexpr T sqsqeps = details::sqrt(details::sqrt(std::numeric_limits<T>::epsilon()));
+
+  Eigen::MatrixBase<Derived2> & out_nc = const_cast<Eigen::MatrixBase<Derived2> &>(out);
+  auto e = [&E](int i, int j) { return E.col(3 * i + j).array(); };
+
+  const lane_t trace = e(0, 0) + e(1, 1) + e(2, 2);
+  const lane_t c = ((trace - T(1)) * T(0.5)).max(T(-1)).min(T(1));
+  const lane_t theta = c.acos();
+  // theta/(2 sin(theta)) with sin(theta) = sqrt((1 - c)(1 + c)) since theta is in [0, pi]
+  const lane_t halfSincInv = T(0.5) * theta / ((T(1) - c) * (T(1) + c)).sqrt();
+  out_nc.col(0).array() = (e(1, 2) - e(2, 1)) * halfSincInv;
+  out_nc.col(1).array() = (e(2, 0) - e(0, 2)) * halfSincInv;
+  out_nc.col(2).array() = (e(0, 1) - e(1, 0)) * halfSincInv;
+
+  if((theta < sqsqeps).any() || ((trace + T(1)) < sqsqeps).any())
+  {
+    for(Eigen::Index k = 0; k < E.rows(); ++k)
+    {
+      if(theta(k) < sqsqeps || trace(k) + T(1) < sqsqeps)
+      {
+        Eigen::Matrix3<T> Ek;
+        for(int i = 0; i < 3; ++i)
+        {
+          for(int j = 0; j < 3; ++j)
+          {
+            Ek(i, j) = E(k, 3 * i + j);
+          }
+        }
+        out_nc.row(k) = rotationVelocity(Ek).transpose();
+      }
+    }
+  }
+}
+
+/// out = details::alternatingFactorialSeries<N>(x2) where x2 and out are lanes.
+template<int N, typename Derived1, typename Derived2>
+inline void lanesAlternatingFactorialSeries(const Eigen::ArrayBase<Derived1> & x2,
+                                            Eigen::ArrayBase<Derived2> const & out)
+{
+  typedef typename Derived1::Scalar T;
+  Eigen::ArrayBase<Derived2> & out_nc = const_cast<Eigen::ArrayBase<Derived2> &>(out);
+  out_nc.setOnes();
+  for(int k = details::alternatingFactorialSeriesTerms - 1; k > 0; --k)
+  {
+    out_nc = T(1) - x2 * out_nc * (T(1) / static_cast<T>((N + 2 * k - 1) * (N + 2 * k)));
+  }
+  out_nc *= T(1) / details::factorial<T>(N);
+}
+
+/**
+ * Coefficients of the exponential map of the n x 3 block of angular velocity
+ * lanes w. The columns of out are theta^2, sinc(theta), details::SO3JacG1(theta)
+ * and details::SO3JacG2(theta).
+ * Each coefficient is selected lane-wise between its Taylor series and its
+ * closed form, so the small angle lanes do not need any branch.
+ */
+template<typename Derived1, typename Derived2>
+inline void lanesSO3Coeffs(const Eigen::MatrixBase<Derived1> & w, Eigen::MatrixBase<Derived2> const & out)
+{
+  typedef typename Derived1::Scalar T;
+  typedef Eigen::Array<T, Eigen::Dynamic, 1, Eigen::ColMajor, batchBlockSize, 1> lane_t;
+  constexpr T bound1 = details::alternatingFactorialSeriesBound<1, T>();
+  constexpr T bound2 = details::alternatingFactorialSeriesBound<2, T>();
+  constexpr T bound3 = details::alternatingFactorialSeriesBound<3, T>();
+
+  Eigen::MatrixBase<Derived2> & out_nc = const_cast<Eigen::MatrixBase<Derived2> &>(out);
+  auto theta2 = out_nc.col(0).array();
+  theta2 = w.col(0).array().square() + w.col(1).array().square() + w.col(2).array().square();
+  const lane_t theta = theta2.sqrt();
+  const lane_t s = theta.sin();
+  lane_t series(w.rows());
+
+  lanesAlternatingFactorialSeries<1>(theta2, series);
+  out_nc.col(1).array() = (theta < bound1).select(series, s / theta);
+  lanesAlternatingFactorialSeries<2>(theta2, series);
+  out_nc.col(2).array() = (theta < bound2).select(series, (T(1) - theta.cos()) / theta2);
+  lanesAlternatingFactorialSeries<3>(theta2, series);
+  out_nc.col(3).array() = (theta < bound3).select(series, (theta - s) / (theta2 * theta));
+}
+
+/**
+ * Jacobians of SE(3) of the n x 6 block of motion vector lanes nu,
+ * see sva_internal::SE3Jac(const MotionVec<T>&, T) for the formulas.
+ * out is a n x 18 block of lanes with D(i, j) in lane 3*i + j and L(i, j)
+ * in lane 9 + 3*i + j.
+ */
+template<typename Derived1, typename Derived2>
+inline void lanesSE3Jac(const Eigen::MatrixBase<Derived1> & nu,
+                        typename Derived1::Scalar sign,
+                        Eigen::MatrixBase<Derived2> const & out)
+{
+  typedef typename Derived1::Scalar T;
+  typedef Eigen::Array<T, Eigen::Dynamic, 1, Eigen::ColMajor, batchBlockSize, 1> lane_t;
+  constexpr T bound4 = details::alternatingFactorialSeriesBound<4, T>();
+
+  Eigen::MatrixBase<Derived2> & out_nc = const_cast<Eigen::MatrixBase<Derived2> &>(out);
+  auto w = [&nu](int i) { return nu.col(i).array(); };
+  auto v = [&nu](int i) { return nu.col(3 + i).array(); };
+
+  BatchBlock<T, 4> coeffs(nu.rows(), 4);
+  lanesSO3Coeffs(nu.template leftCols<3>(), coeffs);
+  const auto theta2 = coeffs.col(0).array();
+  const auto g1 = coeffs.col(2).array();
+  const auto g2 = coeffs.col(3).array();
+
+  lane_t s4(nu.rows()), s5(nu.rows());
+  lanesAlternatingFactorialSeries<4>(theta2, s4);
+  lanesAlternatingFactorialSeries<5>(theta2, s5);
+  const lane_t g3 = (theta2 < bound4 * bound4).select(s4, (T(0.5) - g1) / theta2);
+  const lane_t g4 = (theta2 < bound4 * bound4)
+                        .select(T(0.5) * (s4 - T(3) * s5), T(0.5) * (g3 - T(3) * (T(1) / 6 - g2) / theta2));
+
+  const lane_t d = w(0) * v(0) + w(1) * v(1) + w(2) * v(2);
+  const lane_t g4d = T(2) * g4 * d;
+  // D = g2 w w^T + (1 - g2 theta^2) I + sign g1 [w]x
+  // L = g2 (w v^T + v w^T) - 2 g4 d w w^T + d (g2 - g1) I + sign (g1 [v]x + d (2 g3 - g2) [w]x)
+  for(int i = 0; i < 3; ++i)
+  {
+    for(int j = 0; j < 3; ++j)
+    {
+      out_nc.col(3 * i + j).array() = g2 * w(i) * w(j);
+      out_nc.col(9 + 3 * i + j).array() = g2 * (w(i) * v(j) + v(i) * w(j)) - g4d * w(i) * w(j);
+    }
+    out_nc.col(4 * i).array() += T(1) - g2 * theta2;
+    out_nc.col(9 + 4 * i).array() += d * (g2 - g1);
+  }
+
+  const lane_t sg1 = sign * g1;
+  const lane_t sc = sign * d * (T(2) * g3 - g2);
+  for(int k = 0; k < 3; ++k)
+  {
+    // [x]x(i, j) = -x(k) and [x]x(j, i) = x(k)
+    const int i = (k + 1) % 3;
+    const int j = (k + 2) % 3;
+    out_nc.col(3 * i + j).array() -= sg1 * w(k);
+    out_nc.col(3 * j + i).array() += sg1 * w(k);
+    out_nc.col(9 + 3 * i + j).array() -= sg1 * v(k) + sc * w(k);
+    out_nc.col(9 + 3 * j + i).array() += sg1 * v(k) + sc * w(k);
+  }
+}
+
+/**
+ * Lanes version of details::alternatingFactorialFunctions<Last>: out is a n x (Last - 1)
+ * block of lanes with G_N(theta) in column N - 2.
+ * When the block mixes small and large angles, both the Taylor series and the
+ * closed forms are evaluated and selected lane-wise.
+ */
+template<int Last, typename Derived1, typename Derived2>
+inline void lanesAlternatingFactorialFunctions(const Eigen::ArrayBase<Derived1> & theta2,
+                                               Eigen::MatrixBase<Derived2> const & out)
+{
+  typedef typename Derived1::Scalar T;
+  typedef Eigen::Array<T, Eigen::Dynamic, 1, Eigen::ColMajor, batchBlockSize, 1> lane_t;
+  constexpr T bound = details::alternatingFactorialSeriesBound<Last - 1, T>();
+
+  Eigen::MatrixBase<Derived2> & out_nc = const_cast<Eigen::MatrixBase<Derived2> &>(out);
+  const lane_t theta = theta2.sqrt();
+  const Eigen::Index nSeries = (theta < bound).count();
+
+  if(nSeries != theta.rows())
+  {
+    out_nc.col(0).array() = (T(1) - theta.cos()) / theta2;
+    out_nc.col(1).array() = (T(1) - theta.sin() / theta) / theta2;
+    for(int N = 4; N <= Last; ++N)
+    {
+      out_nc.col(N - 2).array() = (T(1) / details::factorial<T>(N - 2) - out_nc.col(N - 4).array()) / theta2;
+    }
+  }
+
+  if(nSeries != 0)
+  {
+    BatchBlock<T, Last - 1> series(theta2.rows(), Last - 1);
+    lanesAlternatingFactorialSeries<Last>(theta2, series.col(Last - 2).array());
+    lanesAlternatingFactorialSeries<Last - 1>(theta2, series.col(Last - 3).array());
+    for(int N = Last - 2; N >= 2; --N)
+    {
+      series.col(N - 2).array() = T(1) / details::factorial<T>(N) - theta2 * series.col(N).array();
+    }
+
+    if(nSeries == theta.rows())
+    {
+      out_nc = series;
+    }
+    else
+    {
+      for(int N = 2; N <= Last; ++N)
+      {
+        out_nc.col(N - 2).array() = (theta < bound).select(series.col(N - 2).array(), out_nc.col(N - 2).array());
+      }
+    }
+  }
+}
+
+/**
+ * out = w a^T + a w^T + [c]x + delta I where w, a and c are n x 3 blocks of
+ * lanes and out a n x 9 block of lanes with M(i, j) in lane 3*i + j.
+ */
+template<typename Derived1, typename Derived2, typename Derived3, typename Derived4, typename Derived5>
+inline void lanesSymCrossDiag(const Eigen::MatrixBase<Derived1> & w,
+                              const Eigen::MatrixBase<Derived2> & a,
+                              const Eigen::MatrixBase<Derived3> & c,
+                              const Eigen::ArrayBase<Derived4> & delta,
+                              Eigen::MatrixBase<Derived5> const & out)
+{
+  Eigen::MatrixBase<Derived5> & out_nc = const_cast<Eigen::MatrixBase<Derived5> &>(out);
+  for(int i = 0; i < 3; ++i)
+  {
+    for(int j = 0; j < 3; ++j)
+    {
+      out_nc.col(3 * i + j).array() =
+          w.col(i).array() * a.col(j).array() + a.col(i).array() * w.col(j).array();
+    }
+    out_nc.col(4 * i).array() += delta;
+  }
+  for(int k = 0; k < 3; ++k)
+  {
+    const int i = (k + 1) % 3;
+    const int j = (k + 2) % 3;
+    out_nc.col(3 * i + j) -= c.col(k);
+    out_nc.col(3 * j + i) += c.col(k);
+  }
+}
+
+/**
+ * out = a*b where a, b and out are n x 9 blocks of 3x3 matrix lanes
+ * with M(i, j) in lane 3*i + j. out must not alias a or b.
+ */
+template<typename Derived1, typename Derived2, typename Derived3>
+inline void lanesMatrix3Mul(const Eigen::MatrixBase<Derived1> & a,
+                            const Eigen::MatrixBase<Derived2> & b,
+                            Eigen::MatrixBase<Derived3> const & out)
+{
+  Eigen::MatrixBase<Derived3> & out_nc = const_cast<Eigen::MatrixBase<Derived3> &>(out);
+  for(int i = 0; i < 3; ++i)
+  {
+    for(int j = 0; j < 3; ++j)
+    {
+      out_nc.col(3 * i + j).array() = a.col(3 * i).array() * b.col(j).array()
+                                      + a.col(3 * i + 1).array() * b.col(3 + j).array()
+                                      + a.col(3 * i + 2).array() * b.col(6 + j).array();
+    }
+  }
+}
+
+/**
+ * Lanes version of sva_internal::SE3JacL and sva_internal::SE3JacDInv.
+ * @param G lanes of details::alternatingFactorialFunctions<N>(theta^2) with N >= 5.
+ * @param L n x 9 lanes of the lower block of the Jacobian.
+ * @param DInv n x 9 lanes of the inverse of the diagonal block.
+ */
+template<typename Derived1, typename Derived2, typename Derived3, typename Derived4>
+inline void lanesSE3JacLDInv(const Eigen::MatrixBase<Derived1> & nu,
+                             const Eigen::MatrixBase<Derived2> & G,
+                             typename Derived1::Scalar sign,
+                             Eigen::MatrixBase<Derived3> const & L,
+                             Eigen::MatrixBase<Derived4> const & DInv)
+{
+  typedef typename Derived1::Scalar T;
+  typedef Eigen::Array<T, Eigen::Dynamic, 1, Eigen::ColMajor, batchBlockSize, 1> lane_t;
+  const auto w = nu.template leftCols<3>();
+  const auto v = nu.template rightCols<3>();
+  const auto g1 = G.col(0).array();
+  const auto g2 = G.col(1).array();
+  const auto g3 = G.col(2).array();
+  const lane_t g4 = T(0.5) * (G.col(2).array() - T(3) * G.col(3).array());
+
+  const lane_t theta2 = w.rowwise().squaredNorm().array();
+  const lane_t d = (w.array() * v.array()).rowwise().sum();
+  const lane_t f2 = (g2 - T(2) * g3) / (T(2) * g1);
+  BatchBlock<T, 3> a(nu.rows(), 3), c(nu.rows(), 3);
+  for(int i = 0; i < 3; ++i)
+  {
+    a.col(i).array() = g2 * v.col(i).array() - g4 * d * w.col(i).array();
+    c.col(i).array() = sign * (g1 * v.col(i).array() + d * (T(2) * g3 - g2) * w.col(i).array());
+  }
+  lanesSymCrossDiag(w, a, c, d * (g2 - g1), L);
+
+  for(int i = 0; i < 3; ++i)
+  {
+    a.col(i).array() = T(0.5) * f2 * w.col(i).array();
+  }
+  lanesSymCrossDiag(w, a, T(-0.5) * sign * w, T(1) - f2 * theta2, DInv);
+}
+
+/// Lanes version of sva_internal::SE3JacInv, see lanesSE3Jac for the layout of out.
+template<typename Derived1, typename Derived2>
+inline void lanesSE3JacInv(const Eigen::MatrixBase<Derived1> & nu,
+                           typename Derived1::Scalar sign,
+                           Eigen::MatrixBase<Derived2> const & out)
+{
+  typedef typename Derived1::Scalar T;
+  Eigen::MatrixBase<Derived2> & out_nc = const_cast<Eigen::MatrixBase<Derived2> &>(out);
+  const Eigen::Index n = nu.rows();
+
+  BatchBlock<T, 4> G(n, 4);
+  lanesAlternatingFactorialFunctions<5>(nu.template leftCols<3>().rowwise().squaredNorm().array(), G);
+  BatchBlock<T, 9> L(n, 9), LDInv(n, 9);
+  lanesSE3JacLDInv(nu, G, sign, L, out_nc.template leftCols<9>());
+  lanesMatrix3Mul(L, out_nc.template leftCols<9>(), LDInv);
+  lanesMatrix3Mul(out_nc.template leftCols<9>(), LDInv, out_nc.template rightCols<9>());
+  out_nc.template rightCols<9>() *= T(-1);
+}
+
+/// Lanes version of sva_internal::SE3JacInvDot, see lanesSE3Jac for the layout of out.
+template<typename Derived1, typename Derived2, typename Derived3>
+inline void lanesSE3JacInvDot(const Eigen::MatrixBase<Derived1> & nu,
+                              const Eigen::MatrixBase<Derived2> & dnu,
+                              typename Derived1::Scalar sign,
+                              Eigen::MatrixBase<Derived3> const & out)
+{
+  typedef typename Derived1::Scalar T;
+  typedef Eigen::Array<T, Eigen::Dynamic, 1, Eigen::ColMajor, batchBlockSize, 1> lane_t;
+  Eigen::MatrixBase<Derived3> & out_nc = const_cast<Eigen::MatrixBase<Derived3> &>(out);
+  const Eigen::Index n = nu.rows();
+  const auto w = nu.template leftCols<3>();
+  const auto v = nu.template rightCols<3>();
+  const auto dw = dnu.template leftCols<3>();
+  const auto dv = dnu.template rightCols<3>();
+
+  const lane_t theta2 = w.rowwise().squaredNorm().array();
+  BatchBlock<T, 6> G(n, 6);
+  lanesAlternatingFactorialFunctions<7>(theta2, G);
+  const auto g1 = G.col(0).array();
+  const auto g2 = G.col(1).array();
+  const auto g3 = G.col(2).array();
+  const lane_t g4 = T(0.5) * (G.col(2).array() - T(3) * G.col(3).array());
+
+  const lane_t p = (w.array() * dw.array()).rowwise().sum();
+  const lane_t d = (w.array() * v.array()).rowwise().sum();
+  const lane_t dd = (dw.array() * v.array() + w.array() * dv.array()).rowwise().sum();
+  const lane_t dg1 = p * (T(2) * G.col(2).array() - G.col(1).array());
+  const lane_t dg2 = p * (T(3) * G.col(3).array() - G.col(2).array());
+  const lane_t dg3 = p * (T(4) * G.col(4).array() - G.col(3).array());
+  const lane_t dg4 = T(0.5) * p * (T(7) * G.col(4).array() - G.col(3).array() - T(15) * G.col(5).array());
+  const lane_t f2 = (g2 - T(2) * g3) / (T(2) * g1);
+  const lane_t df2 =
+      p * ((T(5) * G.col(3).array() - g3 - T(8) * G.col(4).array()) * g1 + (g2 - T(2) * g3).square())
+      / (T(2) * g1.square());
+  const lane_t c = T(2) * g3 - g2;
+
+  BatchBlock<T, 9> L(n, 9), DInv(n, 9), LDot(n, 9), tmp1(n, 9), tmp2(n, 9);
+  lanesSE3JacLDInv(nu, G, sign, L, DInv);
+
+  BatchBlock<T, 3> a(n, 3), b(n, 3);
+  auto DInvDot = out_nc.template leftCols<9>();
+  for(int i = 0; i < 3; ++i)
+  {
+    a.col(i).array() = T(0.5) * df2 * w.col(i).array() + f2 * dw.col(i).array();
+  }
+  lanesSymCrossDiag(w, a, T(-0.5) * sign * dw, -df2 * theta2 - T(2) * f2 * p, DInvDot);
+
+  for(int i = 0; i < 3; ++i)
+  {
+    a.col(i).array() = g2 * dv.col(i).array() + dg2 * v.col(i).array() - T(2) * g4 * d * dw.col(i).array()
+                       - (dg4 * d + g4 * dd) * w.col(i).array();
+    b.col(i).array() = sign
+                       * (g1 * dv.col(i).array() + dg1 * v.col(i).array()
+                          + (dd * c + d * (T(2) * dg3 - dg2)) * w.col(i).array() + d * c * dw.col(i).array());
+  }
+  lanesSymCrossDiag(w, a, b, dd * (g2 - g1) + d * (dg2 - dg1), LDot);
+  for(int i = 0; i < 3; ++i)
+  {
+    for(int j = 0; j < 3; ++j)
+    {
+      LDot.col(3 * i + j).array() +=
+          g2 * (dw.col(i).array() * v.col(j).array() + v.col(i).array() * dw.col(j).array());
+    }
+  }
+
+  // LInvDot = -DInvDot (L DInv) - DInv (LDot DInv + L DInvDot)
+  auto LInvDot = out_nc.template rightCols<9>();
+  lanesMatrix3Mul(LDot, DInv, tmp1);
+  lanesMatrix3Mul(L, DInvDot, tmp2);
+  tmp1 += tmp2;
+  lanesMatrix3Mul(DInv, tmp1, LInvDot);
+  lanesMatrix3Mul(L, DInv, tmp1);
+  lanesMatrix3Mul(DInvDot, tmp1, tmp2);
+  LInvDot += tmp2;
+  LInvDot *= T(-1);
+}
+
+} // namespace sva_internal
+
+template<typename T>
+inline MotionVecBatch<T> MotionVecBatch<T>::cross(const MotionVecBatch<T> & mvb2) const
+{
+  MotionVecBatch<T> result(size());
+  cross(mvb2, result);
+  return result;
+}
+
+namespace sva_internal
+{
+
+/**
+ * Rows [begin, end) of MotionVecBatch::cross(const MotionVecBatch<T>&, MotionVecBatch<T>&),
+ * result must already have the size of the batches.
+ */
+template<typename T>
+inline void batchCross(const MotionVecBatch<T> & mvb1,
+                       const MotionVecBatch<T> & mvb2,
+                       MotionVecBatch<T> & result,
+                       typename MotionVecBatch<T>::index_t begin,
+                       typename MotionVecBatch<T>::index_t end)
+{
+  typedef typename MotionVecBatch<T>::index_t index_t;
+
+  BatchBlock<T, 6> res;
+  for(index_t start = begin; start < end; start += batchBlockSize)
+  {
+    const index_t n = std::min<index_t>(batchBlockSize, end - start);
+    const auto mv1 = mvb1.data().middleRows(start, n);
+    const auto mv2 = mvb2.data().middleRows(start, n);
+    res.resize(n, 6);
+
+    lanesCrossEq(mv1.template leftCols<3>(), mv2.template leftCols<3>(), res.template leftCols<3>());
+
+    lanesCrossEq(mv1.template leftCols<3>(), mv2.template rightCols<3>(), res.template rightCols<3>());
+    lanesCrossPlusEq(mv1.template rightCols<3>(), mv2.template leftCols<3>(), res.template rightCols<3>());
+
+    result.data().middleRows(start, n) = res;
+  }
+}
+
+/// Rows [begin, end) of MotionVecBatch::crossDual(const ForceVecBatch<T>&, ForceVecBatch<T>&), see batchCross.
+template<typename T>
+inline void batchCrossDual(const MotionVecBatch<T> & mvb,
+                           const ForceVecBatch<T> & fvb2,
+                           ForceVecBatch<T> & result,
+                           typename MotionVecBatch<T>::index_t begin,
+                           typename MotionVecBatch<T>::index_t end)
+{
+  typedef typename MotionVecBatch<T>::index_t index_t;
+
+  BatchBlock<T, 6> res;
+  for(index_t start = begin; start < end; start += batchBlockSize)
+  {
+    const index_t n = std::min<index_t>(batchBlockSize, end - start);
+    const auto mv = mvb.data().middleRows(start, n);
+    const auto fv = fvb2.data().middleRows(start, n);
+    res.resize(n, 6);
+
+    lanesCrossEq(mv.template leftCols<3>(), fv.template leftCols<3>(), res.template leftCols<3>());
+    lanesCrossPlusEq(mv.template rightCols<3>(), fv.template rightCols<3>(), res.template leftCols<3>());
+
+    lanesCrossEq(mv.template leftCols<3>(), fv.template rightCols<3>(), res.template rightCols<3>());
+
+    result.data().middleRows(start, n) = res;
+  }
+}
+
+} // namespace sva_internal
+
+template<typename T>
+inline void MotionVecBatch<T>::cross(const MotionVecBatch<T> & mvb2, MotionVecBatch<T> & result) const
+{
+  assert(mvb2.size() == size());
+  result.resize(size());
+  sva_internal::batchCross(*this, mvb2, result, 0, size());
+}
+
+template<typename T>
+inline ForceVecBatch<T> MotionVecBatch<T>::crossDual(const ForceVecBatch<T> & fvb2) const
+{
+  ForceVecBatch<T> result(size());
+  crossDual(fvb2, result);
+  return result;
+}
+
+template<typename T>
+inline void MotionVecBatch<T>::crossDual(const ForceVecBatch<T> & fvb2, ForceVecBatch<T> & result) const
+{
+  assert(fvb2.size() == size());
+  result.resize(size());
+  sva_internal::batchCrossDual(*this, fvb2, result, 0, size());
+}
+
+template<typename T>
+inline typename MotionVecBatch<T>::vectorX_t MotionVecBatch<T>::dot(const ForceVecBatch<T> & fvb2) const
+{
+  vectorX_t result(size());
+  dot(fvb2, result);
+  return result;
+}
+
+template<typename T>
+inline void MotionVecBatch<T>::dot(const ForceVecBatch<T> & fvb2, vectorX_t & result) const
+{
+  assert(fvb2.size() == size());
+  result.resize(size());
+  result.noalias() = data_.cwiseProduct(fvb2.data()).rowwise().sum();
+}
+
+template<typename T>
+inline MotionVecBatch<T> PTransform<T>::operator*(const MotionVecBatch<T> & mvb) const
+{
+  MotionVecBatch<T> result(mvb.size());
+  mul(mvb, result);
+  return result;
+}
+
+template<typename T>
+inline void PTransform<T>::mul(const MotionVecBatch<T> & mvb, MotionVecBatch<T> & result) const
+{
+  sva_internal::batchApply<sva_internal::MotionMulKernel>(sva_internal::BroadcastLanes<T>(*this), mvb, result);
+}
+
+template<typename T>
+inline MotionVecBatch<T> PTransform<T>::invMul(const MotionVecBatch<T> & mvb) const
+{
+  MotionVecBatch<T> result(mvb.size());
+  invMul(mvb, result);
+  return result;
+}
+
+template<typename T>
+inline void PTransform<T>::invMul(const MotionVecBatch<T> & mvb, MotionVecBatch<T> & result) const
+{
+  sva_internal::batchApply<sva_internal::MotionInvMulKernel>(sva_internal::BroadcastLanes<T>(*this), mvb, result);
+}
+
+template<typename T>
+inline ForceVecBatch<T> PTransform<T>::dualMul(const ForceVecBatch<T> & fvb) const
+{
+  ForceVecBatch<T> result(fvb.size());
+  dualMul(fvb, result);
+  return result;
+}
+
+template<typename T>
+inline void PTransform<T>::dualMul(const ForceVecBatch<T> & fvb, ForceVecBatch<T> & result) const
+{
+  sva_internal::batchApply<sva_internal::ForceDualMulKernel>(sva_internal::BroadcastLanes<T>(*this), fvb, result);
+}
+
+template<typename T>
+inline ForceVecBatch<T> PTransform<T>::transMul(const ForceVecBatch<T> & fvb) const
+{
+  ForceVecBatch<T> result(fvb.size());
+  transMul(fvb, result);
+  return result;
+}
+
+template<typename T>
+inline void PTransform<T>::transMul(const ForceVecBatch<T> & fvb, ForceVecBatch<T> & result) const
+{
+  sva_internal::batchApply<sva_internal::ForceTransMulKernel>(sva_internal::BroadcastLanes<T>(*this), fvb, result);
+}
+
+template<typename T>
+inline MotionVecBatch<T> PTransformBatch<T>::operator*(const MotionVecBatch<T> & mvb) const
+{
+  MotionVecBatch<T> result(mvb.size());
+  mul(mvb, result);
+  return result;
+}
+
+template<typename T>
+inline void PTransformBatch<T>::mul(const MotionVecBatch<T> & mvb, MotionVecBatch<T> & result) const
+{
+  assert(mvb.size() == size());
+  sva_internal::batchApply<sva_internal::MotionMulKernel>(sva_internal::BatchLanes<T>(*this), mvb, result);
+}
+
+template<typename T>
+inline MotionVecBatch<T> PTransformBatch<T>::invMul(const MotionVecBatch<T> & mvb) const
+{
+  MotionVecBatch<T> result(mvb.size());
+  invMul(mvb, result);
+  return result;
+}
+
+template<typename T>
+inline void PTransformBatch<T>::invMul(const MotionVecBatch<T> & mvb, MotionVecBatch<T> & result) const
+{
+  assert(mvb.size() == size());
+  sva_internal::batchApply<sva_internal::MotionInvMulKernel>(sva_internal::BatchLanes<T>(*this), mvb, result);
+}
+
+template<typename T>
+inline ForceVecBatch<T> PTransformBatch<T>::dualMul(const ForceVecBatch<T> & fvb) const
+{
+  ForceVecBatch<T> result(fvb.size());
+  dualMul(fvb, result);
+  return result;
+}
+
+template<typename T>
+inline void PTransformBatch<T>::dualMul(const ForceVecBatch<T> & fvb, ForceVecBatch<T> & result) const
+{
+  assert(fvb.size() == size());
+  sva_internal::batchApply<sva_internal::ForceDualMulKernel>(sva_internal::BatchLanes<T>(*this), fvb, result);
+}
+
+template<typename T>
+inline ForceVecBatch<T> PTransformBatch<T>::transMul(const ForceVecBatch<T> & fvb) const
+{
+  ForceVecBatch<T> result(fvb.size());
+  transMul(fvb, result);
+  return result;
+}
+
+template<typename T>
+inline void PTransformBatch<T>::transMul(const ForceVecBatch<T> & fvb, ForceVecBatch<T> & result) const
+{
+  assert(fvb.size() == size());
+  sva_internal::batchApply<sva_internal::ForceTransMulKernel>(sva_internal::BatchLanes<T>(*this), fvb, result);
+}
+
+namespace sva_internal
+{
+
+/**
+ * Rows [begin, end) of rotationVelocity(const PTransformBatch<T>&, Eigen::Matrix<T, Eigen::Dynamic, 3>&),
+ * result must already have the size of the batch.
+ */
+template<typename T>
+inline void batchRotationVelocity(const PTransformBatch<T> & X_a_b,
+                                  Eigen::Matrix<T, Eigen::Dynamic, 3> & result,
+                                  typename PTransformBatch<T>::index_t begin,
+                                  typename PTransformBatch<T>::index_t end)
+{
+  typedef typename PTransformBatch<T>::index_t index_t;
+  for(index_t start = begin; start < end; start += batchBlockSize)
+  {
+    const index_t n = std::min<index_t>(batchBlockSize, end - start);
+    lanesRotationVelocity(X_a_b.data().middleRows(start, n), result.middleRows(start, n));
+  }
+}
+
+/// Rows [begin, end) of transformVelocity(const PTransformBatch<T>&, MotionVecBatch<T>&), see batchRotationVelocity.
+template<typename T>
+inline void batchTransformVelocity(const PTransformBatch<T> & X_a_b,
+                                   MotionVecBatch<T> & result,
+                                   typename PTransformBatch<T>::index_t begin,
+                                   typename PTransformBatch<T>::index_t end)
+{
+  typedef typename PTransformBatch<T>::index_t index_t;
+  for(index_t start = begin; start < end; start += batchBlockSize)
+  {
+    const index_t n = std::min<index_t>(batchBlockSize, end - start);
+    const auto X = X_a_b.data().middleRows(start, n);
+    auto res = result.data().middleRows(start, n);
+    lanesRotationVelocity(X, res.template leftCols<3>());
+    res.template rightCols<3>() = X.template rightCols<3>();
+  }
+}
+
+/**
+ * Rows [begin, end) of transformError(const PTransformBatch<T>&, const PTransformBatch<T>&, MotionVecBatch<T>&),
+ * see batchRotationVelocity.
+ */
+template<typename T>
+inline void batchTransformError(const PTransformBatch<T> & X_a_b,
+                                const PTransformBatch<T> & X_a_c,
+                                MotionVecBatch<T> & result,
+                                typename PTransformBatch<T>::index_t begin,
+                                typename PTransformBatch<T>::index_t end)
+{
+  // X_b_c = X_a_c*X_a_b^-1 = (E_a_c*E_a_b^T, E_a_b*(r_a_c - r_a_b))
+  // so the error E_a_b^T*transformVelocity(X_b_c) is
+  // (E_a_b^T*rotationVelocity(E_a_c*E_a_b^T), r_a_c - r_a_b)
+  typedef typename PTransformBatch<T>::index_t index_t;
+
+  BatchBlock<T, 9> E_b_c;
+  BatchBlock<T, 3> w;
+  for(index_t start = begin; start < end; start += batchBlockSize)
+  {
+    const index_t n = std::min<index_t>(batchBlockSize, end - start);
+    const auto A = X_a_b.data().middleRows(start, n);
+    const auto C = X_a_c.data().middleRows(start, n);
+    E_b_c.resize(n, 9);
+    w.resize(n, 3);
+
+    for(int i = 0; i < 3; ++i)
+    {
+      for(int j = 0; j < 3; ++j)
+      {
+        E_b_c.col(3 * i + j).array() = C.col(3 * i).array() * A.col(3 * j).array()
+                                       + C.col(3 * i + 1).array() * A.col(3 * j + 1).array()
+                                       + C.col(3 * i + 2).array() * A.col(3 * j + 2).array();
+      }
+    }
+    lanesRotationVelocity(E_b_c, w);
+
+    auto res = result.data().middleRows(start, n);
+    for(int i = 0; i < 3; ++i)
+    {
+      res.col(i).array() = A.col(i).array() * w.col(0).array() + A.col(3 + i).array() * w.col(1).array()
+                           + A.col(6 + i).array() * w.col(2).array();
+      res.col(3 + i) = C.col(9 + i) - A.col(9 + i);
+    }
+  }
+}
+
+/// Rows [begin, end) of exp(const MotionVecBatch<T>&, PTransformBatch<T>&), see batchRotationVelocity.
+template<typename T>
+inline void batchExp(const MotionVecBatch<T> & nu,
+                     PTransformBatch<T> & result,
+                     typename PTransformBatch<T>::index_t begin,
+                     typename PTransformBatch<T>::index_t end)
+{
+  typedef typename PTransformBatch<T>::index_t index_t;
+  typedef Eigen::Array<T, Eigen::Dynamic, 1, Eigen::ColMajor, batchBlockSize, 1> lane_t;
+
+  BatchBlock<T, 4> coeffs;
+  for(index_t start = begin; start < end; start += batchBlockSize)
+  {
+    const index_t n = std::min<index_t>(batchBlockSize, end - start);
+    const auto V = nu.data().middleRows(start, n);
+    auto X = result.data().middleRows(start, n);
+    auto w = [&V](int i) { return V.col(i).array(); };
+    auto v = [&V](int i) { return V.col(3 + i).array(); };
+
+    coeffs.resize(n, 4);
+    lanesSO3Coeffs(V.template leftCols<3>(), coeffs);
+    const auto theta2 = coeffs.col(0).array();
+    const auto a = coeffs.col(1).array();
+    const auto g1 = coeffs.col(2).array();
+    const auto g2 = coeffs.col(3).array();
+
+    // E = g1 w w^T + (1 - g1 theta^2) I - sinc(theta) [w]x
+    for(int i = 0; i < 3; ++i)
+    {
+      for(int j = 0; j < 3; ++j)
+      {
+        X.col(3 * i + j).array() = g1 * w(i) * w(j);
+      }
+      X.col(4 * i).array() += T(1) - g1 * theta2;
+    }
+    X.col(1).array() += a * w(2);
+    X.col(3).array() -= a * w(2);
+    X.col(2).array() -= a * w(1);
+    X.col(6).array() += a * w(1);
+    X.col(5).array() += a * w(0);
+    X.col(7).array() -= a * w(0);
+
+    // r = v + g1 w x v + g2 w x (w x v) with w x (w x v) = (w.v) w - theta^2 v
+    const lane_t g2d = g2 * (w(0) * v(0) + w(1) * v(1) + w(2) * v(2));
+    const lane_t c = T(1) - g2 * theta2;
+    X.col(9).array() = c * v(0) + g1 * (w(1) * v(2) - w(2) * v(1)) + g2d * w(0);
+    X.col(10).array() = c * v(1) + g1 * (w(2) * v(0) - w(0) * v(2)) + g2d * w(1);
+    X.col(11).array() = c * v(2) + g1 * (w(0) * v(1) - w(1) * v(0)) + g2d * w(2);
+  }
+}
+
+} // namespace sva_internal
+
+template<typename T>
+inline void rotationVelocity(const PTransformBatch<T> & X_a_b, Eigen::Matrix<T, Eigen::Dynamic, 3> & result)
+{
+  result.resize(X_a_b.size(), 3);
+  sva_internal::batchRotationVelocity(X_a_b, result, 0, X_a_b.size());
+}
+
+template<typename T>
+inline void transformVelocity(const PTransformBatch<T> & X_a_b, MotionVecBatch<T> & result)
+{
+  result.resize(X_a_b.size());
+  sva_internal::batchTransformVelocity(X_a_b, result, 0, X_a_b.size());
+}
+
+template<typename T>
+inline void transformError(const PTransformBatch<T> & X_a_b, const PTransformBatch<T> & X_a_c, MotionVecBatch<T> & result)
+{
+  assert(X_a_c.size() == X_a_b.size());
+  result.resize(X_a_b.size());
+  sva_internal::batchTransformError(X_a_b, X_a_c, result, 0, X_a_b.size());
+}
+
+template<typename T>
+inline void exp(const MotionVecBatch<T> & nu, PTransformBatch<T> & result)
+{
+  result.resize(nu.size());
+  sva_internal::batchExp(nu, result, 0, nu.size());
+}
+
+namespace sva_internal
+{
+
+template<typename T>
+inline void batchSE3Jac(const MotionVecBatch<T> & nu, T sign, Eigen::Matrix<T, Eigen::Dynamic, 18> & result)
+{
+  typedef typename MotionVecBatch<T>::index_t index_t;
+  result.resize(nu.size(), 18);
+  for(index_t start = 0; start < nu.size(); start += batchBlockSize)
+  {
+    const index_t n = std::min<index_t>(batchBlockSize, nu.size() - start);
+    lanesSE3Jac(nu.data().middleRows(start, n), sign, result.middleRows(start, n));
+  }
+}
+
+template<typename T>
+inline void batchSE3JacInv(const MotionVecBatch<T> & nu, T sign, Eigen::Matrix<T, Eigen::Dynamic, 18> & result)
+{
+  typedef typename MotionVecBatch<T>::index_t index_t;
+  result.resize(nu.size(), 18);
+  for(index_t start = 0; start < nu.size(); start += batchBlockSize)
+  {
+    const index_t n = std::min<index_t>(batchBlockSize, nu.size() - start);
+    lanesSE3JacInv(nu.data().middleRows(start, n), sign, result.middleRows(start, n));
+  }
+}
+
+template<typename T>
+inline void batchSE3JacInvDot(const MotionVecBatch<T> & nu,
+                              const MotionVecBatch<T> & dnu,
+                              T sign,
+                              Eigen::Matrix<T, Eigen::Dynamic, 18> & result)
+{
+  typedef typename MotionVecBatch<T>::index_t index_t;
+  assert(nu.size() == dnu.size());
+  result.resize(nu.size(), 18);
+#ifdef EIGEN_VECTORIZE_AVX
+  for(index_t start = 0; start < nu.size(); start += batchBlockSize)
+  {
+    const index_t n = std::min<index_t>(batchBlockSize, nu.size() - start);
+    lanesSE3JacInvDot(nu.data().middleRows(start, n), dnu.data().middleRows(start, n), sign,
+                      result.middleRows(start, n));
+  }
+#else
+  // with 2 lanes per packet the many temporary lanes of lanesSE3JacInvDot cost
+  // more than the scalar version, the blocks are transposed so that each
+  // motion vector and Jacobian is contiguous
+  Eigen::Matrix<T, 6, batchBlockSize> nuT, dnuT;
+  Eigen::Matrix<T, 18, batchBlockSize> resultT;
+  for(index_t start = 0; start < nu.size(); start += batchBlockSize)
+  {
+    const index_t n = std::min<index_t>(batchBlockSize, nu.size() - start);
+    nuT.leftCols(n) = nu.data().middleRows(start, n).transpose();
+    dnuT.leftCols(n) = dnu.data().middleRows(start, n).transpose();
+    for(index_t i = 0; i < n; ++i)
+    {
+      const SE3Jacobian<T> J = SE3JacInvDot(MotionVec<T>(nuT.col(i)), MotionVec<T>(dnuT.col(i)), sign);
+      Eigen::Map<Eigen::Matrix<T, 3, 3>>(resultT.col(i).data()) = J.D().transpose();
+      Eigen::Map<Eigen::Matrix<T, 3, 3>>(resultT.col(i).data() + 9) = J.L().transpose();
+    }
+    result.middleRows(start, n) = resultT.leftCols(n).transpose();
+  }
+#endif
+}
+
+} // namespace sva_internal
+
+template<typename T>
+inline void SE3RightJac(const MotionVecBatch<T> & nu, Eigen::Matrix<T, Eigen::Dynamic, 18> & result)
+{
+  sva_internal::batchSE3Jac(nu, T(-1), result);
+}
+
+template<typename T>
+inline void SE3LeftJac(const MotionVecBatch<T> & nu, Eigen::Matrix<T, Eigen::Dynamic, 18> & result)
+{
+  sva_internal::batchSE3Jac(nu, T(1), result);
+}
+
+template<typename T>
+inline void SE3RightJacInv(const MotionVecBatch<T> & nu, Eigen::Matrix<T, Eigen::Dynamic, 18> & result)
+{
+  sva_internal::batchSE3JacInv(nu, T(-1), result);
+}
+
+template<typename T>
+inline void SE3LeftJacInv(const MotionVecBatch<T> & nu, Eigen::Matrix<T, Eigen::Dynamic, 18> & result)
+{
+  sva_internal::batchSE3JacInv(nu, T(1), result);
+}
+
+template<typename T>
+inline void SE3RightJacInvDot(const MotionVecBatch<T> & nu,
+                              const MotionVecBatch<T> & dnu,
+                              Eigen::Matrix<T, Eigen::Dynamic, 18> & result)
+{
+  sva_internal::batchSE3JacInvDot(nu, dnu, T(-1), result);
+}
+
+template<typename T>
+inline void SE3LeftJacInvDot(const MotionVecBatch<T> & nu,
+                             const MotionVecBatch<T> & dnu,
+                             Eigen::Matrix<T, Eigen::Dynamic, 18> & result)
+{
+  sva_internal::batchSE3JacInvDot(nu, dnu, T(1), result);
+}
+
+} // namespace sva
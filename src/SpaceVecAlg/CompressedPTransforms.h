@@ -0,0 +1,477 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+#include "SimdKernels.h"
+#include "SpaceVecAlg"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sva
+{
+
+namespace sva_internal
+{
+
+/**
+ * Smallest number of bits of a quantized component of a smallest three
+ * quaternion, with less bits the decoded rotation is not orthonormal.
+ */
+constexpr int minQuaternionComponentBits = 3;
+/// Largest number of bits of a quantized component of a smallest three quaternion.
+constexpr int maxQuaternionComponentBits = 20;
+/// Largest number of bits of a quantized component of a smallest three quaternion stored in 32 bits.
+constexpr int maxNarrowQuaternionComponentBits = 10;
+/**
+ * Bound of the rotation angle error of a smallest three quaternion over the
+ * quantization step of its components, each component error is below half a
+ * step so the quaternion error is below sqrt(3) steps at first order and the
+ * angle error below 2 sqrt(3) steps. Rounded up to bound the higher order
+ * terms on coarse steps.
+ */
+constexpr double rotationErrorFactor = 4.;
+/// Largest quantized translation difference stored in a block of CompressedPTransforms.
+constexpr std::int64_t maxTranslationDelta = 32767;
+/// Marker of a quantized translation difference that does not fit in 16 bits.
+constexpr std::int16_t translationDeltaEscape = -32768;
+
+/**
+ * Decode the first smallest three quaternions of words[0, n) with a SIMD kernel,
+ * see CompressedPTransforms::decode.
+ * @return Number of decoded quaternions, 0 when there is no kernel for T.
+ */
+template<typename Word, typename T>
+inline std::size_t simdDecodeSmallestThree(const Word *, std::size_t, int, T, T *)
+{
+  return 0;
+}
+
+#ifdef SVA_HAS_AVX2_KERNELS
+template<typename Word>
+inline std::size_t simdDecodeSmallestThree(const Word * words, std::size_t n, int bits, double step, double * out)
+{
+  return avx2DecodeSmallestThree(words, n, bits, step, out);
+}
+#endif
+
+} // namespace sva_internal
+
+/**
+ * Lossy compressed array of PTransform, for instance a history of poses.
+ *
+ * A transformation is stored in about 14.4 bytes, or 10.4 bytes with a loose
+ * angular tolerance, instead of the 96 bytes of a PTransformd:
+ *  - the rotation is stored as a smallest three quaternion: the index of the
+ *    largest component in absolute value (2 bits) and the three other
+ *    components quantized on the same number of bits, the sign of the
+ *    quaternion is chosen so that the largest component is positive and
+ *    recovered from the unit norm. The number of bits is the smallest one, at
+ *    most 20, whose rotation angle error is below the angular tolerance. The
+ *    quaternion is stored in 32 bits when it needs at most 10 bits per
+ *    component, i.e. for an angular tolerance of at least 5.53e-3, and in 64
+ *    bits otherwise. The angle of the rotation between the original and the
+ *    decoded rotation, and so the error on the rotation matrix coefficients,
+ *    is below the angular tolerance.
+ *  - the translation is quantized with a step of twice the linear tolerance,
+ *    so the error on each coefficient is below the linear tolerance. The
+ *    transformations are grouped in blocks of batchBlockSize, each block
+ *    stores the quantized translation of its first transformation and the
+ *    differences of the quantized translations of consecutive transformations
+ *    as 16 bits integers. The quantized translations are integers so the
+ *    errors do not accumulate. The rare translations whose difference does not
+ *    fit are stored on the side.
+ *
+ * The transformations are decoded directly in the PTransform array. When the
+ * code is compiled for AVX2 and FMA the rotations of PTransformd are decoded 4
+ * at a time by a SIMD kernel, see SimdKernels.h.
+ */
+template<typename T>
+class CompressedPTransforms
+{
+public:
+  typedef std::size_t index_t;
+
+  static_assert(sizeof(PTransform<T>) == 12 * sizeof(T), "PTransform must be stored as 12 contiguous coefficients");
+
+public:
+  /**
+   * @param linearTolerance Maximum error on the translation coefficients,
+   * must be strictly positive.
+   * @param angularTolerance Maximum angle in radians of the rotation error,
+   * must be at least minAngularTolerance().
+   */
+  explicit CompressedPTransforms(T linearTolerance = T(1e-5), T angularTolerance = T(1e-5))
+  : step_(2 * linearTolerance), angularTolerance_(angularTolerance), bits_(rotationBits(angularTolerance)), size_(0),
+    last_()
+  {
+    assert(linearTolerance > T(0));
+    assert(angularTolerance >= minAngularTolerance());
+  }
+
+  /// @return Smallest angular tolerance, reached with 20 bits per quaternion component.
+  static T minAngularTolerance()
+  {
+    return rotationError(sva_internal::maxQuaternionComponentBits);
+  }
+
+  /// @return Maximum error on the translation coefficients.
+  T linearTolerance() const
+  {
+    return step_ / 2;
+  }
+
+  /// @return Maximum angle in radians of the rotation error.
+  T angularTolerance() const
+  {
+    return angularTolerance_;
+  }
+
+  /// @return Number of bits of a quantized quaternion component.
+  int rotationBits() const
+  {
+    return bits_;
+  }
+
+  /// @return Number of transformations.
+  index_t size() const
+  {
+    return size_;
+  }
+
+  bool empty() const
+  {
+    return size_ == 0;
+  }
+
+  /// @return Number of bytes used to store the transformations.
+  std::size_t bytes() const
+  {
+    return narrowRotations_.size() * sizeof(std::uint32_t) + rotations_.size() * sizeof(std::uint64_t)
+           + translations_.size() * sizeof(std::int16_t)
+           + references_.size() * sizeof(std::int64_t) + outliers_.size() * sizeof(Outlier);
+  }
+
+  /// Remove all the transformations.
+  void clear()
+  {
+    narrowRotations_.clear();
+    rotations_.clear();
+    translations_.clear();
+    references_.clear();
+    outliers_.clear();
+    size_ = 0;
+  }
+
+  /// Reserve the memory of size transformations.
+  void reserve(index_t size)
+  {
+    const index_t nrBlocks = (size + blockSize - 1) / blockSize;
+    if(narrow())
+    {
+      narrowRotations_.reserve(size);
+    }
+    else
+    {
+      rotations_.reserve(size);
+    }
+    translations_.reserve(3 * blockSize * nrBlocks);
+    references_.reserve(3 * nrBlocks);
+  }
+
+  /// Append the transformation X, its rotation must be orthonormal.
+  void push_back(const PTransform<T> & X)
+  {
+    const index_t k = size_ % blockSize;
+    std::int64_t q[3];
+    for(int a = 0; a < 3; ++a)
+    {
+      q[a] = std::llround(X.translation()(a) / step_);
+    }
+
+    if(k == 0)
+    {
+      references_.insert(references_.end(), q, q + 3);
+      translations_.resize(translations_.size() + 3 * blockSize, 0);
+    }
+    else
+    {
+      std::int16_t * delta = translations_.data() + translations_.size() - 3 * blockSize + k;
+      bool outlier = false;
+      for(int a = 0; a < 3; ++a)
+      {
+        const std::int64_t d = q[a] - last_[a];
+        outlier = outlier || d < -sva_internal::maxTranslationDelta || d > sva_internal::maxTranslationDelta;
+        delta[a * blockSize] = static_cast<std::int16_t>(d);
+      }
+      if(outlier)
+      {
+        for(int a = 0; a < 3; ++a)
+        {
+          delta[a * blockSize] = sva_internal::translationDeltaEscape;
+        }
+        outliers_.push_back({size_, {q[0], q[1], q[2]}});
+      }
+    }
+    std::copy(q, q + 3, last_);
+
+    const std::uint64_t word = encodeRotation(X.rotation());
+    if(narrow())
+    {
+      narrowRotations_.push_back(static_cast<std::uint32_t>(word));
+    }
+    else
+    {
+      rotations_.push_back(word);
+    }
+    ++size_;
+  }
+
+  /// Append the n transformations of X.
+  void push_back(const PTransform<T> * X, index_t n)
+  {
+    reserve(size_ + n);
+    for(index_t i = 0; i < n; ++i)
+    {
+      push_back(X[i]);
+    }
+  }
+
+  /// Append the transformations of X.
+  void push_back(const std::vector<PTransform<T>> & X)
+  {
+    push_back(X.data(), X.size());
+  }
+
+  /// @return The i-th transformation.
+  PTransform<T> operator[](index_t i) const
+  {
+    PTransform<T> X;
+    decode(i, 1, &X);
+    return X;
+  }
+
+  /// Decode the n transformations [start, start + n) in out.
+  void decode(index_t start, index_t n, PTransform<T> * out) const
+  {
+    assert(start + n <= size_);
+    for(index_t i = start; i < start + n;)
+    {
+      const index_t m = std::min(blockSize - i % blockSize, start + n - i);
+      decodeBlock(i, m, reinterpret_cast<T *>(out + (i - start)));
+      i += m;
+    }
+  }
+
+  /// Decode all the transformations in out, out is resized if needed.
+  void decode(std::vector<PTransform<T>> & out) const
+  {
+    out.resize(size_);
+    decode(0, size_, out.data());
+  }
+
+private:
+  enum : index_t
+  {
+    blockSize = sva_internal::batchBlockSize
+  };
+
+  /// Quantized translation of the transformation index, when its difference does not fit.
+  struct Outlier
+  {
+    index_t index;
+    std::int64_t q[3];
+  };
+
+private:
+  /// Quantization step of a quaternion component in [-1/sqrt(2), 1/sqrt(2)] on bits bits.
+  static T rotationStep(int bits)
+  {
+    return T(std::sqrt(2.)) / T((std::uint64_t(1) << bits) - 1);
+  }
+
+  /// @return Bound of the rotation angle error with bits bits per quaternion component.
+  static T rotationError(int bits)
+  {
+    return T(sva_internal::rotationErrorFactor) * rotationStep(bits);
+  }
+
+  /// @return Smallest number of bits per quaternion component whose rotation error is below angularTolerance.
+  static int rotationBits(T angularTolerance)
+  {
+    int bits = sva_internal::minQuaternionComponentBits;
+    while(bits < sva_internal::maxQuaternionComponentBits && rotationError(bits) > angularTolerance)
+    {
+      ++bits;
+    }
+    return bits;
+  }
+
+  T rotationStep() const
+  {
+    return rotationStep(bits_);
+  }
+
+  /// @return True when the quaternions are stored in 32 bits.
+  bool narrow() const
+  {
+    return bits_ <= sva_internal::maxNarrowQuaternionComponentBits;
+  }
+
+  std::uint64_t encodeRotation(const Eigen::Matrix<T, 3, 3> & E) const
+  {
+    const std::uint64_t mask = (std::uint64_t(1) << bits_) - 1;
+    const Eigen::Quaternion<T> quat(E);
+    Eigen::Matrix<T, 4, 1> q = quat.coeffs();
+    int largest;
+    q.cwiseAbs().maxCoeff(&largest);
+    if(q(largest) < T(0))
+    {
+      q = -q;
+    }
+
+    const T offset = T(1) / T(std::sqrt(2.));
+    std::uint64_t word = static_cast<std::uint64_t>(largest);
+    int shift = 2;
+    for(int c = 0; c < 4; ++c)
+    {
+      if(c != largest)
+      {
+        const std::int64_t u = std::llround((q(c) + offset) / rotationStep());
+        const std::uint64_t v = static_cast<std::uint64_t>(std::max<std::int64_t>(0, u));
+        word |= std::min(v, mask) << shift;
+        shift += bits_;
+      }
+    }
+    return word;
+  }
+
+  /// Decode the smallest three quaternion word in the first 9 coefficients of out.
+  void decodeRotation(std::uint64_t word, T * out) const
+  {
+    const int bits = bits_;
+    const std::uint64_t mask = (std::uint64_t(1) << bits) - 1;
+    const T offset = T(1) / T(std::sqrt(2.));
+    const std::uint64_t largest = word & 3;
+    T small[3];
+    for(int c = 0; c < 3; ++c)
+    {
+      // the components fit in 32 bits, whose conversion is faster
+      small[c] = static_cast<T>(static_cast<std::int32_t>((word >> (2 + c * bits)) & mask)) * rotationStep() - offset;
+    }
+    const T l = std::sqrt(std::max(T(0), T(1) - small[0] * small[0] - small[1] * small[1] - small[2] * small[2]));
+
+    // Eigen::Quaternion coefficients, the largest one is missing from small
+    const T x = largest == 0 ? l : small[0];
+    const T y = largest == 1 ? l : (largest > 1 ? small[1] : small[0]);
+    const T z = largest == 2 ? l : (largest > 2 ? small[2] : small[1]);
+    const T w = largest == 3 ? l : small[2];
+    out[0] = T(1) - T(2) * (y * y + z * z);
+    out[1] = T(2) * (x * y + w * z);
+    out[2] = T(2) * (x * z - w * y);
+    out[3] = T(2) * (x * y - w * z);
+    out[4] = T(1) - T(2) * (x * x + z * z);
+    out[5] = T(2) * (y * z + w * x);
+    out[6] = T(2) * (x * z + w * y);
+    out[7] = T(2) * (y * z - w * x);
+    out[8] = T(1) - T(2) * (x * x + y * y);
+  }
+
+  /// Decode the m smallest three quaternions words in the coefficients out of m PTransform.
+  template<typename Word>
+  void decodeRotations(const Word * words, index_t m, T * out) const
+  {
+    for(index_t i = sva_internal::simdDecodeSmallestThree(words, m, bits_, rotationStep(), out); i < m; ++i)
+    {
+      decodeRotation(words[i], out + 12 * i);
+    }
+  }
+
+  /**
+   * Decode the m transformations [start, start + m), that must be in the same
+   * block, in the coefficients out of m PTransform.
+   */
+  void decodeBlock(index_t start, index_t m, T * out) const
+  {
+    if(narrow())
+    {
+      decodeRotations(narrowRotations_.data() + start, m, out);
+    }
+    else
+    {
+      decodeRotations(rotations_.data() + start, m, out);
+    }
+
+    // sum of the translation differences from the start of the block
+    const index_t block = start / blockSize;
+    const index_t blockStart = block * blockSize;
+    const index_t first = start - blockStart;
+    const std::int16_t * delta = translations_.data() + 3 * blockSize * block;
+    typename std::vector<Outlier>::const_iterator outlier = std::lower_bound(
+        outliers_.begin(), outliers_.end(), blockStart, [](const Outlier & o, index_t i) { return o.index < i; });
+    const std::int64_t * ref = references_.data() + 3 * block;
+    std::int64_t qx = ref[0], qy = ref[1], qz = ref[2];
+    const std::int16_t * dx = delta;
+    const std::int16_t * dy = delta + blockSize;
+    const std::int16_t * dz = delta + 2 * blockSize;
+    for(index_t k = 0; k < first + m; ++k)
+    {
+      if(k > 0)
+      {
+        if(dx[k] == sva_internal::translationDeltaEscape)
+        {
+          qx = outlier->q[0];
+          qy = outlier->q[1];
+          qz = outlier->q[2];
+          ++outlier;
+        }
+        else
+        {
+          qx += dx[k];
+          qy += dy[k];
+          qz += dz[k];
+        }
+      }
+      if(k >= first)
+      {
+        T * r = out + 12 * (k - first) + 9;
+        r[0] = static_cast<T>(qx) * step_;
+        r[1] = static_cast<T>(qy) * step_;
+        r[2] = static_cast<T>(qz) * step_;
+      }
+    }
+  }
+
+private:
+  T step_;
+  T angularTolerance_;
+  /// Number of bits of a quantized quaternion component.
+  int bits_;
+  index_t size_;
+  /// Smallest three quaternions, when they are stored in 32 bits.
+  std::vector<std::uint32_t> narrowRotations_;
+  /// Smallest three quaternions, when they are stored in 64 bits.
+  std::vector<std::uint64_t> rotations_;
+  /**
+   * For each block, the x, y then z lanes of the differences of the quantized
+   * translations with the previous transformation, the first element of the
+   * lanes is unused.
+   */
+  std::vector<std::int16_t> translations_;
+  /// Quantized translation of the first transformation of each block.
+  std::vector<std::int64_t> references_;
+  /// Quantized translation of the last transformation.
+  std::int64_t last_[3];
+  /// Translations that do not fit in their block, sorted by index.
+  std::vector<Outlier> outliers_;
+};
+
+typedef CompressedPTransforms<double> CompressedPTransformsd;
+
+} // namespace sva
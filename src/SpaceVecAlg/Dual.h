@@ -0,0 +1,520 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <ostream>
+
+#include <Eigen/Core>
+
+namespace sva
+{
+
+/**
+ * Forward mode dual number scalar with N derivatives stored on the stack.
+ * Unlike Eigen::AutoDiffScalar with a dynamic derivative vector, no operation
+ * allocates, so the sva templates can be instantiated with Dual<T, N> to
+ * differentiate them at a cost close to (N + 1) times the double version.
+ *
+ * The math functions (sin, cos, sqrt, ...) are defined in the sva namespace
+ * and found by argument dependent lookup.
+ */
+template<typename T, int N>
+class Dual
+{
+  static_assert(N > 0, "The derivative width must be positive");
+
+public:
+  /// Unaligned so that Dual can be stored in any container.
+  typedef Eigen::Matrix<T, N, 1, Eigen::DontAlign> derivative_t;
+
+public:
+  /**
+   * Variable number i of the differentiation.
+   * @param value Value of the variable.
+   * @param i Index of the variable, its derivative is the i-th unit vector.
+   */
+  static Dual<T, N> Variable(const T & value, int i)
+  {
+    return Dual<T, N>(value, derivative_t::Unit(i));
+  }
+
+public:
+  // Constructors
+  /// Uninitialized value and derivatives, as a built-in scalar.
+  Dual() {}
+
+  /// Constant, its derivatives are zero.
+  Dual(const T & value) : v_(value), d_(derivative_t::Zero()) {}
+
+  /**
+   * @param value Value.
+   * @param derivatives Derivatives w.r.t. the N variables.
+   */
+  Dual(const T & value, const derivative_t & derivatives) : v_(value), d_(derivatives) {}
+
+  // Accessor
+  /// @return Value.
+  const T & value() const
+  {
+    return v_;
+  }
+
+  /// @return Value.
+  T & value()
+  {
+    return v_;
+  }
+
+  /// @return Derivatives w.r.t. the N variables.
+  const derivative_t & derivatives() const
+  {
+    return d_;
+  }
+
+  /// @return Derivatives w.r.t. the N variables.
+  derivative_t & derivatives()
+  {
+    return d_;
+  }
+
+  // Operators
+  Dual<T, N> operator-() const
+  {
+    return Dual<T, N>(-v_, -d_);
+  }
+
+  Dual<T, N> & operator+=(const Dual<T, N> & x)
+  {
+    v_ += x.v_;
+    d_ += x.d_;
+    return *this;
+  }
+
+  Dual<T, N> & operator+=(const T & x)
+  {
+    v_ += x;
+    return *this;
+  }
+
+  Dual<T, N> & operator-=(const Dual<T, N> & x)
+  {
+    v_ -= x.v_;
+    d_ -= x.d_;
+    return *this;
+  }
+
+  Dual<T, N> & operator-=(const T & x)
+  {
+    v_ -= x;
+    return *this;
+  }
+
+  Dual<T, N> & operator*=(const Dual<T, N> & x)
+  {
+    d_ = x.v_ * d_ + v_ * x.d_;
+    v_ *= x.v_;
+    return *this;
+  }
+
+  Dual<T, N> & operator*=(const T & x)
+  {
+    v_ *= x;
+    d_ *= x;
+    return *this;
+  }
+
+  Dual<T, N> & operator/=(const Dual<T, N> & x)
+  {
+    // (a/b)' = (a' - (a/b) b')/b
+    v_ /= x.v_;
+    d_ = (d_ - v_ * x.d_) / x.v_;
+    return *this;
+  }
+
+  Dual<T, N> & operator/=(const T & x)
+  {
+    v_ /= x;
+    d_ /= x;
+    return *this;
+  }
+
+  friend Dual<T, N> operator+(Dual<T, N> x, const Dual<T, N> & y)
+  {
+    return x += y;
+  }
+
+  friend Dual<T, N> operator+(Dual<T, N> x, const T & y)
+  {
+    return x += y;
+  }
+
+  friend Dual<T, N> operator+(const T & x, Dual<T, N> y)
+  {
+    return y += x;
+  }
+
+  friend Dual<T, N> operator-(Dual<T, N> x, const Dual<T, N> & y)
+  {
+    return x -= y;
+  }
+
+  friend Dual<T, N> operator-(Dual<T, N> x, const T & y)
+  {
+    return x -= y;
+  }
+
+  friend Dual<T, N> operator-(const T & x, const Dual<T, N> & y)
+  {
+    return Dual<T, N>(x - y.v_, -y.d_);
+  }
+
+  friend Dual<T, N> operator*(const Dual<T, N> & x, const Dual<T, N> & y)
+  {
+    return Dual<T, N>(x.v_ * y.v_, y.v_ * x.d_ + x.v_ * y.d_);
+  }
+
+  friend Dual<T, N> operator*(Dual<T, N> x, const T & y)
+  {
+    return x *= y;
+  }
+
+  friend Dual<T, N> operator*(const T & x, Dual<T, N> y)
+  {
+    return y *= x;
+  }
+
+  friend Dual<T, N> operator/(Dual<T, N> x, const Dual<T, N> & y)
+  {
+    return x /= y;
+  }
+
+  friend Dual<T, N> operator/(Dual<T, N> x, const T & y)
+  {
+    return x /= y;
+  }
+
+  friend Dual<T, N> operator/(const T & x, const Dual<T, N> & y)
+  {
+    // (x/b)' = -(x/b) b'/b
+    const T v = x / y.v_;
+    return Dual<T, N>(v, (-v / y.v_) * y.d_);
+  }
+
+  // Comparisons only involve the values
+  friend bool operator==(const Dual<T, N> & x, const Dual<T, N> & y)
+  {
+    return x.v_ == y.v_;
+  }
+
+  friend bool operator!=(const Dual<T, N> & x, const Dual<T, N> & y)
+  {
+    return x.v_ != y.v_;
+  }
+
+  friend bool operator<(const Dual<T, N> & x, const Dual<T, N> & y)
+  {
+    return x.v_ < y.v_;
+  }
+
+  friend bool operator<=(const Dual<T, N> & x, const Dual<T, N> & y)
+  {
+    return x.v_ <= y.v_;
+  }
+
+  friend bool operator>(const Dual<T, N> & x, const Dual<T, N> & y)
+  {
+    return x.v_ > y.v_;
+  }
+
+  friend bool operator>=(const Dual<T, N> & x, const Dual<T, N> & y)
+  {
+    return x.v_ >= y.v_;
+  }
+
+  friend bool operator==(const Dual<T, N> & x, const T & y)
+  {
+    return x.v_ == y;
+  }
+
+  friend bool operator!=(const Dual<T, N> & x, const T & y)
+  {
+    return x.v_ != y;
+  }
+
+  friend bool operator<(const Dual<T, N> & x, const T & y)
+  {
+    return x.v_ < y;
+  }
+
+  friend bool operator<=(const Dual<T, N> & x, const T & y)
+  {
+    return x.v_ <= y;
+  }
+
+  friend bool operator>(const Dual<T, N> & x, const T & y)
+  {
+    return x.v_ > y;
+  }
+
+  friend bool operator>=(const Dual<T, N> & x, const T & y)
+  {
+    return x.v_ >= y;
+  }
+
+  friend bool operator==(const T & x, const Dual<T, N> & y)
+  {
+    return x == y.v_;
+  }
+
+  friend bool operator!=(const T & x, const Dual<T, N> & y)
+  {
+    return x != y.v_;
+  }
+
+  friend bool operator<(const T & x, const Dual<T, N> & y)
+  {
+    return x < y.v_;
+  }
+
+  friend bool operator<=(const T & x, const Dual<T, N> & y)
+  {
+    return x <= y.v_;
+  }
+
+  friend bool operator>(const T & x, const Dual<T, N> & y)
+  {
+    return x > y.v_;
+  }
+
+  friend bool operator>=(const T & x, const Dual<T, N> & y)
+  {
+    return x >= y.v_;
+  }
+
+private:
+  T v_;
+  derivative_t d_;
+};
+
+namespace sva_internal
+{
+
+/// @return Dual number of value v and derivatives dv*x.derivatives() (chain rule).
+template<typename T, int N>
+inline Dual<T, N> chain(const T & v, const T & dv, const Dual<T, N> & x)
+{
+  return Dual<T, N>(v, dv * x.derivatives());
+}
+
+} // namespace sva_internal
+
+// Math functions, found by argument dependent lookup from unqualified calls
+template<typename T, int N>
+inline Dual<T, N> abs(const Dual<T, N> & x)
+{
+  return x.value() < T(0) ? -x : x;
+}
+
+/**
+ * At 0 the derivative is set to zero instead of being infinite: sva only takes
+ * the square root of squared norms, whose derivatives also vanish there, to
+ * evaluate even functions of the angle.
+ */
+template<typename T, int N>
+inline Dual<T, N> sqrt(const Dual<T, N> & x)
+{
+  using std::sqrt;
+  const T s = sqrt(x.value());
+  return sva_internal::chain(s, s > T(0) ? T(0.5) / s : T(0), x);
+}
+
+template<typename T, int N>
+inline Dual<T, N> sin(const Dual<T, N> & x)
+{
+  using std::cos;
+  using std::sin;
+  return sva_internal::chain(sin(x.value()), cos(x.value()), x);
+}
+
+template<typename T, int N>
+inline Dual<T, N> cos(const Dual<T, N> & x)
+{
+  using std::cos;
+  using std::sin;
+  return sva_internal::chain(cos(x.value()), -sin(x.value()), x);
+}
+
+template<typename T, int N>
+inline Dual<T, N> tan(const Dual<T, N> & x)
+{
+  using std::tan;
+  const T t = tan(x.value());
+  return sva_internal::chain(t, T(1) + t * t, x);
+}
+
+template<typename T, int N>
+inline Dual<T, N> asin(const Dual<T, N> & x)
+{
+  using std::asin;
+  using std::sqrt;
+  return sva_internal::chain(asin(x.value()), T(1) / sqrt(T(1) - x.value() * x.value()), x);
+}
+
+template<typename T, int N>
+inline Dual<T, N> acos(const Dual<T, N> & x)
+{
+  using std::acos;
+  using std::sqrt;
+  return sva_internal::chain(acos(x.value()), T(-1) / sqrt(T(1) - x.value() * x.value()), x);
+}
+
+template<typename T, int N>
+inline Dual<T, N> atan(const Dual<T, N> & x)
+{
+  using std::atan;
+  return sva_internal::chain(atan(x.value()), T(1) / (T(1) + x.value() * x.value()), x);
+}
+
+template<typename T, int N>
+inline Dual<T, N> atan2(const Dual<T, N> & y, const Dual<T, N> & x)
+{
+  using std::atan2;
+  const T n2 = x.value() * x.value() + y.value() * y.value();
+  return Dual<T, N>(atan2(y.value(), x.value()),
+                    (x.value() / n2) * y.derivatives() - (y.value() / n2) * x.derivatives());
+}
+
+template<typename T, int N>
+inline Dual<T, N> exp(const Dual<T, N> & x)
+{
+  using std::exp;
+  const T e = exp(x.value());
+  return sva_internal::chain(e, e, x);
+}
+
+template<typename T, int N>
+inline Dual<T, N> log(const Dual<T, N> & x)
+{
+  using std::log;
+  return sva_internal::chain(log(x.value()), T(1) / x.value(), x);
+}
+
+template<typename T, int N>
+inline Dual<T, N> pow(const Dual<T, N> & x, const T & p)
+{
+  using std::pow;
+  const T xp1 = pow(x.value(), p - T(1));
+  return sva_internal::chain(xp1 * x.value(), p * xp1, x);
+}
+
+template<typename T, int N>
+inline bool isfinite(const Dual<T, N> & x)
+{
+  using std::isfinite;
+  return isfinite(x.value()) && x.derivatives().allFinite();
+}
+
+template<typename T, int N>
+inline bool isnan(const Dual<T, N> & x)
+{
+  using std::isnan;
+  return isnan(x.value());
+}
+
+template<typename T, int N>
+inline bool isinf(const Dual<T, N> & x)
+{
+  using std::isinf;
+  return isinf(x.value());
+}
+
+template<typename T, int N>
+inline std::ostream & operator<<(std::ostream & out, const Dual<T, N> & x)
+{
+  out << x.value() << " [" << x.derivatives().transpose() << "]";
+  return out;
+}
+
+} // namespace sva
+
+namespace Eigen
+{
+
+template<typename T, int N>
+struct NumTraits<sva::Dual<T, N>> : NumTraits<T>
+{
+  typedef sva::Dual<T, N> Real;
+  typedef sva::Dual<T, N> NonInteger;
+  typedef sva::Dual<T, N> Nested;
+  typedef T Literal;
+  enum
+  {
+    IsComplex = 0,
+    IsInteger = 0,
+    IsSigned = 1,
+    RequireInitialization = 1,
+    ReadCost = (N + 1) * NumTraits<T>::ReadCost,
+    AddCost = (N + 1) * NumTraits<T>::AddCost,
+    MulCost = (2 * N + 1) * NumTraits<T>::MulCost + N * NumTraits<T>::AddCost
+  };
+
+  static inline Real epsilon()
+  {
+    return Real(NumTraits<T>::epsilon());
+  }
+
+  static inline Real dummy_precision()
+  {
+    return Real(NumTraits<T>::dummy_precision());
+  }
+
+  static inline Real highest()
+  {
+    return Real(NumTraits<T>::highest());
+  }
+
+  static inline Real lowest()
+  {
+    return Real(NumTraits<T>::lowest());
+  }
+
+  static inline Real infinity()
+  {
+    return Real(NumTraits<T>::infinity());
+  }
+
+  static inline Real quiet_NaN()
+  {
+    return Real(NumTraits<T>::quiet_NaN());
+  }
+};
+
+// Allow the products of Dual matrices with matrices of their underlying scalar
+template<typename T, int N, typename BinOp>
+struct ScalarBinaryOpTraits<sva::Dual<T, N>, T, BinOp>
+{
+  typedef sva::Dual<T, N> ReturnType;
+};
+
+template<typename T, int N, typename BinOp>
+struct ScalarBinaryOpTraits<T, sva::Dual<T, N>, BinOp>
+{
+  typedef sva::Dual<T, N> ReturnType;
+};
+
+} // namespace Eigen
+
+namespace std
+{
+
+/// The limits are the ones of the underlying scalar, as for Eigen::AutoDiffScalar.
+template<typename T, int N>
+class numeric_limits<sva::Dual<T, N>> : public numeric_limits<T>
+{
+};
+
+} // namespace std
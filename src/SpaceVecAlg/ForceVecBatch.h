@@ -0,0 +1,217 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+#include "EigenTypedef.h"
+#include "ForceVec.h"
+#include "fwd.h"
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sva
+{
+
+/**
+ * Batch of spatial force vectors stored in structure of arrays layout.
+ * Each of the 6 coefficients is stored in its own contiguous lane:
+ * the couple in lanes 0 to 2 and the force in lanes 3 to 5.
+ */
+template<typename T>
+class ForceVecBatch
+{
+public:
+  typedef Eigen::Matrix<T, Eigen::Dynamic, 6> storage_t;
+  typedef typename storage_t::Index index_t;
+  typedef typename storage_t::ColXpr lane_t;
+  typedef typename storage_t::ConstColXpr const_lane_t;
+
+public:
+  /// Batch of size zero force vectors.
+  static ForceVecBatch<T> Zero(index_t size)
+  {
+    ForceVecBatch<T> fvb(size);
+    fvb.data_.setZero();
+    return fvb;
+  }
+
+public:
+  /// Empty batch.
+  ForceVecBatch() : data_() {}
+
+  /// Batch of size uninitialized force vectors.
+  explicit ForceVecBatch(index_t size) : data_(size, 6) {}
+
+  /// Batch of size copies of fv.
+  ForceVecBatch(index_t size, const ForceVec<T> & fv) : data_(size, 6)
+  {
+    setConstant(fv);
+  }
+
+  /// @param fvs Force vectors to store in the batch.
+  ForceVecBatch(const std::vector<ForceVec<T>> & fvs) : data_(static_cast<index_t>(fvs.size()), 6)
+  {
+    for(index_t i = 0; i < size(); ++i)
+    {
+      set(i, fvs[static_cast<std::size_t>(i)]);
+    }
+  }
+
+  /// Copy constructor.
+  template<typename T2>
+  ForceVecBatch(const ForceVecBatch<T2> & fvb) : data_(fvb.data().template cast<T>())
+  {
+  }
+
+  // Accessor
+  /// @return Number of force vectors in the batch.
+  index_t size() const
+  {
+    return data_.rows();
+  }
+
+  /// Resize the batch, the force vectors are left uninitialized.
+  void resize(index_t size)
+  {
+    data_.resize(size, 6);
+  }
+
+  /// @return Lane of the couple coefficient i.
+  lane_t couple(int i)
+  {
+    return data_.col(i);
+  }
+
+  /// @return Lane of the couple coefficient i.
+  const_lane_t couple(int i) const
+  {
+    return data_.col(i);
+  }
+
+  /// @return Lane of the force coefficient i.
+  lane_t force(int i)
+  {
+    return data_.col(3 + i);
+  }
+
+  /// @return Lane of the force coefficient i.
+  const_lane_t force(int i) const
+  {
+    return data_.col(3 + i);
+  }
+
+  /// @return Underlying size x 6 storage.
+  const storage_t & data() const
+  {
+    return data_;
+  }
+
+  /// @return Underlying size x 6 storage.
+  storage_t & data()
+  {
+    return data_;
+  }
+
+  /// @return Copy of the i-th force vector.
+  ForceVec<T> operator[](index_t i) const
+  {
+    return ForceVec<T>(Eigen::Vector6<T>(data_.row(i).transpose()));
+  }
+
+  /// Set all the force vectors of the batch to fv.
+  void setConstant(const ForceVec<T> & fv)
+  {
+    for(int i = 0; i < 3; ++i)
+    {
+      couple(i).setConstant(fv.couple()(i));
+      force(i).setConstant(fv.force()(i));
+    }
+  }
+
+  /// Set the i-th force vector.
+  void set(index_t i, const ForceVec<T> & fv)
+  {
+    data_.row(i) << fv.couple().transpose(), fv.force().transpose();
+  }
+
+  template<typename T2>
+  ForceVecBatch<T2> cast() const
+  {
+    return ForceVecBatch<T2>(*this);
+  }
+
+  // Operators
+  ForceVecBatch<T> operator+(const ForceVecBatch<T> & fvb) const
+  {
+    return ForceVecBatch<T>(storage_t(data_ + fvb.data_));
+  }
+
+  ForceVecBatch<T> operator-(const ForceVecBatch<T> & fvb) const
+  {
+    return ForceVecBatch<T>(storage_t(data_ - fvb.data_));
+  }
+
+  ForceVecBatch<T> operator-() const
+  {
+    return ForceVecBatch<T>(storage_t(-data_));
+  }
+
+  ForceVecBatch<T> & operator+=(const ForceVecBatch<T> & fvb)
+  {
+    data_ += fvb.data_;
+    return *this;
+  }
+
+  ForceVecBatch<T> & operator-=(const ForceVecBatch<T> & fvb)
+  {
+    data_ -= fvb.data_;
+    return *this;
+  }
+
+  template<typename T2, typename std::enable_if<std::is_arithmetic<T2>::value, int>::type = 0>
+  ForceVecBatch<T> operator*(T2 scalar) const
+  {
+    return ForceVecBatch<T>(storage_t(scalar * data_));
+  }
+
+  template<typename T2, typename std::enable_if<std::is_arithmetic<T2>::value, int>::type = 0>
+  ForceVecBatch<T> & operator*=(T2 scalar)
+  {
+    data_ *= scalar;
+    return *this;
+  }
+
+  bool operator==(const ForceVecBatch<T> & fvb) const
+  {
+    return data_ == fvb.data_;
+  }
+
+  bool operator!=(const ForceVecBatch<T> & fvb) const
+  {
+    return data_ != fvb.data_;
+  }
+
+private:
+  explicit ForceVecBatch(storage_t && data) : data_(std::move(data)) {}
+
+private:
+  storage_t data_;
+};
+
+template<typename T, typename T2>
+inline ForceVecBatch<T> operator*(T2 scalar, const ForceVecBatch<T> & fvb)
+{
+  return fvb * scalar;
+}
+
+template<typename T>
+inline std::ostream & operator<<(std::ostream & out, const ForceVecBatch<T> & fvb)
+{
+  out << fvb.data();
+  return out;
+}
+
+} // namespace sva
@@ -0,0 +1,350 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+#include "ForwardKinematics.h"
+#include "Parallel.h"
+
+#include <memory>
+#include <vector>
+
+namespace sva
+{
+
+/**
+ * Articulated-body algorithm forward dynamics of a KinematicTree.
+ * All the buffers are allocated by the constructor, compute does not allocate.
+ * The articulated-body inertias are kept in the compact ABInertia form during
+ * the whole algorithm.
+ * See Roy Featherstone «Rigid Body Dynamics Algorithms» table 7.1.
+ */
+template<typename T>
+class ForwardDynamics
+{
+public:
+  typedef typename KinematicTree<T>::vectorX_t vectorX_t;
+  typedef Eigen::Vector3<T> vector3_t;
+
+public:
+  ForwardDynamics() {}
+
+  /// Allocate the buffers for tree.
+  explicit ForwardDynamics(const KinematicTree<T> & tree)
+  : fk_(tree), c_(static_cast<std::size_t>(tree.nrBodies())), IA_(static_cast<std::size_t>(tree.nrBodies())),
+    pA_(static_cast<std::size_t>(tree.nrBodies())), U_(static_cast<std::size_t>(tree.nrBodies())),
+    invD_(static_cast<std::size_t>(tree.nrBodies())), u_(static_cast<std::size_t>(tree.nrBodies())),
+    bodyAccB_(static_cast<std::size_t>(tree.nrBodies())), qdd_(tree.nrDof())
+  {
+  }
+
+  /**
+   * Compute the joint acceleration produced by the joint torques tau.
+   * @param q Joint configuration.
+   * @param qd Joint velocity.
+   * @param tau Joint torques.
+   * @param gravity Gravity acceleration in the world frame.
+   */
+  void compute(const KinematicTree<T> & tree,
+               const vectorX_t & q,
+               const vectorX_t & qd,
+               const vectorX_t & tau,
+               const vector3_t & gravity = vector3_t(T(0), T(0), T(-9.81)));
+
+  // Accessor
+  /// @return Joint acceleration computed by the last call to compute.
+  const vectorX_t & acceleration() const
+  {
+    return qdd_;
+  }
+
+  /// @return Articulated-body inertia of each body in the body frame.
+  const std::vector<ABInertia<T>> & articulatedInertia() const
+  {
+    return IA_;
+  }
+
+  /// @return Acceleration of each body in the body frame, the opposite of the gravity included.
+  const std::vector<MotionVec<T>> & bodyAccB() const
+  {
+    return bodyAccB_;
+  }
+
+  /// @return Forward kinematics computed by the first pass.
+  const ForwardKinematics<T> & forwardKinematics() const
+  {
+    return fk_;
+  }
+
+private:
+  ForwardKinematics<T> fk_;
+  std::vector<MotionVec<T>> c_;
+  std::vector<ABInertia<T>> IA_;
+  std::vector<ForceVec<T>> pA_;
+  std::vector<ForceVec<T>> U_;
+  std::vector<T> invD_;
+  std::vector<T> u_;
+  std::vector<MotionVec<T>> bodyAccB_;
+  vectorX_t qdd_;
+};
+
+/**
+ * Forward dynamics of many independent simulations of the same KinematicTree
+ * computed in parallel, each thread owning its own ForwardDynamics workspace.
+ * The worker threads are started by the constructor and reused by each call.
+ * States are given as size x nrDof matrices, the row s holding the state of
+ * the simulation s.
+ */
+template<typename T>
+class ForwardDynamicsParallel
+{
+public:
+  typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> matrixX_t;
+  typedef typename KinematicTree<T>::vectorX_t vectorX_t;
+  typedef Eigen::Vector3<T> vector3_t;
+
+public:
+  ForwardDynamicsParallel() : nrThreads_(0) {}
+
+  /**
+   * Start the worker threads and allocate one workspace per thread.
+   * @param nrThreads Number of threads, 0 to use defaultNrThreads().
+   */
+  explicit ForwardDynamicsParallel(const KinematicTree<T> & tree, unsigned nrThreads = 0)
+  : nrThreads_(nrThreads == 0 ? defaultNrThreads() : nrThreads), pool_(new ThreadPool(nrThreads_)),
+    workspaces_(nrThreads_, Workspace(tree))
+  {
+  }
+
+  /**
+   * Compute the joint accelerations of every simulation.
+   * @param q size x nrDof joint configurations.
+   * @param qd size x nrDof joint velocities.
+   * @param tau size x nrDof joint torques.
+   * @param qdd size x nrDof joint accelerations, resized if needed.
+   * @param gravity Gravity acceleration in the world frame.
+   */
+  void compute(const KinematicTree<T> & tree,
+               const matrixX_t & q,
+               const matrixX_t & qd,
+               const matrixX_t & tau,
+               matrixX_t & qdd,
+               const vector3_t & gravity = vector3_t(T(0), T(0), T(-9.81)));
+
+  /**
+   * Advance every simulation by dt with a semi-implicit Euler integration:
+   * qd += qdd*dt then q += qd*dt.
+   * @param q size x nrDof joint configurations, updated in place.
+   * @param qd size x nrDof joint velocities, updated in place.
+   * @param tau size x nrDof joint torques.
+   * @param dt Time step.
+   * @param gravity Gravity acceleration in the world frame.
+   */
+  void step(const KinematicTree<T> & tree,
+            matrixX_t & q,
+            matrixX_t & qd,
+            const matrixX_t & tau,
+            T dt,
+            const vector3_t & gravity = vector3_t(T(0), T(0), T(-9.81)));
+
+  /// @return Number of threads used.
+  unsigned nrThreads() const
+  {
+    return nrThreads_;
+  }
+
+private:
+  struct Workspace
+  {
+    explicit Workspace(const KinematicTree<T> & tree)
+    : fd(tree), q(tree.nrDof()), qd(tree.nrDof()), tau(tree.nrDof())
+    {
+    }
+
+    ForwardDynamics<T> fd;
+    vectorX_t q, qd, tau;
+  };
+
+  /// @return Number of simulations of a chunk, a few chunks per thread balance the load.
+  std::ptrdiff_t grain(std::ptrdiff_t size) const
+  {
+    const std::ptrdiff_t nrChunks = 4 * static_cast<std::ptrdiff_t>(nrThreads_);
+    return (size + nrChunks - 1) / nrChunks;
+  }
+
+private:
+  unsigned nrThreads_;
+  /// Worker threads, a pointer since the pool can not be moved.
+  std::unique_ptr<ThreadPool> pool_;
+  std::vector<Workspace> workspaces_;
+};
+
+namespace sva_internal
+{
+
+/// @return IA*v computed from the lower triangular parts of IA.
+template<typename T>
+inline ForceVec<T> abInertiaMul(const ABInertia<T> & IA, const MotionVec<T> & mv)
+{
+  return ForceVec<T>(lowerSymmetricMul(IA.lowerTriangularInertia(), mv.angular()) + IA.gInertia() * mv.linear(),
+                     lowerSymmetricMul(IA.lowerTriangularMassMatrix(), mv.linear())
+                         + IA.gInertia().transpose() * mv.angular());
+}
+
+/// @return IA - invD*U*U^T computed on the lower triangular parts of IA.
+template<typename T>
+inline ABInertia<T> abInertiaRankOneUpdate(const ABInertia<T> & IA, const ForceVec<T> & U, T invD)
+{
+  Eigen::Matrix3<T> M = IA.lowerTriangularMassMatrix();
+  Eigen::Matrix3<T> I = IA.lowerTriangularInertia();
+  const Eigen::Vector3<T> Uc = invD * U.couple();
+  for(int j = 0; j < 3; ++j)
+  {
+    for(int i = j; i < 3; ++i)
+    {
+      M(i, j) -= invD * U.force()(i) * U.force()(j);
+      I(i, j) -= Uc(i) * U.couple()(j);
+    }
+  }
+  return ABInertia<T>(M.template triangularView<Eigen::Lower>(), IA.gInertia() - Uc * U.force().transpose(),
+                      I.template triangularView<Eigen::Lower>());
+}
+
+/// @return Articulated-body inertia of a single rigid body.
+template<typename T>
+inline ABInertia<T> rbToABInertia(const RBInertia<T> & rbI)
+{
+  return ABInertia<T>(rbI.mass() * Eigen::Matrix3<T>::Identity(), vector3ToCrossMatrix(rbI.momentum()),
+                      rbI.lowerTriangularInertia());
+}
+
+} // namespace sva_internal
+
+template<typename T>
+inline void ForwardDynamics<T>::compute(const KinematicTree<T> & tree,
+                                        const vectorX_t & q,
+                                        const vectorX_t & qd,
+                                        const vectorX_t & tau,
+                                        const vector3_t & gravity)
+{
+  assert(tau.size() == tree.nrDof());
+  fk_.computeVelocities(tree, q, qd);
+  const std::vector<MotionVec<T>> & v = fk_.bodyVelB();
+  const std::vector<PTransform<T>> & X_p = fk_.parentToBody();
+
+  // c_i = v_i x S*qd, IA_i = I_i, pA_i = v_i x* I_i*v_i
+  for(int i = 0; i < tree.nrBodies(); ++i)
+  {
+    const std::size_t ui = static_cast<std::size_t>(i);
+    const int dof = tree.dofIndex(i);
+    const RBInertia<T> & rbI = tree.inertia(i);
+    c_[ui] = dof < 0 ? MotionVec<T>::Zero() : v[ui].cross(tree.motionSubspace(i) * qd(dof));
+    IA_[ui] = sva_internal::rbToABInertia(rbI);
+    pA_[ui] = v[ui].crossDual(rbI * v[ui]);
+  }
+
+  // articulated-body inertias and bias forces
+  for(int i = tree.nrBodies() - 1; i >= 0; --i)
+  {
+    const std::size_t ui = static_cast<std::size_t>(i);
+    const int dof = tree.dofIndex(i);
+    const int p = tree.parent(i);
+
+    ABInertia<T> Ia;
+    ForceVec<T> pa;
+    if(dof >= 0)
+    {
+      const MotionVec<T> & S = tree.motionSubspace(i);
+      U_[ui] = sva_internal::abInertiaMul(IA_[ui], S);
+      invD_[ui] = T(1) / S.dot(U_[ui]);
+      u_[ui] = tau(dof) - S.dot(pA_[ui]);
+      if(p < 0)
+      {
+        continue;
+      }
+      Ia = sva_internal::abInertiaRankOneUpdate(IA_[ui], U_[ui], invD_[ui]);
+      pa = pA_[ui] + sva_internal::abInertiaMul(Ia, c_[ui]) + U_[ui] * (u_[ui] * invD_[ui]);
+    }
+    else
+    {
+      if(p < 0)
+      {
+        continue;
+      }
+      Ia = IA_[ui];
+      pa = pA_[ui];
+    }
+
+    const std::size_t up = static_cast<std::size_t>(p);
+    IA_[up] += X_p[ui].transMul(Ia);
+    pA_[up] += X_p[ui].transMul(pa);
+  }
+
+  // accelerations, the gravity is accounted for by accelerating the base upward
+  const MotionVec<T> a0(vector3_t::Zero(), -gravity);
+  for(int i = 0; i < tree.nrBodies(); ++i)
+  {
+    const std::size_t ui = static_cast<std::size_t>(i);
+    const int dof = tree.dofIndex(i);
+    const int p = tree.parent(i);
+
+    MotionVec<T> a = X_p[ui] * (p < 0 ? a0 : bodyAccB_[static_cast<std::size_t>(p)]) + c_[ui];
+    if(dof >= 0)
+    {
+      qdd_(dof) = (u_[ui] - a.dot(U_[ui])) * invD_[ui];
+      a += tree.motionSubspace(i) * qdd_(dof);
+    }
+    bodyAccB_[ui] = a;
+  }
+}
+
+template<typename T>
+inline void ForwardDynamicsParallel<T>::compute(const KinematicTree<T> & tree,
+                                                const matrixX_t & q,
+                                                const matrixX_t & qd,
+                                                const matrixX_t & tau,
+                                                matrixX_t & qdd,
+                                                const vector3_t & gravity)
+{
+  qdd.resize(q.rows(), tree.nrDof());
+  assert(pool_);
+  pool_->parallelFor(q.rows(), grain(q.rows()), [&](unsigned t, std::ptrdiff_t begin, std::ptrdiff_t end) {
+    Workspace & w = workspaces_[t];
+    for(std::ptrdiff_t s = begin; s < end; ++s)
+    {
+      w.q = q.row(s).transpose();
+      w.qd = qd.row(s).transpose();
+      w.tau = tau.row(s).transpose();
+      w.fd.compute(tree, w.q, w.qd, w.tau, gravity);
+      qdd.row(s) = w.fd.acceleration().transpose();
+    }
+  });
+}
+
+template<typename T>
+inline void ForwardDynamicsParallel<T>::step(const KinematicTree<T> & tree,
+                                             matrixX_t & q,
+                                             matrixX_t & qd,
+                                             const matrixX_t & tau,
+                                             T dt,
+                                             const vector3_t & gravity)
+{
+  assert(pool_);
+  pool_->parallelFor(q.rows(), grain(q.rows()), [&](unsigned t, std::ptrdiff_t begin, std::ptrdiff_t end) {
+    Workspace & w = workspaces_[t];
+    for(std::ptrdiff_t s = begin; s < end; ++s)
+    {
+      w.q = q.row(s).transpose();
+      w.qd = qd.row(s).transpose();
+      w.tau = tau.row(s).transpose();
+      w.fd.compute(tree, w.q, w.qd, w.tau, gravity);
+      w.qd += dt * w.fd.acceleration();
+      w.q += dt * w.qd;
+      q.row(s) = w.q.transpose();
+      qd.row(s) = w.qd.transpose();
+    }
+  });
+}
+
+} // namespace sva
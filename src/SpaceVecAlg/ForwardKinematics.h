@@ -0,0 +1,395 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+#include "KinematicTree.h"
+
+#include <vector>
+
+namespace sva
+{
+
+/**
+ * Forward kinematics of a KinematicTree.
+ * All the buffers are allocated by the constructor, the compute functions
+ * do not allocate and visit each body only once.
+ * The poses are X_0_i, the transformation from the world frame to the body
+ * frame, velocities and accelerations are expressed in the body frame.
+ */
+template<typename T>
+class ForwardKinematics
+{
+public:
+  typedef typename KinematicTree<T>::vectorX_t vectorX_t;
+
+public:
+  ForwardKinematics() {}
+
+  /// Allocate the buffers for tree.
+  explicit ForwardKinematics(const KinematicTree<T> & tree)
+  : parentToBody_(static_cast<std::size_t>(tree.nrBodies())), bodyPosW_(static_cast<std::size_t>(tree.nrBodies())),
+    bodyVelB_(static_cast<std::size_t>(tree.nrBodies())), bodyAccB_(static_cast<std::size_t>(tree.nrBodies()))
+  {
+  }
+
+  /**
+   * Compute the bodies poses.
+   * @param q Joint configuration.
+   */
+  void computePoses(const KinematicTree<T> & tree, const vectorX_t & q)
+  {
+    compute<false, false>(tree, q, q, q, MotionVec<T>::Zero());
+  }
+
+  /**
+   * Compute the bodies poses and velocities.
+   * @param q Joint configuration.
+   * @param qd Joint velocity.
+   */
+  void computeVelocities(const KinematicTree<T> & tree, const vectorX_t & q, const vectorX_t & qd)
+  {
+    compute<true, false>(tree, q, qd, qd, MotionVec<T>::Zero());
+  }
+
+  /**
+   * Compute the bodies poses, velocities and accelerations.
+   * @param q Joint configuration.
+   * @param qd Joint velocity.
+   * @param qdd Joint acceleration.
+   * @param baseAcc Acceleration of the world frame. Set it to the opposite
+   * of the gravity to account for it in the inverse dynamics.
+   */
+  void computeAccelerations(const KinematicTree<T> & tree,
+                            const vectorX_t & q,
+                            const vectorX_t & qd,
+                            const vectorX_t & qdd,
+                            const MotionVec<T> & baseAcc = MotionVec<T>::Zero())
+  {
+    compute<true, true>(tree, q, qd, qdd, baseAcc);
+  }
+
+  // Accessor
+  /// @return X_p_i, the transformation from the parent of each body to the body.
+  const std::vector<PTransform<T>> & parentToBody() const
+  {
+    return parentToBody_;
+  }
+
+  /// @return X_0_i, the transformation from the world to each body.
+  const std::vector<PTransform<T>> & bodyPosW() const
+  {
+    return bodyPosW_;
+  }
+
+  /// @return Velocity of each body in the body frame.
+  const std::vector<MotionVec<T>> & bodyVelB() const
+  {
+    return bodyVelB_;
+  }
+
+  /// @return Acceleration of each body in the body frame.
+  const std::vector<MotionVec<T>> & bodyAccB() const
+  {
+    return bodyAccB_;
+  }
+
+private:
+  template<bool Vel, bool Acc>
+  void compute(const KinematicTree<T> & tree,
+               const vectorX_t & q,
+               const vectorX_t & qd,
+               const vectorX_t & qdd,
+               const MotionVec<T> & baseAcc);
+
+private:
+  std::vector<PTransform<T>> parentToBody_;
+  std::vector<PTransform<T>> bodyPosW_;
+  std::vector<MotionVec<T>> bodyVelB_;
+  std::vector<MotionVec<T>> bodyAccB_;
+};
+
+/**
+ * Forward kinematics of a KinematicTree for a batch of configurations.
+ * The configurations are given as a size x nrDof matrix, the column j holding
+ * the coordinate j of every configuration, so each joint coordinate is
+ * a contiguous lane of the batch kernels.
+ * All the buffers are allocated once for a given batch size.
+ */
+template<typename T>
+class ForwardKinematicsBatch
+{
+public:
+  typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> matrixX_t;
+  typedef typename PTransformBatch<T>::index_t index_t;
+
+public:
+  ForwardKinematicsBatch() {}
+
+  /// Allocate the buffers for tree and batches of size elements.
+  ForwardKinematicsBatch(const KinematicTree<T> & tree, index_t size)
+  : jointTransform_(size), jointVel_(size), baseAcc_(size),
+    parentToBody_(static_cast<std::size_t>(tree.nrBodies()), PTransformBatch<T>(size)), bodyPosW_(parentToBody_),
+    bodyVelB_(static_cast<std::size_t>(tree.nrBodies()), MotionVecBatch<T>(size)), bodyAccB_(bodyVelB_)
+  {
+  }
+
+  /**
+   * Compute the bodies poses.
+   * @param q size x nrDof joint configurations.
+   */
+  void computePoses(const KinematicTree<T> & tree, const matrixX_t & q)
+  {
+    compute<false, false>(tree, q, q, q, MotionVec<T>::Zero());
+  }
+
+  /**
+   * Compute the bodies poses and velocities.
+   * @param q size x nrDof joint configurations.
+   * @param qd size x nrDof joint velocities.
+   */
+  void computeVelocities(const KinematicTree<T> & tree, const matrixX_t & q, const matrixX_t & qd)
+  {
+    compute<true, false>(tree, q, qd, qd, MotionVec<T>::Zero());
+  }
+
+  /**
+   * Compute the bodies poses, velocities and accelerations.
+   * @param q size x nrDof joint configurations.
+   * @param qd size x nrDof joint velocities.
+   * @param qdd size x nrDof joint accelerations.
+   * @param baseAcc Acceleration of the world frame.
+   */
+  void computeAccelerations(const KinematicTree<T> & tree,
+                            const matrixX_t & q,
+                            const matrixX_t & qd,
+                            const matrixX_t & qdd,
+                            const MotionVec<T> & baseAcc = MotionVec<T>::Zero())
+  {
+    compute<true, true>(tree, q, qd, qdd, baseAcc);
+  }
+
+  // Accessor
+  /// @return X_p_i, the transformation from the parent of each body to the body.
+  const std::vector<PTransformBatch<T>> & parentToBody() const
+  {
+    return parentToBody_;
+  }
+
+  /// @return X_0_i, the transformation from the world to each body.
+  const std::vector<PTransformBatch<T>> & bodyPosW() const
+  {
+    return bodyPosW_;
+  }
+
+  /// @return Velocity of each body in the body frame.
+  const std::vector<MotionVecBatch<T>> & bodyVelB() const
+  {
+    return bodyVelB_;
+  }
+
+  /// @return Acceleration of each body in the body frame.
+  const std::vector<MotionVecBatch<T>> & bodyAccB() const
+  {
+    return bodyAccB_;
+  }
+
+private:
+  template<bool Vel, bool Acc>
+  void compute(const KinematicTree<T> & tree,
+               const matrixX_t & q,
+               const matrixX_t & qd,
+               const matrixX_t & qdd,
+               const MotionVec<T> & baseAcc);
+
+private:
+  PTransformBatch<T> jointTransform_;
+  MotionVecBatch<T> jointVel_;
+  MotionVecBatch<T> baseAcc_;
+  std::vector<PTransformBatch<T>> parentToBody_;
+  std::vector<PTransformBatch<T>> bodyPosW_;
+  std::vector<MotionVecBatch<T>> bodyVelB_;
+  std::vector<MotionVecBatch<T>> bodyAccB_;
+};
+
+namespace sva_internal
+{
+
+/// result = S*q for each element of the batch.
+template<typename T, typename Derived>
+inline void motionSubspaceMul(const MotionVec<T> & S, const Eigen::MatrixBase<Derived> & q, MotionVecBatch<T> & result)
+{
+  result.resize(q.size());
+  for(int i = 0; i < 3; ++i)
+  {
+    result.angular(i) = S.angular()(i) * q;
+    result.linear(i) = S.linear()(i) * q;
+  }
+}
+
+/// result += S*q for each element of the batch.
+template<typename T, typename Derived>
+inline void motionSubspaceMulPlusEq(const MotionVec<T> & S,
+                                    const Eigen::MatrixBase<Derived> & q,
+                                    MotionVecBatch<T> & result)
+{
+  for(int i = 0; i < 3; ++i)
+  {
+    result.angular(i) += S.angular()(i) * q;
+    result.linear(i) += S.linear()(i) * q;
+  }
+}
+
+} // namespace sva_internal
+
+template<typename T>
+template<bool Vel, bool Acc>
+inline void ForwardKinematics<T>::compute(const KinematicTree<T> & tree,
+                                          const vectorX_t & q,
+                                          const vectorX_t & qd,
+                                          const vectorX_t & qdd,
+                                          const MotionVec<T> & baseAcc)
+{
+  assert(static_cast<int>(bodyPosW_.size()) == tree.nrBodies());
+  assert(q.size() == tree.nrDof());
+
+  for(int i = 0; i < tree.nrBodies(); ++i)
+  {
+    const std::size_t ui = static_cast<std::size_t>(i);
+    const int p = tree.parent(i);
+    const int dof = tree.dofIndex(i);
+
+    // X_p_i = X_j*X_t
+    parentToBody_[ui] = tree.parentToBody(i, dof < 0 ? T(0) : q(dof));
+    const PTransform<T> & X_p_i = parentToBody_[ui];
+
+    if(p < 0)
+    {
+      bodyPosW_[ui] = X_p_i;
+    }
+    else
+    {
+      bodyPosW_[ui] = X_p_i * bodyPosW_[static_cast<std::size_t>(p)];
+    }
+
+    if(Vel)
+    {
+      // v_i = X_p_i*v_p + S*qd
+      const MotionVec<T> vJ = dof < 0 ? MotionVec<T>::Zero() : tree.motionSubspace(i) * qd(dof);
+      if(p < 0)
+      {
+        bodyVelB_[ui] = vJ;
+      }
+      else
+      {
+        bodyVelB_[ui] = X_p_i * bodyVelB_[static_cast<std::size_t>(p)] + vJ;
+      }
+
+      if(Acc)
+      {
+        // a_i = X_p_i*a_p + S*qdd + v_i x S*qd
+        const MotionVec<T> & a_p = p < 0 ? baseAcc : bodyAccB_[static_cast<std::size_t>(p)];
+        bodyAccB_[ui] = X_p_i * a_p;
+        if(dof >= 0)
+        {
+          bodyAccB_[ui] += tree.motionSubspace(i) * qdd(dof) + bodyVelB_[ui].cross(vJ);
+        }
+      }
+    }
+  }
+}
+
+template<typename T>
+template<bool Vel, bool Acc>
+inline void ForwardKinematicsBatch<T>::compute(const KinematicTree<T> & tree,
+                                               const matrixX_t & q,
+                                               const matrixX_t & qd,
+                                               const matrixX_t & qdd,
+                                               const MotionVec<T> & baseAcc)
+{
+  assert(static_cast<int>(bodyPosW_.size()) == tree.nrBodies());
+  assert(q.cols() == tree.nrDof());
+
+  const index_t size = q.rows();
+  if(Acc)
+  {
+    baseAcc_.resize(size);
+    baseAcc_.setConstant(baseAcc);
+  }
+
+  for(int i = 0; i < tree.nrBodies(); ++i)
+  {
+    const std::size_t ui = static_cast<std::size_t>(i);
+    const int p = tree.parent(i);
+    const int dof = tree.dofIndex(i);
+    PTransformBatch<T> & X_p_i = parentToBody_[ui];
+
+    // X_p_i = X_j*X_t
+    if(dof < 0)
+    {
+      X_p_i.resize(size);
+      X_p_i.setConstant(tree.treeTransform(i));
+    }
+    else
+    {
+      tree.jointTransform(i, q.col(dof), jointTransform_);
+      jointTransform_.mul(tree.treeTransform(i), X_p_i);
+    }
+
+    if(p < 0)
+    {
+      bodyPosW_[ui] = X_p_i;
+    }
+    else
+    {
+      X_p_i.mul(bodyPosW_[static_cast<std::size_t>(p)], bodyPosW_[ui]);
+    }
+
+    if(Vel)
+    {
+      // v_i = X_p_i*v_p + S*qd
+      const MotionVec<T> & S = tree.motionSubspace(i);
+      if(dof < 0)
+      {
+        jointVel_.resize(size);
+        jointVel_.data().setZero();
+      }
+      else
+      {
+        sva_internal::motionSubspaceMul(S, qd.col(dof), jointVel_);
+      }
+      if(p < 0)
+      {
+        bodyVelB_[ui] = jointVel_;
+      }
+      else
+      {
+        X_p_i.mul(bodyVelB_[static_cast<std::size_t>(p)], bodyVelB_[ui]);
+        bodyVelB_[ui] += jointVel_;
+      }
+
+      if(Acc)
+      {
+        // a_i = X_p_i*a_p + S*qdd + v_i x S*qd
+        MotionVecBatch<T> & a_i = bodyAccB_[ui];
+        if(p < 0)
+        {
+          X_p_i.mul(baseAcc_, a_i);
+        }
+        else
+        {
+          X_p_i.mul(bodyAccB_[static_cast<std::size_t>(p)], a_i);
+        }
+        if(dof >= 0)
+        {
+          sva_internal::motionSubspaceMulPlusEq(S, qdd.col(dof), a_i);
+          bodyVelB_[ui].cross(jointVel_, jointVel_);
+          a_i += jointVel_;
+        }
+      }
+    }
+  }
+}
+
+} // namespace sva
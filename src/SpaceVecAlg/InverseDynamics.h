@@ -0,0 +1,247 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+#include "ForwardKinematics.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace sva
+{
+
+/**
+ * Recursive Newton-Euler inverse dynamics of a KinematicTree.
+ * The forces and torques buffers are allocated by the constructor,
+ * compute does not allocate.
+ * See Roy Featherstone «Rigid Body Dynamics Algorithms» table 5.1.
+ */
+template<typename T>
+class InverseDynamics
+{
+public:
+  typedef typename KinematicTree<T>::vectorX_t vectorX_t;
+  typedef Eigen::Vector3<T> vector3_t;
+
+public:
+  InverseDynamics() {}
+
+  /// Allocate the buffers for tree.
+  explicit InverseDynamics(const KinematicTree<T> & tree)
+  : fk_(tree), bodyForce_(static_cast<std::size_t>(tree.nrBodies())), tau_(tree.nrDof())
+  {
+  }
+
+  /**
+   * Compute the joint torques needed to produce the joint acceleration qdd.
+   * @param q Joint configuration.
+   * @param qd Joint velocity.
+   * @param qdd Joint acceleration.
+   * @param gravity Gravity acceleration in the world frame.
+   */
+  void compute(const KinematicTree<T> & tree,
+               const vectorX_t & q,
+               const vectorX_t & qd,
+               const vectorX_t & qdd,
+               const vector3_t & gravity = vector3_t(T(0), T(0), T(-9.81)));
+
+  // Accessor
+  /// @return Joint torques computed by the last call to compute.
+  const vectorX_t & torque() const
+  {
+    return tau_;
+  }
+
+  /// @return Force transmitted by the joint of each body in the body frame.
+  const std::vector<ForceVec<T>> & bodyForce() const
+  {
+    return bodyForce_;
+  }
+
+  /// @return Forward kinematics computed by the forward pass.
+  const ForwardKinematics<T> & forwardKinematics() const
+  {
+    return fk_;
+  }
+
+private:
+  ForwardKinematics<T> fk_;
+  std::vector<ForceVec<T>> bodyForce_;
+  vectorX_t tau_;
+};
+
+/**
+ * Recursive Newton-Euler inverse dynamics for a batch of samples.
+ * Samples are given as size x nrDof matrices, the column j holding
+ * the coordinate j of every sample, @see ForwardKinematicsBatch.
+ * All the buffers are allocated once for a given batch size.
+ */
+template<typename T>
+class InverseDynamicsBatch
+{
+public:
+  typedef typename ForwardKinematicsBatch<T>::matrixX_t matrixX_t;
+  typedef typename ForwardKinematicsBatch<T>::index_t index_t;
+  typedef Eigen::Vector3<T> vector3_t;
+
+public:
+  InverseDynamicsBatch() {}
+
+  /// Allocate the buffers for tree and batches of size elements.
+  InverseDynamicsBatch(const KinematicTree<T> & tree, index_t size)
+  : fk_(tree, size), bodyMomentum_(size), transForce_(size),
+    bodyForce_(static_cast<std::size_t>(tree.nrBodies()), ForceVecBatch<T>(size)), tau_(size, tree.nrDof())
+  {
+  }
+
+  /**
+   * Compute the joint torques of each sample.
+   * @param q size x nrDof joint configurations.
+   * @param qd size x nrDof joint velocities.
+   * @param qdd size x nrDof joint accelerations.
+   * @param gravity Gravity acceleration in the world frame.
+   */
+  void compute(const KinematicTree<T> & tree,
+               const matrixX_t & q,
+               const matrixX_t & qd,
+               const matrixX_t & qdd,
+               const vector3_t & gravity = vector3_t(T(0), T(0), T(-9.81)));
+
+  // Accessor
+  /// @return size x nrDof joint torques computed by the last call to compute.
+  const matrixX_t & torque() const
+  {
+    return tau_;
+  }
+
+  /// @return Force transmitted by the joint of each body in the body frame.
+  const std::vector<ForceVecBatch<T>> & bodyForce() const
+  {
+    return bodyForce_;
+  }
+
+  /// @return Forward kinematics computed by the forward pass.
+  const ForwardKinematicsBatch<T> & forwardKinematics() const
+  {
+    return fk_;
+  }
+
+private:
+  ForwardKinematicsBatch<T> fk_;
+  ForceVecBatch<T> bodyMomentum_;
+  ForceVecBatch<T> transForce_;
+  std::vector<ForceVecBatch<T>> bodyForce_;
+  matrixX_t tau_;
+};
+
+namespace sva_internal
+{
+
+/// result = I*v for each element of the batch.
+template<typename T>
+inline void rbInertiaMul(const RBInertia<T> & rbI, const MotionVecBatch<T> & mvb, ForceVecBatch<T> & result)
+{
+  const Eigen::Matrix3<T> & I = rbI.lowerTriangularInertia();
+  const Eigen::Vector3<T> & h = rbI.momentum();
+  result.resize(mvb.size());
+  for(int i = 0; i < 3; ++i)
+  {
+    const int j = (i + 1) % 3;
+    const int k = (i + 2) % 3;
+    // I*w + h x v, only the lower part of I is used
+    result.couple(i) = I(i, i) * mvb.angular(i) + I(std::max(i, j), std::min(i, j)) * mvb.angular(j)
+                       + I(std::max(i, k), std::min(i, k)) * mvb.angular(k) + h(j) * mvb.linear(k)
+                       - h(k) * mvb.linear(j);
+    // m*v - h x w
+    result.force(i) = rbI.mass() * mvb.linear(i) - h(j) * mvb.angular(k) + h(k) * mvb.angular(j);
+  }
+}
+
+} // namespace sva_internal
+
+template<typename T>
+inline void InverseDynamics<T>::compute(const KinematicTree<T> & tree,
+                                        const vectorX_t & q,
+                                        const vectorX_t & qd,
+                                        const vectorX_t & qdd,
+                                        const vector3_t & gravity)
+{
+  // the gravity is accounted for by accelerating the base upward
+  fk_.computeAccelerations(tree, q, qd, qdd, MotionVec<T>(vector3_t::Zero(), -gravity));
+
+  const std::vector<MotionVec<T>> & v = fk_.bodyVelB();
+  const std::vector<MotionVec<T>> & a = fk_.bodyAccB();
+
+  // f_i = I_i*a_i + v_i x* I_i*v_i
+  for(std::size_t i = 0; i < bodyForce_.size(); ++i)
+  {
+    const RBInertia<T> & rbI = tree.inertia(static_cast<int>(i));
+    bodyForce_[i] = rbI * a[i] + v[i].crossDual(rbI * v[i]);
+  }
+
+  // tau_i = S_i^T f_i and f_p += X_p_i^T f_i
+  for(int i = tree.nrBodies() - 1; i >= 0; --i)
+  {
+    const std::size_t ui = static_cast<std::size_t>(i);
+    const int dof = tree.dofIndex(i);
+    if(dof >= 0)
+    {
+      tau_(dof) = tree.motionSubspace(i).dot(bodyForce_[ui]);
+    }
+
+    const int p = tree.parent(i);
+    if(p >= 0)
+    {
+      bodyForce_[static_cast<std::size_t>(p)] += fk_.parentToBody()[ui].transMul(bodyForce_[ui]);
+    }
+  }
+}
+
+template<typename T>
+inline void InverseDynamicsBatch<T>::compute(const KinematicTree<T> & tree,
+                                             const matrixX_t & q,
+                                             const matrixX_t & qd,
+                                             const matrixX_t & qdd,
+                                             const vector3_t & gravity)
+{
+  fk_.computeAccelerations(tree, q, qd, qdd, MotionVec<T>(vector3_t::Zero(), -gravity));
+  tau_.resize(q.rows(), tree.nrDof());
+
+  const std::vector<MotionVecBatch<T>> & v = fk_.bodyVelB();
+  const std::vector<MotionVecBatch<T>> & a = fk_.bodyAccB();
+
+  // f_i = I_i*a_i + v_i x* I_i*v_i
+  for(std::size_t i = 0; i < bodyForce_.size(); ++i)
+  {
+    const RBInertia<T> & rbI = tree.inertia(static_cast<int>(i));
+    sva_internal::rbInertiaMul(rbI, a[i], bodyForce_[i]);
+    sva_internal::rbInertiaMul(rbI, v[i], bodyMomentum_);
+    v[i].crossDual(bodyMomentum_, bodyMomentum_);
+    bodyForce_[i] += bodyMomentum_;
+  }
+
+  // tau_i = S_i^T f_i and f_p += X_p_i^T f_i
+  for(int i = tree.nrBodies() - 1; i >= 0; --i)
+  {
+    const std::size_t ui = static_cast<std::size_t>(i);
+    const int dof = tree.dofIndex(i);
+    if(dof >= 0)
+    {
+      const MotionVec<T> & S = tree.motionSubspace(i);
+      const ForceVecBatch<T> & f = bodyForce_[ui];
+      tau_.col(dof) = S.angular()(0) * f.couple(0) + S.angular()(1) * f.couple(1) + S.angular()(2) * f.couple(2)
+                      + S.linear()(0) * f.force(0) + S.linear()(1) * f.force(1) + S.linear()(2) * f.force(2);
+    }
+
+    const int p = tree.parent(i);
+    if(p >= 0)
+    {
+      fk_.parentToBody()[ui].transMul(bodyForce_[ui], transForce_);
+      bodyForce_[static_cast<std::size_t>(p)] += transForce_;
+    }
+  }
+}
+
+} // namespace sva
@@ -0,0 +1,316 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+#include "SpaceVecAlg"
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+namespace sva
+{
+
+/// Type of the joint between a body and its parent.
+enum class JointType
+{
+  /// No degree of freedom.
+  Fixed,
+  /// Rotation about the joint axis.
+  Revolute,
+  /// Translation along the joint axis.
+  Prismatic
+};
+
+/**
+ * Kinematic tree with one degree of freedom joints.
+ * The tree is stored as flat arrays indexed by body, the bodies are
+ * topologically ordered: the parent of a body always has a smaller index.
+ * The transformation from the parent body to the body i is
+ * X_p_i = X_j(q_i)*X_t_i where X_t_i is the fixed transformation from
+ * the parent body to the joint frame and X_j(q_i) is the joint transformation.
+ * See Roy Featherstone «Rigid Body Dynamics Algorithms» chapter 4.
+ */
+template<typename T>
+class KinematicTree
+{
+public:
+  typedef Eigen::Vector3<T> vector3_t;
+  typedef Eigen::Matrix<T, Eigen::Dynamic, 1> vectorX_t;
+
+public:
+  /// Empty tree.
+  KinematicTree()
+  : parents_(), dofIndex_(), types_(), axes_(), principalAxes_(), Xt_(), S_(), inertias_(), nrDof_(0)
+  {
+  }
+
+  /**
+   * Add a body at the end of the tree.
+   * @param parent Index of the parent body, -1 if the body is attached to the world.
+   * @param X_t Fixed transformation from the parent body frame to the joint frame.
+   * @param type Joint type.
+   * @param axis Unit joint axis in the joint frame, unused for fixed joints.
+   * @return Index of the new body.
+   */
+  int addBody(int parent, const PTransform<T> & X_t, JointType type, const vector3_t & axis = vector3_t::UnitZ())
+  {
+    return addBody(parent, X_t, type, axis, RBInertia<T>(T(0), vector3_t::Zero(), Eigen::Matrix3<T>::Zero()));
+  }
+
+  /**
+   * Add a body at the end of the tree.
+   * @see addBody(int, const PTransform<T>&, JointType, const vector3_t&)
+   * @param inertia Spatial inertia of the body in the body frame.
+   */
+  int addBody(int parent,
+              const PTransform<T> & X_t,
+              JointType type,
+              const vector3_t & axis,
+              const RBInertia<T> & inertia)
+  {
+    assert(parent >= -1 && parent < nrBodies());
+    parents_.push_back(parent);
+    inertias_.push_back(inertia);
+    dofIndex_.push_back(type == JointType::Fixed ? -1 : nrDof_);
+    types_.push_back(type);
+    axes_.push_back(axis);
+    principalAxes_.push_back(principalAxis(axis));
+    Xt_.push_back(X_t);
+    switch(type)
+    {
+      case JointType::Revolute:
+        S_.push_back(MotionVec<T>(axis, vector3_t::Zero()));
+        break;
+      case JointType::Prismatic:
+        S_.push_back(MotionVec<T>(vector3_t::Zero(), axis));
+        break;
+      default:
+        S_.push_back(MotionVec<T>::Zero());
+        break;
+    }
+    if(type != JointType::Fixed)
+    {
+      ++nrDof_;
+    }
+    return nrBodies() - 1;
+  }
+
+  // Accessor
+  /// @return Number of bodies.
+  int nrBodies() const
+  {
+    return static_cast<int>(parents_.size());
+  }
+
+  /// @return Number of degrees of freedom.
+  int nrDof() const
+  {
+    return nrDof_;
+  }
+
+  /// @return Index of the parent of body i, -1 for the bodies attached to the world.
+  int parent(int i) const
+  {
+    return parents_[static_cast<std::size_t>(i)];
+  }
+
+  /// @return Parent index of each body.
+  const std::vector<int> & parents() const
+  {
+    return parents_;
+  }
+
+  /// @return Index of the joint i in the configuration vector, -1 for fixed joints.
+  int dofIndex(int i) const
+  {
+    return dofIndex_[static_cast<std::size_t>(i)];
+  }
+
+  /// @return Type of the joint i.
+  JointType jointType(int i) const
+  {
+    return types_[static_cast<std::size_t>(i)];
+  }
+
+  /// @return Axis of the joint i in the joint frame.
+  const vector3_t & jointAxis(int i) const
+  {
+    return axes_[static_cast<std::size_t>(i)];
+  }
+
+  /// @return Fixed transformation from the parent of body i to the joint i frame.
+  const PTransform<T> & treeTransform(int i) const
+  {
+    return Xt_[static_cast<std::size_t>(i)];
+  }
+
+  /// @return Spatial inertia of the body i in the body frame.
+  const RBInertia<T> & inertia(int i) const
+  {
+    return inertias_[static_cast<std::size_t>(i)];
+  }
+
+  /// Set the spatial inertia of the body i in the body frame.
+  void inertia(int i, const RBInertia<T> & rbI)
+  {
+    inertias_[static_cast<std::size_t>(i)] = rbI;
+  }
+
+  /// @return Motion subspace of the joint i, zero for fixed joints.
+  const MotionVec<T> & motionSubspace(int i) const
+  {
+    return S_[static_cast<std::size_t>(i)];
+  }
+
+  /// @return Joint transformation X_j(q) of the joint i.
+  PTransform<T> jointTransform(int i, T q) const;
+
+  /**
+   * Compute the transformation X_p_i = X_j(q)*X_t_i from the parent of body i
+   * to the body i.
+   * Revolute joints about ±X, ±Y or ±Z only combine two rows of X_t_i (see
+   * AxisRotationTransform) and prismatic joints only offset its translation.
+   * @param q Joint configuration, unused for fixed joints.
+   */
+  PTransform<T> parentToBody(int i, T q) const;
+
+  /**
+   * Compute the joint transformation of the joint i for a batch of configurations.
+   * @param q Joint configuration of each element of the batch.
+   * @param result Resized if needed.
+   */
+  template<typename Derived>
+  void jointTransform(int i, const Eigen::MatrixBase<Derived> & q, PTransformBatch<T> & result) const;
+
+private:
+  std::vector<int> parents_;
+  std::vector<int> dofIndex_;
+  std::vector<JointType> types_;
+  std::vector<vector3_t> axes_;
+  /// 1 + index of the principal axis, negated for -X, -Y and -Z, 0 for other axes.
+  std::vector<int> principalAxes_;
+  std::vector<PTransform<T>> Xt_;
+  std::vector<MotionVec<T>> S_;
+  std::vector<RBInertia<T>> inertias_;
+  int nrDof_;
+
+private:
+  static int principalAxis(const vector3_t & axis)
+  {
+    for(int k = 0; k < 3; ++k)
+    {
+      if(axis(k) == T(1) && axis((k + 1) % 3) == T(0) && axis((k + 2) % 3) == T(0))
+      {
+        return k + 1;
+      }
+      if(axis(k) == T(-1) && axis((k + 1) % 3) == T(0) && axis((k + 2) % 3) == T(0))
+      {
+        return -(k + 1);
+      }
+    }
+    return 0;
+  }
+};
+
+template<typename T>
+inline PTransform<T> KinematicTree<T>::jointTransform(int i, T q) const
+{
+  switch(jointType(i))
+  {
+    case JointType::Revolute:
+      // the rotation is expressed in successor frame
+      return PTransform<T>(Eigen::AngleAxis<T>(-q, jointAxis(i)).toRotationMatrix());
+    case JointType::Prismatic:
+      return PTransform<T>(vector3_t(q * jointAxis(i)));
+    default:
+      return PTransform<T>::Identity();
+  }
+}
+
+template<typename T>
+inline PTransform<T> KinematicTree<T>::parentToBody(int i, T q) const
+{
+  const PTransform<T> & X_t = treeTransform(i);
+  switch(jointType(i))
+  {
+    case JointType::Revolute:
+    {
+      const int axis = principalAxes_[static_cast<std::size_t>(i)];
+      // a rotation of q about -a is a rotation of -q about a
+      using std::cos;
+      using std::sin;
+      const T c = cos(q);
+      const T s = axis < 0 ? T(-sin(q)) : T(sin(q));
+      switch(std::abs(axis))
+      {
+        case 1:
+          return RotXTransform<T>(c, s) * X_t;
+        case 2:
+          return RotYTransform<T>(c, s) * X_t;
+        case 3:
+          return RotZTransform<T>(c, s) * X_t;
+        default:
+          return jointTransform(i, q) * X_t;
+      }
+    }
+    case JointType::Prismatic:
+      return TranslationTransform<T>(vector3_t(q * jointAxis(i))) * X_t;
+    default:
+      return X_t;
+  }
+}
+
+template<typename T>
+template<typename Derived>
+inline void KinematicTree<T>::jointTransform(int i,
+                                             const Eigen::MatrixBase<Derived> & q,
+                                             PTransformBatch<T> & result) const
+{
+  result.resize(q.size());
+  const vector3_t & a = jointAxis(i);
+  switch(jointType(i))
+  {
+    case JointType::Revolute:
+    {
+      // E = c*I + (1 - c)*a*a^T - s*[a]x with c = cos(q) and s = sin(q)
+      // computed lane by lane from the Rodrigues formula
+      typename PTransformBatch<T>::lane_t c = result.translation(0);
+      typename PTransformBatch<T>::lane_t s = result.translation(1);
+      c.array() = q.derived().array().cos();
+      s.array() = q.derived().array().sin();
+      for(int r = 0; r < 3; ++r)
+      {
+        for(int col = 0; col < 3; ++col)
+        {
+          result.rotation(r, col).array() = a(r) * a(col) * (T(1) - c.array());
+        }
+        result.rotation(r, r).array() += c.array();
+      }
+      result.rotation(0, 1).array() += a(2) * s.array();
+      result.rotation(0, 2).array() -= a(1) * s.array();
+      result.rotation(1, 0).array() -= a(2) * s.array();
+      result.rotation(1, 2).array() += a(0) * s.array();
+      result.rotation(2, 0).array() += a(1) * s.array();
+      result.rotation(2, 1).array() -= a(0) * s.array();
+      result.translation(0).setZero();
+      result.translation(1).setZero();
+      result.translation(2).setZero();
+      break;
+    }
+    case JointType::Prismatic:
+      result.setConstant(PTransform<T>::Identity());
+      for(int r = 0; r < 3; ++r)
+      {
+        result.translation(r) = a(r) * q;
+      }
+      break;
+    default:
+      result.setConstant(PTransform<T>::Identity());
+      break;
+  }
+}
+
+} // namespace sva
@@ -0,0 +1,308 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+#include "KinematicTree.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace sva
+{
+
+/**
+ * Joint space mass matrix of a KinematicTree computed with the composite
+ * rigid body algorithm.
+ * The composite inertias are kept in the compact RBInertia form during the
+ * whole algorithm.
+ * The bodies are split by the constructor in independent subtrees that are
+ * reduced in parallel, then the remaining bodies are reduced by the calling
+ * thread and the columns of the mass matrix are computed in parallel.
+ * The result does not depend on the number of threads.
+ * The worker threads and all the buffers are created by the constructor,
+ * compute neither starts threads nor allocates.
+ * See Roy Featherstone «Rigid Body Dynamics Algorithms» table 6.2.
+ */
+template<typename T>
+class MassMatrix
+{
+public:
+  typedef typename KinematicTree<T>::vectorX_t vectorX_t;
+  typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> matrixX_t;
+
+public:
+  MassMatrix() : nrThreads_(1) {}
+
+  /**
+   * Allocate the buffers, split tree in independent subtrees and start the
+   * worker threads.
+   * @param nrThreads Number of threads, 0 to use defaultNrThreads().
+   */
+  explicit MassMatrix(const KinematicTree<T> & tree, unsigned nrThreads = 1);
+
+  /**
+   * Compute the mass matrix at the joint configuration q.
+   * tree must have the same structure than the one given to the constructor.
+   */
+  void compute(const KinematicTree<T> & tree, const vectorX_t & q);
+
+  // Accessor
+  /// @return nrDof x nrDof mass matrix computed by the last call to compute.
+  const matrixX_t & matrix() const
+  {
+    return H_;
+  }
+
+  /// @return Composite inertia of the subtree of each body in the body frame.
+  const std::vector<RBInertia<T>> & compositeInertia() const
+  {
+    return Ic_;
+  }
+
+  /// @return Transformation from the parent body to each body.
+  const std::vector<PTransform<T>> & parentToBody() const
+  {
+    return X_p_;
+  }
+
+  /// @return Number of threads used.
+  unsigned nrThreads() const
+  {
+    return nrThreads_;
+  }
+
+  /// @return Number of subtrees reduced in parallel.
+  std::size_t nrSubtrees() const
+  {
+    return subtreeStart_.size() - 1;
+  }
+
+private:
+  void reduceBody(const KinematicTree<T> & tree, int i);
+  void computeColumn(const KinematicTree<T> & tree, int i);
+
+private:
+  unsigned nrThreads_;
+  /// Worker threads, a pointer since the pool can not be moved.
+  std::unique_ptr<ThreadPool> pool_;
+  std::vector<PTransform<T>> X_p_;
+  std::vector<RBInertia<T>> Ic_;
+  matrixX_t H_;
+  /// Bodies of each subtree, parents first, the subtree s being [subtreeStart_[s], subtreeStart_[s + 1]).
+  std::vector<int> subtreeBodies_;
+  std::vector<std::size_t> subtreeStart_;
+  /// Subtrees given to each thread, the thread t reducing [subtreeChunk_[t], subtreeChunk_[t + 1]).
+  std::vector<std::size_t> subtreeChunk_;
+  /// Bodies that are not in a subtree.
+  std::vector<int> trunkBodies_;
+  /// Bodies reduced by the calling thread after the subtrees, children first.
+  std::vector<int> trunkReduce_;
+  /// Bodies with a degree of freedom, the thread t computing their columns in [columnChunk_[t], columnChunk_[t + 1]).
+  std::vector<int> columnBodies_;
+  std::vector<std::size_t> columnChunk_;
+};
+
+namespace sva_internal
+{
+
+/**
+ * Split costs in nrChunks contiguous chunks of similar total cost.
+ * @return Chunks boundaries, the chunk k being [result[k], result[k + 1]).
+ */
+inline std::vector<std::size_t> balancedChunks(const std::vector<std::size_t> & costs, unsigned nrChunks)
+{
+  std::size_t total = 0;
+  for(std::size_t c : costs)
+  {
+    total += c;
+  }
+
+  std::vector<std::size_t> result(nrChunks + 1, costs.size());
+  result[0] = 0;
+  std::size_t index = 0;
+  std::size_t cumulated = 0;
+  for(unsigned k = 1; k < nrChunks; ++k)
+  {
+    const std::size_t target = (total * k) / nrChunks;
+    while(index < costs.size() && cumulated + costs[index] / 2 < target)
+    {
+      cumulated += costs[index];
+      ++index;
+    }
+    result[k] = index;
+  }
+  return result;
+}
+
+} // namespace sva_internal
+
+template<typename T>
+inline MassMatrix<T>::MassMatrix(const KinematicTree<T> & tree, unsigned nrThreads)
+: nrThreads_(nrThreads == 0 ? defaultNrThreads() : nrThreads), pool_(new ThreadPool(nrThreads_)),
+  X_p_(static_cast<std::size_t>(tree.nrBodies())),
+  Ic_(static_cast<std::size_t>(tree.nrBodies())), H_(matrixX_t::Zero(tree.nrDof(), tree.nrDof()))
+{
+  const std::size_t nrBodies = static_cast<std::size_t>(tree.nrBodies());
+
+  std::vector<std::size_t> subtreeSize(nrBodies, 1);
+  std::vector<std::size_t> depth(nrBodies, 0);
+  for(int i = tree.nrBodies() - 1; i >= 0; --i)
+  {
+    const int p = tree.parent(i);
+    if(p >= 0)
+    {
+      subtreeSize[static_cast<std::size_t>(p)] += subtreeSize[static_cast<std::size_t>(i)];
+    }
+  }
+
+  // a subtree root is the biggest subtree holding at most 1/nrThreads of the bodies,
+  // subtree[i] is the root of the subtree of the body i or -1 for the trunk bodies
+  const std::size_t grain = std::max<std::size_t>(1, (nrBodies + nrThreads_ - 1) / nrThreads_);
+  std::vector<int> subtree(nrBodies, -1);
+  std::vector<int> roots;
+  for(int i = 0; i < tree.nrBodies(); ++i)
+  {
+    const std::size_t ui = static_cast<std::size_t>(i);
+    const int p = tree.parent(i);
+    depth[ui] = p < 0 ? 1 : depth[static_cast<std::size_t>(p)] + 1;
+    if(p >= 0 && subtree[static_cast<std::size_t>(p)] >= 0)
+    {
+      subtree[ui] = subtree[static_cast<std::size_t>(p)];
+    }
+    else if(subtreeSize[ui] <= grain)
+    {
+      subtree[ui] = i;
+      roots.push_back(i);
+    }
+  }
+
+  std::vector<std::size_t> subtreeCosts;
+  subtreeStart_.push_back(0);
+  for(int root : roots)
+  {
+    for(int i = root; i < tree.nrBodies(); ++i)
+    {
+      if(subtree[static_cast<std::size_t>(i)] == root)
+      {
+        subtreeBodies_.push_back(i);
+      }
+    }
+    subtreeStart_.push_back(subtreeBodies_.size());
+    subtreeCosts.push_back(subtreeSize[static_cast<std::size_t>(root)]);
+  }
+  subtreeChunk_ = sva_internal::balancedChunks(subtreeCosts, nrThreads_);
+
+  for(int i = tree.nrBodies() - 1; i >= 0; --i)
+  {
+    const std::size_t ui = static_cast<std::size_t>(i);
+    if(subtree[ui] < 0 || subtree[ui] == i)
+    {
+      trunkReduce_.push_back(i);
+    }
+  }
+  for(int i = 0; i < tree.nrBodies(); ++i)
+  {
+    if(subtree[static_cast<std::size_t>(i)] < 0)
+    {
+      trunkBodies_.push_back(i);
+    }
+  }
+
+  // the cost of a column is the depth of its body
+  std::vector<std::size_t> columnCosts;
+  for(int i = 0; i < tree.nrBodies(); ++i)
+  {
+    if(tree.dofIndex(i) >= 0)
+    {
+      columnBodies_.push_back(i);
+      columnCosts.push_back(depth[static_cast<std::size_t>(i)]);
+    }
+  }
+  columnChunk_ = sva_internal::balancedChunks(columnCosts, nrThreads_);
+}
+
+template<typename T>
+inline void MassMatrix<T>::reduceBody(const KinematicTree<T> & tree, int i)
+{
+  const int p = tree.parent(i);
+  if(p >= 0)
+  {
+    const std::size_t ui = static_cast<std::size_t>(i);
+    Ic_[static_cast<std::size_t>(p)] += X_p_[ui].transMul(Ic_[ui]);
+  }
+}
+
+template<typename T>
+inline void MassMatrix<T>::computeColumn(const KinematicTree<T> & tree, int i)
+{
+  // F = Ic_i*S_i, H_ii = S_i^T F then F is carried to each ancestor j: H_ij = H_ji = S_j^T F
+  const int dof = tree.dofIndex(i);
+  ForceVec<T> F = Ic_[static_cast<std::size_t>(i)] * tree.motionSubspace(i);
+  H_(dof, dof) = tree.motionSubspace(i).dot(F);
+  for(int j = i; tree.parent(j) >= 0;)
+  {
+    F = X_p_[static_cast<std::size_t>(j)].transMul(F);
+    j = tree.parent(j);
+    const int dofJ = tree.dofIndex(j);
+    if(dofJ >= 0)
+    {
+      H_(dof, dofJ) = H_(dofJ, dof) = tree.motionSubspace(j).dot(F);
+    }
+  }
+}
+
+template<typename T>
+inline void MassMatrix<T>::compute(const KinematicTree<T> & tree, const vectorX_t & q)
+{
+  assert(q.size() == tree.nrDof());
+  assert(pool_);
+  auto initBody = [this, &tree, &q](int i) {
+    const std::size_t ui = static_cast<std::size_t>(i);
+    const int dof = tree.dofIndex(i);
+    X_p_[ui] = tree.parentToBody(i, dof < 0 ? T(0) : q(dof));
+    Ic_[ui] = tree.inertia(i);
+  };
+
+  // each subtree is reduced up to its root, the order of the sums is the same
+  // as a sequential reduction so the result does not depend on the splitting
+  pool_->parallelFor(static_cast<std::ptrdiff_t>(nrThreads_), 1,
+                     [this, &tree, &initBody](unsigned, std::ptrdiff_t begin, std::ptrdiff_t end) {
+                       for(std::size_t s = subtreeChunk_[static_cast<std::size_t>(begin)];
+                           s < subtreeChunk_[static_cast<std::size_t>(end)]; ++s)
+                       {
+                         for(std::size_t b = subtreeStart_[s]; b < subtreeStart_[s + 1]; ++b)
+                         {
+                           initBody(subtreeBodies_[b]);
+                         }
+                         // the subtree root is reduced with the trunk
+                         for(std::size_t b = subtreeStart_[s + 1] - 1; b > subtreeStart_[s]; --b)
+                         {
+                           reduceBody(tree, subtreeBodies_[b]);
+                         }
+                       }
+                     });
+
+  for(int i : trunkBodies_)
+  {
+    initBody(i);
+  }
+  for(int i : trunkReduce_)
+  {
+    reduceBody(tree, i);
+  }
+
+  pool_->parallelFor(static_cast<std::ptrdiff_t>(nrThreads_), 1,
+                     [this, &tree](unsigned, std::ptrdiff_t begin, std::ptrdiff_t end) {
+                       for(std::size_t c = columnChunk_[static_cast<std::size_t>(begin)];
+                           c < columnChunk_[static_cast<std::size_t>(end)]; ++c)
+                       {
+                         computeColumn(tree, columnBodies_[c]);
+                       }
+                     });
+}
+
+} // namespace sva
@@ -79,16 +79,20 @@ inline T SO3JacF2(const T & x)
   // Taylor expansion at 0 is 1/360 * (1 + x^2/60 + x^4/2520 + x^6/100800 + x^8/3991680)
   using details::cbrt;
   using details::sqrt;
-  constexpr T ulp = std::numeric_limits<T>::epsilon();
-  constexpr T taylor_2_bound = sqrt(static_cast<T>(60) * ulp);
-  constexpr T taylor_4_bound = sqrt(sqrt(static_cast<T>(2520) * ulp));
-  constexpr T taylor_6_bound = sqrt(cbrt(static_cast<T>(100800) * ulp));
-  constexpr T taylor_8_bound = sqrt(sqrt(sqrt(static_cast<T>(3991680) * ulp)));
-
-  double absx = std::abs(x);
+  using std::abs;
+  using std::cos;
+  using std::sin;
+  typedef typename Eigen::NumTraits<T>::Literal literal_t;
+  constexpr literal_t ulp = std::numeric_limits<literal_t>::epsilon();
+  constexpr literal_t taylor_2_bound = sqrt(static_cast<literal_t>(60) * ulp);
+  constexpr literal_t taylor_4_bound = sqrt(sqrt(static_cast<literal_t>(2520) * ulp));
+  constexpr literal_t taylor_6_bound = sqrt(cbrt(static_cast<literal_t>(100800) * ulp));
+  constexpr literal_t taylor_8_bound = sqrt(sqrt(sqrt(static_cast<literal_t>(3991680) * ulp)));
+
+  T absx = abs(x);
   if(absx >= taylor_8_bound)
   {
-    return static_cast<T>(1) / (x * x) - (static_cast<T>(1) + std::cos(x)) / (static_cast<T>(2) * x * std::sin(x));
+    return static_cast<T>(1) / (x * x) - (static_cast<T>(1) + cos(x)) / (static_cast<T>(2) * x * sin(x));
   }
   else
   {
@@ -130,18 +134,24 @@ inline T dSO3JacF2(const T & x)
   // up to 13th order gives us a max error of about 3e-10.
   using details::cbrt;
   using details::sqrt;
-  constexpr T ulp = std::numeric_limits<T>::epsilon();
-  constexpr T taylor_2_bound = sqrt(static_cast<T>(21) * ulp);
-  constexpr T taylor_4_bound = sqrt(sqrt(static_cast<T>(560) * ulp));
-  constexpr T taylor_6_bound = sqrt(cbrt(static_cast<T>(16632) * ulp));
-  constexpr T taylor_8_bound = sqrt(sqrt(sqrt(static_cast<T>(363242880) * ulp / static_cast<T>(691))));
-  constexpr T taylor_12_bound = sqrt(sqrt(cbrt(static_cast<T>(2117187072000) * ulp / static_cast<T>(3617))));
-
-  double absx = std::abs(x);
+  using std::abs;
+  using std::cos;
+  using std::sin;
+  typedef typename Eigen::NumTraits<T>::Literal literal_t;
+  constexpr literal_t ulp = std::numeric_limits<literal_t>::epsilon();
+  constexpr literal_t taylor_2_bound = sqrt(static_cast<literal_t>(21) * ulp);
+  constexpr literal_t taylor_4_bound = sqrt(sqrt(static_cast<literal_t>(560) * ulp));
+  constexpr literal_t taylor_6_bound = sqrt(cbrt(static_cast<literal_t>(16632) * ulp));
+  constexpr literal_t taylor_8_bound =
+      sqrt(sqrt(sqrt(static_cast<literal_t>(363242880) * ulp / static_cast<literal_t>(691))));
+  constexpr literal_t taylor_12_bound =
+      sqrt(sqrt(cbrt(static_cast<literal_t>(2117187072000) * ulp / static_cast<literal_t>(3617))));
+
+  T absx = abs(x);
   if(absx >= taylor_12_bound)
   {
     T x2 = x * x;
-    return (x + std::sin(x)) / (static_cast<T>(2) * x2 * (1 - std::cos(x))) - static_cast<T>(2) / (x2 * x);
+    return (x + sin(x)) / (static_cast<T>(2) * x2 * (1 - cos(x))) - static_cast<T>(2) / (x2 * x);
   }
   else
   {
@@ -178,6 +188,132 @@ inline T dSO3JacF2(const T & x)
   }
 }
 
+/// @return n!
+template<typename T>
+T constexpr factorial(int n)
+{
+  return n <= 1 ? static_cast<T>(1) : static_cast<T>(n) * factorial<T>(n - 1);
+}
+
+/// Number of terms of the Taylor series evaluated by alternatingFactorialSeries.
+constexpr int alternatingFactorialSeriesTerms = 8;
+
+/**
+ * Bound on |x| under which the terms of alternatingFactorialSeries<N> that
+ * are not evaluated (order 16 and more) are below the ulp of the result.
+ */
+template<int N, typename T>
+T constexpr alternatingFactorialSeriesBound()
+{
+  using details::sqrt;
+  return sqrt(sqrt(sqrt(sqrt(std::numeric_limits<T>::epsilon() * factorial<T>(N + 16) / factorial<T>(N)))));
+}
+
+/** Compute the Taylor series \f$ \sum_{k=0}^{7} \frac{(-1)^k x^{2k}}{(2k + N)!} \f$ by Horner's rule.
+ * \param x2 Square of x.
+ */
+template<int N, typename T>
+inline T alternatingFactorialSeries(const T & x2)
+{
+  typedef typename Eigen::NumTraits<T>::Literal literal_t;
+  T result = static_cast<T>(1);
+  for(int k = alternatingFactorialSeriesTerms - 1; k > 0; --k)
+  {
+    result = static_cast<literal_t>(1)
+             - x2 * result * (static_cast<literal_t>(1) / static_cast<literal_t>((N + 2 * k - 1) * (N + 2 * k)));
+  }
+  return result * (static_cast<literal_t>(1) / factorial<literal_t>(N));
+}
+
+/** Compute the value \f$ \frac{1 - \cos(x)}{x^2} \f$.
+ * This is the coefficient of \f$ [u]_\times \f$ in the left Jacobian of SO(3).
+ */
+template<typename T>
+inline T SO3JacG1(const T & x)
+{
+  // Taylor expansion at 0 is 1/2 - x^2/24 + x^4/720 - ...
+  using std::abs;
+  using std::cos;
+  typedef typename Eigen::NumTraits<T>::Literal literal_t;
+  constexpr literal_t taylor_bound = alternatingFactorialSeriesBound<2, literal_t>();
+
+  if(abs(x) >= taylor_bound)
+  {
+    return (static_cast<T>(1) - cos(x)) / (x * x);
+  }
+  return alternatingFactorialSeries<2>(x * x);
+}
+
+/** Compute the value \f$ \frac{x - \sin(x)}{x^3} \f$.
+ * This is the coefficient of \f$ [u]_\times^2 \f$ in the Jacobians of SO(3).
+ */
+template<typename T>
+inline T SO3JacG2(const T & x)
+{
+  // Taylor expansion at 0 is 1/6 - x^2/120 + x^4/5040 - ...
+  using std::abs;
+  using std::sin;
+  typedef typename Eigen::NumTraits<T>::Literal literal_t;
+  constexpr literal_t taylor_bound = alternatingFactorialSeriesBound<3, literal_t>();
+
+  if(abs(x) >= taylor_bound)
+  {
+    return (x - sin(x)) / (x * x * x);
+  }
+  return alternatingFactorialSeries<3>(x * x);
+}
+
+/** Compute \f$ G_N(x) = \sum_{k=0}^{\infty} \frac{(-1)^k x^{2k}}{(2k + N)!} \f$ for N = 2..Last in out[N - 2]
+ * with at most one evaluation of sin and cos.
+ * The argument is x^2 so that no square root is taken below the Taylor bound, which keeps the functions
+ * differentiable at 0 for automatic differentiation scalars.
+ * SO3JacG1 is G_2 and SO3JacG2 is G_3.
+ *
+ * For small x, the last two functions are given by their Taylor series and the others by the recurrence
+ * \f$ G_N = \frac{1}{N!} - x^2 G_{N+2} \f$ that does not cancel. Otherwise they are all obtained
+ * from \f$ G_0 = \cos(x) \f$ and \f$ G_1 = \frac{\sin(x)}{x} \f$ by \f$ G_N = \frac{1/(N-2)! - G_{N-2}}{x^2} \f$.
+ */
+template<int Last, typename T>
+inline void alternatingFactorialFunctions(const T & x2, T (&out)[Last - 1])
+{
+  static_assert(Last >= 3, "At least G_2 and G_3 are computed");
+  using std::cos;
+  using std::sin;
+  using std::sqrt;
+  typedef typename Eigen::NumTraits<T>::Literal literal_t;
+  constexpr literal_t taylor_bound = alternatingFactorialSeriesBound<Last - 1, literal_t>();
+
+  if(x2 >= taylor_bound * taylor_bound)
+  {
+    T x = sqrt(x2);
+    out[0] = (static_cast<T>(1) - cos(x)) / x2;
+    out[1] = (static_cast<T>(1) - sin(x) / x) / x2;
+    for(int N = 4; N <= Last; ++N)
+    {
+      out[N - 2] = (static_cast<literal_t>(1) / factorial<literal_t>(N - 2) - out[N - 4]) / x2;
+    }
+  }
+  else
+  {
+    out[Last - 2] = alternatingFactorialSeries<Last>(x2);
+    out[Last - 3] = alternatingFactorialSeries<Last - 1>(x2);
+    for(int N = Last - 2; N >= 2; --N)
+    {
+      out[N - 2] = static_cast<literal_t>(1) / factorial<literal_t>(N) - x2 * out[N];
+    }
+  }
+}
+
+/** Compute the value \f$ \frac{1}{x^2} - \frac{1+\cos(x)}{2 x \sin(x)} = \frac{G_3(x) - 2 G_4(x)}{2 G_2(x)} \f$
+ * from G = alternatingFactorialFunctions<N>(x^2) with N >= 4, the latter form does not cancel for small x.
+ * Only use it when G is already computed, SO3JacF2(x) is faster otherwise.
+ */
+template<typename T>
+inline T SO3JacF2(const T * G)
+{
+  return (G[1] - static_cast<T>(2) * G[2]) / (static_cast<T>(2) * G[0]);
+}
+
 } // namespace details
 
 /** sinus cardinal: sin(x)/x
@@ -186,27 +322,30 @@ inline T dSO3JacF2(const T & x)
 template<typename T>
 T sinc(const T x)
 {
-  constexpr T taylor_0_bound = std::numeric_limits<double>::epsilon();
-  constexpr T taylor_2_bound = details::sqrt(taylor_0_bound);
-  constexpr T taylor_n_bound = details::sqrt(taylor_2_bound);
-
-  if(std::abs(x) >= taylor_n_bound)
+  using std::abs;
+  using std::sin;
+  typedef typename Eigen::NumTraits<T>::Literal literal_t;
+  constexpr literal_t taylor_0_bound = std::numeric_limits<double>::epsilon();
+  constexpr literal_t taylor_2_bound = details::sqrt(taylor_0_bound);
+  constexpr literal_t taylor_n_bound = details::sqrt(taylor_2_bound);
+
+  if(abs(x) >= taylor_n_bound)
   {
-    return (std::sin(x) / x);
+    return (sin(x) / x);
   }
   else
   {
     // approximation by taylor series in x at 0 up to order 0
     T result = static_cast<T>(1);
 
-    if(std::abs(x) >= taylor_0_bound)
+    if(abs(x) >= taylor_0_bound)
     {
       T x2 = x * x;
 
       // approximation by taylor series in x at 0 up to order 2
       result -= x2 / static_cast<T>(6);
 
-      if(std::abs(x) >= taylor_2_bound)
+      if(abs(x) >= taylor_2_bound)
       {
         // approximation by taylor series in x at 0 up to order 4
         result += (x2 * x2) / static_cast<T>(120);
@@ -224,9 +363,12 @@ T sinc(const T x)
 template<typename T>
 T sinc_inv(const T x)
 {
-  constexpr T taylor_0_bound = std::numeric_limits<T>::epsilon();
-  constexpr T taylor_2_bound = details::sqrt(taylor_0_bound);
-  constexpr T taylor_n_bound = details::sqrt(taylor_2_bound);
+  using std::abs;
+  using std::sin;
+  typedef typename Eigen::NumTraits<T>::Literal literal_t;
+  constexpr literal_t taylor_0_bound = std::numeric_limits<literal_t>::epsilon();
+  constexpr literal_t taylor_2_bound = details::sqrt(taylor_0_bound);
+  constexpr literal_t taylor_n_bound = details::sqrt(taylor_2_bound);
 
   // We use the 4th order taylor series around 0 of x/sin(x) to compute
   // this function:
@@ -240,9 +382,9 @@ T sinc_inv(const T x)
   // (i.e. taylor_2_bound^6 + taylor_0_bound == taylor_0_bound but
   //       taylor_n_bound^6 + taylor_0_bound != taylor_0).
 
-  if(std::abs(x) >= taylor_n_bound)
+  if(abs(x) >= taylor_n_bound)
   {
-    return (x / std::sin(x));
+    return (x / sin(x));
   }
   else
   {
@@ -251,13 +393,13 @@ T sinc_inv(const T x)
     // We set the 0 order term.
     T result = static_cast<T>(1);
 
-    if(std::abs(x) >= taylor_0_bound)
+    if(abs(x) >= taylor_0_bound)
     {
       // x is above the machine epsilon so x^2 is meaningful.
       T x2 = x * x;
       result += x2 / static_cast<T>(6);
 
-      if(std::abs(x) >= taylor_2_bound)
+      if(abs(x) >= taylor_2_bound)
       {
         // x is above the machine sqrt(epsilon) so x^4 is meaningful.
         result += static_cast<T>(7) * (x2 * x2) / static_cast<T>(360);
@@ -268,6 +410,36 @@ T sinc_inv(const T x)
   }
 }
 
+/** Right Jacobian of SO(3) as defined in
+ * "A micro Lie theory for state estimation in robotics" by Solà et al. (see in particular eq. 143)
+ *
+ * This is the inverse of SO3RightJacInv, the left Jacobian is given by SO3LeftJac.
+ *
+ * \param u Point of so(3) at which to compute the matrix.
+ */
+template<typename T>
+Eigen::Matrix3<T> SO3RightJac(const Eigen::Vector3<T> & u)
+{
+  auto nu = u.norm();
+  Eigen::Matrix3<T> C = vector3ToCrossMatrix(u);
+  // C^2 = u u^T - |u|^2 I
+  Eigen::Matrix3<T> C2 = u * u.transpose() - nu * nu * Eigen::Matrix3<T>::Identity();
+  return Eigen::Matrix3<T>::Identity() - details::SO3JacG1(nu) * C + details::SO3JacG2(nu) * C2;
+}
+
+/** Left Jacobian of SO(3), that is the transpose of SO3RightJac (see Solà et al. eq. 145).
+ *
+ * \param u Point of so(3) at which to compute the matrix.
+ */
+template<typename T>
+Eigen::Matrix3<T> SO3LeftJac(const Eigen::Vector3<T> & u)
+{
+  auto nu = u.norm();
+  Eigen::Matrix3<T> C = vector3ToCrossMatrix(u);
+  Eigen::Matrix3<T> C2 = u * u.transpose() - nu * nu * Eigen::Matrix3<T>::Identity();
+  return Eigen::Matrix3<T>::Identity() + details::SO3JacG1(nu) * C + details::SO3JacG2(nu) * C2;
+}
+
 /** Inverse of the right Jacobian of SO(3) as defined in
  * "A micro Lie theory for state estimation in robotics" by Solà et al. (see in particular eq. 144)
  *
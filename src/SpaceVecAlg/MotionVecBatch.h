@@ -0,0 +1,236 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+#include "EigenTypedef.h"
+#include "MotionVec.h"
+#include "fwd.h"
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sva
+{
+
+/**
+ * Batch of spatial motion vectors stored in structure of arrays layout.
+ * Each of the 6 coefficients is stored in its own contiguous lane:
+ * the angular motion in lanes 0 to 2 and the linear motion in lanes 3 to 5.
+ */
+template<typename T>
+class MotionVecBatch
+{
+public:
+  typedef Eigen::Matrix<T, Eigen::Dynamic, 6> storage_t;
+  typedef Eigen::Matrix<T, Eigen::Dynamic, 1> vectorX_t;
+  typedef typename storage_t::Index index_t;
+  typedef typename storage_t::ColXpr lane_t;
+  typedef typename storage_t::ConstColXpr const_lane_t;
+
+public:
+  /// Batch of size zero motion vectors.
+  static MotionVecBatch<T> Zero(index_t size)
+  {
+    MotionVecBatch<T> mvb(size);
+    mvb.data_.setZero();
+    return mvb;
+  }
+
+public:
+  /// Empty batch.
+  MotionVecBatch() : data_() {}
+
+  /// Batch of size uninitialized motion vectors.
+  explicit MotionVecBatch(index_t size) : data_(size, 6) {}
+
+  /// Batch of size copies of mv.
+  MotionVecBatch(index_t size, const MotionVec<T> & mv) : data_(size, 6)
+  {
+    setConstant(mv);
+  }
+
+  /// @param mvs Motion vectors to store in the batch.
+  MotionVecBatch(const std::vector<MotionVec<T>> & mvs) : data_(static_cast<index_t>(mvs.size()), 6)
+  {
+    for(index_t i = 0; i < size(); ++i)
+    {
+      set(i, mvs[static_cast<std::size_t>(i)]);
+    }
+  }
+
+  /// Copy constructor.
+  template<typename T2>
+  MotionVecBatch(const MotionVecBatch<T2> & mvb) : data_(mvb.data().template cast<T>())
+  {
+  }
+
+  // Accessor
+  /// @return Number of motion vectors in the batch.
+  index_t size() const
+  {
+    return data_.rows();
+  }
+
+  /// Resize the batch, the motion vectors are left uninitialized.
+  void resize(index_t size)
+  {
+    data_.resize(size, 6);
+  }
+
+  /// @return Lane of the angular motion coefficient i.
+  lane_t angular(int i)
+  {
+    return data_.col(i);
+  }
+
+  /// @return Lane of the angular motion coefficient i.
+  const_lane_t angular(int i) const
+  {
+    return data_.col(i);
+  }
+
+  /// @return Lane of the linear motion coefficient i.
+  lane_t linear(int i)
+  {
+    return data_.col(3 + i);
+  }
+
+  /// @return Lane of the linear motion coefficient i.
+  const_lane_t linear(int i) const
+  {
+    return data_.col(3 + i);
+  }
+
+  /// @return Underlying size x 6 storage.
+  const storage_t & data() const
+  {
+    return data_;
+  }
+
+  /// @return Underlying size x 6 storage.
+  storage_t & data()
+  {
+    return data_;
+  }
+
+  /// @return Copy of the i-th motion vector.
+  MotionVec<T> operator[](index_t i) const
+  {
+    return MotionVec<T>(Eigen::Vector6<T>(data_.row(i).transpose()));
+  }
+
+  /// Set all the motion vectors of the batch to mv.
+  void setConstant(const MotionVec<T> & mv)
+  {
+    for(int i = 0; i < 3; ++i)
+    {
+      angular(i).setConstant(mv.angular()(i));
+      linear(i).setConstant(mv.linear()(i));
+    }
+  }
+
+  /// Set the i-th motion vector.
+  void set(index_t i, const MotionVec<T> & mv)
+  {
+    data_.row(i) << mv.angular().transpose(), mv.linear().transpose();
+  }
+
+  template<typename T2>
+  MotionVecBatch<T2> cast() const
+  {
+    return MotionVecBatch<T2>(*this);
+  }
+
+  // Operators
+  MotionVecBatch<T> operator+(const MotionVecBatch<T> & mvb) const
+  {
+    return MotionVecBatch<T>(storage_t(data_ + mvb.data_));
+  }
+
+  MotionVecBatch<T> operator-(const MotionVecBatch<T> & mvb) const
+  {
+    return MotionVecBatch<T>(storage_t(data_ - mvb.data_));
+  }
+
+  MotionVecBatch<T> operator-() const
+  {
+    return MotionVecBatch<T>(storage_t(-data_));
+  }
+
+  MotionVecBatch<T> & operator+=(const MotionVecBatch<T> & mvb)
+  {
+    data_ += mvb.data_;
+    return *this;
+  }
+
+  MotionVecBatch<T> & operator-=(const MotionVecBatch<T> & mvb)
+  {
+    data_ -= mvb.data_;
+    return *this;
+  }
+
+  template<typename T2, typename std::enable_if<std::is_arithmetic<T2>::value, int>::type = 0>
+  MotionVecBatch<T> operator*(T2 scalar) const
+  {
+    return MotionVecBatch<T>(storage_t(scalar * data_));
+  }
+
+  template<typename T2, typename std::enable_if<std::is_arithmetic<T2>::value, int>::type = 0>
+  MotionVecBatch<T> & operator*=(T2 scalar)
+  {
+    data_ *= scalar;
+    return *this;
+  }
+
+  /// @return v_i x v_i for each element of the batches
+  MotionVecBatch<T> cross(const MotionVecBatch<T> & mvb2) const;
+
+  /// @see cross, result is resized if needed and can be one of the operands.
+  void cross(const MotionVecBatch<T> & mvb2, MotionVecBatch<T> & result) const;
+
+  /// @return v_i x* f_i for each element of the batches
+  ForceVecBatch<T> crossDual(const ForceVecBatch<T> & fvb2) const;
+
+  /// @see crossDual, result is resized if needed and can be fvb2.
+  void crossDual(const ForceVecBatch<T> & fvb2, ForceVecBatch<T> & result) const;
+
+  /// @return v_i.f_i for each element of the batches
+  vectorX_t dot(const ForceVecBatch<T> & fvb2) const;
+
+  /// @see dot, result is resized if needed.
+  void dot(const ForceVecBatch<T> & fvb2, vectorX_t & result) const;
+
+  bool operator==(const MotionVecBatch<T> & mvb) const
+  {
+    return data_ == mvb.data_;
+  }
+
+  bool operator!=(const MotionVecBatch<T> & mvb) const
+  {
+    return data_ != mvb.data_;
+  }
+
+private:
+  explicit MotionVecBatch(storage_t && data) : data_(std::move(data)) {}
+
+private:
+  storage_t data_;
+};
+
+template<typename T, typename T2>
+inline MotionVecBatch<T> operator*(T2 scalar, const MotionVecBatch<T> & mvb)
+{
+  return mvb * scalar;
+}
+
+template<typename T>
+inline std::ostream & operator<<(std::ostream & out, const MotionVecBatch<T> & mvb)
+{
+  out << mvb.data();
+  return out;
+}
+
+} // namespace sva
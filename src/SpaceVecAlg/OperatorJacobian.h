@@ -0,0 +1,394 @@
+/*
+ * Copyright 2012-2021 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+#include "EigenTypedef.h"
+#include "SE3Jacobian.h"
+#include "fwd.h"
+
+/**
+ * Analytic Jacobians of the PTransform operators in the tangent space of SE(3).
+ *
+ * A PTransform X is perturbed by a motion vector dx as exp(dx)*X, the
+ * convention of SE3RightJac, so that dx is expressed in the successor frame of
+ * X. The Jacobian of a PTransform valued function f is J such that
+ * f(exp(dx)*X) = exp(J*dx)*f(X) at first order, the Jacobian of a vector valued
+ * function is the usual derivative w.r.t. dx.
+ */
+
+namespace sva
+{
+
+/**
+ * 6x6 block diagonal matrix diag(A, B) acting on motion vectors (angular part
+ * first), the structure of the Jacobians of functions that handle the rotation
+ * and the translation separately.
+ */
+template<typename T>
+class BlockDiagJacobian
+{
+  typedef Eigen::Matrix3<T> matrix3_t;
+  typedef Eigen::Matrix6<T> matrix6_t;
+
+public:
+  /// Identity matrix.
+  static BlockDiagJacobian<T> Identity()
+  {
+    return BlockDiagJacobian<T>(matrix3_t::Identity(), matrix3_t::Identity());
+  }
+
+public:
+  // Constructors
+  /// Default constructor. Blocks are uninitialized.
+  BlockDiagJacobian() : A_(), B_() {}
+
+  /// Copy constructor.
+  template<typename T2>
+  BlockDiagJacobian(const BlockDiagJacobian<T2> & J)
+  : A_(J.angular().template cast<T>()), B_(J.linear().template cast<T>())
+  {
+  }
+
+  /**
+   * @param A Block acting on the angular part.
+   * @param B Block acting on the linear part.
+   */
+  BlockDiagJacobian(const matrix3_t & A, const matrix3_t & B) : A_(A), B_(B) {}
+
+  // Accessor
+  /// @return Block acting on the angular part.
+  const matrix3_t & angular() const
+  {
+    return A_;
+  }
+
+  /// @return Block acting on the angular part.
+  matrix3_t & angular()
+  {
+    return A_;
+  }
+
+  /// @return Block acting on the linear part.
+  const matrix3_t & linear() const
+  {
+    return B_;
+  }
+
+  /// @return Block acting on the linear part.
+  matrix3_t & linear()
+  {
+    return B_;
+  }
+
+  /// @return Non compact 6x6 matrix.
+  matrix6_t matrix() const
+  {
+    matrix6_t m;
+    m << A_, matrix3_t::Zero(), matrix3_t::Zero(), B_;
+    return m;
+  }
+
+  template<typename T2>
+  BlockDiagJacobian<T2> cast() const
+  {
+    return BlockDiagJacobian<T2>(*this);
+  }
+
+  // Operators
+  /// @return J*J
+  BlockDiagJacobian<T> operator*(const BlockDiagJacobian<T> & J) const
+  {
+    return BlockDiagJacobian<T>(matrix3_t(A_ * J.A_), matrix3_t(B_ * J.B_));
+  }
+
+  /// @return Jv
+  MotionVec<T> operator*(const MotionVec<T> & mv) const;
+
+  /// @return J^T f
+  ForceVec<T> transMul(const ForceVec<T> & fv) const;
+
+  bool operator==(const BlockDiagJacobian<T> & J) const
+  {
+    return A_ == J.A_ && B_ == J.B_;
+  }
+
+  bool operator!=(const BlockDiagJacobian<T> & J) const
+  {
+    return !(*this == J);
+  }
+
+private:
+  matrix3_t A_, B_;
+};
+
+/**
+ * 6x6 matrix \f$ \begin{bmatrix} [n]_\times & [f]_\times \\ [f]_\times & 0 \end{bmatrix} \f$
+ * mapping motion vectors to force vectors, the structure of the Jacobian of
+ * PTransform::dualMul. Only the vectors n and f are stored.
+ * With g = ForceVec(n, f), J*mv = -mv.crossDual(g) and J^T = -J.
+ */
+template<typename T>
+class ForceCrossJacobian
+{
+  typedef Eigen::Vector3<T> vector3_t;
+  typedef Eigen::Matrix6<T> matrix6_t;
+
+public:
+  // Constructors
+  /// Default constructor. Vectors are uninitialized.
+  ForceCrossJacobian() : n_(), f_() {}
+
+  /// Copy constructor.
+  template<typename T2>
+  ForceCrossJacobian(const ForceCrossJacobian<T2> & J)
+  : n_(J.couple().template cast<T>()), f_(J.force().template cast<T>())
+  {
+  }
+
+  /**
+   * @param n Vector of the upper left block.
+   * @param f Vector of the off diagonal blocks.
+   */
+  ForceCrossJacobian(const vector3_t & n, const vector3_t & f) : n_(n), f_(f) {}
+
+  // Accessor
+  /// @return Vector of the upper left block.
+  const vector3_t & couple() const
+  {
+    return n_;
+  }
+
+  /// @return Vector of the upper left block.
+  vector3_t & couple()
+  {
+    return n_;
+  }
+
+  /// @return Vector of the off diagonal blocks.
+  const vector3_t & force() const
+  {
+    return f_;
+  }
+
+  /// @return Vector of the off diagonal blocks.
+  vector3_t & force()
+  {
+    return f_;
+  }
+
+  /// @return Non compact 6x6 matrix.
+  matrix6_t matrix() const
+  {
+    matrix6_t m;
+    const Eigen::Matrix3<T> F = vector3ToCrossMatrix(f_);
+    m << vector3ToCrossMatrix(n_), F, F, Eigen::Matrix3<T>::Zero();
+    return m;
+  }
+
+  template<typename T2>
+  ForceCrossJacobian<T2> cast() const
+  {
+    return ForceCrossJacobian<T2>(*this);
+  }
+
+  // Operators
+  /// @return Jv
+  ForceVec<T> operator*(const MotionVec<T> & mv) const;
+
+  /// @return J^T v
+  ForceVec<T> transMul(const MotionVec<T> & mv) const;
+
+  bool operator==(const ForceCrossJacobian<T> & J) const
+  {
+    return n_ == J.n_ && f_ == J.f_;
+  }
+
+  bool operator!=(const ForceCrossJacobian<T> & J) const
+  {
+    return !(*this == J);
+  }
+
+private:
+  vector3_t n_, f_;
+};
+
+/// Jacobians of a function of two arguments w.r.t. each of them.
+template<typename J>
+struct BinaryJacobian
+{
+  /// Jacobian w.r.t. the first argument.
+  J first;
+  /// Jacobian w.r.t. the second argument.
+  J second;
+};
+
+/**
+ * Jacobians of X1*X2: the identity w.r.t. X1 and the matrix of X1 w.r.t. X2.
+ */
+template<typename T>
+BinaryJacobian<SE3Jacobian<T>> mulJacobian(const PTransform<T> & X1, const PTransform<T> & X2);
+
+/**
+ * Jacobian of X*mv w.r.t. X, that is the motion cross product matrix of X*mv.
+ * The Jacobian w.r.t. mv is the matrix of X.
+ */
+template<typename T>
+SE3Jacobian<T> mulJacobian(const PTransform<T> & X, const MotionVec<T> & mv);
+
+/**
+ * Jacobian of X.invMul(mv) w.r.t. X: -[X^-1 mv]x X^-1.
+ * The Jacobian w.r.t. mv is the matrix of X^-1.
+ */
+template<typename T>
+SE3Jacobian<T> invMulJacobian(const PTransform<T> & X, const MotionVec<T> & mv);
+
+/**
+ * Jacobian of X.dualMul(fv) w.r.t. X. With g = X.dualMul(fv) it is
+ * \f$ \begin{bmatrix} [g_n]_\times & [g_f]_\times \\ [g_f]_\times & 0 \end{bmatrix} \f$
+ * where g_n is the couple and g_f the force of g.
+ * The Jacobian w.r.t. fv is the dual matrix of X.
+ */
+template<typename T>
+ForceCrossJacobian<T> dualMulJacobian(const PTransform<T> & X, const ForceVec<T> & fv);
+
+/// Jacobian of X.inv(): minus the matrix of X^-1.
+template<typename T>
+SE3Jacobian<T> invJacobian(const PTransform<T> & X);
+
+/**
+ * Jacobians of transformError(X_a_b, X_a_c).
+ * With e the angular part of the error and K = SO3RightJacInv(e), they are
+ * diag(-K E_a_b^T, -E_a_b^T) w.r.t. X_a_b and diag(K E_a_b^T, E_a_c^T) w.r.t. X_a_c.
+ */
+template<typename T>
+BinaryJacobian<BlockDiagJacobian<T>> transformErrorJacobian(const PTransform<T> & X_a_b, const PTransform<T> & X_a_c);
+
+/**
+ * Jacobians of interpolate(from, to, t).
+ * With u = rotationVelocity(E_to E_from^T), R = exp(t u) and
+ * B = t SO3RightJac(t u) SO3RightJacInv(u), they are
+ * diag(I - B, (1 - t) R) w.r.t. from and diag(B, t R E_from E_to^T) w.r.t. to.
+ */
+template<typename T>
+BinaryJacobian<BlockDiagJacobian<T>> interpolateJacobian(const PTransform<T> & from,
+                                                         const PTransform<T> & to,
+                                                         double t);
+
+namespace sva_internal
+{
+
+/// @return Matrix of X as a SE3Jacobian.
+template<typename T>
+inline SE3Jacobian<T> adjoint(const PTransform<T> & X)
+{
+  const Eigen::Matrix3<T> & E = X.rotation();
+  return SE3Jacobian<T>(E, Eigen::Matrix3<T>(-E * vector3ToCrossMatrix(X.translation())));
+}
+
+/// @return Motion cross product matrix [mv]x as a SE3Jacobian.
+template<typename T>
+inline SE3Jacobian<T> crossJacobian(const MotionVec<T> & mv)
+{
+  return SE3Jacobian<T>(vector3ToCrossMatrix(mv.angular()), vector3ToCrossMatrix(mv.linear()));
+}
+
+} // namespace sva_internal
+
+template<typename T>
+inline BinaryJacobian<SE3Jacobian<T>> mulJacobian(const PTransform<T> & X1, const PTransform<T> &)
+{
+  return {SE3Jacobian<T>::Identity(), sva_internal::adjoint(X1)};
+}
+
+template<typename T>
+inline SE3Jacobian<T> mulJacobian(const PTransform<T> & X, const MotionVec<T> & mv)
+{
+  return sva_internal::crossJacobian(X * mv);
+}
+
+template<typename T>
+inline SE3Jacobian<T> invMulJacobian(const PTransform<T> & X, const MotionVec<T> & mv)
+{
+  // -[X^-1 mv]x X^-1 = -X^-1 [mv]x, the latter avoids computing X^-1 mv
+  Eigen::Matrix3<T> ET = X.rotation().transpose();
+  Eigen::Matrix3<T> W = ET * vector3ToCrossMatrix(mv.angular());
+  Eigen::Matrix3<T> L = vector3ToCrossMatrix(X.translation()) * W + ET * vector3ToCrossMatrix(mv.linear());
+  return SE3Jacobian<T>(Eigen::Matrix3<T>(-W), Eigen::Matrix3<T>(-L));
+}
+
+template<typename T>
+inline ForceCrossJacobian<T> dualMulJacobian(const PTransform<T> & X, const ForceVec<T> & fv)
+{
+  ForceVec<T> g = X.dualMul(fv);
+  return ForceCrossJacobian<T>(g.couple(), g.force());
+}
+
+template<typename T>
+inline SE3Jacobian<T> invJacobian(const PTransform<T> & X)
+{
+  Eigen::Matrix3<T> ET = X.rotation().transpose();
+  return SE3Jacobian<T>(Eigen::Matrix3<T>(-ET), Eigen::Matrix3<T>(-vector3ToCrossMatrix(X.translation()) * ET));
+}
+
+template<typename T>
+inline BinaryJacobian<BlockDiagJacobian<T>> transformErrorJacobian(const PTransform<T> & X_a_b,
+                                                                   const PTransform<T> & X_a_c)
+{
+  Eigen::Vector3<T> e = rotationError(X_a_b.rotation(), X_a_c.rotation());
+  T G[3];
+  details::alternatingFactorialFunctions<4>(e.squaredNorm(), G);
+  Eigen::Matrix3<T> A = sva_internal::SE3JacDInv(e, G, T(-1)) * X_a_b.rotation().transpose();
+  return {BlockDiagJacobian<T>(Eigen::Matrix3<T>(-A), Eigen::Matrix3<T>(-X_a_b.rotation().transpose())),
+          BlockDiagJacobian<T>(A, X_a_c.rotation().transpose())};
+}
+
+template<typename T>
+inline BinaryJacobian<BlockDiagJacobian<T>> interpolateJacobian(const PTransform<T> & from,
+                                                                const PTransform<T> & to,
+                                                                double t)
+{
+  const T tt = T(t);
+  Eigen::Matrix3<T> E_b_c = to.rotation() * from.rotation().transpose();
+  Eigen::Vector3<T> u = rotationVelocity(E_b_c);
+  T theta2 = u.squaredNorm();
+  T G[3], Gt[2];
+  details::alternatingFactorialFunctions<4>(theta2, G);
+  details::alternatingFactorialFunctions<3>(tt * tt * theta2, Gt);
+  T f2 = details::SO3JacF2(G);
+  T g1 = Gt[0], g2 = Gt[1];
+
+  // With C = [u]x and C^3 = -theta^2 C,
+  // B = t (I - t g1 C + t^2 g2 C^2) (I + C/2 + f2 C^2) = t (I + a C + b C^2)
+  T a = T(0.5) - tt * g1 - theta2 * tt * (T(0.5) * tt * g2 - g1 * f2);
+  T b = f2 + tt * tt * g2 - T(0.5) * tt * g1 - theta2 * tt * tt * g2 * f2;
+  // [u]x^2 = u u^T - theta^2 I
+  Eigen::Matrix3<T> B = sva_internal::symCrossDiag<T>(u, T(0.5) * tt * b * u, tt * a * u, tt * (T(1) - b * theta2));
+
+  // R = exp(t u) = I - sinc(t theta) t C + g1 t^2 C^2 with sinc(x) = 1 - x^2 G_3
+  Eigen::Matrix3<T> R = sva_internal::symCrossDiag<T>(u, T(0.5) * g1 * tt * tt * u,
+                                                      -(T(1) - tt * tt * theta2 * g2) * tt * u,
+                                                      T(1) - g1 * tt * tt * theta2);
+
+  Eigen::Matrix3<T> IB = -B;
+  IB.diagonal().array() += T(1);
+  return {BlockDiagJacobian<T>(IB, Eigen::Matrix3<T>((T(1) - tt) * R)),
+          BlockDiagJacobian<T>(B, Eigen::Matrix3<T>(tt * R * E_b_c.transpose()))};
+}
+
+template<typename T>
+inline std::ostream & operator<<(std::ostream & out, const BlockDiagJacobian<T> & J)
+{
+  out << J.matrix();
+  return out;
+}
+
+template<typename T>
+inline std::ostream & operator<<(std::ostream & out, const ForceCrossJacobian<T> & J)
+{
+  out << J.matrix();
+  return out;
+}
+
+} // namespace sva
@@ -10,6 +10,8 @@ namespace sva
 {
 
 // Operators implementation
+// None of the operators below allocate except the ones returning a batch,
+// the Matrix6X versions only write in the preallocated result (see NoMallocTest).
 
 namespace sva_internal
 {
@@ -52,10 +54,83 @@ inline void colwiseLeftMultEq(const Eigen::MatrixBase<Derived1> & m1,
                               const Eigen::MatrixBase<Derived2> & m2,
                               Eigen::MatrixBase<Derived3> const & result)
 {
+  static_assert(Derived1::RowsAtCompileTime == 3, "m1 must have exactly 3 rows");
   Eigen::MatrixBase<Derived3> & result_nc = const_cast<Eigen::MatrixBase<Derived3> &>(result);
+  // m1 and result can alias, each column goes through a fixed size temporary
+  Eigen::Matrix<typename Derived1::Scalar, 3, 1> col;
   for(typename Derived1::Index i = 0; i < m1.cols(); ++i)
   {
-    result_nc.col(i) = m2 * m1.col(i);
+    col.noalias() = m2 * m1.col(i);
+    result_nc.col(i) = col;
+  }
+}
+
+/// @return L*v where L is the lower triangular part of a symmetric matrix.
+template<typename T>
+inline Eigen::Vector3<T> lowerSymmetricMul(const Eigen::Matrix3<T> & L, const Eigen::Vector3<T> & v)
+{
+  return Eigen::Vector3<T>(L(0, 0) * v(0) + L(1, 0) * v(1) + L(2, 0) * v(2),
+                           L(1, 0) * v(0) + L(1, 1) * v(1) + L(2, 1) * v(2),
+                           L(2, 0) * v(0) + L(2, 1) * v(1) + L(2, 2) * v(2));
+}
+
+/// @return Lower triangular part of B^T S B where S is symmetric and only its lower part is read.
+template<typename T>
+inline Eigen::Matrix3<T> lowerSymmetricCongruence(const Eigen::Matrix3<T> & L, const Eigen::Matrix3<T> & B)
+{
+  Eigen::Matrix3<T> LB;
+  for(int j = 0; j < 3; ++j)
+  {
+    LB.col(j) = lowerSymmetricMul<T>(L, B.col(j));
+  }
+  Eigen::Matrix3<T> ret;
+  for(int j = 0; j < 3; ++j)
+  {
+    for(int i = j; i < 3; ++i)
+    {
+      ret(i, j) = B.col(i).dot(LB.col(j));
+    }
+  }
+  return ret;
+}
+
+/**
+ * Blocks of the articulated body inertia [[M, H], [H^T, I]] moved by a
+ * translation r: H' = H + [r]x M and I' = I + [r]x H^T - H' [r]x, M is
+ * unchanged. This is TranslationTransform(r).transMul and its dualMul is the
+ * translation -r.
+ * @param LM Lower triangular part of M.
+ * @param LI Lower triangular part of I.
+ * @param Hp H'.
+ * @param LIp Lower triangular part of I', the strictly upper part is not set.
+ */
+template<typename T>
+inline void translateABInertia(const Eigen::Matrix3<T> & LM,
+                               const Eigen::Matrix3<T> & H,
+                               const Eigen::Matrix3<T> & LI,
+                               const Eigen::Vector3<T> & r,
+                               Eigen::Matrix3<T> & Hp,
+                               Eigen::Matrix3<T> & LIp)
+{
+  // column j of [r]x M is r x M.col(j) and row i of H' [r]x is H'.row(i) x r
+  const Eigen::Vector3<T> M0(LM(0, 0), LM(1, 0), LM(2, 0));
+  const Eigen::Vector3<T> M1(LM(1, 0), LM(1, 1), LM(2, 1));
+  const Eigen::Vector3<T> M2(LM(2, 0), LM(2, 1), LM(2, 2));
+  Hp.col(0) = H.col(0) + r.cross(M0);
+  Hp.col(1) = H.col(1) + r.cross(M1);
+  Hp.col(2) = H.col(2) + r.cross(M2);
+  Eigen::Matrix3<T> rHt, Hpr;
+  for(int i = 0; i < 3; ++i)
+  {
+    rHt.col(i) = r.cross(H.row(i).transpose());
+    Hpr.col(i) = Hp.row(i).transpose().cross(r);
+  }
+  for(int j = 0; j < 3; ++j)
+  {
+    for(int i = j; i < 3; ++i)
+    {
+      LIp(i, j) = LI(i, j) + rHt(i, j) - Hpr(j, i);
+    }
   }
 }
 
@@ -109,6 +184,167 @@ inline Eigen::Block<const Derived, 3, Eigen::Dynamic> forceForce(const Eigen::Ma
   return Eigen::Block<const Derived, 3, Eigen::Dynamic>(mv.derived(), 3, 0, 3, mv.cols());
 }
 
+namespace sva_internal
+{
+
+// Matrix6X PTransform operators kernels.
+// The std::false_type overloads are the generic Eigen implementation and the
+// std::true_type overloads dispatch to the SIMD kernels of SimdKernels.h.
+
+template<typename T, typename Derived>
+inline void ptransformMul(const PTransform<T> & X,
+                          const Eigen::MatrixBase<Derived> & mv,
+                          Eigen::MatrixBase<Derived> const & result,
+                          std::false_type)
+{
+  Eigen::MatrixBase<Derived> & result_nc = const_cast<Eigen::MatrixBase<Derived> &>(result);
+  const Eigen::Matrix3<T> & E = X.rotation();
+  const Eigen::Vector3<T> & r = X.translation();
+
+  motionAngular(result_nc).noalias() = E * motionAngular(mv);
+
+  motionLinear(result_nc).noalias() = motionLinear(mv);
+  colwiseCrossPlusEq(motionAngular(mv), r, motionLinear(result_nc));
+  colwiseLeftMultEq(motionLinear(result_nc), E, motionLinear(result_nc));
+}
+
+template<typename T, typename Derived>
+inline void ptransformInvMul(const PTransform<T> & X,
+                             const Eigen::MatrixBase<Derived> & mv,
+                             Eigen::MatrixBase<Derived> const & result,
+                             std::false_type)
+{
+  Eigen::MatrixBase<Derived> & result_nc = const_cast<Eigen::MatrixBase<Derived> &>(result);
+  const Eigen::Matrix3<T> & E = X.rotation();
+  const Eigen::Vector3<T> & r = X.translation();
+
+  motionAngular(result_nc).noalias() = E.transpose() * motionAngular(mv);
+
+  motionLinear(result_nc).noalias() = E.transpose() * motionLinear(mv);
+  colwiseCrossMinusEq(motionAngular(result_nc), r, motionLinear(result_nc));
+}
+
+template<typename T, typename Derived>
+inline void ptransformDualMul(const PTransform<T> & X,
+                              const Eigen::MatrixBase<Derived> & fv,
+                              Eigen::MatrixBase<Derived> const & result,
+                              std::false_type)
+{
+  Eigen::MatrixBase<Derived> & result_nc = const_cast<Eigen::MatrixBase<Derived> &>(result);
+  const Eigen::Matrix3<T> & E = X.rotation();
+  const Eigen::Vector3<T> & r = X.translation();
+
+  forceCouple(result_nc).noalias() = forceCouple(fv);
+  colwiseCrossPlusEq(forceForce(fv), r, forceCouple(result_nc));
+  colwiseLeftMultEq(forceCouple(result_nc), E, forceCouple(result_nc));
+
+  forceForce(result_nc).noalias() = E * forceForce(fv);
+}
+
+template<typename T, typename Derived>
+inline void ptransformTransMul(const PTransform<T> & X,
+                               const Eigen::MatrixBase<Derived> & fv,
+                               Eigen::MatrixBase<Derived> const & result,
+                               std::false_type)
+{
+  Eigen::MatrixBase<Derived> & result_nc = const_cast<Eigen::MatrixBase<Derived> &>(result);
+  const Eigen::Matrix3<T> & E = X.rotation();
+  const Eigen::Vector3<T> & r = X.translation();
+
+  forceForce(result_nc).noalias() = E.transpose() * forceForce(fv);
+
+  forceCouple(result_nc).noalias() = E.transpose() * forceCouple(fv);
+  colwiseCrossMinusEq(forceForce(result_nc), r, forceCouple(result_nc));
+}
+
+#ifdef SVA_HAS_AVX_KERNELS
+
+template<typename Derived>
+inline void ptransformMul(const PTransform<double> & X,
+                          const Eigen::MatrixBase<Derived> & mv,
+                          Eigen::MatrixBase<Derived> const & result,
+                          std::true_type)
+{
+  Eigen::MatrixBase<Derived> & result_nc = const_cast<Eigen::MatrixBase<Derived> &>(result);
+  if(mv.derived().innerStride() != 1 || result_nc.derived().innerStride() != 1)
+  {
+    ptransformMul(X, mv, result, std::false_type());
+    return;
+  }
+
+  const Eigen::Matrix3d & E = X.rotation();
+  const Eigen::Vector3d & r = X.translation();
+  const Eigen::Matrix3d Q = -E * vector3ToCrossMatrix(r);
+  avxBlockTriangularMul<true>(E.data(), Q.data(), mv.derived().data(), mv.derived().outerStride(),
+                              result_nc.derived().data(), result_nc.derived().outerStride(), mv.cols());
+}
+
+template<typename Derived>
+inline void ptransformInvMul(const PTransform<double> & X,
+                             const Eigen::MatrixBase<Derived> & mv,
+                             Eigen::MatrixBase<Derived> const & result,
+                             std::true_type)
+{
+  Eigen::MatrixBase<Derived> & result_nc = const_cast<Eigen::MatrixBase<Derived> &>(result);
+  if(mv.derived().innerStride() != 1 || result_nc.derived().innerStride() != 1)
+  {
+    ptransformInvMul(X, mv, result, std::false_type());
+    return;
+  }
+
+  const Eigen::Matrix3d & E = X.rotation();
+  const Eigen::Vector3d & r = X.translation();
+  const Eigen::Matrix3d Et = E.transpose();
+  const Eigen::Matrix3d Q = vector3ToCrossMatrix(r) * Et;
+  avxBlockTriangularMul<true>(Et.data(), Q.data(), mv.derived().data(), mv.derived().outerStride(),
+                              result_nc.derived().data(), result_nc.derived().outerStride(), mv.cols());
+}
+
+template<typename Derived>
+inline void ptransformDualMul(const PTransform<double> & X,
+                              const Eigen::MatrixBase<Derived> & fv,
+                              Eigen::MatrixBase<Derived> const & result,
+                              std::true_type)
+{
+  Eigen::MatrixBase<Derived> & result_nc = const_cast<Eigen::MatrixBase<Derived> &>(result);
+  if(fv.derived().innerStride() != 1 || result_nc.derived().innerStride() != 1)
+  {
+    ptransformDualMul(X, fv, result, std::false_type());
+    return;
+  }
+
+  const Eigen::Matrix3d & E = X.rotation();
+  const Eigen::Vector3d & r = X.translation();
+  const Eigen::Matrix3d Q = -E * vector3ToCrossMatrix(r);
+  avxBlockTriangularMul<false>(E.data(), Q.data(), fv.derived().data(), fv.derived().outerStride(),
+                               result_nc.derived().data(), result_nc.derived().outerStride(), fv.cols());
+}
+
+template<typename Derived>
+inline void ptransformTransMul(const PTransform<double> & X,
+                               const Eigen::MatrixBase<Derived> & fv,
+                               Eigen::MatrixBase<Derived> const & result,
+                               std::true_type)
+{
+  Eigen::MatrixBase<Derived> & result_nc = const_cast<Eigen::MatrixBase<Derived> &>(result);
+  if(fv.derived().innerStride() != 1 || result_nc.derived().innerStride() != 1)
+  {
+    ptransformTransMul(X, fv, result, std::false_type());
+    return;
+  }
+
+  const Eigen::Matrix3d & E = X.rotation();
+  const Eigen::Vector3d & r = X.translation();
+  const Eigen::Matrix3d Et = E.transpose();
+  const Eigen::Matrix3d Q = vector3ToCrossMatrix(r) * Et;
+  avxBlockTriangularMul<false>(Et.data(), Q.data(), fv.derived().data(), fv.derived().outerStride(),
+                               result_nc.derived().data(), result_nc.derived().outerStride(), fv.cols());
+}
+
+#endif
+
+} // namespace sva_internal
+
 template<typename T>
 inline MotionVec<T> MotionVec<T>::cross(const MotionVec<T> & mv2) const
 {
@@ -200,7 +436,7 @@ inline void ABInertia<T>::mul(const Eigen::MatrixBase<Derived> & mv, Eigen::Matr
   forceCouple(result).noalias() = inertia() * motionAngular(mv);
   forceCouple(result).noalias() += gInertia() * motionLinear(mv);
 
-  forceForce(result).noalias() = inertia() * motionLinear(mv);
+  forceForce(result).noalias() = massMatrix() * motionLinear(mv);
   forceForce(result).noalias() += gInertia().transpose() * motionAngular(mv);
 }
 
@@ -232,14 +468,7 @@ inline void PTransform<T>::mul(const Eigen::MatrixBase<Derived> & mv, Eigen::Mat
   static_assert(Derived::RowsAtCompileTime == 6, "the matrix must have exactly 6 rows");
   static_assert(std::is_same<typename Derived::Scalar, T>::value, "motion vec and matrix must be the same type");
 
-  const Eigen::Matrix3<T> & E = rotation();
-  const Eigen::Vector3<T> & r = translation();
-
-  motionAngular(result).noalias() = E * motionAngular(mv);
-
-  motionLinear(result).noalias() = motionLinear(mv);
-  sva_internal::colwiseCrossPlusEq(motionAngular(mv), r, motionLinear(result));
-  sva_internal::colwiseLeftMultEq(motionLinear(result), E, motionLinear(result));
+  sva_internal::ptransformMul(*this, mv, result, sva_internal::has_simd_kernels<Derived>());
 }
 
 template<typename T>
@@ -276,13 +505,7 @@ inline void PTransform<T>::invMul(const Eigen::MatrixBase<Derived> & mv, Eigen::
   static_assert(Derived::RowsAtCompileTime == 6, "the matrix must have exactly 6 rows");
   static_assert(std::is_same<typename Derived::Scalar, T>::value, "motion vec and matrix must be the same type");
 
-  const Eigen::Matrix3<T> & E = rotation();
-  const Eigen::Vector3<T> & r = translation();
-
-  motionAngular(result).noalias() = E.transpose() * motionAngular(mv);
-
-  motionLinear(result).noalias() = E.transpose() * motionLinear(mv);
-  sva_internal::colwiseCrossMinusEq(motionAngular(result), r, motionLinear(result));
+  sva_internal::ptransformInvMul(*this, mv, result, sva_internal::has_simd_kernels<Derived>());
 }
 
 template<typename T>
@@ -313,14 +536,7 @@ inline void PTransform<T>::dualMul(const Eigen::MatrixBase<Derived> & fv, Eigen:
   static_assert(Derived::RowsAtCompileTime == 6, "the matrix must have exactly 6 rows");
   static_assert(std::is_same<typename Derived::Scalar, T>::value, "force vec and matrix must be the same type");
 
-  const Eigen::Matrix3<T> & E = rotation();
-  const Eigen::Vector3<T> & r = translation();
-
-  forceCouple(result).noalias() = forceCouple(fv);
-  sva_internal::colwiseCrossPlusEq(forceForce(fv), r, forceCouple(result));
-  sva_internal::colwiseLeftMultEq(forceCouple(result), E, forceCouple(result));
-
-  forceForce(result).noalias() = E * forceForce(fv);
+  sva_internal::ptransformDualMul(*this, fv, result, sva_internal::has_simd_kernels<Derived>());
 }
 
 template<typename T>
@@ -358,13 +574,7 @@ inline void PTransform<T>::transMul(const Eigen::MatrixBase<Derived> & fv, Eigen
   static_assert(Derived::RowsAtCompileTime == 6, "the matrix must have exactly 6 rows");
   static_assert(std::is_same<typename Derived::Scalar, T>::value, "force vec and matrix must be the same type");
 
-  const Eigen::Matrix3<T> & E = rotation();
-  const Eigen::Vector3<T> & r = translation();
-
-  forceForce(result).noalias() = E.transpose() * forceForce(fv);
-
-  forceCouple(result).noalias() = E.transpose() * forceCouple(fv);
-  sva_internal::colwiseCrossMinusEq(forceForce(result), r, forceCouple(result));
+  sva_internal::ptransformTransMul(*this, fv, result, sva_internal::has_simd_kernels<Derived>());
 }
 
 template<typename T>
@@ -384,50 +594,644 @@ inline RBInertia<T> PTransform<T>::dualMul(const RBInertia<T> & rbI) const
 template<typename T>
 inline RBInertia<T> PTransform<T>::transMul(const RBInertia<T> & rbI) const
 {
+  // I' = E^T I E - [r]x[y]x - [z]x[r]x with y = E^T h and z = y + m r
+  //    = E^T I E - y r^T - r z^T + (r.y + r.z) Id
+  // only the lower triangular parts of I and I' are read and computed
   const Eigen::Matrix3<T> & E = rotation();
   const Eigen::Vector3<T> & r = translation();
+  const Eigen::Matrix3<T> & L = rbI.lowerTriangularInertia();
+  const Eigen::Vector3<T> y = E.transpose() * rbI.momentum();
+  const Eigen::Vector3<T> z = y + rbI.mass() * r;
+  Eigen::Matrix3<T> LE;
+  for(int j = 0; j < 3; ++j)
+  {
+    LE.col(j) = sva_internal::lowerSymmetricMul<T>(L, E.col(j));
+  }
+  const T d = r.dot(y) + r.dot(z);
   Eigen::Matrix3<T> I;
-  I.template triangularView<Eigen::Lower>() =
-      E.transpose() * rbI.inertia() * E
-      - Eigen::vector3ToCrossMatrix<T>(r) * Eigen::vector3ToCrossMatrix<T>(E.transpose() * rbI.momentum())
-      - Eigen::vector3ToCrossMatrix<T>(E.transpose() * rbI.momentum() + rbI.mass() * r)
-            * Eigen::vector3ToCrossMatrix<T>(r);
-  return RBInertia<T>(rbI.mass(), E.transpose() * rbI.momentum() + rbI.mass() * r, I);
+  for(int j = 0; j < 3; ++j)
+  {
+    for(int i = j; i < 3; ++i)
+    {
+      I(i, j) = E.col(i).dot(LE.col(j)) - y(i) * r(j) - r(i) * z(j);
+    }
+    I(j, j) += d;
+  }
+  return RBInertia<T>(rbI.mass(), z, I.template triangularView<Eigen::Lower>());
 }
 
 template<typename T>
 inline ABInertia<T> PTransform<T>::dualMul(const ABInertia<T> & rbI) const
 {
+  // translation by -r then rotation by E, only the lower triangular parts of
+  // the mass matrix and the inertia are read and computed
   const Eigen::Matrix3<T> & E = rotation();
-  const Eigen::Vector3<T> & r = translation();
+  const Eigen::Matrix3<T> Et = E.transpose();
+  Eigen::Matrix3<T> H, LI;
+  sva_internal::translateABInertia<T>(rbI.lowerTriangularMassMatrix(), rbI.gInertia(), rbI.lowerTriangularInertia(),
+                                      -translation(), H, LI);
+  return ABInertia<T>(sva_internal::lowerSymmetricCongruence<T>(rbI.lowerTriangularMassMatrix(), Et), E * H * Et,
+                      sva_internal::lowerSymmetricCongruence<T>(LI, Et));
+}
 
-  Eigen::Matrix3<T> massM = rbI.massMatrix();
-  Eigen::Matrix3<T> rCross = vector3ToCrossMatrix(r);
-  Eigen::Matrix3<T> tmpI = rbI.gInertia() - rCross * massM;
+template<typename T>
+inline ABInertia<T> PTransform<T>::transMul(const ABInertia<T> & rbI) const
+{
+  // rotation by E^T then translation by r, only the lower triangular parts of
+  // the mass matrix and the inertia are read and computed
+  const Eigen::Matrix3<T> & E = rotation();
+  const Eigen::Matrix3<T> LM = sva_internal::lowerSymmetricCongruence<T>(rbI.lowerTriangularMassMatrix(), E);
+  const Eigen::Matrix3<T> LI = sva_internal::lowerSymmetricCongruence<T>(rbI.lowerTriangularInertia(), E);
+  Eigen::Matrix3<T> H, LIp;
+  sva_internal::translateABInertia<T>(LM, E.transpose() * rbI.gInertia() * E, LI, translation(), H, LIp);
+  return ABInertia<T>(LM, H, LIp);
+}
 
-  Eigen::Matrix3<T> M, I;
-  M.template triangularView<Eigen::Lower>() = E * massM * E.transpose();
-  I.template triangularView<Eigen::Lower>() =
-      E * (rbI.inertia() - rCross * rbI.gInertia().transpose() + (tmpI * rCross)) * E.transpose();
+template<typename T>
+inline PTransform<T>::PTransform(const QTransform<T> & qt)
+: E_(qt.rotation().toRotationMatrix()), r_(qt.translation())
+{
+}
 
-  return ABInertia<T>(M, E * (tmpI)*E.transpose(), I);
+template<typename T>
+inline QTransform<T>::QTransform(const PTransform<T> & pt) : q_(pt.rotation()), r_(pt.translation())
+{
 }
 
 template<typename T>
-inline ABInertia<T> PTransform<T>::transMul(const ABInertia<T> & rbI) const
+inline PTransform<T> QTransform<T>::ptransform() const
 {
-  const Eigen::Matrix3<T> & E = rotation();
-  const Eigen::Vector3<T> & r = translation();
+  return PTransform<T>(*this);
+}
 
-  Eigen::Matrix3<T> Mp(E.transpose() * rbI.massMatrix() * E);
-  Eigen::Matrix3<T> Hp(E.transpose() * rbI.gInertia() * E);
-  Eigen::Matrix3<T> rCross(vector3ToCrossMatrix(r));
+template<typename T>
+inline MotionVec<T> QTransform<T>::operator*(const MotionVec<T> & mv) const
+{
+  return MotionVec<T>(q_ * mv.angular(), q_ * (mv.linear() - r_.cross(mv.angular())));
+}
 
-  Eigen::Matrix3<T> M, I;
-  M.template triangularView<Eigen::Lower>() = Mp;
-  I.template triangularView<Eigen::Lower>() =
-      (E.transpose() * rbI.inertia() * E + rCross * Hp.transpose() - (Hp + rCross * Mp) * rCross);
-  return ABInertia<T>(M, Hp + rCross * Mp, I);
+template<typename T>
+template<typename Derived>
+inline void QTransform<T>::mul(const Eigen::MatrixBase<Derived> & mv, Eigen::MatrixBase<Derived> & result) const
+{
+  // the rotation matrix is cheaper to apply as soon as there is more than one vector
+  ptransform().mul(mv, result);
+}
+
+template<typename T>
+inline MotionVec<T> QTransform<T>::invMul(const MotionVec<T> & mv) const
+{
+  const Eigen::Quaternion<T> qInv = q_.conjugate();
+  const Eigen::Vector3<T> angular = qInv * mv.angular();
+  return MotionVec<T>(angular, qInv * mv.linear() + r_.cross(angular));
+}
+
+template<typename T>
+template<typename Derived>
+inline void QTransform<T>::invMul(const Eigen::MatrixBase<Derived> & mv, Eigen::MatrixBase<Derived> & result) const
+{
+  ptransform().invMul(mv, result);
+}
+
+template<typename T>
+inline ForceVec<T> QTransform<T>::dualMul(const ForceVec<T> & fv) const
+{
+  return ForceVec<T>(q_ * (fv.couple() - r_.cross(fv.force())), q_ * fv.force());
+}
+
+template<typename T>
+template<typename Derived>
+inline void QTransform<T>::dualMul(const Eigen::MatrixBase<Derived> & fv, Eigen::MatrixBase<Derived> & result) const
+{
+  ptransform().dualMul(fv, result);
+}
+
+template<typename T>
+inline ForceVec<T> QTransform<T>::transMul(const ForceVec<T> & fv) const
+{
+  const Eigen::Quaternion<T> qInv = q_.conjugate();
+  const Eigen::Vector3<T> force = qInv * fv.force();
+  return ForceVec<T>(qInv * fv.couple() + r_.cross(force), force);
+}
+
+template<typename T>
+template<typename Derived>
+inline void QTransform<T>::transMul(const Eigen::MatrixBase<Derived> & fv, Eigen::MatrixBase<Derived> & result) const
+{
+  ptransform().transMul(fv, result);
+}
+
+template<typename T>
+inline RBInertia<T> QTransform<T>::dualMul(const RBInertia<T> & rbI) const
+{
+  return ptransform().dualMul(rbI);
+}
+
+template<typename T>
+inline RBInertia<T> QTransform<T>::transMul(const RBInertia<T> & rbI) const
+{
+  return ptransform().transMul(rbI);
+}
+
+template<typename T>
+inline ABInertia<T> QTransform<T>::dualMul(const ABInertia<T> & rbI) const
+{
+  return ptransform().dualMul(rbI);
+}
+
+template<typename T>
+inline ABInertia<T> QTransform<T>::transMul(const ABInertia<T> & rbI) const
+{
+  return ptransform().transMul(rbI);
+}
+
+template<typename T>
+inline PTransform<T>::PTransform(const RotationTransform<T> & rt) : E_(rt.rotation()), r_(vector3_t::Zero())
+{
+}
+
+template<typename T>
+inline PTransform<T>::PTransform(const TranslationTransform<T> & tt)
+: E_(matrix3_t::Identity()), r_(tt.translation())
+{
+}
+
+template<typename T>
+inline PTransform<T> PTransform<T>::operator*(const RotationTransform<T> & rt) const
+{
+  return PTransform<T>(E_ * rt.rotation(), rt.rotation().transpose() * r_);
+}
+
+template<typename T>
+inline PTransform<T> PTransform<T>::operator*(const TranslationTransform<T> & tt) const
+{
+  return PTransform<T>(E_, tt.translation() + r_);
+}
+
+// RotationTransform operators implementation
+
+template<typename T>
+inline PTransform<T> RotationTransform<T>::ptransform() const
+{
+  return PTransform<T>(*this);
+}
+
+template<typename T>
+inline PTransform<T> RotationTransform<T>::operator*(const PTransform<T> & pt) const
+{
+  return PTransform<T>(E_ * pt.rotation(), pt.translation());
+}
+
+template<typename T>
+inline PTransform<T> RotationTransform<T>::operator*(const TranslationTransform<T> & tt) const
+{
+  return PTransform<T>(E_, tt.translation());
+}
+
+template<typename T>
+inline MotionVec<T> RotationTransform<T>::operator*(const MotionVec<T> & mv) const
+{
+  return MotionVec<T>(E_ * mv.angular(), E_ * mv.linear());
+}
+
+template<typename T>
+template<typename Derived>
+inline void RotationTransform<T>::mul(const Eigen::MatrixBase<Derived> & mv, Eigen::MatrixBase<Derived> & result) const
+{
+  static_assert(Derived::RowsAtCompileTime == 6, "the matrix must have exactly 6 rows");
+  static_assert(std::is_same<typename Derived::Scalar, T>::value, "motion vec and matrix must be the same type");
+
+  motionAngular(result).noalias() = E_ * motionAngular(mv);
+  motionLinear(result).noalias() = E_ * motionLinear(mv);
+}
+
+template<typename T>
+inline MotionVec<T> RotationTransform<T>::invMul(const MotionVec<T> & mv) const
+{
+  return MotionVec<T>(E_.transpose() * mv.angular(), E_.transpose() * mv.linear());
+}
+
+template<typename T>
+template<typename Derived>
+inline void RotationTransform<T>::invMul(const Eigen::MatrixBase<Derived> & mv,
+                                         Eigen::MatrixBase<Derived> & result) const
+{
+  static_assert(Derived::RowsAtCompileTime == 6, "the matrix must have exactly 6 rows");
+  static_assert(std::is_same<typename Derived::Scalar, T>::value, "motion vec and matrix must be the same type");
+
+  motionAngular(result).noalias() = E_.transpose() * motionAngular(mv);
+  motionLinear(result).noalias() = E_.transpose() * motionLinear(mv);
+}
+
+template<typename T>
+inline ForceVec<T> RotationTransform<T>::dualMul(const ForceVec<T> & fv) const
+{
+  return ForceVec<T>(E_ * fv.couple(), E_ * fv.force());
+}
+
+template<typename T>
+template<typename Derived>
+inline void RotationTransform<T>::dualMul(const Eigen::MatrixBase<Derived> & fv,
+                                          Eigen::MatrixBase<Derived> & result) const
+{
+  static_assert(Derived::RowsAtCompileTime == 6, "the matrix must have exactly 6 rows");
+  static_assert(std::is_same<typename Derived::Scalar, T>::value, "force vec and matrix must be the same type");
+
+  forceCouple(result).noalias() = E_ * forceCouple(fv);
+  forceForce(result).noalias() = E_ * forceForce(fv);
+}
+
+template<typename T>
+inline ForceVec<T> RotationTransform<T>::transMul(const ForceVec<T> & fv) const
+{
+  return ForceVec<T>(E_.transpose() * fv.couple(), E_.transpose() * fv.force());
+}
+
+template<typename T>
+template<typename Derived>
+inline void RotationTransform<T>::transMul(const Eigen::MatrixBase<Derived> & fv,
+                                           Eigen::MatrixBase<Derived> & result) const
+{
+  static_assert(Derived::RowsAtCompileTime == 6, "the matrix must have exactly 6 rows");
+  static_assert(std::is_same<typename Derived::Scalar, T>::value, "force vec and matrix must be the same type");
+
+  forceCouple(result).noalias() = E_.transpose() * forceCouple(fv);
+  forceForce(result).noalias() = E_.transpose() * forceForce(fv);
+}
+
+template<typename T>
+inline RBInertia<T> RotationTransform<T>::dualMul(const RBInertia<T> & rbI) const
+{
+  const Eigen::Matrix3<T> I =
+      sva_internal::lowerSymmetricCongruence<T>(rbI.lowerTriangularInertia(), E_.transpose());
+  return RBInertia<T>(rbI.mass(), E_ * rbI.momentum(), I.template triangularView<Eigen::Lower>());
+}
+
+template<typename T>
+inline RBInertia<T> RotationTransform<T>::transMul(const RBInertia<T> & rbI) const
+{
+  const Eigen::Matrix3<T> I = sva_internal::lowerSymmetricCongruence<T>(rbI.lowerTriangularInertia(), E_);
+  return RBInertia<T>(rbI.mass(), E_.transpose() * rbI.momentum(), I.template triangularView<Eigen::Lower>());
+}
+
+template<typename T>
+inline ABInertia<T> RotationTransform<T>::dualMul(const ABInertia<T> & rbI) const
+{
+  const Eigen::Matrix3<T> Et = E_.transpose();
+  return ABInertia<T>(sva_internal::lowerSymmetricCongruence<T>(rbI.lowerTriangularMassMatrix(), Et),
+                      E_ * rbI.gInertia() * Et,
+                      sva_internal::lowerSymmetricCongruence<T>(rbI.lowerTriangularInertia(), Et));
+}
+
+template<typename T>
+inline ABInertia<T> RotationTransform<T>::transMul(const ABInertia<T> & rbI) const
+{
+  return ABInertia<T>(sva_internal::lowerSymmetricCongruence<T>(rbI.lowerTriangularMassMatrix(), E_),
+                      E_.transpose() * rbI.gInertia() * E_,
+                      sva_internal::lowerSymmetricCongruence<T>(rbI.lowerTriangularInertia(), E_));
+}
+
+// TranslationTransform operators implementation
+
+template<typename T>
+inline PTransform<T> TranslationTransform<T>::ptransform() const
+{
+  return PTransform<T>(*this);
+}
+
+template<typename T>
+inline PTransform<T> TranslationTransform<T>::operator*(const PTransform<T> & pt) const
+{
+  return PTransform<T>(pt.rotation(), pt.translation() + pt.rotation().transpose() * r_);
+}
+
+template<typename T>
+inline PTransform<T> TranslationTransform<T>::operator*(const RotationTransform<T> & rt) const
+{
+  return PTransform<T>(rt.rotation(), rt.rotation().transpose() * r_);
+}
+
+template<typename T>
+inline MotionVec<T> TranslationTransform<T>::operator*(const MotionVec<T> & mv) const
+{
+  return MotionVec<T>(mv.angular(), mv.linear() - r_.cross(mv.angular()));
+}
+
+template<typename T>
+template<typename Derived>
+inline void TranslationTransform<T>::mul(const Eigen::MatrixBase<Derived> & mv,
+                                         Eigen::MatrixBase<Derived> & result) const
+{
+  static_assert(Derived::RowsAtCompileTime == 6, "the matrix must have exactly 6 rows");
+  static_assert(std::is_same<typename Derived::Scalar, T>::value, "motion vec and matrix must be the same type");
+
+  motionAngular(result) = motionAngular(mv);
+  motionLinear(result) = motionLinear(mv);
+  sva_internal::colwiseCrossPlusEq(motionAngular(mv), r_, motionLinear(result));
+}
+
+template<typename T>
+inline MotionVec<T> TranslationTransform<T>::invMul(const MotionVec<T> & mv) const
+{
+  return MotionVec<T>(mv.angular(), mv.linear() + r_.cross(mv.angular()));
+}
+
+template<typename T>
+template<typename Derived>
+inline void TranslationTransform<T>::invMul(const Eigen::MatrixBase<Derived> & mv,
+                                            Eigen::MatrixBase<Derived> & result) const
+{
+  static_assert(Derived::RowsAtCompileTime == 6, "the matrix must have exactly 6 rows");
+  static_assert(std::is_same<typename Derived::Scalar, T>::value, "motion vec and matrix must be the same type");
+
+  motionAngular(result) = motionAngular(mv);
+  motionLinear(result) = motionLinear(mv);
+  sva_internal::colwiseCrossMinusEq(motionAngular(mv), r_, motionLinear(result));
+}
+
+template<typename T>
+inline ForceVec<T> TranslationTransform<T>::dualMul(const ForceVec<T> & fv) const
+{
+  return ForceVec<T>(fv.couple() - r_.cross(fv.force()), fv.force());
+}
+
+template<typename T>
+template<typename Derived>
+inline void TranslationTransform<T>::dualMul(const Eigen::MatrixBase<Derived> & fv,
+                                             Eigen::MatrixBase<Derived> & result) const
+{
+  static_assert(Derived::RowsAtCompileTime == 6, "the matrix must have exactly 6 rows");
+  static_assert(std::is_same<typename Derived::Scalar, T>::value, "force vec and matrix must be the same type");
+
+  forceForce(result) = forceForce(fv);
+  forceCouple(result) = forceCouple(fv);
+  sva_internal::colwiseCrossPlusEq(forceForce(fv), r_, forceCouple(result));
+}
+
+template<typename T>
+inline ForceVec<T> TranslationTransform<T>::transMul(const ForceVec<T> & fv) const
+{
+  return ForceVec<T>(fv.couple() + r_.cross(fv.force()), fv.force());
+}
+
+template<typename T>
+template<typename Derived>
+inline void TranslationTransform<T>::transMul(const Eigen::MatrixBase<Derived> & fv,
+                                              Eigen::MatrixBase<Derived> & result) const
+{
+  static_assert(Derived::RowsAtCompileTime == 6, "the matrix must have exactly 6 rows");
+  static_assert(std::is_same<typename Derived::Scalar, T>::value, "force vec and matrix must be the same type");
+
+  forceForce(result) = forceForce(fv);
+  forceCouple(result) = forceCouple(fv);
+  sva_internal::colwiseCrossMinusEq(forceForce(fv), r_, forceCouple(result));
+}
+
+template<typename T>
+inline RBInertia<T> TranslationTransform<T>::dualMul(const RBInertia<T> & rbI) const
+{
+  // I' = I + [r]x[h]x + [y]x[r]x with y = h - m r
+  //    = I + h r^T + r y^T - (r.h + r.y) Id
+  const Eigen::Vector3<T> & h = rbI.momentum();
+  const Eigen::Vector3<T> y = h - rbI.mass() * r_;
+  const T d = r_.dot(h) + r_.dot(y);
+  Eigen::Matrix3<T> I = rbI.lowerTriangularInertia();
+  for(int j = 0; j < 3; ++j)
+  {
+    for(int i = j; i < 3; ++i)
+    {
+      I(i, j) += h(i) * r_(j) + r_(i) * y(j);
+    }
+    I(j, j) -= d;
+  }
+  return RBInertia<T>(rbI.mass(), y, I.template triangularView<Eigen::Lower>());
+}
+
+template<typename T>
+inline RBInertia<T> TranslationTransform<T>::transMul(const RBInertia<T> & rbI) const
+{
+  // I' = I - [r]x[h]x - [z]x[r]x with z = h + m r
+  //    = I - h r^T - r z^T + (r.h + r.z) Id
+  const Eigen::Vector3<T> & h = rbI.momentum();
+  const Eigen::Vector3<T> z = h + rbI.mass() * r_;
+  const T d = r_.dot(h) + r_.dot(z);
+  Eigen::Matrix3<T> I = rbI.lowerTriangularInertia();
+  for(int j = 0; j < 3; ++j)
+  {
+    for(int i = j; i < 3; ++i)
+    {
+      I(i, j) -= h(i) * r_(j) + r_(i) * z(j);
+    }
+    I(j, j) += d;
+  }
+  return RBInertia<T>(rbI.mass(), z, I.template triangularView<Eigen::Lower>());
+}
+
+template<typename T>
+inline ABInertia<T> TranslationTransform<T>::dualMul(const ABInertia<T> & rbI) const
+{
+  Eigen::Matrix3<T> H, I;
+  sva_internal::translateABInertia<T>(rbI.lowerTriangularMassMatrix(), rbI.gInertia(), rbI.lowerTriangularInertia(),
+                                      -r_, H, I);
+  return ABInertia<T>(rbI.lowerTriangularMassMatrix(), H, I);
+}
+
+template<typename T>
+inline ABInertia<T> TranslationTransform<T>::transMul(const ABInertia<T> & rbI) const
+{
+  Eigen::Matrix3<T> H, I;
+  sva_internal::translateABInertia<T>(rbI.lowerTriangularMassMatrix(), rbI.gInertia(), rbI.lowerTriangularInertia(),
+                                      r_, H, I);
+  return ABInertia<T>(rbI.lowerTriangularMassMatrix(), H, I);
+}
+
+// AxisRotationTransform operators implementation
+
+template<typename T>
+template<int Axis>
+inline PTransform<T>::PTransform(const AxisRotationTransform<T, Axis> & art)
+: E_(art.rotation()), r_(vector3_t::Zero())
+{
+}
+
+template<typename T>
+template<int Axis>
+inline PTransform<T> PTransform<T>::operator*(const AxisRotationTransform<T, Axis> & art) const
+{
+  // E*E_a only combines the two columns of E orthogonal to the axis
+  constexpr int I = (Axis + 1) % 3;
+  constexpr int J = (Axis + 2) % 3;
+  const T c = art.cos(), s = art.sin();
+  PTransform<T> ret;
+  ret.E_.col(Axis) = E_.col(Axis);
+  ret.E_.col(I) = c * E_.col(I) - s * E_.col(J);
+  ret.E_.col(J) = s * E_.col(I) + c * E_.col(J);
+  sva_internal::axisRotationMul<Axis>(c, T(-s), r_, ret.r_);
+  return ret;
+}
+
+template<typename T, int Axis>
+inline PTransform<T> AxisRotationTransform<T, Axis>::ptransform() const
+{
+  return PTransform<T>(*this);
+}
+
+template<typename T, int Axis>
+inline RotationTransform<T> AxisRotationTransform<T, Axis>::rotationTransform() const
+{
+  return RotationTransform<T>(rotation());
+}
+
+template<typename T, int Axis>
+inline PTransform<T> AxisRotationTransform<T, Axis>::operator*(const PTransform<T> & pt) const
+{
+  PTransform<T> ret;
+  sva_internal::axisRotationMul<Axis>(c_, s_, pt.rotation(), ret.rotation());
+  ret.translation() = pt.translation();
+  return ret;
+}
+
+template<typename T, int Axis>
+inline MotionVec<T> AxisRotationTransform<T, Axis>::operator*(const MotionVec<T> & mv) const
+{
+  return MotionVec<T>(sva_internal::axisRotationMul<Axis>(c_, s_, mv.angular()),
+                      sva_internal::axisRotationMul<Axis>(c_, s_, mv.linear()));
+}
+
+template<typename T, int Axis>
+template<typename Derived>
+inline void AxisRotationTransform<T, Axis>::mul(const Eigen::MatrixBase<Derived> & mv,
+                                                Eigen::MatrixBase<Derived> & result) const
+{
+  static_assert(Derived::RowsAtCompileTime == 6, "the matrix must have exactly 6 rows");
+  static_assert(std::is_same<typename Derived::Scalar, T>::value, "motion vec and matrix must be the same type");
+
+  sva_internal::axisRotationMul<Axis>(c_, s_, motionAngular(mv), motionAngular(result));
+  sva_internal::axisRotationMul<Axis>(c_, s_, motionLinear(mv), motionLinear(result));
+}
+
+template<typename T, int Axis>
+inline MotionVec<T> AxisRotationTransform<T, Axis>::invMul(const MotionVec<T> & mv) const
+{
+  return MotionVec<T>(sva_internal::axisRotationMul<Axis>(c_, T(-s_), mv.angular()),
+                      sva_internal::axisRotationMul<Axis>(c_, T(-s_), mv.linear()));
+}
+
+template<typename T, int Axis>
+template<typename Derived>
+inline void AxisRotationTransform<T, Axis>::invMul(const Eigen::MatrixBase<Derived> & mv,
+                                                   Eigen::MatrixBase<Derived> & result) const
+{
+  static_assert(Derived::RowsAtCompileTime == 6, "the matrix must have exactly 6 rows");
+  static_assert(std::is_same<typename Derived::Scalar, T>::value, "motion vec and matrix must be the same type");
+
+  sva_internal::axisRotationMul<Axis>(c_, T(-s_), motionAngular(mv), motionAngular(result));
+  sva_internal::axisRotationMul<Axis>(c_, T(-s_), motionLinear(mv), motionLinear(result));
+}
+
+template<typename T, int Axis>
+inline ForceVec<T> AxisRotationTransform<T, Axis>::dualMul(const ForceVec<T> & fv) const
+{
+  return ForceVec<T>(sva_internal::axisRotationMul<Axis>(c_, s_, fv.couple()),
+                      sva_internal::axisRotationMul<Axis>(c_, s_, fv.force()));
+}
+
+template<typename T, int Axis>
+template<typename Derived>
+inline void AxisRotationTransform<T, Axis>::dualMul(const Eigen::MatrixBase<Derived> & fv,
+                                                    Eigen::MatrixBase<Derived> & result) const
+{
+  static_assert(Derived::RowsAtCompileTime == 6, "the matrix must have exactly 6 rows");
+  static_assert(std::is_same<typename Derived::Scalar, T>::value, "force vec and matrix must be the same type");
+
+  sva_internal::axisRotationMul<Axis>(c_, s_, forceCouple(fv), forceCouple(result));
+  sva_internal::axisRotationMul<Axis>(c_, s_, forceForce(fv), forceForce(result));
+}
+
+template<typename T, int Axis>
+inline ForceVec<T> AxisRotationTransform<T, Axis>::transMul(const ForceVec<T> & fv) const
+{
+  return ForceVec<T>(sva_internal::axisRotationMul<Axis>(c_, T(-s_), fv.couple()),
+                      sva_internal::axisRotationMul<Axis>(c_, T(-s_), fv.force()));
+}
+
+template<typename T, int Axis>
+template<typename Derived>
+inline void AxisRotationTransform<T, Axis>::transMul(const Eigen::MatrixBase<Derived> & fv,
+                                                     Eigen::MatrixBase<Derived> & result) const
+{
+  static_assert(Derived::RowsAtCompileTime == 6, "the matrix must have exactly 6 rows");
+  static_assert(std::is_same<typename Derived::Scalar, T>::value, "force vec and matrix must be the same type");
+
+  sva_internal::axisRotationMul<Axis>(c_, T(-s_), forceCouple(fv), forceCouple(result));
+  sva_internal::axisRotationMul<Axis>(c_, T(-s_), forceForce(fv), forceForce(result));
+}
+
+template<typename T, int Axis>
+inline RBInertia<T> AxisRotationTransform<T, Axis>::dualMul(const RBInertia<T> & rbI) const
+{
+  return rotationTransform().dualMul(rbI);
+}
+
+template<typename T, int Axis>
+inline RBInertia<T> AxisRotationTransform<T, Axis>::transMul(const RBInertia<T> & rbI) const
+{
+  return rotationTransform().transMul(rbI);
+}
+
+template<typename T, int Axis>
+inline ABInertia<T> AxisRotationTransform<T, Axis>::dualMul(const ABInertia<T> & rbI) const
+{
+  return rotationTransform().dualMul(rbI);
+}
+
+template<typename T, int Axis>
+inline ABInertia<T> AxisRotationTransform<T, Axis>::transMul(const ABInertia<T> & rbI) const
+{
+  return rotationTransform().transMul(rbI);
+}
+
+// SE3Jacobian operators implementation
+
+template<typename T>
+inline MotionVec<T> SE3Jacobian<T>::operator*(const MotionVec<T> & mv) const
+{
+  return MotionVec<T>(D_ * mv.angular(), L_ * mv.angular() + D_ * mv.linear());
+}
+
+template<typename T>
+inline ForceVec<T> SE3Jacobian<T>::transMul(const ForceVec<T> & fv) const
+{
+  return ForceVec<T>(D_.transpose() * fv.couple() + L_.transpose() * fv.force(), D_.transpose() * fv.force());
+}
+
+// BlockDiagJacobian operators implementation
+
+template<typename T>
+inline MotionVec<T> BlockDiagJacobian<T>::operator*(const MotionVec<T> & mv) const
+{
+  return MotionVec<T>(A_ * mv.angular(), B_ * mv.linear());
+}
+
+template<typename T>
+inline ForceVec<T> BlockDiagJacobian<T>::transMul(const ForceVec<T> & fv) const
+{
+  return ForceVec<T>(A_.transpose() * fv.couple(), B_.transpose() * fv.force());
+}
+
+// ForceCrossJacobian operators implementation
+
+template<typename T>
+inline ForceVec<T> ForceCrossJacobian<T>::operator*(const MotionVec<T> & mv) const
+{
+  return ForceVec<T>(n_.cross(mv.angular()) + f_.cross(mv.linear()), f_.cross(mv.angular()));
+}
+
+template<typename T>
+inline ForceVec<T> ForceCrossJacobian<T>::transMul(const MotionVec<T> & mv) const
+{
+  // the blocks are skew-symmetric and the block structure is symmetric so J^T = -J
+  return ForceVec<T>(mv.angular().cross(n_) + mv.linear().cross(f_), mv.angular().cross(f_));
 }
 
 } // namespace sva
@@ -74,6 +74,18 @@ MotionVec<T> transformError(const PTransform<T> & X_a_b, const PTransform<T> & X
 template<typename T>
 MotionVec<T> transformVelocity(const PTransform<T> & X_a_b);
 
+/**
+ * Exponential map of SE(3).
+ * Compute the transformation X_a_b reached by integrating the constant motion
+ * vector nu, expressed in the 'a' frame, for 1 second.
+ * The rotation is computed with the Rodrigues formula and the translation is
+ * SO3LeftJac(nu.angular())*nu.linear(), the small angle cases are handled
+ * with Taylor expansions.
+ * rotationVelocity(exp(nu).rotation()) is nu.angular().
+ */
+template<typename T>
+PTransform<T> exp(const MotionVec<T> & nu);
+
 /**
  * Plücker transform compact representation.
  * Use 3D matrix as rotation internal representation.
@@ -136,6 +148,23 @@ public:
    */
   PTransform(const vector3_t & trans) : E_(matrix3_t::Identity()), r_(trans) {}
 
+  /// Conversion from a QTransform.
+  explicit PTransform(const QTransform<T> & qt);
+
+  /// Evaluate a lazy product of PTransform, see compose.
+  template<typename Lhs, typename Rhs>
+  PTransform(const PTransformProduct<Lhs, Rhs> & pt);
+
+  /// Conversion from a RotationTransform.
+  PTransform(const RotationTransform<T> & rt);
+
+  /// Conversion from a TranslationTransform.
+  PTransform(const TranslationTransform<T> & tt);
+
+  /// Conversion from an AxisRotationTransform.
+  template<int Axis>
+  PTransform(const AxisRotationTransform<T, Axis> & art);
+
   // Accessor
   /// @return Rotation matrix.
   const matrix3_t & rotation() const
@@ -189,6 +218,13 @@ public:
   {
     return PTransform<T>(E_ * pt.E_, pt.r_ + pt.E_.transpose() * r_);
   }
+  /// @return X*X
+  PTransform<T> operator*(const RotationTransform<T> & rt) const;
+  /// @return X*X
+  PTransform<T> operator*(const TranslationTransform<T> & tt) const;
+  /// @return X*X
+  template<int Axis>
+  PTransform<T> operator*(const AxisRotationTransform<T, Axis> & art) const;
 
   /// @return Xv
   MotionVec<T> operator*(const MotionVec<T> & mv) const;
@@ -231,6 +267,26 @@ public:
   template<typename Derived>
   void transMul(const Eigen::MatrixBase<Derived> & fv, Eigen::MatrixBase<Derived> & result) const;
 
+  /// @return Xv_i for each element of the batch
+  MotionVecBatch<T> operator*(const MotionVecBatch<T> & mvb) const;
+  /// @see operator*(const MotionVecBatch<T>& mvb) const, result can be mvb.
+  void mul(const MotionVecBatch<T> & mvb, MotionVecBatch<T> & result) const;
+
+  /// @return X^-1 v_i for each element of the batch
+  MotionVecBatch<T> invMul(const MotionVecBatch<T> & mvb) const;
+  /// @see invMul(const MotionVecBatch<T>& mvb) const, result can be mvb.
+  void invMul(const MotionVecBatch<T> & mvb, MotionVecBatch<T> & result) const;
+
+  /// @return X*f_i for each element of the batch
+  ForceVecBatch<T> dualMul(const ForceVecBatch<T> & fvb) const;
+  /// @see dualMul(const ForceVecBatch<T>& fvb) const, result can be fvb.
+  void dualMul(const ForceVecBatch<T> & fvb, ForceVecBatch<T> & result) const;
+
+  /// @return Xtf_i for each element of the batch
+  ForceVecBatch<T> transMul(const ForceVecBatch<T> & fvb) const;
+  /// @see transMul(const ForceVecBatch<T>& fvb) const, result can be fvb.
+  void transMul(const ForceVecBatch<T> & fvb, ForceVecBatch<T> & result) const;
+
   /// @return X*IX^-1
   RBInertia<T> dualMul(const RBInertia<T> & rbI) const;
   /// @return XtIX
@@ -265,21 +321,27 @@ private:
 template<typename T>
 inline Eigen::Matrix3<T> RotX(T theta)
 {
-  T s = std::sin(theta), c = std::cos(theta);
+  using std::cos;
+  using std::sin;
+  T s = sin(theta), c = cos(theta);
   return (Eigen::Matrix3<T>() << 1., 0., 0., 0., c, s, 0., -s, c).finished();
 }
 
 template<typename T>
 inline Eigen::Matrix3<T> RotY(T theta)
 {
-  T s = std::sin(theta), c = std::cos(theta);
+  using std::cos;
+  using std::sin;
+  T s = sin(theta), c = cos(theta);
   return (Eigen::Matrix3<T>() << c, 0., -s, 0., 1., 0., s, 0., c).finished();
 }
 
 template<typename T>
 inline Eigen::Matrix3<T> RotZ(T theta)
 {
-  T s = std::sin(theta), c = std::cos(theta);
+  using std::cos;
+  using std::sin;
+  T s = sin(theta), c = cos(theta);
   return (Eigen::Matrix3<T>() << c, s, 0., -s, c, 0., 0., 0., 1.).finished();
 }
 
@@ -293,14 +355,16 @@ inline Eigen::Vector3<T> rotationError(const Eigen::Matrix3<T> & E_a_b, const Ei
 template<typename T>
 inline Eigen::Vector3<T> rotationVelocity(const Eigen::Matrix3<T> & E_a_b)
 {
-  constexpr T eps = std::numeric_limits<T>::epsilon();
-  constexpr T sqeps = details::sqrt(eps);
-  constexpr T sqsqeps = details::sqrt(sqeps);
-  constexpr T pi = 3.1415926535897932;
+  using std::acos;
+  typedef typename Eigen::NumTraits<T>::Literal literal_t;
+  constexpr literal_t eps = std::numeric_limits<literal_t>::epsilon();
+  constexpr literal_t sqeps = details::sqrt(eps);
+  constexpr literal_t sqsqeps = details::sqrt(sqeps);
+  constexpr literal_t pi = static_cast<literal_t>(3.1415926535897932);
 
   T trace = E_a_b(0, 0) + E_a_b(1, 1) + E_a_b(2, 2);
-  T acosV = (trace - 1.) * 0.5;
-  T theta = std::acos(std::min(std::max(acosV, -1.), 1.));
+  T acosV = (trace - T(1)) * T(0.5);
+  T theta = acos(std::min(std::max(acosV, T(-1)), T(1)));
 
   Eigen::Vector3<T> w(-E_a_b(2, 1) + E_a_b(1, 2), -E_a_b(0, 2) + E_a_b(2, 0), -E_a_b(1, 0) + E_a_b(0, 1));
 
@@ -336,9 +400,17 @@ inline Eigen::Vector3<T> rotationVelocity(const Eigen::Matrix3<T> & E_a_b)
     // The sign is derived from (9)
     return (w.array() >= 0).select(tn2, -tn2);
   }
+  else if(theta < sqsqeps)
+  {
+    // sinc_inv(theta) = 1 + theta^2/6 + 7 theta^4/360 with theta^2 = 2 e (1 + e/6) + O(e^3), e = 1 - cos(theta),
+    // this avoids acos that is not differentiable at the identity
+    T e = T(1) - acosV;
+    T theta2 = T(2) * e * (T(1) + e / T(6));
+    w *= (T(1) + theta2 / T(6) + T(7) * theta2 * theta2 / T(360)) * T(0.5);
+  }
   else
   {
-    w *= sinc_inv(theta) * 0.5;
+    w *= sinc_inv(theta) * T(0.5);
   }
 
   return w;
@@ -348,7 +420,7 @@ template<typename T>
 inline MotionVec<T> transformError(const PTransform<T> & X_a_b, const PTransform<T> & X_a_c)
 {
   PTransform<T> X_b_c = X_a_c * X_a_b.inv();
-  return PTransform<T>(Eigen::Matrix3<T>(X_a_b.rotation().transpose())) * transformVelocity(X_b_c);
+  return RotationTransform<T>(X_a_b.rotation()).invMul(transformVelocity(X_b_c));
 }
 
 template<typename T>
@@ -357,6 +429,34 @@ inline MotionVec<T> transformVelocity(const PTransform<T> & X_a_b)
   return MotionVec<T>(rotationVelocity(X_a_b.rotation()), X_a_b.translation());
 }
 
+template<typename T>
+inline PTransform<T> exp(const MotionVec<T> & nu)
+{
+  const Eigen::Vector3<T> & w = nu.angular();
+  const Eigen::Vector3<T> & v = nu.linear();
+  T theta2 = w.squaredNorm();
+  T G[2];
+  details::alternatingFactorialFunctions<3>(theta2, G);
+  T g1 = G[0];
+  T g2 = G[1];
+  // sinc(theta) = 1 - theta^2 g2
+  T a = T(1) - theta2 * g2;
+
+  // E = I - sinc(theta) [w]x + g1 [w]x^2, with [w]x^2 = w w^T - theta^2 I
+  Eigen::Matrix3<T> E = g1 * w * w.transpose();
+  E.diagonal().array() += T(1) - g1 * theta2;
+  E(0, 1) += a * w.z();
+  E(1, 0) -= a * w.z();
+  E(0, 2) -= a * w.y();
+  E(2, 0) += a * w.y();
+  E(1, 2) += a * w.x();
+  E(2, 1) -= a * w.x();
+
+  // r = v + g1 w x v + g2 w x (w x v)
+  Eigen::Vector3<T> wxv = w.cross(v);
+  return PTransform<T>(E, Eigen::Vector3<T>(v + g1 * wxv + g2 * w.cross(wxv)));
+}
+
 // interpolate between transformations, t must be between 0 and 1
 template<typename T>
 PTransform<T> interpolate(const PTransform<T> & from, const PTransform<T> & to, double t)
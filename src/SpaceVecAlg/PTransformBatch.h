@@ -0,0 +1,447 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+#include "EigenTypedef.h"
+#include "PTransform.h"
+#include "fwd.h"
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+namespace sva
+{
+
+namespace sva_internal
+{
+
+/// Number of elements processed at once by the batch kernels.
+/// The lanes of such a block stay in L1 cache for the whole computation.
+constexpr int batchBlockSize = 64;
+
+/// Stack allocated scratch block used by the batch kernels.
+template<typename T, int Lanes>
+using BatchBlock = Eigen::Matrix<T, Eigen::Dynamic, Lanes, Eigen::ColMajor, batchBlockSize, Lanes>;
+
+} // namespace sva_internal
+
+/**
+ * Batch of Plücker transforms stored in structure of arrays layout.
+ * Each of the 9 rotation coefficients and 3 translation coefficients is
+ * stored in its own contiguous lane, so the batch operators process
+ * several transforms per SIMD instruction.
+ * The rotation coefficient E(i, j) is stored in lane 3*i + j and the
+ * translation coefficient r(i) in lane 9 + i.
+ */
+template<typename T>
+class PTransformBatch
+{
+public:
+  typedef Eigen::Matrix<T, Eigen::Dynamic, 12> storage_t;
+  typedef typename storage_t::Index index_t;
+  typedef typename storage_t::ColXpr lane_t;
+  typedef typename storage_t::ConstColXpr const_lane_t;
+
+public:
+  /// Batch of size identity transformations.
+  static PTransformBatch<T> Identity(index_t size)
+  {
+    return PTransformBatch<T>(size, PTransform<T>::Identity());
+  }
+
+public:
+  // Constructors
+  /// Empty batch.
+  PTransformBatch() : data_() {}
+
+  /// Batch of size uninitialized transformations.
+  explicit PTransformBatch(index_t size) : data_(size, 12) {}
+
+  /// Batch of size copies of pt.
+  PTransformBatch(index_t size, const PTransform<T> & pt) : data_(size, 12)
+  {
+    setConstant(pt);
+  }
+
+  /// @param pts Transformations to store in the batch.
+  PTransformBatch(const std::vector<PTransform<T>> & pts) : data_(static_cast<index_t>(pts.size()), 12)
+  {
+    for(index_t i = 0; i < size(); ++i)
+    {
+      set(i, pts[static_cast<std::size_t>(i)]);
+    }
+  }
+
+  /// Copy constructor.
+  template<typename T2>
+  PTransformBatch(const PTransformBatch<T2> & ptb) : data_(ptb.data().template cast<T>())
+  {
+  }
+
+  // Accessor
+  /// @return Number of transformations in the batch.
+  index_t size() const
+  {
+    return data_.rows();
+  }
+
+  /// Resize the batch, the transformations are left uninitialized.
+  void resize(index_t size)
+  {
+    data_.resize(size, 12);
+  }
+
+  /// @return Lane of the rotation coefficient E(row, col).
+  lane_t rotation(int row, int col)
+  {
+    return data_.col(3 * row + col);
+  }
+
+  /// @return Lane of the rotation coefficient E(row, col).
+  const_lane_t rotation(int row, int col) const
+  {
+    return data_.col(3 * row + col);
+  }
+
+  /// @return Lane of the translation coefficient r(i).
+  lane_t translation(int i)
+  {
+    return data_.col(9 + i);
+  }
+
+  /// @return Lane of the translation coefficient r(i).
+  const_lane_t translation(int i) const
+  {
+    return data_.col(9 + i);
+  }
+
+  /// @return Underlying size x 12 storage.
+  const storage_t & data() const
+  {
+    return data_;
+  }
+
+  /// @return Underlying size x 12 storage.
+  storage_t & data()
+  {
+    return data_;
+  }
+
+  /// @return Copy of the i-th transformation.
+  PTransform<T> operator[](index_t i) const
+  {
+    PTransform<T> pt;
+    for(int r = 0; r < 3; ++r)
+    {
+      for(int c = 0; c < 3; ++c)
+      {
+        pt.rotation()(r, c) = data_(i, 3 * r + c);
+      }
+      pt.translation()(r) = data_(i, 9 + r);
+    }
+    return pt;
+  }
+
+  /// Set all the transformations of the batch to pt.
+  void setConstant(const PTransform<T> & pt)
+  {
+    for(int i = 0; i < 3; ++i)
+    {
+      for(int j = 0; j < 3; ++j)
+      {
+        rotation(i, j).setConstant(pt.rotation()(i, j));
+      }
+      translation(i).setConstant(pt.translation()(i));
+    }
+  }
+
+  /// Set the i-th transformation.
+  void set(index_t i, const PTransform<T> & pt)
+  {
+    for(int r = 0; r < 3; ++r)
+    {
+      for(int c = 0; c < 3; ++c)
+      {
+        data_(i, 3 * r + c) = pt.rotation()(r, c);
+      }
+      data_(i, 9 + r) = pt.translation()(r);
+    }
+  }
+
+  template<typename T2>
+  PTransformBatch<T2> cast() const
+  {
+    return PTransformBatch<T2>(*this);
+  }
+
+  // Operators
+  /// @return X_i*X_i for each element of the batches
+  PTransformBatch<T> operator*(const PTransformBatch<T> & ptb) const
+  {
+    PTransformBatch<T> result(size());
+    mul(ptb, result);
+    return result;
+  }
+
+  /// @return X_i*X for each element of the batch
+  PTransformBatch<T> operator*(const PTransform<T> & pt) const
+  {
+    PTransformBatch<T> result(size());
+    mul(pt, result);
+    return result;
+  }
+
+  /**
+   * @see operator*(const PTransformBatch<T>& ptb) const
+   * result is resized if needed and can be one of the operands.
+   */
+  void mul(const PTransformBatch<T> & ptb, PTransformBatch<T> & result) const;
+
+  /**
+   * @see operator*(const PTransform<T>& pt) const
+   * result is resized if needed and can be this batch.
+   */
+  void mul(const PTransform<T> & pt, PTransformBatch<T> & result) const;
+
+  /// @return X_i*v_i for each element of the batches
+  MotionVecBatch<T> operator*(const MotionVecBatch<T> & mvb) const;
+  /// @see operator*(const MotionVecBatch<T>& mvb) const, result can be mvb.
+  void mul(const MotionVecBatch<T> & mvb, MotionVecBatch<T> & result) const;
+
+  /// @return X_i^-1 v_i for each element of the batches
+  MotionVecBatch<T> invMul(const MotionVecBatch<T> & mvb) const;
+  /// @see invMul(const MotionVecBatch<T>& mvb) const, result can be mvb.
+  void invMul(const MotionVecBatch<T> & mvb, MotionVecBatch<T> & result) const;
+
+  /// @return X_i*f_i for each element of the batches
+  ForceVecBatch<T> dualMul(const ForceVecBatch<T> & fvb) const;
+  /// @see dualMul(const ForceVecBatch<T>& fvb) const, result can be fvb.
+  void dualMul(const ForceVecBatch<T> & fvb, ForceVecBatch<T> & result) const;
+
+  /// @return X_i^t f_i for each element of the batches
+  ForceVecBatch<T> transMul(const ForceVecBatch<T> & fvb) const;
+  /// @see transMul(const ForceVecBatch<T>& fvb) const, result can be fvb.
+  void transMul(const ForceVecBatch<T> & fvb, ForceVecBatch<T> & result) const;
+
+  /// @return Inverse of each Plücker transformation.
+  PTransformBatch<T> inv() const
+  {
+    PTransformBatch<T> result(size());
+    inv(result);
+    return result;
+  }
+
+  /**
+   * @see inv() const
+   * result is resized if needed and can be this batch.
+   */
+  void inv(PTransformBatch<T> & result) const;
+
+  bool operator==(const PTransformBatch<T> & ptb) const
+  {
+    return data_ == ptb.data_;
+  }
+
+  bool operator!=(const PTransformBatch<T> & ptb) const
+  {
+    return data_ != ptb.data_;
+  }
+
+private:
+  storage_t data_;
+};
+
+/**
+ * Batched version of rotationVelocity(const Eigen::Matrix3<T>&) on the
+ * rotations of X_a_b.
+ * The regular case is computed lane-wise without branches, the small angle
+ * and near pi elements fall back to the scalar version.
+ * @param result size x 3 lanes, resized if needed.
+ */
+template<typename T>
+void rotationVelocity(const PTransformBatch<T> & X_a_b, Eigen::Matrix<T, Eigen::Dynamic, 3> & result);
+
+/**
+ * Batched version of transformVelocity(const PTransform<T>&).
+ * @param result Resized if needed.
+ */
+template<typename T>
+void transformVelocity(const PTransformBatch<T> & X_a_b, MotionVecBatch<T> & result);
+
+/**
+ * Batched version of transformError(const PTransform<T>&, const PTransform<T>&).
+ * @param result Resized if needed.
+ */
+template<typename T>
+void transformError(const PTransformBatch<T> & X_a_b, const PTransformBatch<T> & X_a_c, MotionVecBatch<T> & result);
+
+/**
+ * Batched version of exp(const MotionVec<T>&).
+ * The small angle elements are handled lane-wise without branches.
+ * @param result Resized if needed.
+ */
+template<typename T>
+void exp(const MotionVecBatch<T> & nu, PTransformBatch<T> & result);
+
+namespace sva_internal
+{
+
+/**
+ * Rows [begin, end) of PTransformBatch::mul(const PTransformBatch<T>&, PTransformBatch<T>&),
+ * result must already have the size of the batches.
+ */
+template<typename T>
+inline void batchMul(const PTransformBatch<T> & ptba,
+                     const PTransformBatch<T> & ptb,
+                     PTransformBatch<T> & result,
+                     typename PTransformBatch<T>::index_t begin,
+                     typename PTransformBatch<T>::index_t end)
+{
+  typedef typename PTransformBatch<T>::index_t index_t;
+
+  // Each block is computed in a scratch buffer before being written back,
+  // this makes the kernel safe when result is one of the operands.
+  BatchBlock<T, 12> res;
+  for(index_t start = begin; start < end; start += batchBlockSize)
+  {
+    const index_t n = std::min<index_t>(batchBlockSize, end - start);
+    const auto A = ptba.data().middleRows(start, n);
+    const auto B = ptb.data().middleRows(start, n);
+    res.resize(n, 12);
+
+    // E = E_a*E_b
+    for(int i = 0; i < 3; ++i)
+    {
+      for(int j = 0; j < 3; ++j)
+      {
+        res.col(3 * i + j).array() = A.col(3 * i).array() * B.col(j).array()
+                                     + A.col(3 * i + 1).array() * B.col(3 + j).array()
+                                     + A.col(3 * i + 2).array() * B.col(6 + j).array();
+      }
+    }
+
+    // r = r_b + E_b^T*r_a
+    for(int i = 0; i < 3; ++i)
+    {
+      res.col(9 + i).array() = B.col(9 + i).array() + B.col(i).array() * A.col(9).array()
+                               + B.col(3 + i).array() * A.col(10).array() + B.col(6 + i).array() * A.col(11).array();
+    }
+
+    result.data().middleRows(start, n) = res;
+  }
+}
+
+/// Rows [begin, end) of PTransformBatch::mul(const PTransform<T>&, PTransformBatch<T>&), see batchMul.
+template<typename T>
+inline void batchMul(const PTransformBatch<T> & ptba,
+                     const PTransform<T> & pt,
+                     PTransformBatch<T> & result,
+                     typename PTransformBatch<T>::index_t begin,
+                     typename PTransformBatch<T>::index_t end)
+{
+  typedef typename PTransformBatch<T>::index_t index_t;
+  const Eigen::Matrix3<T> & Eb = pt.rotation();
+  const Eigen::Vector3<T> & rb = pt.translation();
+
+  BatchBlock<T, 12> res;
+  for(index_t start = begin; start < end; start += batchBlockSize)
+  {
+    const index_t n = std::min<index_t>(batchBlockSize, end - start);
+    const auto A = ptba.data().middleRows(start, n);
+    res.resize(n, 12);
+
+    // E = E_a*E_b
+    for(int i = 0; i < 3; ++i)
+    {
+      for(int j = 0; j < 3; ++j)
+      {
+        res.col(3 * i + j).array() =
+            A.col(3 * i).array() * Eb(0, j) + A.col(3 * i + 1).array() * Eb(1, j) + A.col(3 * i + 2).array() * Eb(2, j);
+      }
+    }
+
+    // r = r_b + E_b^T*r_a
+    for(int i = 0; i < 3; ++i)
+    {
+      res.col(9 + i).array() =
+          A.col(9).array() * Eb(0, i) + A.col(10).array() * Eb(1, i) + A.col(11).array() * Eb(2, i) + rb(i);
+    }
+
+    result.data().middleRows(start, n) = res;
+  }
+}
+
+/// Rows [begin, end) of PTransformBatch::inv(PTransformBatch<T>&), see batchMul.
+template<typename T>
+inline void batchInv(const PTransformBatch<T> & ptba,
+                     PTransformBatch<T> & result,
+                     typename PTransformBatch<T>::index_t begin,
+                     typename PTransformBatch<T>::index_t end)
+{
+  typedef typename PTransformBatch<T>::index_t index_t;
+
+  BatchBlock<T, 12> res;
+  for(index_t start = begin; start < end; start += batchBlockSize)
+  {
+    const index_t n = std::min<index_t>(batchBlockSize, end - start);
+    const auto A = ptba.data().middleRows(start, n);
+    res.resize(n, 12);
+
+    // E^T
+    for(int i = 0; i < 3; ++i)
+    {
+      for(int j = 0; j < 3; ++j)
+      {
+        res.col(3 * i + j) = A.col(3 * j + i);
+      }
+    }
+
+    // -E*r
+    for(int i = 0; i < 3; ++i)
+    {
+      res.col(9 + i).array() = -(A.col(3 * i).array() * A.col(9).array() + A.col(3 * i + 1).array() * A.col(10).array()
+                                 + A.col(3 * i + 2).array() * A.col(11).array());
+    }
+
+    result.data().middleRows(start, n) = res;
+  }
+}
+
+} // namespace sva_internal
+
+template<typename T>
+inline void PTransformBatch<T>::mul(const PTransformBatch<T> & ptb, PTransformBatch<T> & result) const
+{
+  assert(ptb.size() == size());
+  result.resize(size());
+  sva_internal::batchMul(*this, ptb, result, 0, size());
+}
+
+template<typename T>
+inline void PTransformBatch<T>::mul(const PTransform<T> & pt, PTransformBatch<T> & result) const
+{
+  result.resize(size());
+  sva_internal::batchMul(*this, pt, result, 0, size());
+}
+
+template<typename T>
+inline void PTransformBatch<T>::inv(PTransformBatch<T> & result) const
+{
+  result.resize(size());
+  sva_internal::batchInv(*this, result, 0, size());
+}
+
+template<typename T>
+inline std::ostream & operator<<(std::ostream & out, const PTransformBatch<T> & ptb)
+{
+  for(typename PTransformBatch<T>::index_t i = 0; i < ptb.size(); ++i)
+  {
+    out << ptb[i] << "\n\n";
+  }
+  return out;
+}
+
+} // namespace sva
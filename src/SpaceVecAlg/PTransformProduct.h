@@ -0,0 +1,255 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+#include <type_traits>
+
+#include "EigenTypedef.h"
+#include "fwd.h"
+
+namespace sva
+{
+
+namespace sva_internal
+{
+
+template<typename X>
+struct ptransform_expr_traits;
+
+template<typename T>
+struct ptransform_expr_traits<PTransform<T>>
+{
+  typedef T scalar_t;
+};
+
+template<typename Lhs, typename Rhs>
+struct ptransform_expr_traits<PTransformProduct<Lhs, Rhs>>
+{
+  typedef typename ptransform_expr_traits<typename std::decay<Lhs>::type>::scalar_t scalar_t;
+};
+
+/**
+ * How a PTransform factor of type X (as deduced by a forwarding reference) is
+ * stored in a PTransformProduct: lvalues by reference and temporaries by value.
+ * There is no type for other types so the operators taking a factor are
+ * discarded for them.
+ */
+template<typename X>
+struct ptransform_nested
+{
+};
+
+template<typename T>
+struct ptransform_nested<PTransform<T>>
+{
+  typedef PTransform<T> type;
+};
+
+template<typename T>
+struct ptransform_nested<const PTransform<T>>
+{
+  typedef PTransform<T> type;
+};
+
+template<typename T>
+struct ptransform_nested<PTransform<T> &>
+{
+  typedef const PTransform<T> & type;
+};
+
+template<typename T>
+struct ptransform_nested<const PTransform<T> &>
+{
+  typedef const PTransform<T> & type;
+};
+
+/// @return X.
+template<typename T>
+inline const PTransform<T> & ptransformEval(const PTransform<T> & X)
+{
+  return X;
+}
+
+/// @return Evaluated product.
+template<typename Lhs, typename Rhs>
+inline PTransform<typename ptransform_expr_traits<PTransformProduct<Lhs, Rhs>>::scalar_t> ptransformEval(
+    const PTransformProduct<Lhs, Rhs> & X)
+{
+  return X.eval();
+}
+
+} // namespace sva_internal
+
+/**
+ * Lazy product of PTransform returned by compose.
+ * X_a_d = compose(X_c_d, X_b_c) * X_a_b is evaluated when the product is
+ * converted to a PTransform.
+ * When the product is applied to a MotionVec or a ForceVec the vector is
+ * transformed by each factor (24 multiplications by factor) instead of
+ * computing the product (36 multiplications by factor) and applying it.
+ * Matrix6X are transformed by the evaluated product, it is cheaper as soon as
+ * the matrix has more than one column.
+ * Lhs and Rhs are PTransform (owned temporaries), const PTransform& (lvalue
+ * factors, that must outlive the product) or PTransformProduct.
+ */
+template<typename Lhs, typename Rhs>
+class PTransformProduct
+{
+  typedef typename std::decay<Lhs>::type lhs_t;
+  typedef typename std::decay<Rhs>::type rhs_t;
+
+public:
+  typedef typename sva_internal::ptransform_expr_traits<PTransformProduct>::scalar_t scalar_t;
+
+public:
+  PTransformProduct(const lhs_t & lhs, const rhs_t & rhs) : lhs_(lhs), rhs_(rhs) {}
+
+  // Accessor
+  const lhs_t & lhs() const
+  {
+    return lhs_;
+  }
+
+  const rhs_t & rhs() const
+  {
+    return rhs_;
+  }
+
+  /// @return Evaluated product.
+  PTransform<scalar_t> eval() const
+  {
+    const auto & X1 = sva_internal::ptransformEval(lhs_);
+    const auto & X2 = sva_internal::ptransformEval(rhs_);
+    return PTransform<scalar_t>(X1.rotation() * X2.rotation(),
+                                X2.translation() + X2.rotation().transpose() * X1.translation());
+  }
+
+  // Operators
+  /// @return Lazy product X*X
+  template<typename X>
+  PTransformProduct<PTransformProduct, typename sva_internal::ptransform_nested<X>::type> operator*(X && pt) const
+  {
+    return PTransformProduct<PTransformProduct, typename sva_internal::ptransform_nested<X>::type>(*this, pt);
+  }
+
+  /// @return Lazy product X*X
+  template<typename Lhs2, typename Rhs2>
+  PTransformProduct<PTransformProduct, PTransformProduct<Lhs2, Rhs2>> operator*(
+      const PTransformProduct<Lhs2, Rhs2> & pt) const
+  {
+    return PTransformProduct<PTransformProduct, PTransformProduct<Lhs2, Rhs2>>(*this, pt);
+  }
+
+  /// @return Xv
+  MotionVec<scalar_t> operator*(const MotionVec<scalar_t> & mv) const
+  {
+    return lhs_ * (rhs_ * mv);
+  }
+
+  /// @return X^-1v
+  MotionVec<scalar_t> invMul(const MotionVec<scalar_t> & mv) const
+  {
+    return rhs_.invMul(lhs_.invMul(mv));
+  }
+
+  /// @return X*f
+  ForceVec<scalar_t> dualMul(const ForceVec<scalar_t> & fv) const
+  {
+    return lhs_.dualMul(rhs_.dualMul(fv));
+  }
+
+  /// @return X^Tf
+  ForceVec<scalar_t> transMul(const ForceVec<scalar_t> & fv) const
+  {
+    return rhs_.transMul(lhs_.transMul(fv));
+  }
+
+  /// @see PTransform::mul(const Eigen::MatrixBase<Derived>&, Eigen::MatrixBase<Derived>&) const
+  template<typename Derived>
+  void mul(const Eigen::MatrixBase<Derived> & mv, Eigen::MatrixBase<Derived> & result) const
+  {
+    eval().mul(mv, result);
+  }
+
+  /// @see PTransform::invMul(const Eigen::MatrixBase<Derived>&, Eigen::MatrixBase<Derived>&) const
+  template<typename Derived>
+  void invMul(const Eigen::MatrixBase<Derived> & mv, Eigen::MatrixBase<Derived> & result) const
+  {
+    eval().invMul(mv, result);
+  }
+
+  /// @see PTransform::dualMul(const Eigen::MatrixBase<Derived>&, Eigen::MatrixBase<Derived>&) const
+  template<typename Derived>
+  void dualMul(const Eigen::MatrixBase<Derived> & fv, Eigen::MatrixBase<Derived> & result) const
+  {
+    eval().dualMul(fv, result);
+  }
+
+  /// @see PTransform::transMul(const Eigen::MatrixBase<Derived>&, Eigen::MatrixBase<Derived>&) const
+  template<typename Derived>
+  void transMul(const Eigen::MatrixBase<Derived> & fv, Eigen::MatrixBase<Derived> & result) const
+  {
+    eval().transMul(fv, result);
+  }
+
+  /// @return Inverse Plücker transformation.
+  PTransform<scalar_t> inv() const
+  {
+    return eval().inv();
+  }
+
+  bool operator==(const PTransform<scalar_t> & pt) const
+  {
+    return eval() == pt;
+  }
+
+  bool operator!=(const PTransform<scalar_t> & pt) const
+  {
+    return eval() != pt;
+  }
+
+private:
+  Lhs lhs_;
+  Rhs rhs_;
+};
+
+/**
+ * @return Lazy product X1*X2.
+ * Unlike PTransform::operator*(const PTransform&), the product is not
+ * evaluated so that compose(X1, X2)*v can be applied factor by factor.
+ * Temporaries are copied in the product, other factors are referenced.
+ */
+template<typename X1, typename X2>
+inline PTransformProduct<typename sva_internal::ptransform_nested<X1>::type,
+                         typename sva_internal::ptransform_nested<X2>::type>
+    compose(X1 && pt1, X2 && pt2)
+{
+  return PTransformProduct<typename sva_internal::ptransform_nested<X1>::type,
+                           typename sva_internal::ptransform_nested<X2>::type>(pt1, pt2);
+}
+
+/// @return Lazy product X*X
+template<typename X, typename Lhs, typename Rhs>
+inline PTransformProduct<typename sva_internal::ptransform_nested<X>::type, PTransformProduct<Lhs, Rhs>> operator*(
+    X && pt,
+    const PTransformProduct<Lhs, Rhs> & prod)
+{
+  return PTransformProduct<typename sva_internal::ptransform_nested<X>::type, PTransformProduct<Lhs, Rhs>>(pt, prod);
+}
+
+template<typename T>
+template<typename Lhs, typename Rhs>
+inline PTransform<T>::PTransform(const PTransformProduct<Lhs, Rhs> & pt) : PTransform(pt.eval())
+{
+}
+
+template<typename Lhs, typename Rhs>
+inline std::ostream & operator<<(std::ostream & out, const PTransformProduct<Lhs, Rhs> & pt)
+{
+  out << pt.eval();
+  return out;
+}
+
+} // namespace sva
@@ -0,0 +1,298 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace sva
+{
+
+/// @return Number of threads to use when 0 is requested.
+inline unsigned defaultNrThreads()
+{
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/**
+ * Pool of persistent worker threads with work stealing.
+ * The workers are started by the constructor and wait for work between calls
+ * to parallelFor, so a call does not create threads nor allocate memory.
+ * The calling thread takes part in the work, a pool of nrThreads threads has
+ * nrThreads - 1 workers.
+ * parallelFor must not be called concurrently nor recursively on the same pool.
+ */
+class ThreadPool
+{
+public:
+  /**
+   * Start the workers.
+   * @param nrThreads Number of threads, 0 to use defaultNrThreads().
+   */
+  explicit ThreadPool(unsigned nrThreads = 0)
+  : nrThreads_(nrThreads == 0 ? defaultNrThreads() : nrThreads), queues_(nrThreads_), stop_(false), generation_(0),
+    active_(0), invoke_(nullptr), job_(nullptr), size_(0), grain_(1)
+  {
+    workers_.reserve(nrThreads_ - 1);
+    for(unsigned t = 0; t + 1 < nrThreads_; ++t)
+    {
+      workers_.emplace_back([this, t]() { workerLoop(t); });
+    }
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool & operator=(const ThreadPool &) = delete;
+
+  /// Stop and join the workers.
+  ~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    wake_.notify_all();
+    for(std::thread & th : workers_)
+    {
+      th.join();
+    }
+  }
+
+  /// @return Number of threads, the calling thread included.
+  unsigned nrThreads() const
+  {
+    return nrThreads_;
+  }
+
+  /**
+   * Split [0, size) in chunks of grain elements, the last one being shorter,
+   * and call f(thread, begin, end) once for each of them.
+   * The chunks only depend on size and grain, not on the number of threads nor
+   * on the scheduling, so if f writes each [begin, end) range independently
+   * the result is bitwise reproducible.
+   * Each thread starts with a contiguous range of chunks and steals half of
+   * the remaining chunks of another thread when it runs out of work. thread is
+   * the index, in [0, nrThreads()), of the thread running the chunk, it can be
+   * used to select a per thread workspace.
+   * The first exception thrown by f is rethrown once all the chunks are done.
+   */
+  template<typename F>
+  void parallelFor(std::ptrdiff_t size, std::ptrdiff_t grain, F && f)
+  {
+    if(size <= 0)
+    {
+      return;
+    }
+    grain = std::max<std::ptrdiff_t>(grain, 1);
+    const std::ptrdiff_t nrChunks = (size + grain - 1) / grain;
+    if(nrThreads_ == 1 || nrChunks == 1)
+    {
+      for(std::ptrdiff_t c = 0; c < nrChunks; ++c)
+      {
+        f(nrThreads_ - 1, c * grain, std::min(size, (c + 1) * grain));
+      }
+      return;
+    }
+
+    typedef typename std::remove_reference<F>::type f_t;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      invoke_ = [](void * job, unsigned t, std::ptrdiff_t begin, std::ptrdiff_t end) {
+        (*static_cast<f_t *>(job))(t, begin, end);
+      };
+      job_ = const_cast<void *>(static_cast<const void *>(std::addressof(f)));
+      size_ = size;
+      grain_ = grain;
+      error_ = nullptr;
+      for(unsigned t = 0; t < nrThreads_; ++t)
+      {
+        std::lock_guard<std::mutex> queueLock(queues_[t].mutex);
+        queues_[t].next = (nrChunks * t) / nrThreads_;
+        queues_[t].end = (nrChunks * (t + 1)) / nrThreads_;
+      }
+      active_ = nrThreads_ - 1;
+      ++generation_;
+    }
+    wake_.notify_all();
+
+    work(nrThreads_ - 1);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this]() { return active_ == 0; });
+    if(error_)
+    {
+      std::exception_ptr error = error_;
+      error_ = nullptr;
+      std::rethrow_exception(error);
+    }
+  }
+
+private:
+  /// Chunks [next, end) owned by a thread.
+  struct Queue
+  {
+    std::mutex mutex;
+    std::ptrdiff_t next = 0;
+    std::ptrdiff_t end = 0;
+  };
+
+private:
+  void workerLoop(unsigned t)
+  {
+    std::size_t seen = 0;
+    for(;;)
+    {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        wake_.wait(lock, [this, seen]() { return stop_ || generation_ != seen; });
+        if(stop_)
+        {
+          return;
+        }
+        seen = generation_;
+      }
+      work(t);
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(--active_ == 0)
+        {
+          done_.notify_one();
+        }
+      }
+    }
+  }
+
+  /// Run the chunks of the thread t then steal from the other threads.
+  void work(unsigned t)
+  {
+    std::ptrdiff_t c;
+    while(pop(t, c) || steal(t, c))
+    {
+      try
+      {
+        invoke_(job_, t, c * grain_, std::min(size_, (c + 1) * grain_));
+      }
+      catch(...)
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(!error_)
+        {
+          error_ = std::current_exception();
+        }
+      }
+    }
+  }
+
+  bool pop(unsigned t, std::ptrdiff_t & c)
+  {
+    Queue & q = queues_[t];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if(q.next == q.end)
+    {
+      return false;
+    }
+    c = q.next++;
+    return true;
+  }
+
+  /// Move the upper half of the chunks of the first non empty queue to the queue of t.
+  bool steal(unsigned t, std::ptrdiff_t & c)
+  {
+    for(unsigned k = 1; k < nrThreads_; ++k)
+    {
+      Queue & victim = queues_[(t + k) % nrThreads_];
+      std::ptrdiff_t begin, end;
+      {
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if(victim.next == victim.end)
+        {
+          continue;
+        }
+        begin = victim.next + (victim.end - victim.next) / 2;
+        end = victim.end;
+        victim.end = begin;
+      }
+      Queue & q = queues_[t];
+      std::lock_guard<std::mutex> lock(q.mutex);
+      c = begin;
+      q.next = begin + 1;
+      q.end = end;
+      return true;
+    }
+    return false;
+  }
+
+private:
+  unsigned nrThreads_;
+  std::vector<Queue> queues_;
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  bool stop_;
+  std::size_t generation_;
+  unsigned active_;
+  std::exception_ptr error_;
+
+  // current job
+  void (*invoke_)(void *, unsigned, std::ptrdiff_t, std::ptrdiff_t);
+  void * job_;
+  std::ptrdiff_t size_;
+  std::ptrdiff_t grain_;
+};
+
+/// Default number of elements of a parallelTransform chunk.
+constexpr std::ptrdiff_t parallelTransformGrain = 4096;
+
+/**
+ * Parallel std::transform: *(d_first + i) = op(*(first + i)) for i in
+ * [0, last - first), with the chunking of ThreadPool::parallelFor.
+ * The iterators must be random access, op must not have side effects.
+ */
+template<typename InputIt, typename OutputIt, typename UnaryOp>
+void parallelTransform(ThreadPool & pool,
+                       InputIt first,
+                       InputIt last,
+                       OutputIt d_first,
+                       UnaryOp op,
+                       std::ptrdiff_t grain = parallelTransformGrain)
+{
+  pool.parallelFor(static_cast<std::ptrdiff_t>(std::distance(first, last)), grain,
+                   [&](unsigned, std::ptrdiff_t begin, std::ptrdiff_t end) {
+                     std::transform(first + begin, first + end, d_first + begin, op);
+                   });
+}
+
+/**
+ * Parallel std::transform: *(d_first + i) = op(*(first1 + i), *(first2 + i))
+ * for i in [0, last1 - first1), with the chunking of ThreadPool::parallelFor.
+ * The iterators must be random access, op must not have side effects.
+ * This overload is discarded when op is a number so that the grain of the
+ * unary overload is not taken for op.
+ */
+template<typename InputIt1, typename InputIt2, typename OutputIt, typename BinaryOp>
+typename std::enable_if<!std::is_arithmetic<BinaryOp>::value>::type parallelTransform(ThreadPool & pool,
+                       InputIt1 first1,
+                       InputIt1 last1,
+                       InputIt2 first2,
+                       OutputIt d_first,
+                       BinaryOp op,
+                       std::ptrdiff_t grain = parallelTransformGrain)
+{
+  pool.parallelFor(static_cast<std::ptrdiff_t>(std::distance(first1, last1)), grain,
+                   [&](unsigned, std::ptrdiff_t begin, std::ptrdiff_t end) {
+                     std::transform(first1 + begin, first1 + end, first2 + begin, d_first + begin, op);
+                   });
+}
+
+} // namespace sva
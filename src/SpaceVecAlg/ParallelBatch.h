@@ -0,0 +1,299 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+#include "Parallel.h"
+#include "SpaceVecAlg"
+
+#include <algorithm>
+#include <cassert>
+#include <type_traits>
+
+namespace sva
+{
+
+namespace sva_internal
+{
+
+/// Base of the batch operations accepted by parallelTransform.
+struct BatchOp
+{
+};
+
+template<typename T>
+inline typename PTransformBatch<T>::index_t batchSize(const PTransform<T> &)
+{
+  return 0;
+}
+
+template<typename Batch>
+inline typename Batch::index_t batchSize(const Batch & b)
+{
+  return b.size();
+}
+
+} // namespace sva_internal
+
+/// Batch X*Y, X*mv and X*f, see PTransformBatch::mul and PTransform::mul.
+struct BatchMul : sva_internal::BatchOp
+{
+  template<typename T>
+  void operator()(const PTransformBatch<T> & X,
+                  const PTransformBatch<T> & Y,
+                  PTransformBatch<T> & result,
+                  typename PTransformBatch<T>::index_t begin,
+                  typename PTransformBatch<T>::index_t end) const
+  {
+    sva_internal::batchMul(X, Y, result, begin, end);
+  }
+
+  template<typename T>
+  void operator()(const PTransformBatch<T> & X,
+                  const PTransform<T> & Y,
+                  PTransformBatch<T> & result,
+                  typename PTransformBatch<T>::index_t begin,
+                  typename PTransformBatch<T>::index_t end) const
+  {
+    sva_internal::batchMul(X, Y, result, begin, end);
+  }
+
+  template<typename T>
+  void operator()(const PTransformBatch<T> & X,
+                  const MotionVecBatch<T> & mv,
+                  MotionVecBatch<T> & result,
+                  typename MotionVecBatch<T>::index_t begin,
+                  typename MotionVecBatch<T>::index_t end) const
+  {
+    sva_internal::batchApply<sva_internal::MotionMulKernel>(sva_internal::BatchLanes<T>(X), mv, result, begin, end);
+  }
+
+  template<typename T>
+  void operator()(const PTransform<T> & X,
+                  const MotionVecBatch<T> & mv,
+                  MotionVecBatch<T> & result,
+                  typename MotionVecBatch<T>::index_t begin,
+                  typename MotionVecBatch<T>::index_t end) const
+  {
+    sva_internal::batchApply<sva_internal::MotionMulKernel>(sva_internal::BroadcastLanes<T>(X), mv, result, begin,
+                                                            end);
+  }
+};
+
+/// Batch X^-1 mv, see PTransformBatch::invMul and PTransform::invMul.
+struct BatchInvMul : sva_internal::BatchOp
+{
+  template<typename T>
+  void operator()(const PTransformBatch<T> & X,
+                  const MotionVecBatch<T> & mv,
+                  MotionVecBatch<T> & result,
+                  typename MotionVecBatch<T>::index_t begin,
+                  typename MotionVecBatch<T>::index_t end) const
+  {
+    sva_internal::batchApply<sva_internal::MotionInvMulKernel>(sva_internal::BatchLanes<T>(X), mv, result, begin,
+                                                               end);
+  }
+
+  template<typename T>
+  void operator()(const PTransform<T> & X,
+                  const MotionVecBatch<T> & mv,
+                  MotionVecBatch<T> & result,
+                  typename MotionVecBatch<T>::index_t begin,
+                  typename MotionVecBatch<T>::index_t end) const
+  {
+    sva_internal::batchApply<sva_internal::MotionInvMulKernel>(sva_internal::BroadcastLanes<T>(X), mv, result, begin,
+                                                               end);
+  }
+};
+
+/// Batch X*f, see PTransformBatch::dualMul and PTransform::dualMul.
+struct BatchDualMul : sva_internal::BatchOp
+{
+  template<typename T>
+  void operator()(const PTransformBatch<T> & X,
+                  const ForceVecBatch<T> & fv,
+                  ForceVecBatch<T> & result,
+                  typename ForceVecBatch<T>::index_t begin,
+                  typename ForceVecBatch<T>::index_t end) const
+  {
+    sva_internal::batchApply<sva_internal::ForceDualMulKernel>(sva_internal::BatchLanes<T>(X), fv, result, begin,
+                                                               end);
+  }
+
+  template<typename T>
+  void operator()(const PTransform<T> & X,
+                  const ForceVecBatch<T> & fv,
+                  ForceVecBatch<T> & result,
+                  typename ForceVecBatch<T>::index_t begin,
+                  typename ForceVecBatch<T>::index_t end) const
+  {
+    sva_internal::batchApply<sva_internal::ForceDualMulKernel>(sva_internal::BroadcastLanes<T>(X), fv, result, begin,
+                                                               end);
+  }
+};
+
+/// Batch X^T f, see PTransformBatch::transMul and PTransform::transMul.
+struct BatchTransMul : sva_internal::BatchOp
+{
+  template<typename T>
+  void operator()(const PTransformBatch<T> & X,
+                  const ForceVecBatch<T> & fv,
+                  ForceVecBatch<T> & result,
+                  typename ForceVecBatch<T>::index_t begin,
+                  typename ForceVecBatch<T>::index_t end) const
+  {
+    sva_internal::batchApply<sva_internal::ForceTransMulKernel>(sva_internal::BatchLanes<T>(X), fv, result, begin,
+                                                                end);
+  }
+
+  template<typename T>
+  void operator()(const PTransform<T> & X,
+                  const ForceVecBatch<T> & fv,
+                  ForceVecBatch<T> & result,
+                  typename ForceVecBatch<T>::index_t begin,
+                  typename ForceVecBatch<T>::index_t end) const
+  {
+    sva_internal::batchApply<sva_internal::ForceTransMulKernel>(sva_internal::BroadcastLanes<T>(X), fv, result, begin,
+                                                                end);
+  }
+};
+
+/// Batch X^-1, see PTransformBatch::inv.
+struct BatchInv : sva_internal::BatchOp
+{
+  template<typename T>
+  void operator()(const PTransformBatch<T> & X,
+                  PTransformBatch<T> & result,
+                  typename PTransformBatch<T>::index_t begin,
+                  typename PTransformBatch<T>::index_t end) const
+  {
+    sva_internal::batchInv(X, result, begin, end);
+  }
+};
+
+/// Batch mv x mv and mv x* f, see MotionVecBatch::cross and MotionVecBatch::crossDual.
+struct BatchCross : sva_internal::BatchOp
+{
+  template<typename T>
+  void operator()(const MotionVecBatch<T> & mv1,
+                  const MotionVecBatch<T> & mv2,
+                  MotionVecBatch<T> & result,
+                  typename MotionVecBatch<T>::index_t begin,
+                  typename MotionVecBatch<T>::index_t end) const
+  {
+    sva_internal::batchCross(mv1, mv2, result, begin, end);
+  }
+
+  template<typename T>
+  void operator()(const MotionVecBatch<T> & mv,
+                  const ForceVecBatch<T> & fv,
+                  ForceVecBatch<T> & result,
+                  typename MotionVecBatch<T>::index_t begin,
+                  typename MotionVecBatch<T>::index_t end) const
+  {
+    sva_internal::batchCrossDual(mv, fv, result, begin, end);
+  }
+};
+
+/// Batch transformVelocity, see transformVelocity(const PTransformBatch<T>&, MotionVecBatch<T>&).
+struct BatchTransformVelocity : sva_internal::BatchOp
+{
+  template<typename T>
+  void operator()(const PTransformBatch<T> & X,
+                  MotionVecBatch<T> & result,
+                  typename PTransformBatch<T>::index_t begin,
+                  typename PTransformBatch<T>::index_t end) const
+  {
+    sva_internal::batchTransformVelocity(X, result, begin, end);
+  }
+};
+
+/**
+ * Batch transformError, see
+ * transformError(const PTransformBatch<T>&, const PTransformBatch<T>&, MotionVecBatch<T>&).
+ */
+struct BatchTransformError : sva_internal::BatchOp
+{
+  template<typename T>
+  void operator()(const PTransformBatch<T> & X_a_b,
+                  const PTransformBatch<T> & X_a_c,
+                  MotionVecBatch<T> & result,
+                  typename PTransformBatch<T>::index_t begin,
+                  typename PTransformBatch<T>::index_t end) const
+  {
+    sva_internal::batchTransformError(X_a_b, X_a_c, result, begin, end);
+  }
+};
+
+/// Batch exp, see exp(const MotionVecBatch<T>&, PTransformBatch<T>&).
+struct BatchExp : sva_internal::BatchOp
+{
+  template<typename T>
+  void operator()(const MotionVecBatch<T> & nu,
+                  PTransformBatch<T> & result,
+                  typename MotionVecBatch<T>::index_t begin,
+                  typename MotionVecBatch<T>::index_t end) const
+  {
+    sva_internal::batchExp(nu, result, begin, end);
+  }
+};
+
+namespace sva_internal
+{
+
+/// @return grain rounded up to a multiple of batchBlockSize.
+inline std::ptrdiff_t batchGrain(std::ptrdiff_t grain)
+{
+  return std::max<std::ptrdiff_t>(1, (grain + batchBlockSize - 1) / batchBlockSize) * batchBlockSize;
+}
+
+} // namespace sva_internal
+
+/**
+ * Compute op(in) on the batch in with the threads of pool, result is resized
+ * if needed and can be in when the serial operation allows it.
+ * The batch is split in chunks of grain elements, rounded up to a multiple of
+ * the block size of the batch kernels, so every element is computed exactly as
+ * by the serial operation: the result is bitwise identical whatever the number
+ * of threads.
+ * @param op One of BatchInv, BatchTransformVelocity or BatchExp.
+ */
+template<typename Op, typename In, typename Out>
+typename std::enable_if<std::is_base_of<sva_internal::BatchOp, Op>::value>::type parallelTransform(
+    ThreadPool & pool,
+    Op op,
+    const In & in,
+    Out & result,
+    std::ptrdiff_t grain = parallelTransformGrain)
+{
+  result.resize(in.size());
+  pool.parallelFor(static_cast<std::ptrdiff_t>(in.size()), sva_internal::batchGrain(grain),
+                   [&](unsigned, std::ptrdiff_t begin, std::ptrdiff_t end) { op(in, result, begin, end); });
+}
+
+/**
+ * Compute op(in1, in2) on the batches in1 and in2 with the threads of pool,
+ * one of them can be a single PTransform, see
+ * parallelTransform(ThreadPool&, Op, const In&, Out&, std::ptrdiff_t).
+ * @param op One of BatchMul, BatchInvMul, BatchDualMul, BatchTransMul,
+ * BatchCross or BatchTransformError.
+ */
+template<typename Op, typename In1, typename In2, typename Out>
+typename std::enable_if<std::is_base_of<sva_internal::BatchOp, Op>::value>::type parallelTransform(
+    ThreadPool & pool,
+    Op op,
+    const In1 & in1,
+    const In2 & in2,
+    Out & result,
+    std::ptrdiff_t grain = parallelTransformGrain)
+{
+  const auto size = std::max(sva_internal::batchSize(in1), sva_internal::batchSize(in2));
+  assert(sva_internal::batchSize(in1) == 0 || sva_internal::batchSize(in1) == size);
+  assert(sva_internal::batchSize(in2) == 0 || sva_internal::batchSize(in2) == size);
+  result.resize(size);
+  pool.parallelFor(static_cast<std::ptrdiff_t>(size), sva_internal::batchGrain(grain),
+                   [&](unsigned, std::ptrdiff_t begin, std::ptrdiff_t end) { op(in1, in2, result, begin, end); });
+}
+
+} // namespace sva
@@ -0,0 +1,282 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+#include "EigenTypedef.h"
+#include "fwd.h"
+
+namespace sva
+{
+
+/**
+ * Compute the 3D rotation vector of the rotation quaternion q_a_b in the 'a' frame.
+ * This is the quaternion counterpart of rotationVelocity(const Eigen::Matrix3<T>&),
+ * q_a_b.matrix() being the rotation matrix expressed in successor frame.
+ */
+template<typename T, int Options>
+Eigen::Vector3<T> rotationVelocity(const Eigen::Quaternion<T, Options> & q_a_b);
+
+/**
+ * Compute the 6D error between two QTransform in the 'a' frame.
+ * @see transformError(const PTransform<T>&, const PTransform<T>&)
+ */
+template<typename T>
+MotionVec<T> transformError(const QTransform<T> & X_a_b, const QTransform<T> & X_a_c);
+
+/**
+ * Compute the motion vector of the transformation X_a_b in the 'a' frame.
+ * @see transformVelocity(const PTransform<T>&)
+ */
+template<typename T>
+MotionVec<T> transformVelocity(const QTransform<T> & X_a_b);
+
+/**
+ * Plücker transform compact representation.
+ * Use an unit quaternion as rotation internal representation, this
+ * transformation is stored with 7 scalars instead of 12 for PTransform.
+ * The rotation matrix of the transformation is rotation().matrix(), the
+ * quaternion is then the one given to the PTransform constructor.
+ * The quaternion is stored unaligned to keep the footprint minimal and to
+ * allow storing QTransform in standard containers.
+ */
+template<typename T>
+class QTransform
+{
+  typedef Eigen::Vector3<T> vector3_t;
+  typedef Eigen::Matrix3<T> matrix3_t;
+  typedef Eigen::Matrix6<T> matrix6_t;
+  typedef Eigen::Quaternion<T, Eigen::DontAlign> quaternion_t;
+
+public:
+  /// Identity transformation.
+  static QTransform<T> Identity()
+  {
+    return QTransform<T>(Eigen::Quaternion<T>::Identity(), vector3_t::Zero());
+  }
+
+public:
+  // Constructors
+  /// Default constructor. Rotation and translation are uninitialized.
+  QTransform() : q_(), r_() {}
+
+  /// Copy constructor.
+  template<typename T2>
+  QTransform(const QTransform<T2> & qt) : q_(qt.rotation().template cast<T>()), r_(qt.translation().template cast<T>())
+  {
+  }
+
+  /// Conversion from a PTransform, the rotation matrix must be orthonormal.
+  explicit QTransform(const PTransform<T> & pt);
+
+  /**
+   * @param rot Rotation quaternion.
+   * @param trans Translation vector.
+   */
+  template<int Options>
+  QTransform(const Eigen::Quaternion<T, Options> & rot, const vector3_t & trans) : q_(rot), r_(trans)
+  {
+  }
+
+  /**
+   * @param rot Rotation matrix.
+   * @param trans Translation vector.
+   */
+  QTransform(const matrix3_t & rot, const vector3_t & trans) : q_(rot), r_(trans) {}
+
+  /**
+   * Rotation only transform.
+   * @param rot Rotation quaternion.
+   */
+  template<int Options>
+  QTransform(const Eigen::Quaternion<T, Options> & rot) : q_(rot), r_(vector3_t::Zero())
+  {
+  }
+
+  /**
+   * Rotation only transform.
+   * @param rot Rotation matrix.
+   */
+  QTransform(const matrix3_t & rot) : q_(rot), r_(vector3_t::Zero()) {}
+
+  /**
+   * Translation only transform.
+   * @param trans Translation vector.
+   */
+  QTransform(const vector3_t & trans) : q_(Eigen::Quaternion<T>::Identity()), r_(trans) {}
+
+  // Accessor
+  /// @return Rotation quaternion.
+  const quaternion_t & rotation() const
+  {
+    return q_;
+  }
+
+  /// @return Rotation quaternion.
+  quaternion_t & rotation()
+  {
+    return q_;
+  }
+
+  /// @return Translation vector.
+  const vector3_t & translation() const
+  {
+    return r_;
+  }
+
+  /// @return Translation vector.
+  vector3_t & translation()
+  {
+    return r_;
+  }
+
+  /// @return Equivalent PTransform.
+  PTransform<T> ptransform() const;
+
+  /// @return Non compact Plücker transformation matrix.
+  matrix6_t matrix() const
+  {
+    const matrix3_t E = q_.toRotationMatrix();
+    matrix6_t m;
+    m << E, matrix3_t::Zero(), -E * vector3ToCrossMatrix(r_), E;
+    return m;
+  }
+
+  /// @return Non compact dual Plücker transformation matrix.
+  matrix6_t dualMatrix() const
+  {
+    const matrix3_t E = q_.toRotationMatrix();
+    matrix6_t m;
+    m << E, -E * vector3ToCrossMatrix(r_), matrix3_t::Zero(), E;
+    return m;
+  }
+
+  template<typename T2>
+  QTransform<T2> cast() const
+  {
+    return QTransform<T2>(*this);
+  }
+
+  // Operators
+  /// @return X*X
+  QTransform<T> operator*(const QTransform<T> & qt) const
+  {
+    return QTransform<T>(q_ * qt.q_, vector3_t(qt.r_ + qt.q_.conjugate() * r_));
+  }
+
+  /// @return Xv
+  MotionVec<T> operator*(const MotionVec<T> & mv) const;
+  /// @see operator*(const MotionVec<T>& mv) const;
+  template<typename Derived>
+  void mul(const Eigen::MatrixBase<Derived> & mv, Eigen::MatrixBase<Derived> & result) const;
+
+  /// @return X^-1 v
+  MotionVec<T> invMul(const MotionVec<T> & mv) const;
+  /// @see invMul
+  template<typename Derived>
+  void invMul(const Eigen::MatrixBase<Derived> & mv, Eigen::MatrixBase<Derived> & result) const;
+
+  /// @return X*v
+  ForceVec<T> dualMul(const ForceVec<T> & fv) const;
+  /// @see dualMul
+  template<typename Derived>
+  void dualMul(const Eigen::MatrixBase<Derived> & fv, Eigen::MatrixBase<Derived> & result) const;
+
+  /// @return Xtv
+  ForceVec<T> transMul(const ForceVec<T> & fv) const;
+  /// @see transMul
+  template<typename Derived>
+  void transMul(const Eigen::MatrixBase<Derived> & fv, Eigen::MatrixBase<Derived> & result) const;
+
+  /// @return X*IX^-1
+  RBInertia<T> dualMul(const RBInertia<T> & rbI) const;
+  /// @return XtIX
+  RBInertia<T> transMul(const RBInertia<T> & rbI) const;
+
+  /// @return X*IX^-1
+  ABInertia<T> dualMul(const ABInertia<T> & rbI) const;
+  /// @return XtIX
+  ABInertia<T> transMul(const ABInertia<T> & rbI) const;
+
+  /// @return Inverse Plücker transformation.
+  QTransform<T> inv() const
+  {
+    return QTransform<T>(q_.conjugate(), vector3_t(-(q_ * r_)));
+  }
+
+  bool operator==(const QTransform<T> & qt) const
+  {
+    return q_.coeffs() == qt.q_.coeffs() && r_ == qt.r_;
+  }
+
+  bool operator!=(const QTransform<T> & qt) const
+  {
+    return q_.coeffs() != qt.q_.coeffs() || r_ != qt.r_;
+  }
+
+private:
+  quaternion_t q_;
+  vector3_t r_;
+};
+
+template<typename T, int Options>
+inline Eigen::Vector3<T> rotationVelocity(const Eigen::Quaternion<T, Options> & q_a_b)
+{
+  using std::atan2;
+  using std::sqrt;
+  typedef typename Eigen::NumTraits<T>::Literal literal_t;
+  constexpr literal_t eps = std::numeric_limits<literal_t>::epsilon();
+  constexpr literal_t sqsqeps = details::sqrt(details::sqrt(eps));
+
+  // q and -q are the same rotation, we choose the one with a positive real part
+  // to get an angle in [0, pi]
+  const T w = q_a_b.w() < T(0) ? -q_a_b.w() : q_a_b.w();
+  const Eigen::Vector3<T> v = q_a_b.w() < T(0) ? Eigen::Vector3<T>(-q_a_b.vec()) : Eigen::Vector3<T>(q_a_b.vec());
+  const T n2 = v.squaredNorm();
+
+  // theta/n with theta = 2*atan2(n, w), the Taylor expansion is used for small angles
+  T theta_n;
+  if(n2 < sqsqeps * sqsqeps)
+  {
+    theta_n = T(2) / w * (T(1) - n2 / (T(3) * w * w));
+  }
+  else
+  {
+    const T n = sqrt(n2);
+    theta_n = T(2) * atan2(n, w) / n;
+  }
+
+  // the rotation matrix is expressed in successor frame
+  return Eigen::Vector3<T>(-theta_n * v);
+}
+
+template<typename T>
+inline MotionVec<T> transformError(const QTransform<T> & X_a_b, const QTransform<T> & X_a_c)
+{
+  QTransform<T> X_b_c = X_a_c * X_a_b.inv();
+  return QTransform<T>(X_a_b.rotation().conjugate()) * transformVelocity(X_b_c);
+}
+
+template<typename T>
+inline MotionVec<T> transformVelocity(const QTransform<T> & X_a_b)
+{
+  return MotionVec<T>(rotationVelocity(X_a_b.rotation()), X_a_b.translation());
+}
+
+// interpolate between transformations, t must be between 0 and 1
+template<typename T>
+QTransform<T> interpolate(const QTransform<T> & from, const QTransform<T> & to, double t)
+{
+  return QTransform<T>(from.rotation().slerp(t, to.rotation()),
+                       Eigen::Vector3<T>(from.translation() * (1. - t) + to.translation() * t));
+}
+
+template<typename T>
+inline std::ostream & operator<<(std::ostream & out, const QTransform<T> & qt)
+{
+  out << qt.matrix();
+  return out;
+}
+
+} // namespace sva
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+#include "EigenTypedef.h"
+#include "fwd.h"
+
+namespace sva
+{
+
+/**
+ * Plücker transform with a null translation.
+ * The operators skip all the translation terms of the PTransform ones.
+ * As for PTransform the rotation is expressed in successor frame.
+ */
+template<typename T>
+class RotationTransform
+{
+  typedef Eigen::Vector3<T> vector3_t;
+  typedef Eigen::Matrix3<T> matrix3_t;
+  typedef Eigen::Matrix6<T> matrix6_t;
+  typedef Eigen::Quaternion<T> quaternion_t;
+
+public:
+  /// Identity transformation.
+  static RotationTransform<T> Identity()
+  {
+    return RotationTransform<T>(matrix3_t::Identity());
+  }
+
+public:
+  // Constructors
+  /// Default constructor. Rotation is uninitialized.
+  RotationTransform() : E_() {}
+
+  /// Copy constructor.
+  template<typename T2>
+  RotationTransform(const RotationTransform<T2> & rt) : E_(rt.rotation().template cast<T>())
+  {
+  }
+
+  /// @param rot Rotation matrix.
+  explicit RotationTransform(const matrix3_t & rot) : E_(rot) {}
+
+  /// @param rot Rotation quaternion.
+  explicit RotationTransform(const quaternion_t & rot) : E_(rot.matrix()) {}
+
+  // Accessor
+  /// @return Rotation matrix.
+  const matrix3_t & rotation() const
+  {
+    return E_;
+  }
+
+  /// @return Rotation matrix.
+  matrix3_t & rotation()
+  {
+    return E_;
+  }
+
+  /// @return Equivalent PTransform.
+  PTransform<T> ptransform() const;
+
+  /// @return Non compact Plücker transformation matrix.
+  matrix6_t matrix() const
+  {
+    matrix6_t m;
+    m << E_, matrix3_t::Zero(), matrix3_t::Zero(), E_;
+    return m;
+  }
+
+  /// @return Non compact dual Plücker transformation matrix.
+  matrix6_t dualMatrix() const
+  {
+    return matrix();
+  }
+
+  template<typename T2>
+  RotationTransform<T2> cast() const
+  {
+    return RotationTransform<T2>(*this);
+  }
+
+  // Operators
+  /// @return X*X
+  RotationTransform<T> operator*(const RotationTransform<T> & rt) const
+  {
+    return RotationTransform<T>(matrix3_t(E_ * rt.E_));
+  }
+
+  /// @return X*X
+  PTransform<T> operator*(const PTransform<T> & pt) const;
+  /// @return X*X
+  PTransform<T> operator*(const TranslationTransform<T> & tt) const;
+
+  /// @return Xv
+  MotionVec<T> operator*(const MotionVec<T> & mv) const;
+  /// @see operator*(const MotionVec<T>& mv) const;
+  template<typename Derived>
+  void mul(const Eigen::MatrixBase<Derived> & mv, Eigen::MatrixBase<Derived> & result) const;
+
+  /// @return X^-1 v
+  MotionVec<T> invMul(const MotionVec<T> & mv) const;
+  /// @see invMul
+  template<typename Derived>
+  void invMul(const Eigen::MatrixBase<Derived> & mv, Eigen::MatrixBase<Derived> & result) const;
+
+  /// @return X*v
+  ForceVec<T> dualMul(const ForceVec<T> & fv) const;
+  /// @see dualMul
+  template<typename Derived>
+  void dualMul(const Eigen::MatrixBase<Derived> & fv, Eigen::MatrixBase<Derived> & result) const;
+
+  /// @return Xtv
+  ForceVec<T> transMul(const ForceVec<T> & fv) const;
+  /// @see transMul
+  template<typename Derived>
+  void transMul(const Eigen::MatrixBase<Derived> & fv, Eigen::MatrixBase<Derived> & result) const;
+
+  /// @return X*IX^-1
+  RBInertia<T> dualMul(const RBInertia<T> & rbI) const;
+  /// @return XtIX
+  RBInertia<T> transMul(const RBInertia<T> & rbI) const;
+
+  /// @return X*IX^-1
+  ABInertia<T> dualMul(const ABInertia<T> & rbI) const;
+  /// @return XtIX
+  ABInertia<T> transMul(const ABInertia<T> & rbI) const;
+
+  /// @return Inverse Plücker transformation.
+  RotationTransform<T> inv() const
+  {
+    return RotationTransform<T>(matrix3_t(E_.transpose()));
+  }
+
+  bool operator==(const RotationTransform<T> & rt) const
+  {
+    return E_ == rt.E_;
+  }
+
+  bool operator!=(const RotationTransform<T> & rt) const
+  {
+    return E_ != rt.E_;
+  }
+
+private:
+  matrix3_t E_;
+};
+
+template<typename T>
+inline std::ostream & operator<<(std::ostream & out, const RotationTransform<T> & rt)
+{
+  out << rt.matrix();
+  return out;
+}
+
+} // namespace sva
@@ -0,0 +1,387 @@
+/*
+ * Copyright 2012-2021 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+#include "EigenTypedef.h"
+#include "fwd.h"
+
+namespace sva
+{
+
+/**
+ * 6x6 matrix with the block structure of the Jacobians of SE(3)
+ * \f$ \begin{bmatrix} D & 0 \\ L & D \end{bmatrix} \f$
+ * acting on motion vectors (angular part first).
+ * Only the diagonal block D and the lower block L are stored.
+ */
+template<typename T>
+class SE3Jacobian
+{
+  typedef Eigen::Matrix3<T> matrix3_t;
+  typedef Eigen::Matrix6<T> matrix6_t;
+
+public:
+  /// Identity matrix.
+  static SE3Jacobian<T> Identity()
+  {
+    return SE3Jacobian<T>(matrix3_t::Identity(), matrix3_t::Zero());
+  }
+
+public:
+  // Constructors
+  /// Default constructor. Blocks are uninitialized.
+  SE3Jacobian() : D_(), L_() {}
+
+  /// Copy constructor.
+  template<typename T2>
+  SE3Jacobian(const SE3Jacobian<T2> & J) : D_(J.D().template cast<T>()), L_(J.L().template cast<T>())
+  {
+  }
+
+  /**
+   * @param D Diagonal block.
+   * @param L Lower block.
+   */
+  SE3Jacobian(const matrix3_t & D, const matrix3_t & L) : D_(D), L_(L) {}
+
+  // Accessor
+  /// @return Diagonal block.
+  const matrix3_t & D() const
+  {
+    return D_;
+  }
+
+  /// @return Diagonal block.
+  matrix3_t & D()
+  {
+    return D_;
+  }
+
+  /// @return Lower block.
+  const matrix3_t & L() const
+  {
+    return L_;
+  }
+
+  /// @return Lower block.
+  matrix3_t & L()
+  {
+    return L_;
+  }
+
+  /// @return Non compact 6x6 matrix.
+  matrix6_t matrix() const
+  {
+    matrix6_t m;
+    m << D_, matrix3_t::Zero(), L_, D_;
+    return m;
+  }
+
+  template<typename T2>
+  SE3Jacobian<T2> cast() const
+  {
+    return SE3Jacobian<T2>(*this);
+  }
+
+  // Operators
+  /// @return J*J
+  SE3Jacobian<T> operator*(const SE3Jacobian<T> & J) const
+  {
+    return SE3Jacobian<T>(matrix3_t(D_ * J.D_), matrix3_t(L_ * J.D_ + D_ * J.L_));
+  }
+
+  /// @return Jv
+  MotionVec<T> operator*(const MotionVec<T> & mv) const;
+
+  /// @return J^T f
+  ForceVec<T> transMul(const ForceVec<T> & fv) const;
+
+  bool operator==(const SE3Jacobian<T> & J) const
+  {
+    return D_ == J.D_ && L_ == J.L_;
+  }
+
+  bool operator!=(const SE3Jacobian<T> & J) const
+  {
+    return !(*this == J);
+  }
+
+private:
+  matrix3_t D_, L_;
+};
+
+/** Right Jacobian of SE(3) as defined in
+ * "A micro Lie theory for state estimation in robotics" by Solà et al. (see in particular eq. 179)
+ * with the motion vector convention of sva (angular part first):
+ * exp(nu + dnu) = exp(SE3RightJac(nu)*dnu)*exp(nu) at first order.
+ * The diagonal block is SO3RightJac(nu.angular()).
+ *
+ * \param nu Point of se(3) at which to compute the matrix.
+ */
+template<typename T>
+SE3Jacobian<T> SE3RightJac(const MotionVec<T> & nu);
+
+/** Left Jacobian of SE(3), see SE3RightJac:
+ * exp(nu + dnu) = exp(nu)*exp(SE3LeftJac(nu)*dnu) at first order.
+ * The diagonal block is SO3LeftJac(nu.angular()).
+ *
+ * \param nu Point of se(3) at which to compute the matrix.
+ */
+template<typename T>
+SE3Jacobian<T> SE3LeftJac(const MotionVec<T> & nu);
+
+/**
+ * Batched version of SE3RightJac(const MotionVec<T>&).
+ * @param result size x 18 lanes, resized if needed. The coefficient D(i, j)
+ * is stored in lane 3*i + j and the coefficient L(i, j) in lane 9 + 3*i + j.
+ */
+template<typename T>
+void SE3RightJac(const MotionVecBatch<T> & nu, Eigen::Matrix<T, Eigen::Dynamic, 18> & result);
+
+/**
+ * Batched version of SE3LeftJac(const MotionVec<T>&).
+ * @param result size x 18 lanes, resized if needed, see
+ * SE3RightJac(const MotionVecBatch<T>&, Eigen::Matrix<T, Eigen::Dynamic, 18>&).
+ */
+template<typename T>
+void SE3LeftJac(const MotionVecBatch<T> & nu, Eigen::Matrix<T, Eigen::Dynamic, 18> & result);
+
+/** Inverse of SE3RightJac(const MotionVec<T>&), that is the SE(3) counterpart of SO3RightJacInv:
+ * the diagonal block is SO3RightJacInv(nu.angular()) and the lower block is -D L D
+ * where L is the lower block of SE3RightJac(nu).
+ *
+ * \param nu Point of se(3) at which to compute the matrix.
+ */
+template<typename T>
+SE3Jacobian<T> SE3RightJacInv(const MotionVec<T> & nu);
+
+/** Inverse of SE3LeftJac(const MotionVec<T>&), see SE3RightJacInv.
+ *
+ * \param nu Point of se(3) at which to compute the matrix.
+ */
+template<typename T>
+SE3Jacobian<T> SE3LeftJacInv(const MotionVec<T> & nu);
+
+/** Derivative w.r.t. time of SE3RightJacInv(const MotionVec<T>&), that is the SE(3) counterpart of SO3RightJacInvDot.
+ *
+ * \param nu Point of se(3) at which to compute the matrix.
+ * \param dnu Derivative w.r.t. time of \p nu.
+ */
+template<typename T>
+SE3Jacobian<T> SE3RightJacInvDot(const MotionVec<T> & nu, const MotionVec<T> & dnu);
+
+/** Derivative w.r.t. time of SE3LeftJacInv(const MotionVec<T>&).
+ *
+ * \param nu Point of se(3) at which to compute the matrix.
+ * \param dnu Derivative w.r.t. time of \p nu.
+ */
+template<typename T>
+SE3Jacobian<T> SE3LeftJacInvDot(const MotionVec<T> & nu, const MotionVec<T> & dnu);
+
+/**
+ * Batched version of SE3RightJacInv(const MotionVec<T>&).
+ * @param result size x 18 lanes, resized if needed, see
+ * SE3RightJac(const MotionVecBatch<T>&, Eigen::Matrix<T, Eigen::Dynamic, 18>&).
+ */
+template<typename T>
+void SE3RightJacInv(const MotionVecBatch<T> & nu, Eigen::Matrix<T, Eigen::Dynamic, 18> & result);
+
+/**
+ * Batched version of SE3LeftJacInv(const MotionVec<T>&).
+ * @param result size x 18 lanes, resized if needed, see
+ * SE3RightJac(const MotionVecBatch<T>&, Eigen::Matrix<T, Eigen::Dynamic, 18>&).
+ */
+template<typename T>
+void SE3LeftJacInv(const MotionVecBatch<T> & nu, Eigen::Matrix<T, Eigen::Dynamic, 18> & result);
+
+/**
+ * Batched version of SE3RightJacInvDot(const MotionVec<T>&, const MotionVec<T>&).
+ * @param result size x 18 lanes, resized if needed, see
+ * SE3RightJac(const MotionVecBatch<T>&, Eigen::Matrix<T, Eigen::Dynamic, 18>&).
+ */
+template<typename T>
+void SE3RightJacInvDot(const MotionVecBatch<T> & nu,
+                       const MotionVecBatch<T> & dnu,
+                       Eigen::Matrix<T, Eigen::Dynamic, 18> & result);
+
+/**
+ * Batched version of SE3LeftJacInvDot(const MotionVec<T>&, const MotionVec<T>&).
+ * @param result size x 18 lanes, resized if needed, see
+ * SE3RightJac(const MotionVecBatch<T>&, Eigen::Matrix<T, Eigen::Dynamic, 18>&).
+ */
+template<typename T>
+void SE3LeftJacInvDot(const MotionVecBatch<T> & nu,
+                      const MotionVecBatch<T> & dnu,
+                      Eigen::Matrix<T, Eigen::Dynamic, 18> & result);
+
+namespace sva_internal
+{
+
+/// @return w a^T + a w^T + [c]x + delta I
+template<typename T>
+inline Eigen::Matrix3<T> symCrossDiag(const Eigen::Vector3<T> & w,
+                                      const Eigen::Vector3<T> & a,
+                                      const Eigen::Vector3<T> & c,
+                                      T delta)
+{
+  Eigen::Matrix3<T> m = w * a.transpose() + a * w.transpose() + vector3ToCrossMatrix(c);
+  m.diagonal().array() += delta;
+  return m;
+}
+
+/**
+ * Lower block of the Jacobian of SE(3) at nu, sign = 1 for the left Jacobian and -1 for the right one.
+ * @param G details::alternatingFactorialFunctions<N>(|nu.angular()|^2) with N >= 5.
+ */
+template<typename T>
+inline Eigen::Matrix3<T> SE3JacL(const MotionVec<T> & nu, const T * G, T sign)
+{
+  const Eigen::Vector3<T> & w = nu.angular();
+  const Eigen::Vector3<T> & v = nu.linear();
+  T g1 = G[0], g2 = G[1], g3 = G[2], g4 = T(0.5) * (G[2] - T(3) * G[3]);
+  T d = w.dot(v);
+  return symCrossDiag<T>(w, g2 * v - g4 * d * w, sign * (g1 * v + d * (T(2) * g3 - g2) * w), d * (g2 - g1));
+}
+
+/**
+ * Jacobian of SE(3) at nu, sign = 1 for the left Jacobian and -1 for the
+ * right one (J_r(nu) = J_l(-nu)).
+ * With w = nu.angular(), v = nu.linear(), theta = |w| and d = w.v the blocks are
+ * D = I + sign g1 [w]x + g2 [w]x^2 and
+ * L = sign (g1 [v]x + d (2 g3 - g2) [w]x) + d (g2 - g1) I + g2 (w v^T + v w^T) - 2 g4 d w w^T
+ * where g1 = G_2, g2 = G_3, g3 = G_4 and g4 = (G_4 - 3 G_5) / 2 with G_N = details::alternatingFactorialFunctions.
+ */
+template<typename T>
+inline SE3Jacobian<T> SE3Jac(const MotionVec<T> & nu, T sign)
+{
+  const Eigen::Vector3<T> & w = nu.angular();
+  T theta2 = w.squaredNorm();
+  T G[4];
+  details::alternatingFactorialFunctions<5>(theta2, G);
+  T g1 = G[0], g2 = G[1];
+
+  // [w]x^2 = w w^T - theta^2 I
+  Eigen::Matrix3<T> D = symCrossDiag<T>(w, T(0.5) * g2 * w, sign * g1 * w, T(1) - g2 * theta2);
+  return SE3Jacobian<T>(D, SE3JacL(nu, G, sign));
+}
+
+/**
+ * Inverse of the diagonal block of the Jacobian of SE(3):
+ * I - sign/2 [w]x + f2 [w]x^2 with f2 = details::SO3JacF2(theta).
+ * @param G details::alternatingFactorialFunctions<N>(theta^2) with N >= 4.
+ */
+template<typename T>
+inline Eigen::Matrix3<T> SE3JacDInv(const Eigen::Vector3<T> & w, const T * G, T sign)
+{
+  T f2 = details::SO3JacF2(G);
+  return symCrossDiag<T>(w, T(0.5) * f2 * w, T(-0.5) * sign * w, T(1) - f2 * w.squaredNorm());
+}
+
+/// Inverse of SE3Jac(nu, sign): [[D^-1, 0], [-D^-1 L D^-1, D^-1]].
+template<typename T>
+inline SE3Jacobian<T> SE3JacInv(const MotionVec<T> & nu, T sign)
+{
+  T G[4];
+  details::alternatingFactorialFunctions<5>(nu.angular().squaredNorm(), G);
+
+  Eigen::Matrix3<T> DInv = SE3JacDInv(nu.angular(), G, sign);
+  Eigen::Matrix3<T> LDInv = SE3JacL(nu, G, sign) * DInv;
+  return SE3Jacobian<T>(DInv, -DInv * LDInv);
+}
+
+/**
+ * Derivative w.r.t. time of SE3JacInv(nu, sign).
+ * With p = w.dw, the derivatives of the coefficients are dG_N/dt = p (N G_{N+2} - G_{N+1}) so that
+ * none of them is divided by theta.
+ */
+template<typename T>
+inline SE3Jacobian<T> SE3JacInvDot(const MotionVec<T> & nu, const MotionVec<T> & dnu, T sign)
+{
+  const Eigen::Vector3<T> & w = nu.angular();
+  const Eigen::Vector3<T> & v = nu.linear();
+  const Eigen::Vector3<T> & dw = dnu.angular();
+  const Eigen::Vector3<T> & dv = dnu.linear();
+  T theta2 = w.squaredNorm();
+  T G[6];
+  details::alternatingFactorialFunctions<7>(theta2, G);
+  T g1 = G[0], g2 = G[1], g3 = G[2], g4 = T(0.5) * (G[2] - T(3) * G[3]);
+
+  T p = w.dot(dw);
+  T d = w.dot(v);
+  T dd = dw.dot(v) + w.dot(dv);
+  T dg1 = p * (T(2) * G[2] - G[1]);
+  T dg2 = p * (T(3) * G[3] - G[2]);
+  T dg3 = p * (T(4) * G[4] - G[3]);
+  T dg4 = T(0.5) * p * (T(7) * G[4] - G[3] - T(15) * G[5]);
+
+  // f2 = (G_3 - 2 G_4) / (2 G_2) and df2/dt = p k
+  T f2 = details::SO3JacF2(G);
+  T k = ((T(5) * G[3] - G[2] - T(8) * G[4]) * G[0] + (G[1] - T(2) * G[2]) * (G[1] - T(2) * G[2]))
+        / (T(2) * G[0] * G[0]);
+  T df2 = p * k;
+
+  Eigen::Matrix3<T> DInv = SE3JacDInv(w, G, sign);
+  Eigen::Matrix3<T> DInvDot =
+      symCrossDiag<T>(w, T(0.5) * df2 * w + f2 * dw, T(-0.5) * sign * dw, -df2 * theta2 - T(2) * f2 * p);
+
+  T c = T(2) * g3 - g2;
+  Eigen::Matrix3<T> L = SE3JacL(nu, G, sign);
+  Eigen::Matrix3<T> LDot = symCrossDiag<T>(w, g2 * dv + dg2 * v - T(2) * g4 * d * dw - (dg4 * d + g4 * dd) * w,
+                                           sign * (g1 * dv + dg1 * v + (dd * c + d * (T(2) * dg3 - dg2)) * w + d * c * dw),
+                                           dd * (g2 - g1) + d * (dg2 - dg1));
+  LDot += g2 * (dw * v.transpose() + v * dw.transpose());
+
+  // d(-D^-1 L D^-1)/dt
+  Eigen::Matrix3<T> LDInv = L * DInv;
+  Eigen::Matrix3<T> LInvDot = -DInvDot * LDInv - DInv * (LDot * DInv + L * DInvDot);
+  return SE3Jacobian<T>(DInvDot, LInvDot);
+}
+
+} // namespace sva_internal
+
+template<typename T>
+inline SE3Jacobian<T> SE3RightJac(const MotionVec<T> & nu)
+{
+  return sva_internal::SE3Jac(nu, T(-1));
+}
+
+template<typename T>
+inline SE3Jacobian<T> SE3LeftJac(const MotionVec<T> & nu)
+{
+  return sva_internal::SE3Jac(nu, T(1));
+}
+
+template<typename T>
+inline SE3Jacobian<T> SE3RightJacInv(const MotionVec<T> & nu)
+{
+  return sva_internal::SE3JacInv(nu, T(-1));
+}
+
+template<typename T>
+inline SE3Jacobian<T> SE3LeftJacInv(const MotionVec<T> & nu)
+{
+  return sva_internal::SE3JacInv(nu, T(1));
+}
+
+template<typename T>
+inline SE3Jacobian<T> SE3RightJacInvDot(const MotionVec<T> & nu, const MotionVec<T> & dnu)
+{
+  return sva_internal::SE3JacInvDot(nu, dnu, T(-1));
+}
+
+template<typename T>
+inline SE3Jacobian<T> SE3LeftJacInvDot(const MotionVec<T> & nu, const MotionVec<T> & dnu)
+{
+  return sva_internal::SE3JacInvDot(nu, dnu, T(1));
+}
+
+template<typename T>
+inline std::ostream & operator<<(std::ostream & out, const SE3Jacobian<T> & J)
+{
+  out << J.matrix();
+  return out;
+}
+
+} // namespace sva
@@ -0,0 +1,232 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+#include "EigenTypedef.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// The SIMD kernels are selected at compile time, they are enabled when the
+// code is compiled for a target supporting AVX and FMA (e.g. -march=haswell,
+// -mavx2 -mfma or any AVX-512 target). Define SVA_NO_SIMD to disable them.
+#if !defined(SVA_NO_SIMD) && defined(__AVX__) && defined(__FMA__)
+#  define SVA_HAS_AVX_KERNELS
+#  include <immintrin.h>
+// the integer kernels also need AVX2
+#  ifdef __AVX2__
+#    define SVA_HAS_AVX2_KERNELS
+#  endif
+#endif
+
+namespace sva
+{
+
+namespace sva_internal
+{
+
+/// True if the Matrix6X operators have a SIMD kernel for matrices of type Derived.
+template<typename Derived>
+struct has_simd_kernels
+: std::integral_constant<bool,
+#ifdef SVA_HAS_AVX_KERNELS
+                         std::is_same<typename Derived::Scalar, double>::value
+                             && (Derived::Flags & Eigen::DirectAccessBit) != 0
+                             && (Derived::Flags & Eigen::RowMajorBit) == 0
+#else
+                         false
+#endif
+                         >
+{
+};
+
+#ifdef SVA_HAS_AVX_KERNELS
+
+/**
+ * Compute, for each column of the column-major 6 x cols matrix in,
+ * out = [P 0; Q P] in if Lower is true and out = [P Q; 0 P] in otherwise.
+ * P and Q are column-major 3x3 matrices.
+ *
+ * Each 3D column of P and Q is kept in a 256 bits register and the output is
+ * computed as a linear combination of those columns with broadcast input
+ * coefficients. The whole input column is read before anything is written so
+ * in and out can be the same matrix.
+ */
+template<bool Lower>
+inline void avxBlockTriangularMul(const double * P,
+                                  const double * Q,
+                                  const double * in,
+                                  std::ptrdiff_t inStride,
+                                  double * out,
+                                  std::ptrdiff_t outStride,
+                                  std::ptrdiff_t cols)
+{
+  const __m256i mask3 = _mm256_set_epi64x(0, -1, -1, -1);
+  const __m256d p0 = _mm256_maskload_pd(P, mask3);
+  const __m256d p1 = _mm256_maskload_pd(P + 3, mask3);
+  const __m256d p2 = _mm256_maskload_pd(P + 6, mask3);
+  const __m256d q0 = _mm256_maskload_pd(Q, mask3);
+  const __m256d q1 = _mm256_maskload_pd(Q + 3, mask3);
+  const __m256d q2 = _mm256_maskload_pd(Q + 6, mask3);
+
+  for(std::ptrdiff_t j = 0; j < cols; ++j, in += inStride, out += outStride)
+  {
+    const __m256d v0 = _mm256_broadcast_sd(in);
+    const __m256d v1 = _mm256_broadcast_sd(in + 1);
+    const __m256d v2 = _mm256_broadcast_sd(in + 2);
+    const __m256d v3 = _mm256_broadcast_sd(in + 3);
+    const __m256d v4 = _mm256_broadcast_sd(in + 4);
+    const __m256d v5 = _mm256_broadcast_sd(in + 5);
+
+    __m256d top = _mm256_fmadd_pd(p2, v2, _mm256_fmadd_pd(p1, v1, _mm256_mul_pd(p0, v0)));
+    __m256d bottom = _mm256_fmadd_pd(p2, v5, _mm256_fmadd_pd(p1, v4, _mm256_mul_pd(p0, v3)));
+    if(Lower)
+    {
+      bottom = _mm256_fmadd_pd(q2, v2, _mm256_fmadd_pd(q1, v1, _mm256_fmadd_pd(q0, v0, bottom)));
+    }
+    else
+    {
+      top = _mm256_fmadd_pd(q2, v5, _mm256_fmadd_pd(q1, v4, _mm256_fmadd_pd(q0, v3, top)));
+    }
+
+    // the 4th lane of top is overwritten by the bottom part
+    _mm256_storeu_pd(out, top);
+    _mm256_maskstore_pd(out + 3, mask3, bottom);
+  }
+}
+
+#endif
+
+#ifdef SVA_HAS_AVX2_KERNELS
+
+/// Convert the 64 bits integers of v, that must be below 2^52, to double.
+inline __m256d avx2SmallUInt64ToDouble(__m256i v)
+{
+  // v is the mantissa of 2^52 + v
+  const __m256d magic = _mm256_set1_pd(4503599627370496.);
+  return _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(v, _mm256_castpd_si256(magic))), magic);
+}
+
+/// Transpose the 4x4 matrix of rows r0, r1, r2 and r3 in place.
+inline void avx2Transpose4(__m256d & r0, __m256d & r1, __m256d & r2, __m256d & r3)
+{
+  const __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+  const __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+  const __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+  const __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+  r0 = _mm256_permute2f128_pd(t0, t2, 0x20);
+  r1 = _mm256_permute2f128_pd(t1, t3, 0x20);
+  r2 = _mm256_permute2f128_pd(t0, t2, 0x31);
+  r3 = _mm256_permute2f128_pd(t1, t3, 0x31);
+}
+
+/// Load 4 words of 64 bits.
+inline __m256i avx2LoadWords(const std::uint64_t * words)
+{
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words));
+}
+
+/// Load 4 words of 32 bits zero extended to 64 bits.
+inline __m256i avx2LoadWords(const std::uint32_t * words)
+{
+  return _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i *>(words)));
+}
+
+/**
+ * Decode the smallest three quaternions words[0, n), whose components are
+ * quantized on bits bits, see CompressedPTransforms, 4 at a time and store
+ * their rotation matrices, in column-major order, in the first 9 coefficients
+ * of out + 12*i.
+ * Each register holds one coefficient of 4 quaternions, the largest component
+ * is put back in place with blends and the rotation matrices are transposed
+ * 4x4 in registers before being stored.
+ * @return Number of decoded quaternions, n rounded down to a multiple of 4.
+ */
+template<typename Word>
+inline std::size_t avx2DecodeSmallestThree(const Word * words, std::size_t n, int bits, double step, double * out)
+{
+  const __m256i mask = _mm256_set1_epi64x((std::int64_t(1) << bits) - 1);
+  const __m128i shift1 = _mm_cvtsi32_si128(2 + bits);
+  const __m128i shift2 = _mm_cvtsi32_si128(2 + 2 * bits);
+  const __m256d vstep = _mm256_set1_pd(step);
+  const __m256d offset = _mm256_set1_pd(0.70710678118654752440);
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d one = _mm256_set1_pd(1.);
+  const __m256d two = _mm256_set1_pd(2.);
+  const __m256d three = _mm256_set1_pd(3.);
+
+  std::size_t i = 0;
+  for(; i + 4 <= n; i += 4, out += 48)
+  {
+    const __m256i w = avx2LoadWords(words + i);
+    const __m256d largest = avx2SmallUInt64ToDouble(_mm256_and_si256(w, _mm256_set1_epi64x(3)));
+    const __m256d a0 =
+        _mm256_fmsub_pd(avx2SmallUInt64ToDouble(_mm256_and_si256(_mm256_srli_epi64(w, 2), mask)), vstep, offset);
+    const __m256d a1 =
+        _mm256_fmsub_pd(avx2SmallUInt64ToDouble(_mm256_and_si256(_mm256_srl_epi64(w, shift1), mask)), vstep, offset);
+    const __m256d a2 =
+        _mm256_fmsub_pd(avx2SmallUInt64ToDouble(_mm256_and_si256(_mm256_srl_epi64(w, shift2), mask)), vstep, offset);
+    __m256d l = _mm256_fnmadd_pd(a0, a0, one);
+    l = _mm256_fnmadd_pd(a1, a1, l);
+    l = _mm256_fnmadd_pd(a2, a2, l);
+    l = _mm256_sqrt_pd(_mm256_max_pd(l, zero));
+
+    // x, y, z, w with the largest component in place
+    const __m256d x = _mm256_blendv_pd(a0, l, _mm256_cmp_pd(largest, zero, _CMP_EQ_OQ));
+    const __m256d y = _mm256_blendv_pd(_mm256_blendv_pd(a0, a1, _mm256_cmp_pd(largest, one, _CMP_GT_OQ)), l,
+                                       _mm256_cmp_pd(largest, one, _CMP_EQ_OQ));
+    const __m256d z = _mm256_blendv_pd(_mm256_blendv_pd(a1, a2, _mm256_cmp_pd(largest, two, _CMP_GT_OQ)), l,
+                                       _mm256_cmp_pd(largest, two, _CMP_EQ_OQ));
+    const __m256d qw = _mm256_blendv_pd(a2, l, _mm256_cmp_pd(largest, three, _CMP_EQ_OQ));
+
+    const __m256d x2 = _mm256_add_pd(x, x);
+    const __m256d y2 = _mm256_add_pd(y, y);
+    const __m256d z2 = _mm256_add_pd(z, z);
+    const __m256d xx = _mm256_mul_pd(x, x2);
+    const __m256d yy = _mm256_mul_pd(y, y2);
+    const __m256d zz = _mm256_mul_pd(z, z2);
+    const __m256d xy = _mm256_mul_pd(x, y2);
+    const __m256d xz = _mm256_mul_pd(x, z2);
+    const __m256d yz = _mm256_mul_pd(y, z2);
+    const __m256d wx = _mm256_mul_pd(qw, x2);
+    const __m256d wy = _mm256_mul_pd(qw, y2);
+    const __m256d wz = _mm256_mul_pd(qw, z2);
+
+    __m256d e0 = _mm256_sub_pd(one, _mm256_add_pd(yy, zz));
+    __m256d e1 = _mm256_add_pd(xy, wz);
+    __m256d e2 = _mm256_sub_pd(xz, wy);
+    __m256d e3 = _mm256_sub_pd(xy, wz);
+    __m256d e4 = _mm256_sub_pd(one, _mm256_add_pd(xx, zz));
+    __m256d e5 = _mm256_add_pd(yz, wx);
+    __m256d e6 = _mm256_add_pd(xz, wy);
+    __m256d e7 = _mm256_sub_pd(yz, wx);
+    const __m256d e8 = _mm256_sub_pd(one, _mm256_add_pd(xx, yy));
+
+    avx2Transpose4(e0, e1, e2, e3);
+    avx2Transpose4(e4, e5, e6, e7);
+    alignas(32) double last[4];
+    _mm256_store_pd(last, e8);
+    _mm256_storeu_pd(out, e0);
+    _mm256_storeu_pd(out + 4, e4);
+    out[8] = last[0];
+    _mm256_storeu_pd(out + 12, e1);
+    _mm256_storeu_pd(out + 16, e5);
+    out[20] = last[1];
+    _mm256_storeu_pd(out + 24, e2);
+    _mm256_storeu_pd(out + 28, e6);
+    out[32] = last[2];
+    _mm256_storeu_pd(out + 36, e3);
+    _mm256_storeu_pd(out + 40, e7);
+    out[44] = last[3];
+  }
+  return i;
+}
+
+#endif
+
+} // namespace sva_internal
+
+} // namespace sva
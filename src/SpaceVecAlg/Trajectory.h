@@ -0,0 +1,719 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+#include "SpaceVecAlg"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+/**
+ * Binary trajectory files: sequences of PTransform, MotionVec, ForceVec or
+ * RBInertia samples, for instance one per control tick, that are written once and
+ * replayed by mapping the file in memory.
+ *
+ * A file is a 64 bytes TrajectoryHeader followed by the samples, each one
+ * stored as its coefficients in the memory layout of the sample type:
+ *  - PTransform: the 9 rotation coefficients in column major order then the 3
+ *    translation coefficients,
+ *  - MotionVec: the angular then the linear motion,
+ *  - ForceVec: the couple then the force,
+ *  - RBInertia: the mass, the first moment of mass then the 9 coefficients of
+ *    the inertia matrix in column major order.
+ * All the samples have the same size so the i-th sample is at a known offset
+ * and the mapped samples can be used in place as an array of the sample type.
+ * Files written by TrajectoryStreamWriter, see TrajectoryStream.h, can instead
+ * store the samples in encoded chunks, the encoding of the samples is given by
+ * the header.
+ */
+
+namespace sva
+{
+
+/// Version of the trajectory file format written by TrajectoryWriter.
+constexpr std::uint32_t trajectoryFormatVersion = 1;
+
+/// Type of the samples of a trajectory file.
+enum class TrajectorySampleType : std::uint32_t
+{
+  PTransform = 1,
+  MotionVec = 2,
+  ForceVec = 3,
+  RBInertia = 4
+};
+
+/// Storage of the samples of a trajectory file.
+enum class TrajectoryEncoding : std::uint32_t
+{
+  /// Samples stored one after the other in the memory layout of the sample type.
+  Raw = 0,
+  /**
+   * Chunks of samples, each chunk starting with a raw sample followed by the
+   * differences of the coefficients of consecutive samples quantized with a
+   * fixed step, see TrajectoryStream.h.
+   */
+  QuantizedDelta = 1
+};
+
+/**
+ * Header of a trajectory file.
+ * The integers are in the byte order of the writer, byteOrder allows to detect
+ * a file written on a machine with another byte order.
+ */
+struct TrajectoryHeader
+{
+  /// "SVATRAJ" followed by a null character.
+  char magic[8];
+  /// Version of the format, see trajectoryFormatVersion.
+  std::uint32_t version;
+  /// 0x01020304 in the byte order of the writer.
+  std::uint32_t byteOrder;
+  /// TrajectorySampleType of the samples.
+  std::uint32_t sampleType;
+  /// Size in bytes of a coefficient, 4 for float and 8 for double.
+  std::uint32_t scalarSize;
+  /// Size in bytes of a sample.
+  std::uint32_t sampleSize;
+  /// TrajectoryEncoding of the samples.
+  std::uint32_t encoding;
+  /// Number of samples.
+  std::uint64_t size;
+  /// Quantization step of the QuantizedDelta encoding, zero otherwise.
+  double quantizationStep;
+  /// Unused, zero.
+  std::uint8_t reserved[16];
+};
+
+static_assert(sizeof(TrajectoryHeader) == 64, "The trajectory header must be 64 bytes");
+
+namespace sva_internal
+{
+
+constexpr char trajectoryMagic[8] = {'S', 'V', 'A', 'T', 'R', 'A', 'J', '\0'};
+constexpr std::uint32_t trajectoryByteOrder = 0x01020304;
+
+/// Sample types that can be stored in a trajectory file.
+template<typename Sample>
+struct trajectory_traits;
+
+template<typename T>
+struct trajectory_traits<PTransform<T>>
+{
+  typedef T scalar_t;
+  enum : int
+  {
+    lanes = 12
+  };
+  static constexpr TrajectorySampleType type = TrajectorySampleType::PTransform;
+};
+
+template<typename T>
+struct trajectory_traits<MotionVec<T>>
+{
+  typedef T scalar_t;
+  enum : int
+  {
+    lanes = 6
+  };
+  static constexpr TrajectorySampleType type = TrajectorySampleType::MotionVec;
+};
+
+template<typename T>
+struct trajectory_traits<ForceVec<T>>
+{
+  typedef T scalar_t;
+  enum : int
+  {
+    lanes = 6
+  };
+  static constexpr TrajectorySampleType type = TrajectorySampleType::ForceVec;
+};
+
+template<typename T>
+struct trajectory_traits<RBInertia<T>>
+{
+  typedef T scalar_t;
+  enum : int
+  {
+    lanes = 13
+  };
+  static constexpr TrajectorySampleType type = TrajectorySampleType::RBInertia;
+};
+
+/// @return Header of an empty trajectory of Sample.
+template<typename Sample>
+inline TrajectoryHeader trajectoryHeader()
+{
+  typedef trajectory_traits<Sample> traits;
+  TrajectoryHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, trajectoryMagic, sizeof(header.magic));
+  header.version = trajectoryFormatVersion;
+  header.byteOrder = trajectoryByteOrder;
+  header.sampleType = static_cast<std::uint32_t>(traits::type);
+  header.scalarSize = sizeof(typename traits::scalar_t);
+  header.sampleSize = sizeof(Sample);
+  return header;
+}
+
+/**
+ * @return true if header is the header of a trajectory file of Sample, in the
+ * byte order of this machine and with a version that can be read.
+ */
+template<typename Sample>
+inline bool isTrajectoryHeaderOf(const TrajectoryHeader & header)
+{
+  const TrajectoryHeader expected = trajectoryHeader<Sample>();
+  return std::memcmp(header.magic, expected.magic, sizeof(header.magic)) == 0 && header.version != 0
+         && header.version <= trajectoryFormatVersion && header.byteOrder == expected.byteOrder
+         && header.sampleType == expected.sampleType && header.scalarSize == expected.scalarSize
+         && header.sampleSize == expected.sampleSize;
+}
+
+/// Read only mapping of a whole file in memory.
+class MemoryMap
+{
+public:
+  MemoryMap() : data_(nullptr), size_(0) {}
+
+  MemoryMap(const MemoryMap &) = delete;
+  MemoryMap & operator=(const MemoryMap &) = delete;
+
+  ~MemoryMap()
+  {
+    close();
+  }
+
+  /// Map the file path, @return false if the file can not be mapped or is empty.
+  bool open(const std::string & path)
+  {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+    {
+      return false;
+    }
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+      CloseHandle(file);
+      return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if(mapping == nullptr)
+    {
+      return false;
+    }
+    // the view keeps the mapping alive
+    data_ = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if(data_ == nullptr)
+    {
+      return false;
+    }
+    size_ = static_cast<std::size_t>(size.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+      return false;
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+      ::close(fd);
+      return false;
+    }
+    // the mapping stays valid once the file is closed
+    void * data = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(data == MAP_FAILED)
+    {
+      return false;
+    }
+    data_ = data;
+    size_ = static_cast<std::size_t>(st.st_size);
+#endif
+    return true;
+  }
+
+  void close()
+  {
+    if(data_ != nullptr)
+    {
+#ifdef _WIN32
+      UnmapViewOfFile(data_);
+#else
+      munmap(data_, size_);
+#endif
+    }
+    data_ = nullptr;
+    size_ = 0;
+  }
+
+  const void * data() const
+  {
+    return data_;
+  }
+
+  std::size_t size() const
+  {
+    return size_;
+  }
+
+private:
+  void * data_;
+  std::size_t size_;
+};
+
+} // namespace sva_internal
+
+/**
+ * View of a contiguous array of samples, for instance the samples of a
+ * MappedTrajectory, in array of structures layout (the samples themselves) or
+ * in structure of arrays layout (one strided lane per coefficient).
+ * The view does not own the samples.
+ */
+template<typename Sample>
+class TrajectoryView
+{
+  typedef sva_internal::trajectory_traits<Sample> traits;
+
+public:
+  typedef typename traits::scalar_t scalar_t;
+  enum : int
+  {
+    /// Number of coefficients of a sample.
+    Lanes = traits::lanes
+  };
+  /// Coefficient of all the samples.
+  typedef Eigen::Map<const Eigen::Matrix<scalar_t, Eigen::Dynamic, 1>, 0, Eigen::InnerStride<Lanes>> lane_t;
+  /// size x Lanes matrix of the coefficients, one sample per row.
+  typedef Eigen::Map<const Eigen::Matrix<scalar_t, Eigen::Dynamic, Lanes>, 0, Eigen::Stride<1, Lanes>> lanes_t;
+
+  static_assert(sizeof(Sample) == Lanes * sizeof(scalar_t), "The samples must be stored as contiguous coefficients");
+
+public:
+  TrajectoryView() : data_(nullptr), size_(0) {}
+
+  /// @param data Array of size samples.
+  TrajectoryView(const Sample * data, std::size_t size) : data_(data), size_(size) {}
+
+  // Accessor
+  /// @return Number of samples.
+  std::size_t size() const
+  {
+    return size_;
+  }
+
+  bool empty() const
+  {
+    return size_ == 0;
+  }
+
+  const Sample & operator[](std::size_t i) const
+  {
+    assert(i < size_);
+    return data_[i];
+  }
+
+  const Sample * begin() const
+  {
+    return data_;
+  }
+
+  const Sample * end() const
+  {
+    return data_ + size_;
+  }
+
+  /// @return View of the samples [start, start + n).
+  TrajectoryView<Sample> segment(std::size_t start, std::size_t n) const
+  {
+    assert(start + n <= size_);
+    return TrajectoryView<Sample>(data_ + start, n);
+  }
+
+  /**
+   * @return Lane of the k-th coefficient of the samples, see the layout of the
+   * samples in Trajectory.h.
+   */
+  lane_t lane(int k) const
+  {
+    return lane_t(coeffs() + k, static_cast<Eigen::Index>(size_));
+  }
+
+  /// @return All the lanes as a size x Lanes matrix.
+  lanes_t lanes() const
+  {
+    return lanes_t(coeffs(), static_cast<Eigen::Index>(size_), Lanes);
+  }
+
+private:
+  const scalar_t * coeffs() const
+  {
+    return reinterpret_cast<const scalar_t *>(data_);
+  }
+
+private:
+  const Sample * data_;
+  std::size_t size_;
+};
+
+/**
+ * Write a trajectory file sample by sample or by arrays of samples.
+ * The number of samples is written in the header by close.
+ */
+template<typename Sample>
+class TrajectoryWriter
+{
+public:
+  TrajectoryWriter() : file_(nullptr), size_(0) {}
+
+  /// @see open
+  explicit TrajectoryWriter(const std::string & path) : TrajectoryWriter()
+  {
+    open(path);
+  }
+
+  TrajectoryWriter(const TrajectoryWriter &) = delete;
+  TrajectoryWriter & operator=(const TrajectoryWriter &) = delete;
+
+  /// Close the file, see close.
+  ~TrajectoryWriter()
+  {
+    close();
+  }
+
+  /**
+   * Create or truncate the file path and write the header of an empty trajectory.
+   * @return false if the file can not be written.
+   */
+  bool open(const std::string & path)
+  {
+    close();
+    file_ = std::fopen(path.c_str(), "wb");
+    if(file_ == nullptr)
+    {
+      return false;
+    }
+    size_ = 0;
+    const TrajectoryHeader header = sva_internal::trajectoryHeader<Sample>();
+    if(std::fwrite(&header, sizeof(header), 1, file_) != 1)
+    {
+      std::fclose(file_);
+      file_ = nullptr;
+      return false;
+    }
+    return true;
+  }
+
+  bool isOpen() const
+  {
+    return file_ != nullptr;
+  }
+
+  /// @return Number of samples written.
+  std::size_t size() const
+  {
+    return size_;
+  }
+
+  /// Append n samples, @return false on write error.
+  bool write(const Sample * samples, std::size_t n)
+  {
+    assert(isOpen());
+    const std::size_t written = std::fwrite(samples, sizeof(Sample), n, file_);
+    size_ += written;
+    return written == n;
+  }
+
+  /// Append a sample, @return false on write error.
+  bool write(const Sample & sample)
+  {
+    return write(&sample, 1);
+  }
+
+  /// Append the samples, @return false on write error.
+  bool write(const std::vector<Sample> & samples)
+  {
+    return write(samples.data(), samples.size());
+  }
+
+  /// Append the samples of a PTransformBatch, MotionVecBatch or ForceVecBatch, @return false on write error.
+  template<typename Batch>
+  bool writeBatch(const Batch & batch)
+  {
+    Sample block[sva_internal::batchBlockSize];
+    for(typename Batch::index_t start = 0; start < batch.size(); start += sva_internal::batchBlockSize)
+    {
+      const typename Batch::index_t n = std::min<typename Batch::index_t>(sva_internal::batchBlockSize, batch.size() - start);
+      for(typename Batch::index_t i = 0; i < n; ++i)
+      {
+        block[i] = batch[start + i];
+      }
+      if(!write(block, static_cast<std::size_t>(n)))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Write the number of samples in the header and close the file.
+   * @return false if the file could not be completed.
+   */
+  bool close()
+  {
+    if(file_ == nullptr)
+    {
+      return true;
+    }
+    const std::uint64_t size = size_;
+    bool ok = std::fseek(file_, static_cast<long>(offsetof(TrajectoryHeader, size)), SEEK_SET) == 0
+              && std::fwrite(&size, sizeof(size), 1, file_) == 1;
+    ok = std::fclose(file_) == 0 && ok;
+    file_ = nullptr;
+    return ok;
+  }
+
+private:
+  std::FILE * file_;
+  std::size_t size_;
+};
+
+/**
+ * Read only trajectory file mapped in memory.
+ * Opening a file does not read the samples, the pages are loaded by the system
+ * when the samples are accessed, so a recording larger than the memory can be
+ * replayed.
+ */
+template<typename Sample>
+class MappedTrajectory
+{
+public:
+  MappedTrajectory() : map_(), view_() {}
+
+  /// @see open
+  explicit MappedTrajectory(const std::string & path) : MappedTrajectory()
+  {
+    open(path);
+  }
+
+  MappedTrajectory(const MappedTrajectory &) = delete;
+  MappedTrajectory & operator=(const MappedTrajectory &) = delete;
+
+  /**
+   * Map the trajectory file path.
+   * @return false if the file can not be mapped, is not a raw trajectory file
+   * of Sample in the byte order of this machine, has a newer version or is truncated.
+   */
+  bool open(const std::string & path)
+  {
+    close();
+    if(!map_.open(path) || map_.size() < sizeof(TrajectoryHeader))
+    {
+      map_.close();
+      return false;
+    }
+    const TrajectoryHeader & h = header();
+    if(!sva_internal::isTrajectoryHeaderOf<Sample>(h) || h.encoding != static_cast<std::uint32_t>(TrajectoryEncoding::Raw)
+       || h.size > (map_.size() - sizeof(TrajectoryHeader)) / sizeof(Sample))
+    {
+      map_.close();
+      return false;
+    }
+    const char * samples = static_cast<const char *>(map_.data()) + sizeof(TrajectoryHeader);
+    view_ = TrajectoryView<Sample>(reinterpret_cast<const Sample *>(samples), static_cast<std::size_t>(h.size));
+    return true;
+  }
+
+  /// Unmap the file, the views of the samples become invalid.
+  void close()
+  {
+    map_.close();
+    view_ = TrajectoryView<Sample>();
+  }
+
+  bool isOpen() const
+  {
+    return map_.data() != nullptr;
+  }
+
+  /// @return Header of the file, the file must be open.
+  const TrajectoryHeader & header() const
+  {
+    assert(isOpen());
+    return *static_cast<const TrajectoryHeader *>(map_.data());
+  }
+
+  /// @return Number of samples.
+  std::size_t size() const
+  {
+    return view_.size();
+  }
+
+  const Sample & operator[](std::size_t i) const
+  {
+    return view_[i];
+  }
+
+  const Sample * begin() const
+  {
+    return view_.begin();
+  }
+
+  const Sample * end() const
+  {
+    return view_.end();
+  }
+
+  /// @return View of all the samples.
+  const TrajectoryView<Sample> & view() const
+  {
+    return view_;
+  }
+
+  /// @return View of the samples [start, start + n).
+  TrajectoryView<Sample> view(std::size_t start, std::size_t n) const
+  {
+    return view_.segment(start, n);
+  }
+
+private:
+  sva_internal::MemoryMap map_;
+  TrajectoryView<Sample> view_;
+};
+
+namespace sva_internal
+{
+
+/**
+ * Coefficients of the transformations of a TrajectoryView for the batch
+ * kernels, see BatchLanes. Each block is gathered from the strided samples in
+ * a contiguous scratch block.
+ */
+template<typename T>
+class TrajectoryLanes
+{
+public:
+  typedef Eigen::Index index_t;
+  typedef decltype(std::declval<const BatchBlock<T, 12> &>().col(0).array()) lane_t;
+
+public:
+  TrajectoryLanes(const TrajectoryView<PTransform<T>> & X) : X_(X), block_() {}
+
+  void setBlock(index_t start, index_t n)
+  {
+    block_ = X_.lanes().middleRows(start, n);
+  }
+
+  lane_t E(int row, int col) const
+  {
+    return block_.col(3 * col + row).array();
+  }
+
+  lane_t r(int i) const
+  {
+    return block_.col(9 + i).array();
+  }
+
+private:
+  TrajectoryView<PTransform<T>> X_;
+  BatchBlock<T, 12> block_;
+};
+
+} // namespace sva_internal
+
+/// Copy the transformations of X in result, result is resized if needed.
+template<typename T>
+inline void toBatch(const TrajectoryView<PTransform<T>> & X, PTransformBatch<T> & result)
+{
+  result.resize(static_cast<Eigen::Index>(X.size()));
+  for(int i = 0; i < 3; ++i)
+  {
+    for(int j = 0; j < 3; ++j)
+    {
+      result.rotation(i, j) = X.lane(3 * j + i);
+    }
+    result.translation(i) = X.lane(9 + i);
+  }
+}
+
+/// Copy the motion vectors of mv in result, result is resized if needed.
+template<typename T>
+inline void toBatch(const TrajectoryView<MotionVec<T>> & mv, MotionVecBatch<T> & result)
+{
+  result.resize(static_cast<Eigen::Index>(mv.size()));
+  result.data() = mv.lanes();
+}
+
+/// Copy the force vectors of fv in result, result is resized if needed.
+template<typename T>
+inline void toBatch(const TrajectoryView<ForceVec<T>> & fv, ForceVecBatch<T> & result)
+{
+  result.resize(static_cast<Eigen::Index>(fv.size()));
+  result.data() = fv.lanes();
+}
+
+/**
+ * X_i*v_i for the transformations of X, without copying X in a PTransformBatch.
+ * result is resized if needed and can be mvb.
+ */
+template<typename T>
+inline void mul(const TrajectoryView<PTransform<T>> & X, const MotionVecBatch<T> & mvb, MotionVecBatch<T> & result)
+{
+  assert(static_cast<std::size_t>(mvb.size()) == X.size());
+  sva_internal::batchApply<sva_internal::MotionMulKernel>(sva_internal::TrajectoryLanes<T>(X), mvb, result);
+}
+
+/// X_i^-1 v_i for the transformations of X, see mul.
+template<typename T>
+inline void invMul(const TrajectoryView<PTransform<T>> & X, const MotionVecBatch<T> & mvb, MotionVecBatch<T> & result)
+{
+  assert(static_cast<std::size_t>(mvb.size()) == X.size());
+  sva_internal::batchApply<sva_internal::MotionInvMulKernel>(sva_internal::TrajectoryLanes<T>(X), mvb, result);
+}
+
+/// X_i*f_i for the transformations of X, see mul.
+template<typename T>
+inline void dualMul(const TrajectoryView<PTransform<T>> & X, const ForceVecBatch<T> & fvb, ForceVecBatch<T> & result)
+{
+  assert(static_cast<std::size_t>(fvb.size()) == X.size());
+  sva_internal::batchApply<sva_internal::ForceDualMulKernel>(sva_internal::TrajectoryLanes<T>(X), fvb, result);
+}
+
+/// X_i^T f_i for the transformations of X, see mul.
+template<typename T>
+inline void transMul(const TrajectoryView<PTransform<T>> & X, const ForceVecBatch<T> & fvb, ForceVecBatch<T> & result)
+{
+  assert(static_cast<std::size_t>(fvb.size()) == X.size());
+  sva_internal::batchApply<sva_internal::ForceTransMulKernel>(sva_internal::TrajectoryLanes<T>(X), fvb, result);
+}
+
+} // namespace sva
@@ -0,0 +1,601 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+#include "Trajectory.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Streaming of trajectory files, see Trajectory.h, by chunks of samples.
+ * Only two chunks of samples are in memory at any time: while the user fills
+ * or processes one of them, a background thread writes or reads the other one,
+ * so arbitrarily long recordings are processed in constant memory with the
+ * file I/O overlapping the computation.
+ *
+ * With the Raw encoding the stream writes the same file as TrajectoryWriter,
+ * that can also be read with MappedTrajectory.
+ * With the QuantizedDelta encoding each chunk is stored as:
+ *  - the number of samples and the number of bytes of the chunk data as two
+ *    32 bits unsigned integers,
+ *  - the first sample of the chunk in the Raw encoding,
+ *  - for each following sample and each coefficient, the difference with the
+ *    decoded coefficient of the previous sample divided by the quantization
+ *    step and rounded to the nearest integer, as a zigzag variable length
+ *    integer (7 bits per byte).
+ * The quantization is done against the decoded samples so the errors do not
+ * accumulate: each decoded coefficient is within half a quantization step of
+ * the written one. Slowly varying signals need one or two bytes per coefficient
+ * instead of the 8 bytes of a double. The coefficients must be finite.
+ */
+
+namespace sva
+{
+
+/// Default number of samples of a trajectory stream chunk.
+constexpr std::size_t trajectoryChunkSize = 4096;
+
+namespace sva_internal
+{
+
+/// Append the zigzag variable length encoding of q to out.
+inline void putVarint(std::int64_t q, std::vector<std::uint8_t> & out)
+{
+  std::uint64_t z = (static_cast<std::uint64_t>(q) << 1) ^ static_cast<std::uint64_t>(q >> 63);
+  while(z >= 0x80)
+  {
+    out.push_back(static_cast<std::uint8_t>(z | 0x80));
+    z >>= 7;
+  }
+  out.push_back(static_cast<std::uint8_t>(z));
+}
+
+/// Read a zigzag variable length integer in [p, end) and advance p, @return false if the data is invalid.
+inline bool getVarint(const std::uint8_t *& p, const std::uint8_t * end, std::int64_t & q)
+{
+  std::uint64_t z = 0;
+  for(int shift = 0; shift < 64; shift += 7)
+  {
+    if(p == end)
+    {
+      return false;
+    }
+    const std::uint8_t b = *p++;
+    z |= static_cast<std::uint64_t>(b & 0x7f) << shift;
+    if((b & 0x80) == 0)
+    {
+      q = static_cast<std::int64_t>((z >> 1) ^ (0 - (z & 1)));
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Encode n samples of Lanes coefficients with the QuantizedDelta encoding, the
+ * chunk data is stored in out.
+ */
+template<int Lanes, typename T>
+inline void encodeQuantizedDelta(const T * coeffs, std::size_t n, T step, std::vector<std::uint8_t> & out)
+{
+  out.clear();
+  if(n == 0)
+  {
+    return;
+  }
+  const std::uint8_t * first = reinterpret_cast<const std::uint8_t *>(coeffs);
+  out.insert(out.end(), first, first + Lanes * sizeof(T));
+  T prev[Lanes];
+  std::copy(coeffs, coeffs + Lanes, prev);
+  for(std::size_t i = 1; i < n; ++i)
+  {
+    const T * c = coeffs + i * Lanes;
+    for(int k = 0; k < Lanes; ++k)
+    {
+      const std::int64_t q = std::llround((c[k] - prev[k]) / step);
+      // same operations as the decoder so prev is the decoded coefficient
+      prev[k] += static_cast<T>(q) * step;
+      putVarint(q, out);
+    }
+  }
+}
+
+/**
+ * Decode the chunk data [data, data + bytes) of n samples of Lanes coefficients
+ * encoded by encodeQuantizedDelta in coeffs.
+ * @return false if the data is invalid.
+ */
+template<int Lanes, typename T>
+inline bool decodeQuantizedDelta(const std::uint8_t * data, std::size_t bytes, std::size_t n, T step, T * coeffs)
+{
+  if(n == 0)
+  {
+    return bytes == 0;
+  }
+  if(bytes < Lanes * sizeof(T))
+  {
+    return false;
+  }
+  std::memcpy(coeffs, data, Lanes * sizeof(T));
+  const std::uint8_t * p = data + Lanes * sizeof(T);
+  const std::uint8_t * end = data + bytes;
+  T prev[Lanes];
+  std::copy(coeffs, coeffs + Lanes, prev);
+  for(std::size_t i = 1; i < n; ++i)
+  {
+    T * c = coeffs + i * Lanes;
+    for(int k = 0; k < Lanes; ++k)
+    {
+      std::int64_t q;
+      if(!getVarint(p, end, q))
+      {
+        return false;
+      }
+      prev[k] += static_cast<T>(q) * step;
+      c[k] = prev[k];
+    }
+  }
+  return p == end;
+}
+
+/// Header of a QuantizedDelta chunk.
+struct TrajectoryChunkHeader
+{
+  std::uint32_t size;
+  std::uint32_t bytes;
+};
+
+} // namespace sva_internal
+
+/**
+ * Write a trajectory file by chunks of samples.
+ * Samples are buffered until a chunk is full, the chunk is then encoded and
+ * written by a background thread while the next chunk is filled.
+ * The file is complete once close has been called, by the user or by the
+ * destructor.
+ */
+template<typename Sample>
+class TrajectoryStreamWriter
+{
+  typedef sva_internal::trajectory_traits<Sample> traits;
+  typedef typename traits::scalar_t scalar_t;
+
+public:
+  TrajectoryStreamWriter()
+  : file_(nullptr), header_(), chunkSize_(trajectoryChunkSize), size_(0), pending_(false), stop_(false), error_(false)
+  {
+  }
+
+  /// @see open
+  explicit TrajectoryStreamWriter(const std::string & path,
+                                  TrajectoryEncoding encoding = TrajectoryEncoding::Raw,
+                                  double quantizationStep = 0.,
+                                  std::size_t chunkSize = trajectoryChunkSize)
+  : TrajectoryStreamWriter()
+  {
+    open(path, encoding, quantizationStep, chunkSize);
+  }
+
+  TrajectoryStreamWriter(const TrajectoryStreamWriter &) = delete;
+  TrajectoryStreamWriter & operator=(const TrajectoryStreamWriter &) = delete;
+
+  /// Flush and close the file, see close.
+  ~TrajectoryStreamWriter()
+  {
+    close();
+  }
+
+  /**
+   * Create or truncate the file path, write the header of an empty trajectory
+   * and start the writing thread.
+   * @param encoding Encoding of the samples.
+   * @param quantizationStep Quantization step of the QuantizedDelta encoding,
+   * must be strictly positive with this encoding, ignored otherwise.
+   * @param chunkSize Number of samples of a chunk.
+   * @return false if the file can not be written.
+   */
+  bool open(const std::string & path,
+            TrajectoryEncoding encoding = TrajectoryEncoding::Raw,
+            double quantizationStep = 0.,
+            std::size_t chunkSize = trajectoryChunkSize)
+  {
+    close();
+    assert(chunkSize > 0 && chunkSize <= UINT32_MAX);
+    assert(encoding == TrajectoryEncoding::Raw || quantizationStep > 0.);
+    if(encoding == TrajectoryEncoding::QuantizedDelta && !(quantizationStep > 0.))
+    {
+      return false;
+    }
+    file_ = std::fopen(path.c_str(), "wb");
+    if(file_ == nullptr)
+    {
+      return false;
+    }
+    header_ = sva_internal::trajectoryHeader<Sample>();
+    header_.encoding = static_cast<std::uint32_t>(encoding);
+    header_.quantizationStep = encoding == TrajectoryEncoding::Raw ? 0. : quantizationStep;
+    if(std::fwrite(&header_, sizeof(header_), 1, file_) != 1)
+    {
+      std::fclose(file_);
+      file_ = nullptr;
+      return false;
+    }
+    chunkSize_ = chunkSize;
+    size_ = 0;
+    pending_ = false;
+    stop_ = false;
+    error_ = false;
+    front_.clear();
+    front_.reserve(chunkSize_);
+    back_.clear();
+    back_.reserve(chunkSize_);
+    io_ = std::thread([this]() { ioLoop(); });
+    return true;
+  }
+
+  bool isOpen() const
+  {
+    return file_ != nullptr;
+  }
+
+  /// @return Number of samples written.
+  std::size_t size() const
+  {
+    return size_;
+  }
+
+  /// Append a sample, @return false if a previous chunk could not be written.
+  bool write(const Sample & sample)
+  {
+    assert(isOpen());
+    front_.push_back(sample);
+    ++size_;
+    if(front_.size() == chunkSize_)
+    {
+      return flush();
+    }
+    return true;
+  }
+
+  /// Append n samples, @return false if a previous chunk could not be written.
+  bool write(const Sample * samples, std::size_t n)
+  {
+    bool ok = true;
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      ok = write(samples[i]) && ok;
+    }
+    return ok;
+  }
+
+  /// Append the samples, @return false if a previous chunk could not be written.
+  bool write(const std::vector<Sample> & samples)
+  {
+    return write(samples.data(), samples.size());
+  }
+
+  /**
+   * Write the last chunk, stop the writing thread, write the number of samples
+   * in the header and close the file.
+   * @return false if the file could not be completed.
+   */
+  bool close()
+  {
+    if(file_ == nullptr)
+    {
+      return true;
+    }
+    if(!front_.empty())
+    {
+      flush();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    io_.join();
+    const std::uint64_t size = size_;
+    bool ok = !error_ && std::fseek(file_, static_cast<long>(offsetof(TrajectoryHeader, size)), SEEK_SET) == 0
+              && std::fwrite(&size, sizeof(size), 1, file_) == 1;
+    ok = std::fclose(file_) == 0 && ok;
+    file_ = nullptr;
+    return ok;
+  }
+
+private:
+  /// Hand the current chunk to the writing thread, wait for the previous one if needed.
+  bool flush()
+  {
+    bool ok;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() { return !pending_; });
+      front_.swap(back_);
+      pending_ = true;
+      ok = !error_;
+    }
+    cv_.notify_all();
+    front_.clear();
+    return ok;
+  }
+
+  void ioLoop()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for(;;)
+    {
+      cv_.wait(lock, [this]() { return pending_ || stop_; });
+      if(!pending_)
+      {
+        return;
+      }
+      lock.unlock();
+      const bool ok = writeChunk();
+      lock.lock();
+      error_ = error_ || !ok;
+      pending_ = false;
+      cv_.notify_all();
+    }
+  }
+
+  /// Encode and write back_.
+  bool writeChunk()
+  {
+    if(header_.encoding == static_cast<std::uint32_t>(TrajectoryEncoding::Raw))
+    {
+      return std::fwrite(back_.data(), sizeof(Sample), back_.size(), file_) == back_.size();
+    }
+    sva_internal::encodeQuantizedDelta<traits::lanes>(reinterpret_cast<const scalar_t *>(back_.data()), back_.size(),
+                                                      static_cast<scalar_t>(header_.quantizationStep), encoded_);
+    assert(encoded_.size() <= UINT32_MAX);
+    const sva_internal::TrajectoryChunkHeader chunk = {static_cast<std::uint32_t>(back_.size()),
+                                                       static_cast<std::uint32_t>(encoded_.size())};
+    return std::fwrite(&chunk, sizeof(chunk), 1, file_) == 1
+           && std::fwrite(encoded_.data(), 1, encoded_.size(), file_) == encoded_.size();
+  }
+
+private:
+  std::FILE * file_;
+  TrajectoryHeader header_;
+  std::size_t chunkSize_;
+  std::size_t size_;
+
+  /// Chunk filled by the user.
+  std::vector<Sample> front_;
+  /// Chunk written by the writing thread when pending_ is true.
+  std::vector<Sample> back_;
+  std::vector<std::uint8_t> encoded_;
+
+  std::thread io_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool pending_;
+  bool stop_;
+  bool error_;
+};
+
+/**
+ * Read a trajectory file, in any encoding, by chunks of samples.
+ * next returns the chunks one after the other, while the user processes a
+ * chunk the following one is read and decoded by a background thread.
+ */
+template<typename Sample>
+class TrajectoryStreamReader
+{
+  typedef sva_internal::trajectory_traits<Sample> traits;
+  typedef typename traits::scalar_t scalar_t;
+
+public:
+  TrajectoryStreamReader()
+  : file_(nullptr), header_(), chunkSize_(trajectoryChunkSize), remaining_(0), ready_(false), stop_(false),
+    error_(false)
+  {
+  }
+
+  /// @see open
+  explicit TrajectoryStreamReader(const std::string & path, std::size_t chunkSize = trajectoryChunkSize)
+  : TrajectoryStreamReader()
+  {
+    open(path, chunkSize);
+  }
+
+  TrajectoryStreamReader(const TrajectoryStreamReader &) = delete;
+  TrajectoryStreamReader & operator=(const TrajectoryStreamReader &) = delete;
+
+  ~TrajectoryStreamReader()
+  {
+    close();
+  }
+
+  /**
+   * Open the trajectory file path and start reading the first chunk.
+   * @param chunkSize Number of samples of a chunk for the Raw encoding, the
+   * chunks of the QuantizedDelta encoding are the ones of the writer.
+   * @return false if the file can not be read or is not a trajectory file of
+   * Sample in the byte order of this machine with a version and an encoding
+   * that can be read.
+   */
+  bool open(const std::string & path, std::size_t chunkSize = trajectoryChunkSize)
+  {
+    close();
+    assert(chunkSize > 0);
+    file_ = std::fopen(path.c_str(), "rb");
+    if(file_ == nullptr)
+    {
+      return false;
+    }
+    if(std::fread(&header_, sizeof(header_), 1, file_) != 1 || !sva_internal::isTrajectoryHeaderOf<Sample>(header_)
+       || (header_.encoding != static_cast<std::uint32_t>(TrajectoryEncoding::Raw)
+           && header_.encoding != static_cast<std::uint32_t>(TrajectoryEncoding::QuantizedDelta)))
+    {
+      std::fclose(file_);
+      file_ = nullptr;
+      return false;
+    }
+    chunkSize_ = chunkSize;
+    remaining_ = static_cast<std::size_t>(header_.size);
+    ready_ = false;
+    stop_ = false;
+    error_ = false;
+    front_.clear();
+    back_.clear();
+    io_ = std::thread([this]() { ioLoop(); });
+    return true;
+  }
+
+  bool isOpen() const
+  {
+    return file_ != nullptr;
+  }
+
+  /// @return Header of the file, the file must be open.
+  const TrajectoryHeader & header() const
+  {
+    assert(isOpen());
+    return header_;
+  }
+
+  /// @return Number of samples of the file.
+  std::size_t size() const
+  {
+    return static_cast<std::size_t>(header_.size);
+  }
+
+  /**
+   * @return Next chunk of samples, valid until the next call to next or close,
+   * an empty view once all the samples have been read or on read error.
+   */
+  TrajectoryView<Sample> next()
+  {
+    assert(isOpen());
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() { return ready_; });
+      if(back_.empty())
+      {
+        // end of file or error, the reading thread is done
+        front_.clear();
+        return TrajectoryView<Sample>();
+      }
+      front_.swap(back_);
+      ready_ = false;
+    }
+    cv_.notify_all();
+    return TrajectoryView<Sample>(front_.data(), front_.size());
+  }
+
+  /// @return true if the file could not be read or decoded.
+  bool error() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return error_;
+  }
+
+  /// Stop the reading thread and close the file.
+  void close()
+  {
+    if(file_ == nullptr)
+    {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    io_.join();
+    std::fclose(file_);
+    file_ = nullptr;
+  }
+
+private:
+  void ioLoop()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for(;;)
+    {
+      cv_.wait(lock, [this]() { return !ready_ || stop_; });
+      if(stop_)
+      {
+        return;
+      }
+      lock.unlock();
+      const bool ok = readChunk();
+      lock.lock();
+      if(!ok)
+      {
+        back_.clear();
+        error_ = true;
+      }
+      ready_ = true;
+      cv_.notify_all();
+      if(back_.empty())
+      {
+        return;
+      }
+    }
+  }
+
+  /// Read and decode the next chunk in back_, back_ is empty at the end of the file.
+  bool readChunk()
+  {
+    if(remaining_ == 0)
+    {
+      back_.clear();
+      return true;
+    }
+    if(header_.encoding == static_cast<std::uint32_t>(TrajectoryEncoding::Raw))
+    {
+      back_.resize(std::min(chunkSize_, remaining_));
+      remaining_ -= back_.size();
+      return std::fread(back_.data(), sizeof(Sample), back_.size(), file_) == back_.size();
+    }
+    sva_internal::TrajectoryChunkHeader chunk;
+    if(std::fread(&chunk, sizeof(chunk), 1, file_) != 1 || chunk.size == 0 || chunk.size > remaining_)
+    {
+      return false;
+    }
+    encoded_.resize(chunk.bytes);
+    back_.resize(chunk.size);
+    remaining_ -= back_.size();
+    return std::fread(encoded_.data(), 1, encoded_.size(), file_) == encoded_.size()
+           && sva_internal::decodeQuantizedDelta<traits::lanes>(encoded_.data(), encoded_.size(), back_.size(),
+                                                                static_cast<scalar_t>(header_.quantizationStep),
+                                                                reinterpret_cast<scalar_t *>(back_.data()));
+  }
+
+private:
+  std::FILE * file_;
+  TrajectoryHeader header_;
+  std::size_t chunkSize_;
+  /// Number of samples not read yet by the reading thread.
+  std::size_t remaining_;
+
+  /// Chunk processed by the user.
+  std::vector<Sample> front_;
+  /// Chunk read by the reading thread, available when ready_ is true.
+  std::vector<Sample> back_;
+  std::vector<std::uint8_t> encoded_;
+
+  std::thread io_;
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  bool ready_;
+  bool stop_;
+  bool error_;
+};
+
+} // namespace sva
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+#include "EigenTypedef.h"
+#include "fwd.h"
+
+namespace sva
+{
+
+/**
+ * Plücker transform with an identity rotation.
+ * The operators skip all the rotation products of the PTransform ones.
+ */
+template<typename T>
+class TranslationTransform
+{
+  typedef Eigen::Vector3<T> vector3_t;
+  typedef Eigen::Matrix3<T> matrix3_t;
+  typedef Eigen::Matrix6<T> matrix6_t;
+
+public:
+  /// Identity transformation.
+  static TranslationTransform<T> Identity()
+  {
+    return TranslationTransform<T>(vector3_t::Zero());
+  }
+
+public:
+  // Constructors
+  /// Default constructor. Translation is uninitialized.
+  TranslationTransform() : r_() {}
+
+  /// Copy constructor.
+  template<typename T2>
+  TranslationTransform(const TranslationTransform<T2> & tt) : r_(tt.translation().template cast<T>())
+  {
+  }
+
+  /// @param trans Translation vector.
+  explicit TranslationTransform(const vector3_t & trans) : r_(trans) {}
+
+  // Accessor
+  /// @return Translation vector.
+  const vector3_t & translation() const
+  {
+    return r_;
+  }
+
+  /// @return Translation vector.
+  vector3_t & translation()
+  {
+    return r_;
+  }
+
+  /// @return Equivalent PTransform.
+  PTransform<T> ptransform() const;
+
+  /// @return Non compact Plücker transformation matrix.
+  matrix6_t matrix() const
+  {
+    matrix6_t m;
+    m << matrix3_t::Identity(), matrix3_t::Zero(), -vector3ToCrossMatrix(r_), matrix3_t::Identity();
+    return m;
+  }
+
+  /// @return Non compact dual Plücker transformation matrix.
+  matrix6_t dualMatrix() const
+  {
+    matrix6_t m;
+    m << matrix3_t::Identity(), -vector3ToCrossMatrix(r_), matrix3_t::Zero(), matrix3_t::Identity();
+    return m;
+  }
+
+  template<typename T2>
+  TranslationTransform<T2> cast() const
+  {
+    return TranslationTransform<T2>(*this);
+  }
+
+  // Operators
+  /// @return X*X
+  TranslationTransform<T> operator*(const TranslationTransform<T> & tt) const
+  {
+    return TranslationTransform<T>(vector3_t(r_ + tt.r_));
+  }
+
+  /// @return X*X
+  PTransform<T> operator*(const PTransform<T> & pt) const;
+  /// @return X*X
+  PTransform<T> operator*(const RotationTransform<T> & rt) const;
+
+  /// @return Xv
+  MotionVec<T> operator*(const MotionVec<T> & mv) const;
+  /// @see operator*(const MotionVec<T>& mv) const;
+  template<typename Derived>
+  void mul(const Eigen::MatrixBase<Derived> & mv, Eigen::MatrixBase<Derived> & result) const;
+
+  /// @return X^-1 v
+  MotionVec<T> invMul(const MotionVec<T> & mv) const;
+  /// @see invMul
+  template<typename Derived>
+  void invMul(const Eigen::MatrixBase<Derived> & mv, Eigen::MatrixBase<Derived> & result) const;
+
+  /// @return X*v
+  ForceVec<T> dualMul(const ForceVec<T> & fv) const;
+  /// @see dualMul
+  template<typename Derived>
+  void dualMul(const Eigen::MatrixBase<Derived> & fv, Eigen::MatrixBase<Derived> & result) const;
+
+  /// @return Xtv
+  ForceVec<T> transMul(const ForceVec<T> & fv) const;
+  /// @see transMul
+  template<typename Derived>
+  void transMul(const Eigen::MatrixBase<Derived> & fv, Eigen::MatrixBase<Derived> & result) const;
+
+  /// @return X*IX^-1
+  RBInertia<T> dualMul(const RBInertia<T> & rbI) const;
+  /// @return XtIX
+  RBInertia<T> transMul(const RBInertia<T> & rbI) const;
+
+  /// @return X*IX^-1
+  ABInertia<T> dualMul(const ABInertia<T> & rbI) const;
+  /// @return XtIX
+  ABInertia<T> transMul(const ABInertia<T> & rbI) const;
+
+  /// @return Inverse Plücker transformation.
+  TranslationTransform<T> inv() const
+  {
+    return TranslationTransform<T>(vector3_t(-r_));
+  }
+
+  bool operator==(const TranslationTransform<T> & tt) const
+  {
+    return r_ == tt.r_;
+  }
+
+  bool operator!=(const TranslationTransform<T> & tt) const
+  {
+    return r_ != tt.r_;
+  }
+
+private:
+  vector3_t r_;
+};
+
+template<typename T>
+inline std::ostream & operator<<(std::ostream & out, const TranslationTransform<T> & tt)
+{
+  out << tt.matrix();
+  return out;
+}
+
+} // namespace sva
@@ -21,4 +21,40 @@ class ABInertia;
 
 template<typename T>
 class PTransform;
+
+template<typename Lhs, typename Rhs>
+class PTransformProduct;
+
+template<typename T>
+class PTransformBatch;
+
+template<typename T>
+class QTransform;
+
+template<typename T>
+class RotationTransform;
+
+template<typename T>
+class TranslationTransform;
+
+template<typename T, int Axis>
+class AxisRotationTransform;
+
+template<typename T>
+class MotionVecBatch;
+
+template<typename T>
+class ForceVecBatch;
+
+template<typename T>
+class SE3Jacobian;
+
+template<typename T>
+class BlockDiagJacobian;
+
+template<typename T>
+class ForceCrossJacobian;
+
+template<typename T, int N>
+class Dual;
 } // namespace sva
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+// Cost of differentiating the SpaceVecAlg templates in forward mode.
+//
+// Each benchmark is instantiated with double (reference), sva::Dual<double, 6>
+// and Eigen::AutoDiffScalar with a dynamic and a fixed size derivative vector.
+// The inputs depend on 6 variables (a twist) and cycle over a pool of random
+// values as in OperatorsBench. Times are reported in ns per operation.
+
+// includes
+// std
+#include <cstddef>
+#include <vector>
+
+// benchmark
+#include <benchmark/benchmark.h>
+
+// Eigen
+#include <Eigen/Core>
+#include <unsupported/Eigen/AutoDiff>
+
+// SpaceVecAlg
+#include <SpaceVecAlg/SpaceVecAlg>
+
+namespace
+{
+
+typedef sva::Dual<double, 6> dual_t;
+typedef Eigen::AutoDiffScalar<Eigen::VectorXd> autodiff_t;
+typedef Eigen::AutoDiffScalar<Eigen::Vector6d> autodiff6_t;
+
+/// Number of inputs, must be a power of 2.
+constexpr std::size_t poolSize = 256;
+
+/// @return i-th variable of the differentiation of value v.
+template<typename S>
+S variable(double v, int i);
+
+template<>
+double variable<double>(double v, int)
+{
+  return v;
+}
+
+template<>
+dual_t variable<dual_t>(double v, int i)
+{
+  return dual_t::Variable(v, i);
+}
+
+template<>
+autodiff_t variable<autodiff_t>(double v, int i)
+{
+  return autodiff_t(v, 6, i);
+}
+
+template<>
+autodiff6_t variable<autodiff6_t>(double v, int i)
+{
+  return autodiff6_t(v, 6, i);
+}
+
+/// Random inputs, the twists depend on the 6 variables.
+template<typename S>
+struct Data
+{
+  Data()
+  {
+    using namespace Eigen;
+    for(std::size_t i = 0; i < poolSize; ++i)
+    {
+      // a quarter of the angles below 1e-3 to exercise the small angle paths
+      const double scale = (i % 4 == 0) ? 1e-3 : 1.;
+      Vector6d v = Vector6d::Random();
+      v.head<3>() *= scale;
+      Vector6<S> nu;
+      for(int k = 0; k < 6; ++k)
+      {
+        nu(k) = variable<S>(v(k), k);
+      }
+      tw.push_back(sva::MotionVec<S>(nu));
+      angle.push_back(nu(2));
+      pt.push_back(sva::PTransformd(Quaterniond(Vector4d::Random()).normalized(), Vector3d::Random()).cast<S>());
+      mv.push_back(sva::MotionVecd(Vector6d::Random()).cast<S>());
+      ptTw.push_back(sva::exp(tw.back()));
+      rot.push_back(ptTw.back().rotation());
+    }
+  }
+
+  std::vector<sva::MotionVec<S>> tw;
+  std::vector<S> angle;
+  std::vector<sva::PTransform<S>> pt;
+  std::vector<sva::MotionVec<S>> mv;
+  std::vector<sva::PTransform<S>> ptTw;
+  std::vector<Eigen::Matrix3<S>> rot;
+};
+
+template<typename S>
+Data<S> & data()
+{
+  static Data<S> d;
+  return d;
+}
+
+} // namespace
+
+/**
+ * Define the benchmark name templated on the scalar S that evaluates expr and
+ * stores it in a variable of type type. expr can use d (Data<S>), i and j, two
+ * different indices in the pool.
+ */
+#define SVA_AD_BENCH(name, type, expr)                              \
+  template<typename S>                                             \
+  void BM_##name(benchmark::State & state)                         \
+  {                                                                \
+    using namespace sva;                                           \
+    Data<S> & d = data<S>();                                       \
+    std::size_t i = 0;                                             \
+    for(auto _ : state)                                            \
+    {                                                              \
+      const std::size_t j = (i + 1) & (poolSize - 1);              \
+      type r = expr;                                               \
+      benchmark::DoNotOptimize(r);                                 \
+      i = j;                                                       \
+    }                                                              \
+  }                                                                \
+  BENCHMARK_TEMPLATE(BM_##name, double);                           \
+  BENCHMARK_TEMPLATE(BM_##name, dual_t);                           \
+  BENCHMARK_TEMPLATE(BM_##name, autodiff6_t);                      \
+  BENCHMARK_TEMPLATE(BM_##name, autodiff_t)
+
+SVA_AD_BENCH(RotZ, Eigen::Matrix3<S>, RotZ(d.angle[i]));
+SVA_AD_BENCH(PTransform_PTransform, PTransform<S>, PTransform<S>(d.ptTw[i] * d.pt[j]));
+SVA_AD_BENCH(PTransform_MotionVec, MotionVec<S>, d.ptTw[i] * d.mv[j]);
+SVA_AD_BENCH(exp, PTransform<S>, exp(d.tw[i]));
+SVA_AD_BENCH(rotationVelocity, Eigen::Vector3<S>, rotationVelocity(d.rot[i]));
+SVA_AD_BENCH(transformError, MotionVec<S>, transformError(d.pt[j], d.ptTw[i]));
+SVA_AD_BENCH(SE3RightJac, SE3Jacobian<S>, SE3RightJac(d.tw[i]));
+
+BENCHMARK_MAIN();
@@ -20,39 +20,8 @@
 typedef Eigen::Matrix<double, Eigen::Dynamic, 1> derivative_t;
 typedef Eigen::AutoDiffScalar<derivative_t> scalar_t;
 
-/*
-namespace std
-{
-scalar_t sin(const scalar_t& t)
-{
-  return Eigen::sin(t);
-}
-scalar_t cos(const scalar_t& t)
-{
-  return Eigen::cos(t);
-}
-}
-*/
-
 // SpaceVecAlg
 #include <SpaceVecAlg/SpaceVecAlg>
-namespace sva
-{
-template<>
-inline Eigen::Matrix3<scalar_t> RotZ<scalar_t>(scalar_t theta)
-{
-  using namespace Eigen;
-
-  Matrix3<scalar_t> ret;
-  scalar_t z(0., derivative_t::Zero(theta.derivatives().rows()));
-  scalar_t o(1., derivative_t::Zero(theta.derivatives().rows()));
-  scalar_t s = sin(theta), c = cos(theta);
-
-  ret << c, s, z, -s, c, z, z, z, o;
-
-  return ret;
-}
-} // namespace sva
 
 using boost::math::constants::pi;
 
@@ -112,3 +81,185 @@ BOOST_AUTO_TEST_CASE(PTransformVsPTransform)
     std::cout << std::endl;
   }
 }
+
+typedef sva::Dual<double, 1> dual1_t;
+typedef sva::Dual<double, 6> dual6_t;
+
+BOOST_AUTO_TEST_CASE(DualArithmetic)
+{
+  using namespace sva;
+
+  const double a = 0.7, b = -1.3;
+  dual1_t x = dual1_t::Variable(a, 0);
+  Dual<double, 2> x2 = Dual<double, 2>::Variable(a, 0);
+  Dual<double, 2> y2 = Dual<double, 2>::Variable(b, 1);
+
+  // f(x, y) = x y + x / y - sin(x) exp(y) + atan2(y, x)
+  Dual<double, 2> f = x2 * y2 + x2 / y2 - sin(x2) * exp(y2) + atan2(y2, x2);
+  const double n2 = a * a + b * b;
+  BOOST_CHECK_CLOSE(f.value(), a * b + a / b - std::sin(a) * std::exp(b) + std::atan2(b, a), 1e-12);
+  BOOST_CHECK_CLOSE(f.derivatives()(0), b + 1. / b - std::cos(a) * std::exp(b) - b / n2, 1e-12);
+  BOOST_CHECK_CLOSE(f.derivatives()(1), a - a / (b * b) - std::sin(a) * std::exp(b) + a / n2, 1e-12);
+
+  // mixed operations with double and single argument functions
+  dual1_t g = 2. / x - 3. * x + 1. - x * x / 4. + sqrt(x) + log(x) + pow(x, 3.) + tan(x) + asin(x) + acos(x)
+              + atan(x) + abs(-x);
+  double dg = -2. / (a * a) - 3. - a / 2. + 0.5 / std::sqrt(a) + 1. / a + 3. * a * a
+              + 1. / (std::cos(a) * std::cos(a)) + 1. / (1. + a * a) + 1.;
+  BOOST_CHECK_CLOSE(g.derivatives()(0), dg, 1e-10);
+
+  dual1_t h = x;
+  h *= x;
+  h /= 2. + x;
+  h -= 1.;
+  h += x;
+  BOOST_CHECK_CLOSE(h.derivatives()(0), (a * a + 4. * a) / ((2. + a) * (2. + a)) + 1., 1e-12);
+
+  // comparisons only involve the value
+  BOOST_CHECK(x < 1. && 0. < x && x == a && x != x + 1.);
+  BOOST_CHECK(isfinite(x) && !isnan(x) && !isinf(x));
+}
+
+BOOST_AUTO_TEST_CASE(DualRotations)
+{
+  using namespace sva;
+  using namespace Eigen;
+
+  auto derivative = [](const Matrix3<dual1_t> & m) {
+    return Matrix3d(m.unaryExpr([](const dual1_t & v) { return v.derivatives()(0); }));
+  };
+  auto value = [](const Matrix3<dual1_t> & m) { return Matrix3d(m.unaryExpr([](const dual1_t & v) { return v.value(); })); };
+
+  for(double a : {0., 0.3, -2.1, pi<double>()})
+  {
+    dual1_t theta = dual1_t::Variable(a, 0);
+    const double s = std::sin(a), c = std::cos(a);
+
+    Matrix3d dRotX, dRotY, dRotZ;
+    dRotX << 0., 0., 0., 0., -s, c, 0., -c, -s;
+    dRotY << -s, 0., -c, 0., 0., 0., c, 0., -s;
+    dRotZ << -s, c, 0., -c, -s, 0., 0., 0., 0.;
+
+    BOOST_CHECK_SMALL((value(RotX(theta)) - RotX(a)).norm(), 1e-15);
+    BOOST_CHECK_SMALL((derivative(RotX(theta)) - dRotX).norm(), 1e-15);
+    BOOST_CHECK_SMALL((derivative(RotY(theta)) - dRotY).norm(), 1e-15);
+    BOOST_CHECK_SMALL((derivative(RotZ(theta)) - dRotZ).norm(), 1e-15);
+    BOOST_CHECK_SMALL((derivative(RotXTransform<dual1_t>(theta).rotation()) - dRotX).norm(), 1e-15);
+    BOOST_CHECK_SMALL((derivative(RotYTransform<dual1_t>(theta).rotation()) - dRotY).norm(), 1e-15);
+    BOOST_CHECK_SMALL((derivative(RotZTransform<dual1_t>(theta).rotation()) - dRotZ).norm(), 1e-15);
+  }
+
+  // sinc and sinc_inv, including their Taylor expansions around 0 where both derivatives are about x/3
+  for(double a : {0., 1e-9, 1e-5, 1e-3, 0.5, 2.})
+  {
+    dual1_t x = dual1_t::Variable(a, 0);
+    double dSincInv = a < 1e-3 ? a / 3. : (std::sin(a) - a * std::cos(a)) / (std::sin(a) * std::sin(a));
+    double dSinc = a < 1e-3 ? -a / 3. : (a * std::cos(a) - std::sin(a)) / (a * a);
+    BOOST_CHECK_CLOSE(sinc_inv(x).value(), sinc_inv(a), 1e-12);
+    BOOST_CHECK_SMALL(sinc_inv(x).derivatives()(0) - dSincInv, 1e-7);
+    BOOST_CHECK_SMALL(sinc(x).derivatives()(0) - dSinc, 1e-7);
+  }
+}
+
+/// @return Norm of the difference between the Dual derivatives of f at nu and its central finite differences.
+template<typename F>
+double dualVsFiniteDiff(F f, const sva::MotionVecd & nu)
+{
+  using namespace Eigen;
+
+  Vector6<dual6_t> nuDual;
+  for(int i = 0; i < 6; ++i)
+  {
+    nuDual(i) = dual6_t::Variable(nu.vector()(i), i);
+  }
+  const auto fDual = f(sva::MotionVec<dual6_t>(nuDual));
+
+  const double h = 1e-6;
+  MatrixXd J(fDual.rows(), 6), JDual(fDual.rows(), 6);
+  for(int i = 0; i < 6; ++i)
+  {
+    Vector6d dnu = Vector6d::Unit(i) * h;
+    J.col(i) = (f(sva::MotionVecd(nu.vector() + dnu)) - f(sva::MotionVecd(nu.vector() - dnu))) / (2. * h);
+  }
+  for(Index r = 0; r < fDual.rows(); ++r)
+  {
+    JDual.row(r) = fDual(r).derivatives().transpose();
+  }
+  return (J - JDual).norm();
+}
+
+BOOST_AUTO_TEST_CASE(DualSpaceVecAlg)
+{
+  using namespace sva;
+  using namespace Eigen;
+
+  const PTransformd X_b(RotX(0.4) * RotZ(-1.1), Vector3d(0.1, -0.7, 1.2));
+  const MotionVecd mv(Vector6d(0.3, -0.2, 1.1, 0.5, 0.6, -0.4));
+
+  // identity, Taylor expansions, generic twist and angle close to pi
+  for(const MotionVecd & nu :
+      {MotionVecd(Vector6d::Zero()), MotionVecd(Vector6d(1e-9, 0., 0., 1., 0., 0.)),
+       MotionVecd(Vector6d(0.2, -0.4, 0.9, 1., 2., -3.)), MotionVecd(Vector6d(0., 3., 0., 0.5, 0., 0.))})
+  {
+    // exp and the operators
+    auto fExp = [&X_b, &mv](const auto & n) {
+      typedef typename decltype(n.vector())::Scalar T;
+      PTransform<T> X = exp(n) * X_b.cast<T>();
+      Matrix<T, 18, 1> r;
+      r << X.translation(), Map<const Matrix<T, 9, 1>>(X.rotation().data()), (X.inv() * mv.cast<T>()).vector();
+      return r;
+    };
+    BOOST_CHECK_SMALL(dualVsFiniteDiff(fExp, nu), 1e-7);
+
+    // rotationVelocity (rotation matrix and quaternion) and transformError
+    auto fError = [&X_b](const auto & n) {
+      typedef typename decltype(n.vector())::Scalar T;
+      PTransform<T> X = exp(n);
+      Matrix<T, 12, 1> r;
+      r << transformError(X_b.cast<T>(), PTransform<T>(X * X_b.cast<T>())).vector(),
+          rotationVelocity(QTransform<T>(X).rotation()), rotationVelocity(X.rotation());
+      return r;
+    };
+    BOOST_CHECK_SMALL(dualVsFiniteDiff(fError, nu), 1e-7);
+
+    // SE(3) Jacobians
+    auto fJac = [](const auto & n) {
+      typedef typename decltype(n.vector())::Scalar T;
+      Matrix<T, 3, 3> L = SE3RightJac(n).L(), DInv = SE3RightJacInv(n).D();
+      Matrix<T, 18, 1> r;
+      r << Map<const Matrix<T, 9, 1>>(L.data()), Map<const Matrix<T, 9, 1>>(DInv.data());
+      return r;
+    };
+    BOOST_CHECK_SMALL(dualVsFiniteDiff(fJac, nu), 1e-7);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(DualVsAutoDiffScalar)
+{
+  using namespace sva;
+  using namespace Eigen;
+
+  const Vector3d x(0.3, -0.6, 1.1);
+  const PTransformd X(RotY(0.4) * RotX(-0.2), Vector3d(0.5, 1., -1.5));
+
+  Vector3<scalar_t> xa;
+  Vector3<Dual<double, 3>> xd;
+  for(int i = 0; i < 3; ++i)
+  {
+    xa(i) = scalar_t(x(i), derivative_t::Unit(3, i));
+    xd(i) = Dual<double, 3>::Variable(x(i), i);
+  }
+  PTransform<scalar_t> Xa = X.cast<scalar_t>() * PTransform<scalar_t>(RotZ(xa(2)), xa) * X.cast<scalar_t>();
+  PTransform<Dual<double, 3>> Xd =
+      X.cast<Dual<double, 3>>() * PTransform<Dual<double, 3>>(RotZ(xd(2)), xd) * X.cast<Dual<double, 3>>();
+
+  for(int i = 0; i < 3; ++i)
+  {
+    BOOST_CHECK_SMALL(Xd.translation()(i).value() - Xa.translation()(i).value(), 1e-14);
+    BOOST_CHECK_SMALL((Xd.translation()(i).derivatives() - Xa.translation()(i).derivatives()).norm(), 1e-14);
+    for(int j = 0; j < 3; ++j)
+    {
+      BOOST_CHECK_SMALL((Xd.rotation()(i, j).derivatives() - Xa.rotation()(i, j).derivatives()).norm(), 1e-14);
+    }
+  }
+}
@@ -0,0 +1,497 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+// includes
+// std
+#include <atomic>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+// Eigen
+#include <unsupported/Eigen/MatrixFunctions>
+
+// boost
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Batch test
+#include <boost/test/unit_test.hpp>
+
+// SpaceVecAlg
+#include <SpaceVecAlg/ParallelBatch.h>
+#include <SpaceVecAlg/SpaceVecAlg>
+
+#include "TestUtils.h"
+
+const double TOL = 1e-10;
+
+// not a multiple of the kernel block size to check the tail handling
+const std::size_t SIZE = 150;
+
+bool isClose(const sva::PTransformd & pt1, const sva::PTransformd & pt2)
+{
+  return (pt1.matrix() - pt2.matrix()).array().abs().maxCoeff() < TOL;
+}
+
+BOOST_AUTO_TEST_CASE(PTransformBatchTest)
+{
+  using namespace sva;
+
+  std::vector<PTransformd> pts1 = randomPTransforms(SIZE);
+  std::vector<PTransformd> pts2 = randomPTransforms(SIZE);
+  PTransformd pt = randomPTransform();
+
+  PTransformBatchd ptb1(pts1);
+  PTransformBatchd ptb2(pts2);
+
+  BOOST_CHECK_EQUAL(ptb1.size(), SIZE);
+  for(std::size_t i = 0; i < SIZE; ++i)
+  {
+    BOOST_CHECK_EQUAL(ptb1[i], pts1[i]);
+  }
+
+  // lanes
+  BOOST_CHECK_EQUAL(ptb1.rotation(1, 2)(3), pts1[3].rotation()(1, 2));
+  BOOST_CHECK_EQUAL(ptb1.translation(2)(5), pts1[5].translation()(2));
+
+  // identity
+  PTransformBatchd id = PTransformBatchd::Identity(SIZE);
+  for(std::size_t i = 0; i < SIZE; ++i)
+  {
+    BOOST_CHECK_EQUAL(id[i], PTransformd::Identity());
+  }
+
+  // X*X
+  PTransformBatchd ptbMul = ptb1 * ptb2;
+  PTransformBatchd ptbMulPt = ptb1 * pt;
+  PTransformBatchd ptbInv = ptb1.inv();
+  for(std::size_t i = 0; i < SIZE; ++i)
+  {
+    BOOST_CHECK(isClose(ptbMul[i], pts1[i] * pts2[i]));
+    BOOST_CHECK(isClose(ptbMulPt[i], pts1[i] * pt));
+    BOOST_CHECK(isClose(ptbInv[i], pts1[i].inv()));
+  }
+
+  // aliasing
+  PTransformBatchd ptbAlias(ptb1);
+  ptbAlias.mul(ptb2, ptbAlias);
+  BOOST_CHECK_EQUAL(ptbAlias, ptbMul);
+  ptbAlias = ptb2;
+  ptb1.mul(ptbAlias, ptbAlias);
+  BOOST_CHECK_EQUAL(ptbAlias, ptbMul);
+  ptbAlias = ptb1;
+  ptbAlias.mul(pt, ptbAlias);
+  BOOST_CHECK_EQUAL(ptbAlias, ptbMulPt);
+  ptbAlias = ptb1;
+  ptbAlias.inv(ptbAlias);
+  BOOST_CHECK_EQUAL(ptbAlias, ptbInv);
+
+  // cast
+  PTransformBatch<float> ptbf = ptb1.cast<float>();
+  for(std::size_t i = 0; i < SIZE; ++i)
+  {
+    BOOST_CHECK_EQUAL(ptbf[i], pts1[i].cast<float>());
+  }
+
+  BOOST_CHECK(ptb1 == ptb1);
+  BOOST_CHECK(ptb1 != ptb2);
+}
+
+bool isClose(const sva::MotionVecd & mv1, const sva::MotionVecd & mv2)
+{
+  return (mv1.vector() - mv2.vector()).array().abs().maxCoeff() < TOL;
+}
+
+bool isClose(const sva::ForceVecd & fv1, const sva::ForceVecd & fv2)
+{
+  return (fv1.vector() - fv2.vector()).array().abs().maxCoeff() < TOL;
+}
+
+BOOST_AUTO_TEST_CASE(MotionVecBatchForceVecBatchTest)
+{
+  using namespace sva;
+
+  std::vector<MotionVecd> mvs1(SIZE), mvs2(SIZE);
+  std::vector<ForceVecd> fvs(SIZE);
+  for(std::size_t i = 0; i < SIZE; ++i)
+  {
+    mvs1[i] = MotionVecd(Eigen::Vector6d::Random());
+    mvs2[i] = MotionVecd(Eigen::Vector6d::Random());
+    fvs[i] = ForceVecd(Eigen::Vector6d::Random());
+  }
+
+  MotionVecBatchd mvb1(mvs1), mvb2(mvs2);
+  ForceVecBatchd fvb(fvs);
+
+  BOOST_CHECK_EQUAL(mvb1.size(), SIZE);
+  for(std::size_t i = 0; i < SIZE; ++i)
+  {
+    BOOST_CHECK_EQUAL(mvb1[i], mvs1[i]);
+    BOOST_CHECK_EQUAL(fvb[i], fvs[i]);
+  }
+  BOOST_CHECK_EQUAL(mvb1.angular(1)(3), mvs1[3].angular()(1));
+  BOOST_CHECK_EQUAL(mvb1.linear(2)(4), mvs1[4].linear()(2));
+  BOOST_CHECK_EQUAL(fvb.couple(0)(5), fvs[5].couple()(0));
+  BOOST_CHECK_EQUAL(fvb.force(1)(6), fvs[6].force()(1));
+
+  MotionVecBatchd mvbAdd = mvb1 + mvb2;
+  MotionVecBatchd mvbScale = 2. * mvb1;
+  MotionVecBatchd mvbCross = mvb1.cross(mvb2);
+  ForceVecBatchd fvbCrossDual = mvb1.crossDual(fvb);
+  Eigen::VectorXd dot = mvb1.dot(fvb);
+  for(std::size_t i = 0; i < SIZE; ++i)
+  {
+    BOOST_CHECK_EQUAL(mvbAdd[i], mvs1[i] + mvs2[i]);
+    BOOST_CHECK_EQUAL(mvbScale[i], 2. * mvs1[i]);
+    BOOST_CHECK(isClose(mvbCross[i], mvs1[i].cross(mvs2[i])));
+    BOOST_CHECK(isClose(fvbCrossDual[i], mvs1[i].crossDual(fvs[i])));
+    BOOST_CHECK_SMALL(dot(i) - mvs1[i].dot(fvs[i]), TOL);
+  }
+
+  // one transformation, many vectors
+  PTransformd pt = randomPTransform();
+  MotionVecBatchd mvbMul = pt * mvb1;
+  MotionVecBatchd mvbInvMul = pt.invMul(mvb1);
+  ForceVecBatchd fvbDualMul = pt.dualMul(fvb);
+  ForceVecBatchd fvbTransMul = pt.transMul(fvb);
+  for(std::size_t i = 0; i < SIZE; ++i)
+  {
+    BOOST_CHECK(isClose(mvbMul[i], pt * mvs1[i]));
+    BOOST_CHECK(isClose(mvbInvMul[i], pt.invMul(mvs1[i])));
+    BOOST_CHECK(isClose(fvbDualMul[i], pt.dualMul(fvs[i])));
+    BOOST_CHECK(isClose(fvbTransMul[i], pt.transMul(fvs[i])));
+  }
+
+  // many transformations, many vectors
+  std::vector<PTransformd> pts = randomPTransforms(SIZE);
+  PTransformBatchd ptb(pts);
+  mvbMul = ptb * mvb1;
+  mvbInvMul = ptb.invMul(mvb1);
+  fvbDualMul = ptb.dualMul(fvb);
+  fvbTransMul = ptb.transMul(fvb);
+  for(std::size_t i = 0; i < SIZE; ++i)
+  {
+    BOOST_CHECK(isClose(mvbMul[i], pts[i] * mvs1[i]));
+    BOOST_CHECK(isClose(mvbInvMul[i], pts[i].invMul(mvs1[i])));
+    BOOST_CHECK(isClose(fvbDualMul[i], pts[i].dualMul(fvs[i])));
+    BOOST_CHECK(isClose(fvbTransMul[i], pts[i].transMul(fvs[i])));
+  }
+
+  // aliasing
+  MotionVecBatchd mvbAlias(mvb1);
+  ptb.mul(mvbAlias, mvbAlias);
+  BOOST_CHECK_EQUAL(mvbAlias, mvbMul);
+  mvbAlias = mvb1;
+  ptb.invMul(mvbAlias, mvbAlias);
+  BOOST_CHECK_EQUAL(mvbAlias, mvbInvMul);
+  ForceVecBatchd fvbAlias(fvb);
+  ptb.dualMul(fvbAlias, fvbAlias);
+  BOOST_CHECK_EQUAL(fvbAlias, fvbDualMul);
+  fvbAlias = fvb;
+  ptb.transMul(fvbAlias, fvbAlias);
+  BOOST_CHECK_EQUAL(fvbAlias, fvbTransMul);
+  mvbAlias = mvb1;
+  mvbAlias.cross(mvb2, mvbAlias);
+  BOOST_CHECK_EQUAL(mvbAlias, mvbCross);
+  fvbAlias = fvb;
+  mvb1.crossDual(fvbAlias, fvbAlias);
+  BOOST_CHECK_EQUAL(fvbAlias, fvbCrossDual);
+}
+
+BOOST_AUTO_TEST_CASE(TransformErrorBatchTest)
+{
+  using namespace sva;
+  using namespace Eigen;
+  const double pi = 3.1415926535897932;
+
+  // regular, small angle and near pi rotations, see rotationVelocityTest
+  std::vector<PTransformd> pts1 = randomPTransforms(SIZE);
+  for(double e = -2; e > -16; e -= .5)
+  {
+    for(double angle : {std::pow(10, e), -std::pow(10, e), pi + std::pow(10, e), pi - std::pow(10, e)})
+    {
+      const Vector3d u = Vector3d::Random().normalized();
+      pts1.push_back(PTransformd(AngleAxisd(angle, u).toRotationMatrix(), Vector3d::Random()));
+      pts1.push_back(PTransformd(AngleAxisd(angle, Vector3d::UnitY()).toRotationMatrix(), Vector3d::Random()));
+    }
+  }
+  for(const Vector3d & u : {Vector3d(Vector3d::UnitX()), Vector3d(Vector3d::UnitZ()), Vector3d(Vector3d::Random().normalized())})
+  {
+    pts1.push_back(PTransformd(AngleAxisd(pi, u).toRotationMatrix()));
+  }
+  pts1.push_back(PTransformd::Identity());
+  std::vector<PTransformd> pts2 = randomPTransforms(pts1.size());
+  PTransformBatchd ptb1(pts1);
+  PTransformBatchd ptb2(pts2);
+
+  // both versions lose precision close to pi (the sine goes through acos)
+  // but with different rounding
+  const double tol = 1e-7;
+  Matrix<double, Dynamic, 3> w;
+  rotationVelocity(ptb1, w);
+  MotionVecBatchd V;
+  transformVelocity(ptb1, V);
+  for(std::size_t i = 0; i < pts1.size(); ++i)
+  {
+    const Index ii = static_cast<Index>(i);
+    const Vector3d wRef = rotationVelocity(pts1[i].rotation());
+    BOOST_CHECK_SMALL((w.row(ii).transpose() - wRef).norm(), tol);
+    BOOST_CHECK_SMALL((V[ii].vector() - transformVelocity(pts1[i]).vector()).norm(), tol);
+    BOOST_CHECK(vector3ToCrossMatrix(Vector3d(w.row(ii))).exp().transpose().isApprox(pts1[i].rotation(), 1e-6));
+  }
+
+  // errors against random transformations and against close transformations
+  std::vector<PTransformd> ptsClose(pts1.size());
+  for(std::size_t i = 0; i < pts1.size(); ++i)
+  {
+    ptsClose[i] = PTransformd(AngleAxisd(1e-6, Vector3d::UnitX()).toRotationMatrix()) * pts1[i];
+  }
+  for(const std::vector<PTransformd> & ptsc : {pts2, ptsClose})
+  {
+    transformError(ptb1, PTransformBatchd(ptsc), V);
+    for(std::size_t i = 0; i < pts1.size(); ++i)
+    {
+      const MotionVecd err = transformError(pts1[i], ptsc[i]);
+      BOOST_CHECK_SMALL((V[static_cast<Index>(i)].vector() - err.vector()).norm(), tol);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ExpSE3JacBatchTest)
+{
+  using namespace sva;
+  using namespace Eigen;
+
+  // regular and small angle motions, around the Taylor bounds of the coefficients
+  std::vector<MotionVecd> mvs;
+  for(std::size_t i = 0; i < SIZE; ++i)
+  {
+    mvs.push_back(MotionVecd(Vector6d::Random() * 2));
+  }
+  for(double angle : {0., 1e-12, 1e-6, 1e-3, 0.1, 0.85, 0.98, 1.1, 1.2, 1.3, 3.})
+  {
+    mvs.push_back(MotionVecd(Vector3d(Vector3d::Random().normalized() * angle), Vector3d::Random()));
+  }
+  MotionVecBatchd mvb(mvs);
+
+  PTransformBatchd ptb;
+  exp(mvb, ptb);
+  BOOST_CHECK_EQUAL(ptb.size(), mvb.size());
+  Matrix<double, Dynamic, 18> Jr, Jl;
+  SE3RightJac(mvb, Jr);
+  SE3LeftJac(mvb, Jl);
+  for(std::size_t i = 0; i < mvs.size(); ++i)
+  {
+    const Index ii = static_cast<Index>(i);
+    BOOST_CHECK(isClose(ptb[ii], exp(mvs[i])));
+    for(const auto & J : {std::make_pair(&Jr, SE3RightJac(mvs[i])), std::make_pair(&Jl, SE3LeftJac(mvs[i]))})
+    {
+      for(int r = 0; r < 3; ++r)
+      {
+        for(int c = 0; c < 3; ++c)
+        {
+          BOOST_CHECK_SMALL((*J.first)(ii, 3 * r + c) - J.second.D()(r, c), TOL);
+          BOOST_CHECK_SMALL((*J.first)(ii, 9 + 3 * r + c) - J.second.L()(r, c), TOL);
+        }
+      }
+    }
+  }
+
+  std::vector<MotionVecd> dmvs;
+  for(std::size_t i = 0; i < mvs.size(); ++i)
+  {
+    dmvs.push_back(MotionVecd(Vector6d::Random()));
+  }
+  MotionVecBatchd dmvb(dmvs);
+  Matrix<double, Dynamic, 18> JrInv, JlInv, JrInvDot, JlInvDot;
+  SE3RightJacInv(mvb, JrInv);
+  SE3LeftJacInv(mvb, JlInv);
+  SE3RightJacInvDot(mvb, dmvb, JrInvDot);
+  SE3LeftJacInvDot(mvb, dmvb, JlInvDot);
+  for(std::size_t i = 0; i < mvs.size(); ++i)
+  {
+    const Index ii = static_cast<Index>(i);
+    for(const auto & J : {std::make_pair(&JrInv, SE3RightJacInv(mvs[i])), std::make_pair(&JlInv, SE3LeftJacInv(mvs[i])),
+                          std::make_pair(&JrInvDot, SE3RightJacInvDot(mvs[i], dmvs[i])),
+                          std::make_pair(&JlInvDot, SE3LeftJacInvDot(mvs[i], dmvs[i]))})
+    {
+      for(int r = 0; r < 3; ++r)
+      {
+        for(int c = 0; c < 3; ++c)
+        {
+          BOOST_CHECK_SMALL((*J.first)(ii, 3 * r + c) - J.second.D()(r, c), TOL);
+          BOOST_CHECK_SMALL((*J.first)(ii, 9 + 3 * r + c) - J.second.L()(r, c), TOL);
+        }
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ThreadPoolTest)
+{
+  for(unsigned nrThreads : {1u, 2u, 3u, 8u})
+  {
+    sva::ThreadPool pool(nrThreads);
+    BOOST_CHECK_EQUAL(pool.nrThreads(), nrThreads);
+    // every chunk is computed once, by a valid thread, whatever the scheduling
+    for(std::ptrdiff_t size : {0, 1, 7, 100, 1001})
+    {
+      std::vector<std::atomic<int>> count(static_cast<std::size_t>(size));
+      for(auto & c : count)
+      {
+        c = 0;
+      }
+      std::atomic<bool> badChunk(false);
+      pool.parallelFor(size, 7,
+                       [&](unsigned thread, std::ptrdiff_t begin, std::ptrdiff_t end)
+                       {
+                         if(thread >= nrThreads || begin % 7 != 0 || (end - begin != 7 && end != size))
+                         {
+                           badChunk = true;
+                         }
+                         for(std::ptrdiff_t i = begin; i < end; ++i)
+                         {
+                           ++count[static_cast<std::size_t>(i)];
+                         }
+                       });
+      BOOST_CHECK(!badChunk);
+      for(const auto & c : count)
+      {
+        BOOST_CHECK_EQUAL(c, 1);
+      }
+    }
+
+    // an exception thrown in a chunk is rethrown and the pool is still usable
+    BOOST_CHECK_THROW(pool.parallelFor(100, 1,
+                                       [](unsigned, std::ptrdiff_t begin, std::ptrdiff_t)
+                                       {
+                                         if(begin == 42)
+                                         {
+                                           throw std::runtime_error("chunk 42");
+                                         }
+                                       }),
+                      std::runtime_error);
+    std::atomic<std::ptrdiff_t> sum(0);
+    pool.parallelFor(100, 10, [&](unsigned, std::ptrdiff_t begin, std::ptrdiff_t end) { sum += end - begin; });
+    BOOST_CHECK_EQUAL(sum, 100);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ParallelTransformBatchTest)
+{
+  using namespace Eigen;
+  using namespace sva;
+
+  // several chunks of the smallest grain with a tail
+  const std::size_t size = 5 * sva::sva_internal::batchBlockSize + 17;
+  const std::ptrdiff_t grain = sva::sva_internal::batchBlockSize;
+  PTransformBatchd ptb1(randomPTransforms(size));
+  PTransformBatchd ptb2(randomPTransforms(size));
+  PTransformd pt = randomPTransform();
+  std::vector<MotionVecd> mvs, tws;
+  std::vector<ForceVecd> fvs;
+  for(std::size_t i = 0; i < size; ++i)
+  {
+    mvs.push_back(MotionVecd(Vector6d::Random()));
+    tws.push_back(MotionVecd(Vector6d::Random() * 2));
+    fvs.push_back(ForceVecd(Vector6d::Random()));
+  }
+  MotionVecBatchd mvb(mvs), twb(tws);
+  ForceVecBatchd fvb(fvs);
+
+  // serial references
+  PTransformBatchd mulRef, mulPtRef, invRef, expRef;
+  ptb1.mul(ptb2, mulRef);
+  ptb1.mul(pt, mulPtRef);
+  ptb1.inv(invRef);
+  exp(twb, expRef);
+  MotionVecBatchd mvMulRef, mvPtMulRef, invMulRef, crossRef, velRef, errRef;
+  ptb1.mul(mvb, mvMulRef);
+  pt.mul(mvb, mvPtMulRef);
+  ptb1.invMul(mvb, invMulRef);
+  mvb.cross(twb, crossRef);
+  transformVelocity(ptb1, velRef);
+  transformError(ptb1, ptb2, errRef);
+  ForceVecBatchd dualMulRef, transMulRef, crossDualRef;
+  ptb1.dualMul(fvb, dualMulRef);
+  pt.transMul(fvb, transMulRef);
+  mvb.crossDual(fvb, crossDualRef);
+
+  for(unsigned nrThreads : {1u, 2u, 3u, 8u})
+  {
+    ThreadPool pool(nrThreads);
+    PTransformBatchd ptRes;
+    MotionVecBatchd mvRes;
+    ForceVecBatchd fvRes;
+
+    // results must be bitwise identical to the serial ones
+    parallelTransform(pool, BatchMul(), ptb1, ptb2, ptRes, grain);
+    BOOST_CHECK(ptRes.data() == mulRef.data());
+    parallelTransform(pool, BatchMul(), ptb1, pt, ptRes, grain);
+    BOOST_CHECK(ptRes.data() == mulPtRef.data());
+    parallelTransform(pool, BatchInv(), ptb1, ptRes, grain);
+    BOOST_CHECK(ptRes.data() == invRef.data());
+    parallelTransform(pool, BatchExp(), twb, ptRes, grain);
+    BOOST_CHECK(ptRes.data() == expRef.data());
+
+    parallelTransform(pool, BatchMul(), ptb1, mvb, mvRes, grain);
+    BOOST_CHECK(mvRes.data() == mvMulRef.data());
+    parallelTransform(pool, BatchMul(), pt, mvb, mvRes, grain);
+    BOOST_CHECK(mvRes.data() == mvPtMulRef.data());
+    parallelTransform(pool, BatchInvMul(), ptb1, mvb, mvRes, grain);
+    BOOST_CHECK(mvRes.data() == invMulRef.data());
+    parallelTransform(pool, BatchCross(), mvb, twb, mvRes, grain);
+    BOOST_CHECK(mvRes.data() == crossRef.data());
+    parallelTransform(pool, BatchTransformVelocity(), ptb1, mvRes, grain);
+    BOOST_CHECK(mvRes.data() == velRef.data());
+    parallelTransform(pool, BatchTransformError(), ptb1, ptb2, mvRes, grain);
+    BOOST_CHECK(mvRes.data() == errRef.data());
+
+    parallelTransform(pool, BatchDualMul(), ptb1, fvb, fvRes, grain);
+    BOOST_CHECK(fvRes.data() == dualMulRef.data());
+    parallelTransform(pool, BatchTransMul(), pt, fvb, fvRes, grain);
+    BOOST_CHECK(fvRes.data() == transMulRef.data());
+    parallelTransform(pool, BatchCross(), mvb, fvb, fvRes, grain);
+    BOOST_CHECK(fvRes.data() == crossDualRef.data());
+
+    // in place, with the default grain
+    MotionVecBatchd inPlace(mvb);
+    parallelTransform(pool, BatchMul(), ptb1, inPlace, inPlace);
+    BOOST_CHECK(inPlace.data() == mvMulRef.data());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ParallelTransformTest)
+{
+  using namespace Eigen;
+  using namespace sva;
+
+  const std::size_t size = 1000;
+  std::vector<PTransformd> pts1 = randomPTransforms(size);
+  std::vector<PTransformd> pts2 = randomPTransforms(size);
+  std::vector<RBInertiad> rbis;
+  for(std::size_t i = 0; i < size; ++i)
+  {
+    Matrix3d I = Matrix3d::Random();
+    rbis.push_back(RBInertiad(1. + i, Vector3d::Random(), Matrix3d(I * I.transpose())));
+  }
+
+  for(unsigned nrThreads : {1u, 2u, 3u, 8u})
+  {
+    ThreadPool pool(nrThreads);
+    std::vector<PTransformd> prod(size);
+    parallelTransform(pool, pts1.begin(), pts1.end(), pts2.begin(), prod.begin(),
+                      [](const PTransformd & X1, const PTransformd & X2) { return PTransformd(X1 * X2); }, 64);
+    std::vector<RBInertiad> rbiRes(size);
+    parallelTransform(pool, pts1.begin(), pts1.end(), rbis.begin(), rbiRes.begin(),
+                      [](const PTransformd & X, const RBInertiad & rbi) { return X.dualMul(rbi); }, 64);
+    std::vector<PTransformd> inv(size);
+    parallelTransform(pool, pts1.begin(), pts1.end(), inv.begin(), [](const PTransformd & X) { return X.inv(); }, 64);
+    for(std::size_t i = 0; i < size; ++i)
+    {
+      BOOST_CHECK_EQUAL(prod[i], pts1[i] * pts2[i]);
+      BOOST_CHECK(rbiRes[i] == pts1[i].dualMul(rbis[i]));
+      BOOST_CHECK_EQUAL(inv[i], pts1[i].inv());
+    }
+  }
+}
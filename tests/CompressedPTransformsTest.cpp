@@ -0,0 +1,160 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+// includes
+// std
+#include <iostream>
+#include <vector>
+
+// boost
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE CompressedPTransforms test
+#include <boost/test/unit_test.hpp>
+
+// SpaceVecAlg
+#include <SpaceVecAlg/CompressedPTransforms.h>
+#include <SpaceVecAlg/SpaceVecAlg>
+
+#include "TestUtils.h"
+
+// not a multiple of the block size to check the tail handling
+const std::size_t SIZE = 1000;
+
+const double ANG_TOL = 1e-5;
+
+bool isClose(const sva::PTransformd & pt1, const sva::PTransformd & pt2)
+{
+  return (pt1.rotation() - pt2.rotation()).array().abs().maxCoeff() < 1e-14
+         && (pt1.translation() - pt2.translation()).array().abs().maxCoeff() == 0.;
+}
+
+void checkClose(const sva::PTransformd & X, const sva::PTransformd & Xref, double linTol, double angTol = ANG_TOL)
+{
+  BOOST_CHECK_SMALL(Eigen::AngleAxisd(Xref.rotation().transpose() * X.rotation()).angle(), angTol);
+  BOOST_CHECK_SMALL((X.rotation() - Xref.rotation()).array().abs().maxCoeff(), angTol);
+  BOOST_CHECK_SMALL((X.translation() - Xref.translation()).array().abs().maxCoeff(), linTol * (1. + 1e-9));
+  // the decoded rotation is orthonormal
+  BOOST_CHECK_SMALL((X.rotation() * X.rotation().transpose() - Eigen::Matrix3d::Identity()).norm(), 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE(CompressedPTransformsTest)
+{
+  using namespace Eigen;
+  using namespace sva;
+
+  const double linTol = 1e-5;
+
+  // smooth trajectory with a few jumps
+  std::vector<PTransformd> pts(SIZE);
+  const MotionVecd nu(Vector3d::Random() * 1e-2, Vector3d::Random() * 1e-3);
+  pts[0] = randomPTransform();
+  for(std::size_t i = 1; i < SIZE; ++i)
+  {
+    pts[i] = sva::exp(nu) * pts[i - 1];
+    if(i % 300 == 0)
+    {
+      pts[i] = PTransformd(pts[i].rotation(), Vector3d::Random() * 100.);
+    }
+  }
+  // the four possible largest quaternion components and a negative translation
+  pts[10] = PTransformd(Quaterniond(0.9, 0.1, -0.2, 0.3).normalized(), Vector3d(-1., -2., -3.));
+  pts[11] = PTransformd(Quaterniond(0.1, -0.9, 0.2, 0.3).normalized(), Vector3d::Zero());
+  pts[12] = PTransformd(Quaterniond(0.1, 0.2, -0.9, 0.3).normalized(), Vector3d::Zero());
+  pts[13] = PTransformd(Quaterniond(-0.1, 0.2, 0.3, -0.9).normalized(), Vector3d::Zero());
+
+  CompressedPTransformsd cpts(linTol);
+  BOOST_CHECK_EQUAL(cpts.linearTolerance(), linTol);
+  BOOST_CHECK_EQUAL(cpts.angularTolerance(), ANG_TOL);
+  BOOST_CHECK_EQUAL(cpts.rotationBits(), 20);
+  cpts.push_back(pts[0]);
+  cpts.push_back(pts.data() + 1, SIZE - 1);
+  BOOST_REQUIRE_EQUAL(cpts.size(), SIZE);
+  BOOST_CHECK(cpts.bytes() < SIZE * sizeof(PTransformd) / 6);
+
+  // whole array
+  std::vector<PTransformd> decoded;
+  cpts.decode(decoded);
+  BOOST_REQUIRE_EQUAL(decoded.size(), SIZE);
+  for(std::size_t i = 0; i < SIZE; ++i)
+  {
+    checkClose(decoded[i], pts[i], linTol);
+  }
+
+  // ranges across blocks and single elements, they can use the SIMD or the
+  // scalar decoding depending on their alignment
+  std::vector<PTransformd> range(100);
+  cpts.decode(250, 100, range.data());
+  for(std::size_t i = 0; i < range.size(); ++i)
+  {
+    BOOST_CHECK(isClose(range[i], decoded[250 + i]));
+  }
+  BOOST_CHECK(isClose(cpts[300], decoded[300]));
+  BOOST_CHECK(isClose(cpts[SIZE - 1], decoded[SIZE - 1]));
+
+  cpts.clear();
+  BOOST_CHECK(cpts.empty());
+  BOOST_CHECK_EQUAL(cpts.bytes(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(CompressedPTransformsRandomTest)
+{
+  using namespace Eigen;
+  using namespace sva;
+
+  // unrelated transformations only use the outlier path for the translations
+  const double linTol = 1e-7;
+  std::vector<PTransformd> pts = randomPTransforms(SIZE);
+  CompressedPTransformsd cpts(linTol);
+  cpts.push_back(pts);
+  std::vector<PTransformd> decoded;
+  cpts.decode(decoded);
+  for(std::size_t i = 0; i < SIZE; ++i)
+  {
+    checkClose(decoded[i], pts[i], linTol);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(CompressedPTransformsAngularToleranceTest)
+{
+  using namespace Eigen;
+  using namespace sva;
+
+  const double linTol = 1e-5;
+  std::vector<PTransformd> pts = randomPTransforms(SIZE);
+  // the four possible largest quaternion components close to the others
+  pts[10] = PTransformd(Quaterniond(0.51, 0.5, -0.5, 0.49).normalized(), Vector3d::Zero());
+  pts[11] = PTransformd(Quaterniond(0.5, -0.51, 0.49, 0.5).normalized(), Vector3d::Zero());
+  pts[12] = PTransformd(Quaterniond(-0.49, 0.5, -0.51, 0.5).normalized(), Vector3d::Zero());
+  pts[13] = PTransformd(Quaterniond(0.5, 0.49, 0.5, -0.51).normalized(), Vector3d::Zero());
+
+  int lastBits = 0;
+  for(double angTol : {0.9, 1e-1, 1e-2, 5.53e-3, 5.52e-3, 1e-3, 1e-4, CompressedPTransformsd::minAngularTolerance()})
+  {
+    CompressedPTransformsd cpts(linTol, angTol);
+    BOOST_CHECK_EQUAL(cpts.angularTolerance(), angTol);
+    // tighter tolerances use more bits
+    BOOST_CHECK(cpts.rotationBits() >= lastBits);
+    lastBits = cpts.rotationBits();
+    cpts.push_back(pts);
+
+    std::vector<PTransformd> decoded;
+    cpts.decode(decoded);
+    for(std::size_t i = 0; i < SIZE; ++i)
+    {
+      checkClose(decoded[i], pts[i], linTol, angTol);
+    }
+    // SIMD and scalar decoding
+    BOOST_CHECK(isClose(cpts[SIZE - 1], decoded[SIZE - 1]));
+    BOOST_CHECK(isClose(cpts[5], decoded[5]));
+
+    // rotations are stored in 32 bits up to 10 bits per component
+    const std::size_t rotationBytes = cpts.rotationBits() <= 10 ? 4 : 8;
+    CompressedPTransformsd wide(linTol);
+    wide.push_back(pts);
+    BOOST_CHECK_EQUAL(cpts.bytes() + (8 - rotationBytes) * SIZE, wide.bytes());
+  }
+  BOOST_CHECK_EQUAL(lastBits, 20);
+  BOOST_CHECK_EQUAL(CompressedPTransformsd(linTol, 5.53e-3).rotationBits(), 10);
+  BOOST_CHECK_EQUAL(CompressedPTransformsd(linTol, 5.52e-3).rotationBits(), 11);
+}
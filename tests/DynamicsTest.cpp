@@ -0,0 +1,284 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#define EIGEN_RUNTIME_NO_MALLOC
+
+// includes
+// std
+#include <iostream>
+
+// boost
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Dynamics test
+#include <boost/test/unit_test.hpp>
+
+// SpaceVecAlg
+#include <SpaceVecAlg/ForwardDynamics.h>
+#include <SpaceVecAlg/InverseDynamics.h>
+#include <SpaceVecAlg/MassMatrix.h>
+
+#include "TestUtils.h"
+
+const double TOL = 1e-8;
+
+/// Branching tree with every joint type.
+sva::KinematicTree<double> makeTree()
+{
+  using namespace sva;
+  using namespace Eigen;
+  KinematicTree<double> tree;
+  int root = tree.addBody(-1, randomPTransform(), JointType::Revolute, Vector3d::UnitZ(), randomRBInertia());
+  int b1 =
+      tree.addBody(root, randomPTransform(), JointType::Revolute, Vector3d::Random().normalized(), randomRBInertia());
+  int b2 =
+      tree.addBody(b1, randomPTransform(), JointType::Prismatic, Vector3d::Random().normalized(), randomRBInertia());
+  tree.addBody(b2, randomPTransform(), JointType::Revolute, Vector3d::UnitX(), randomRBInertia());
+  int b4 = tree.addBody(root, randomPTransform(), JointType::Fixed, Vector3d::UnitZ(), randomRBInertia());
+  int b5 = tree.addBody(b4, randomPTransform(), JointType::Revolute, Vector3d::UnitY(), randomRBInertia());
+  tree.addBody(b5, randomPTransform(), JointType::Prismatic, Vector3d::UnitZ(), randomRBInertia());
+  tree.addBody(b1, randomPTransform(), JointType::Revolute, Vector3d::Random().normalized(), randomRBInertia());
+  return tree;
+}
+
+/// Kinetic energy of the tree.
+double kineticEnergy(const sva::KinematicTree<double> & tree, const Eigen::VectorXd & q, const Eigen::VectorXd & qd)
+{
+  sva::ForwardKinematics<double> fk(tree);
+  fk.computeVelocities(tree, q, qd);
+  double ke = 0.;
+  for(int i = 0; i < tree.nrBodies(); ++i)
+  {
+    const sva::MotionVecd & v = fk.bodyVelB()[static_cast<std::size_t>(i)];
+    ke += 0.5 * v.dot(tree.inertia(i) * v);
+  }
+  return ke;
+}
+
+/// Joint space inertia matrix computed column by column with the inverse dynamics.
+Eigen::MatrixXd massMatrixFromRNEA(const sva::KinematicTree<double> & tree, const Eigen::VectorXd & q)
+{
+  sva::InverseDynamics<double> id(tree);
+  Eigen::VectorXd zero(Eigen::VectorXd::Zero(tree.nrDof()));
+  Eigen::MatrixXd H(tree.nrDof(), tree.nrDof());
+  for(int j = 0; j < tree.nrDof(); ++j)
+  {
+    id.compute(tree, q, zero, Eigen::VectorXd::Unit(tree.nrDof(), j), Eigen::Vector3d::Zero());
+    H.col(j) = id.torque();
+  }
+  return H;
+}
+
+BOOST_AUTO_TEST_CASE(InverseDynamicsTest)
+{
+  using namespace sva;
+  using namespace Eigen;
+  KinematicTree<double> tree = makeTree();
+  InverseDynamics<double> id(tree);
+
+  VectorXd q(VectorXd::Random(tree.nrDof()));
+  VectorXd qd(VectorXd::Random(tree.nrDof()));
+  VectorXd qdd(VectorXd::Random(tree.nrDof()));
+
+  // the mass matrix is symmetric and gives the kinetic energy
+  MatrixXd H = massMatrixFromRNEA(tree, q);
+  BOOST_CHECK_SMALL((H - H.transpose()).norm(), TOL);
+  BOOST_CHECK_SMALL(0.5 * qd.dot(H * qd) - kineticEnergy(tree, q, qd), TOL);
+
+  // without gravity the power of the torques is the derivative of the kinetic energy
+  id.compute(tree, q, qd, qdd, Vector3d::Zero());
+  const double dt = 1e-6;
+  double kePlus = kineticEnergy(tree, q + qd * dt + qdd * dt * dt / 2., qd + qdd * dt);
+  double keMinus = kineticEnergy(tree, q - qd * dt + qdd * dt * dt / 2., qd - qdd * dt);
+  BOOST_CHECK_SMALL(qd.dot(id.torque()) - (kePlus - keMinus) / (2. * dt), 1e-5);
+
+  // the gravity torques are the same with or without velocity and acceleration
+  VectorXd zero(VectorXd::Zero(tree.nrDof()));
+  VectorXd tau(id.torque());
+  id.compute(tree, q, zero, zero);
+  VectorXd tauG(id.torque());
+  id.compute(tree, q, qd, qdd);
+  BOOST_CHECK_SMALL((id.torque() - tau - tauG).norm(), TOL);
+
+  // compute must not allocate
+  Eigen::internal::set_is_malloc_allowed(false);
+  id.compute(tree, q, qd, qdd);
+  Eigen::internal::set_is_malloc_allowed(true);
+}
+
+BOOST_AUTO_TEST_CASE(InverseDynamicsBatchTest)
+{
+  using namespace sva;
+  using namespace Eigen;
+  KinematicTree<double> tree = makeTree();
+
+  const int size = 150;
+  MatrixXd q(MatrixXd::Random(size, tree.nrDof()));
+  MatrixXd qd(MatrixXd::Random(size, tree.nrDof()));
+  MatrixXd qdd(MatrixXd::Random(size, tree.nrDof()));
+
+  InverseDynamicsBatch<double> idBatch(tree, size);
+  idBatch.compute(tree, q, qd, qdd);
+
+  InverseDynamics<double> id(tree);
+  for(int s = 0; s < size; ++s)
+  {
+    id.compute(tree, q.row(s).transpose(), qd.row(s).transpose(), qdd.row(s).transpose());
+    BOOST_CHECK_SMALL((idBatch.torque().row(s).transpose() - id.torque()).norm(), TOL);
+  }
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  idBatch.compute(tree, q, qd, qdd);
+  Eigen::internal::set_is_malloc_allowed(true);
+}
+
+BOOST_AUTO_TEST_CASE(ForwardDynamicsTest)
+{
+  using namespace sva;
+  using namespace Eigen;
+  KinematicTree<double> tree = makeTree();
+  InverseDynamics<double> id(tree);
+  ForwardDynamics<double> fd(tree);
+
+  VectorXd q(VectorXd::Random(tree.nrDof()));
+  VectorXd qd(VectorXd::Random(tree.nrDof()));
+  VectorXd qdd(VectorXd::Random(tree.nrDof()));
+
+  // ABA must invert RNEA, with and without gravity
+  id.compute(tree, q, qd, qdd);
+  fd.compute(tree, q, qd, id.torque());
+  BOOST_CHECK_SMALL((fd.acceleration() - qdd).norm(), TOL);
+
+  id.compute(tree, q, qd, qdd, Vector3d::Zero());
+  fd.compute(tree, q, qd, id.torque(), Vector3d::Zero());
+  BOOST_CHECK_SMALL((fd.acceleration() - qdd).norm(), TOL);
+
+  // qdd = H^-1 (tau - C) with C the RNEA bias forces
+  VectorXd tau(VectorXd::Random(tree.nrDof()));
+  VectorXd zero(VectorXd::Zero(tree.nrDof()));
+  id.compute(tree, q, qd, zero);
+  VectorXd C(id.torque());
+  fd.compute(tree, q, qd, tau);
+  BOOST_CHECK_SMALL((massMatrixFromRNEA(tree, q) * fd.acceleration() + C - tau).norm(), TOL);
+
+  // compute must not allocate
+  Eigen::internal::set_is_malloc_allowed(false);
+  fd.compute(tree, q, qd, tau);
+  Eigen::internal::set_is_malloc_allowed(true);
+}
+
+BOOST_AUTO_TEST_CASE(ForwardDynamicsParallelTest)
+{
+  using namespace sva;
+  using namespace Eigen;
+  KinematicTree<double> tree = makeTree();
+
+  const int size = 101;
+  MatrixXd q(MatrixXd::Random(size, tree.nrDof()));
+  MatrixXd qd(MatrixXd::Random(size, tree.nrDof()));
+  MatrixXd tau(MatrixXd::Random(size, tree.nrDof()));
+  MatrixXd qdd;
+
+  ForwardDynamicsParallel<double> fdPar(tree, 4);
+  BOOST_CHECK_EQUAL(fdPar.nrThreads(), 4u);
+  fdPar.compute(tree, q, qd, tau, qdd);
+  BOOST_REQUIRE_EQUAL(qdd.rows(), size);
+
+  ForwardDynamics<double> fd(tree);
+  for(int s = 0; s < size; ++s)
+  {
+    fd.compute(tree, q.row(s).transpose(), qd.row(s).transpose(), tau.row(s).transpose());
+    BOOST_CHECK_EQUAL(qdd.row(s).transpose(), fd.acceleration());
+  }
+
+  // semi-implicit Euler step
+  const double dt = 1e-3;
+  MatrixXd qNext(q), qdNext(qd);
+  fdPar.step(tree, qNext, qdNext, tau, dt);
+  BOOST_CHECK_SMALL((qdNext - (qd + dt * qdd)).norm(), TOL);
+  BOOST_CHECK_SMALL((qNext - (q + dt * qdNext)).norm(), TOL);
+
+  // the result does not depend on the number of threads
+  ForwardDynamicsParallel<double> fdSingle(tree, 1);
+  MatrixXd qddSingle;
+  fdSingle.compute(tree, q, qd, tau, qddSingle);
+  BOOST_CHECK_EQUAL(qdd, qddSingle);
+}
+
+/// Chain of depth bodies attached to parent.
+int addChain(sva::KinematicTree<double> & tree, int parent, int depth)
+{
+  using namespace Eigen;
+  for(int i = 0; i < depth; ++i)
+  {
+    parent = tree.addBody(parent, randomPTransform(), sva::JointType::Revolute, Vector3d::Random().normalized(),
+                          randomRBInertia());
+  }
+  return parent;
+}
+
+BOOST_AUTO_TEST_CASE(MassMatrixTest)
+{
+  using namespace sva;
+  using namespace Eigen;
+
+  // PTransform::transMul(RBInertia) only uses the lower triangular part of the inertia
+  for(int i = 0; i < 10; ++i)
+  {
+    PTransformd X(randomPTransform());
+    RBInertiad rbI(randomRBInertia());
+    Matrix6d expected = X.matrix().transpose() * rbI.matrix() * X.matrix();
+    BOOST_CHECK_SMALL((X.transMul(rbI).matrix() - expected).array().abs().maxCoeff(), TOL);
+  }
+
+  KinematicTree<double> tree = makeTree();
+  MassMatrix<double> mm(tree);
+  VectorXd q(VectorXd::Random(tree.nrDof()));
+  mm.compute(tree, q);
+  BOOST_CHECK_SMALL((mm.matrix() - massMatrixFromRNEA(tree, q)).norm(), TOL);
+
+  // 1/2 qd^T H qd is the kinetic energy
+  VectorXd qd(VectorXd::Random(tree.nrDof()));
+  BOOST_CHECK_SMALL(0.5 * qd.dot(mm.matrix() * qd) - kineticEnergy(tree, q, qd), TOL);
+
+  // compute must not allocate
+  Eigen::internal::set_is_malloc_allowed(false);
+  mm.compute(tree, q);
+  Eigen::internal::set_is_malloc_allowed(true);
+}
+
+BOOST_AUTO_TEST_CASE(MassMatrixParallelTest)
+{
+  using namespace sva;
+  using namespace Eigen;
+
+  // humanoid like tree: a trunk with two arms, two legs and a head
+  KinematicTree<double> tree;
+  int pelvis = tree.addBody(-1, randomPTransform(), JointType::Prismatic, Vector3d::UnitZ(), randomRBInertia());
+  int torso = addChain(tree, pelvis, 3);
+  addChain(tree, pelvis, 6);
+  addChain(tree, pelvis, 6);
+  addChain(tree, torso, 7);
+  addChain(tree, torso, 7);
+  addChain(tree, torso, 2);
+
+  VectorXd q(VectorXd::Random(tree.nrDof()));
+  MassMatrix<double> mmSingle(tree, 1);
+  mmSingle.compute(tree, q);
+  BOOST_CHECK_SMALL((mmSingle.matrix() - massMatrixFromRNEA(tree, q)).norm(), TOL);
+
+  // the result does not depend on the number of threads
+  for(unsigned nrThreads : {2u, 3u, 4u, 8u, 64u})
+  {
+    MassMatrix<double> mm(tree, nrThreads);
+    BOOST_CHECK_EQUAL(mm.nrThreads(), nrThreads);
+    BOOST_CHECK_GE(mm.nrSubtrees(), std::min<std::size_t>(nrThreads, 5));
+    mm.compute(tree, q);
+    BOOST_CHECK_EQUAL(mm.matrix(), mmSingle.matrix());
+    for(int i = 0; i < tree.nrBodies(); ++i)
+    {
+      const std::size_t ui = static_cast<std::size_t>(i);
+      BOOST_CHECK(mm.compositeInertia()[ui] == mmSingle.compositeInertia()[ui]);
+    }
+  }
+}
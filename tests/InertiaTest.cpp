@@ -302,3 +302,25 @@ BOOST_AUTO_TEST_CASE(ABInertiadLeftOperatorsTest)
 #endif
   BOOST_CHECK_EQUAL(fVecRes6Xd.col(0), fVecRes6Xd.col(1));
 }
+
+BOOST_AUTO_TEST_CASE(ABInertiadMulMatrixTest)
+{
+  using namespace Eigen;
+  using namespace sva;
+  // the mass matrix and the inertia must differ to check that each one is
+  // applied to the right part of the motion vectors
+  Matrix3d A = Matrix3d::Random();
+  Matrix3d B = Matrix3d::Random();
+  ABInertiad ab(A * A.transpose() + Matrix3d::Identity(), Matrix3d::Random(),
+                B * B.transpose() + 2. * Matrix3d::Identity());
+
+  Matrix6Xd mVec6Xd(Matrix6Xd::Random(6, 5));
+  Matrix6Xd fVecRes6Xd(6, 5);
+  ab.mul(mVec6Xd, fVecRes6Xd);
+
+  BOOST_CHECK_SMALL((ab.matrix() * mVec6Xd - fVecRes6Xd).array().abs().maxCoeff(), TOL);
+  for(int i = 0; i < 5; ++i)
+  {
+    BOOST_CHECK_SMALL(((ab * MotionVecd(mVec6Xd.col(i))).vector() - fVecRes6Xd.col(i)).array().abs().maxCoeff(), TOL);
+  }
+}
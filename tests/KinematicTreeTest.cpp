@@ -0,0 +1,179 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#define EIGEN_RUNTIME_NO_MALLOC
+
+// includes
+// std
+#include <iostream>
+
+// boost
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE KinematicTree test
+#include <boost/test/unit_test.hpp>
+
+// SpaceVecAlg
+#include <SpaceVecAlg/ForwardKinematics.h>
+
+#include "TestUtils.h"
+
+const double TOL = 1e-10;
+
+/// Branching tree with every joint type.
+sva::KinematicTree<double> makeTree()
+{
+  using namespace sva;
+  KinematicTree<double> tree;
+  int root = tree.addBody(-1, randomPTransform(), JointType::Revolute, Eigen::Vector3d::UnitZ());
+  int b1 = tree.addBody(root, randomPTransform(), JointType::Revolute, Eigen::Vector3d::Random().normalized());
+  int b2 = tree.addBody(b1, randomPTransform(), JointType::Prismatic, Eigen::Vector3d::Random().normalized());
+  tree.addBody(b2, randomPTransform(), JointType::Revolute, Eigen::Vector3d::UnitX());
+  int b4 = tree.addBody(root, randomPTransform(), JointType::Fixed);
+  int b5 = tree.addBody(b4, randomPTransform(), JointType::Revolute, Eigen::Vector3d::UnitY());
+  tree.addBody(b5, randomPTransform(), JointType::Prismatic, Eigen::Vector3d::UnitZ());
+  tree.addBody(b1, randomPTransform(), JointType::Revolute, Eigen::Vector3d::Random().normalized());
+  return tree;
+}
+
+bool isClose(const sva::PTransformd & pt1, const sva::PTransformd & pt2, double tol = TOL)
+{
+  return (pt1.matrix() - pt2.matrix()).array().abs().maxCoeff() < tol;
+}
+
+bool isClose(const sva::MotionVecd & mv1, const sva::MotionVecd & mv2, double tol = TOL)
+{
+  return (mv1.vector() - mv2.vector()).array().abs().maxCoeff() < tol;
+}
+
+BOOST_AUTO_TEST_CASE(KinematicTreeTest)
+{
+  using namespace sva;
+  KinematicTree<double> tree = makeTree();
+
+  BOOST_CHECK_EQUAL(tree.nrBodies(), 8);
+  BOOST_CHECK_EQUAL(tree.nrDof(), 7);
+  BOOST_CHECK_EQUAL(tree.dofIndex(4), -1);
+  BOOST_CHECK_EQUAL(tree.dofIndex(5), 4);
+
+  // joint transformations
+  BOOST_CHECK(isClose(tree.jointTransform(0, 0.3), PTransformd(RotZ(0.3))));
+  BOOST_CHECK(isClose(tree.jointTransform(3, -0.7), PTransformd(RotX(-0.7))));
+  BOOST_CHECK(isClose(tree.jointTransform(6, 0.5), PTransformd(Eigen::Vector3d(0., 0., 0.5))));
+  BOOST_CHECK(isClose(tree.jointTransform(4, 0.5), PTransformd::Identity()));
+
+  Eigen::VectorXd q(Eigen::VectorXd::Random(10));
+  PTransformBatchd XjBatch;
+  for(int i = 0; i < tree.nrBodies(); ++i)
+  {
+    tree.jointTransform(i, q, XjBatch);
+    for(int j = 0; j < q.size(); ++j)
+    {
+      BOOST_CHECK(isClose(XjBatch[j], tree.jointTransform(i, q(j))));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ParentToBodyTest)
+{
+  using namespace sva;
+  using namespace Eigen;
+  KinematicTree<double> tree = makeTree();
+  for(const Vector3d & axis : {Vector3d(-Vector3d::UnitX()), Vector3d(-Vector3d::UnitY()), Vector3d(-Vector3d::UnitZ())})
+  {
+    tree.addBody(tree.nrBodies() - 1, randomPTransform(), JointType::Revolute, axis);
+  }
+
+  for(int i = 0; i < tree.nrBodies(); ++i)
+  {
+    for(double q : {0., 0.3, -1.2, 2.5})
+    {
+      BOOST_CHECK(isClose(tree.parentToBody(i, q), tree.jointTransform(i, q) * tree.treeTransform(i)));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ForwardKinematicsTest)
+{
+  using namespace sva;
+  KinematicTree<double> tree = makeTree();
+  ForwardKinematics<double> fk(tree);
+
+  Eigen::VectorXd q(Eigen::VectorXd::Random(tree.nrDof()));
+  Eigen::VectorXd qd(Eigen::VectorXd::Random(tree.nrDof()));
+  Eigen::VectorXd qdd(Eigen::VectorXd::Random(tree.nrDof()));
+
+  fk.computeAccelerations(tree, q, qd, qdd);
+
+  // poses by composing the transformations up to the root
+  for(int i = 0; i < tree.nrBodies(); ++i)
+  {
+    PTransformd X_0_i = PTransformd::Identity();
+    for(int b = i; b >= 0; b = tree.parent(b))
+    {
+      double qb = tree.dofIndex(b) < 0 ? 0. : q(tree.dofIndex(b));
+      X_0_i = X_0_i * tree.jointTransform(b, qb) * tree.treeTransform(b);
+    }
+    BOOST_CHECK(isClose(fk.bodyPosW()[static_cast<std::size_t>(i)], X_0_i));
+  }
+
+  // velocities and accelerations by finite differences
+  const double dt = 1e-6;
+  ForwardKinematics<double> fkPlus(tree), fkMinus(tree);
+  fkPlus.computeVelocities(tree, q + qd * dt + qdd * dt * dt / 2., qd + qdd * dt);
+  fkMinus.computeVelocities(tree, q - qd * dt + qdd * dt * dt / 2., qd - qdd * dt);
+  for(std::size_t i = 0; i < static_cast<std::size_t>(tree.nrBodies()); ++i)
+  {
+    PTransformd X_minus_plus = fkPlus.bodyPosW()[i] * fkMinus.bodyPosW()[i].inv();
+    MotionVecd velDiff = transformVelocity(X_minus_plus) / (2. * dt);
+    BOOST_CHECK(isClose(fk.bodyVelB()[i], velDiff, 1e-5));
+
+    MotionVecd accDiff = (fkPlus.bodyVelB()[i] - fkMinus.bodyVelB()[i]) / (2. * dt);
+    BOOST_CHECK(isClose(fk.bodyAccB()[i], accDiff, 1e-5));
+  }
+
+  // base acceleration is propagated to every body
+  MotionVecd a0(Eigen::Vector3d::Zero(), Eigen::Vector3d(0., 0., 9.81));
+  ForwardKinematics<double> fkGravity(tree);
+  fkGravity.computeAccelerations(tree, q, qd, qdd, a0);
+  for(std::size_t i = 0; i < static_cast<std::size_t>(tree.nrBodies()); ++i)
+  {
+    BOOST_CHECK(isClose(fkGravity.bodyAccB()[i], fk.bodyAccB()[i] + fk.bodyPosW()[i] * a0));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ForwardKinematicsBatchTest)
+{
+  using namespace sva;
+  KinematicTree<double> tree = makeTree();
+
+  // not a multiple of the kernel block size to check the tail handling
+  const int size = 150;
+  Eigen::MatrixXd q(Eigen::MatrixXd::Random(size, tree.nrDof()));
+  Eigen::MatrixXd qd(Eigen::MatrixXd::Random(size, tree.nrDof()));
+  Eigen::MatrixXd qdd(Eigen::MatrixXd::Random(size, tree.nrDof()));
+  MotionVecd a0(Eigen::Vector3d::Zero(), Eigen::Vector3d(0., 0., 9.81));
+
+  ForwardKinematicsBatch<double> fkBatch(tree, size);
+  fkBatch.computeAccelerations(tree, q, qd, qdd, a0);
+
+  ForwardKinematics<double> fk(tree);
+  for(int s = 0; s < size; ++s)
+  {
+    fk.computeAccelerations(tree, q.row(s).transpose(), qd.row(s).transpose(), qdd.row(s).transpose(), a0);
+    for(std::size_t i = 0; i < static_cast<std::size_t>(tree.nrBodies()); ++i)
+    {
+      BOOST_CHECK(isClose(fkBatch.parentToBody()[i][s], fk.parentToBody()[i]));
+      BOOST_CHECK(isClose(fkBatch.bodyPosW()[i][s], fk.bodyPosW()[i]));
+      BOOST_CHECK(isClose(fkBatch.bodyVelB()[i][s], fk.bodyVelB()[i]));
+      BOOST_CHECK(isClose(fkBatch.bodyAccB()[i][s], fk.bodyAccB()[i]));
+    }
+  }
+
+  // the compute functions must not allocate once the buffers are sized
+  Eigen::VectorXd q0(q.row(0).transpose()), qd0(qd.row(0).transpose()), qdd0(qdd.row(0).transpose());
+  Eigen::internal::set_is_malloc_allowed(false);
+  fkBatch.computeAccelerations(tree, q, qd, qdd, a0);
+  fk.computeAccelerations(tree, q0, qd0, qdd0, a0);
+  Eigen::internal::set_is_malloc_allowed(true);
+}
@@ -211,3 +211,359 @@ BOOST_AUTO_TEST_CASE(SO3RightJacInvDotTest)
     BOOST_CHECK_SMALL((dM - J0).norm(), 1e-6);
   }
 }
+
+BOOST_AUTO_TEST_CASE(SO3SE3JacCoeffs)
+{
+  // x, (1 - cos x)/x^2, (x - sin x)/x^3, (x^2 + 2cos x - 2)/(2x^4), (2x - 3sin x + xcos x)/(2x^5)
+  // Ground truth numbers were computed with 80 digits precision.
+  // clang-format off
+  const std::vector<std::array<double, 5>> values = {
+    {2., 0.3540367091367855967493921, 0.1363378216467897880754975, 0.03649082271580360081265199, 0.006872094475447970934637562},
+    {1.2, 0.4428071149467544599733518, 0.1550699733985958624594129, 0.03971728128697606946295011, 0.007778751822580947015585761},
+    {1.1, 0.4515734533672914150649834, 0.1568690007051575206973685, 0.04002193936587486358265832, 0.007865102788504606209554527},
+    {1., 0.4596976941318602825990634, 0.1585290151921034933474977, 0.04030230586813971740093661, 0.007944675722225098721714821},
+    {0.9, 0.4671481873201673376731899, 0.1600453914574987812601066, 0.04055779343189217571211119, 0.008017275958227781547610958},
+    {0.5, 0.4896697524385091355348737, 0.1645956911663759978136965, 0.04132099024596345786050532, 0.008234642121237715812431770},
+    {1e-1, 0.4995834721974233904438012, 0.1665833531718476931858016, 0.04165278025766095561987804, 0.008329365905984455680177426},
+    {1e-2, 0.4999958333472221974206625, 0.1666658333353174575617309, 0.04166652777802579337522067, 0.008333293650876322651114398},
+    {1e-4, 0.4999999995833333334722222, 0.1666666665833333333531746, 0.04166666665277777778025794, 0.008333333329365079365906085},
+    {1e-6, 0.4999999999999583333333333, 0.1666666666666583333333333, 0.04166666666666527777777778, 0.008333333333332936507936508},
+    {1e-8, 0.4999999999999999958333333, 0.1666666666666666658333333, 0.04166666666666666652777778, 0.008333333333333333293650794},
+    {0., 0.5, 1. / 6., 1. / 24., 1. / 120.}};
+  // clang-format on
+
+  auto check = [](double res, double ref, double eps)
+  { BOOST_CHECK_SMALL(std::abs(res - ref) / ref, eps); };
+
+  // The closed forms are subtracting close numbers just above the Taylor bounds (about 1 to 1.2),
+  // hence a small loss of accuracy.
+  const double eps = 20 * std::numeric_limits<double>::epsilon();
+  for(const auto & v : values)
+  {
+    for(double x : {v[0], -v[0]})
+    {
+      check(details::SO3JacG1(x), v[1], eps);
+      check(details::SO3JacG2(x), v[2], eps);
+      double G[4];
+      details::alternatingFactorialFunctions<5>(x * x, G);
+      check(G[2], v[3], eps);
+      check(0.5 * (G[2] - 3 * G[3]), v[4], eps);
+    }
+    check(details::SO3JacG1(static_cast<float>(v[0])), v[1], 8 * std::numeric_limits<float>::epsilon());
+    check(details::SO3JacG2(static_cast<float>(v[0])), v[2], 8 * std::numeric_limits<float>::epsilon());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SO3RightJacTest)
+{
+  for(int i = 0; i < 100; ++i)
+  {
+    for(double scale : {1e-9, 1e-3, 1., 3.})
+    {
+      Vector3d u = Vector3d::Random().normalized() * scale;
+      Matrix3d Jr = SO3RightJac(u);
+      BOOST_CHECK_SMALL((Jr * SO3RightJacInv(u) - Matrix3d::Identity()).norm(), 1e-12);
+      BOOST_CHECK_SMALL((SO3LeftJac(u) - Jr.transpose()).norm(), 1e-15);
+    }
+  }
+}
+
+namespace
+{
+
+/// Exponential of the homogeneous matrix of nu, converted to a PTransform.
+PTransformd homogeneousExp(const MotionVecd & nu)
+{
+  Matrix4d T = Matrix4d::Zero();
+  T.topLeftCorner<3, 3>() = vector3ToCrossMatrix(nu.angular());
+  T.topRightCorner<3, 1>() = nu.linear();
+  Matrix4d eT = T.exp();
+  return PTransformd(Matrix3d(eT.topLeftCorner<3, 3>().transpose()), Vector3d(eT.topRightCorner<3, 1>()));
+}
+
+/// Finite differences of the Jacobians of SE(3), left = exp(nu)^-1*exp(nu + dnu) and right = exp(nu + dnu)*exp(nu)^-1.
+Matrix6d SE3JacFiniteDiff(const MotionVecd & nu, bool left)
+{
+  const double h = 1e-5;
+  Matrix6d J;
+  for(int i = 0; i < 6; ++i)
+  {
+    MotionVecd dnu(Vector6d(h * Vector6d::Unit(i)));
+    PTransformd Xp = exp(nu + dnu);
+    PTransformd Xm = exp(nu - dnu);
+    PTransformd Xinv = exp(nu).inv();
+    PTransformd Dp = left ? PTransformd(Xinv * Xp) : PTransformd(Xp * Xinv);
+    PTransformd Dm = left ? PTransformd(Xinv * Xm) : PTransformd(Xm * Xinv);
+    J.col(i) = (transformVelocity(Dp).vector() - transformVelocity(Dm).vector()) / (2 * h);
+  }
+  return J;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(SE3ExpTest)
+{
+  BOOST_CHECK_EQUAL(exp(MotionVecd(Vector6d::Zero())), PTransformd::Identity());
+
+  for(int i = 0; i < 100; ++i)
+  {
+    for(double scale : {0., 1e-9, 1e-5, 0.5, 1., 3.})
+    {
+      MotionVecd nu(Vector3d(Vector3d::Random().normalized() * scale), Vector3d::Random());
+      PTransformd X = exp(nu);
+      PTransformd Xh = homogeneousExp(nu);
+      BOOST_CHECK_SMALL((X.matrix() - Xh.matrix()).norm(), 1e-12);
+      BOOST_CHECK_SMALL((rotationVelocity(X.rotation()) - nu.angular()).norm(), 1e-9);
+      BOOST_CHECK_SMALL((X.translation() - SO3LeftJac(nu.angular()) * nu.linear()).norm(), 1e-14);
+      // exp(-nu) = exp(nu)^-1
+      BOOST_CHECK_SMALL((exp(-nu).matrix() - X.inv().matrix()).norm(), 1e-12);
+    }
+  }
+
+  // rotation about an axis
+  double theta = 0.3;
+  BOOST_CHECK_SMALL((exp(MotionVecd(Vector3d(theta, 0., 0.), Vector3d::Zero())).rotation() - RotX(theta)).norm(), 1e-15);
+  BOOST_CHECK_SMALL((exp(MotionVecd(Vector3d(0., theta, 0.), Vector3d::Zero())).rotation() - RotY(theta)).norm(), 1e-15);
+  BOOST_CHECK_SMALL((exp(MotionVecd(Vector3d(0., 0., theta), Vector3d::Zero())).rotation() - RotZ(theta)).norm(), 1e-15);
+}
+
+BOOST_AUTO_TEST_CASE(SE3JacTest)
+{
+  for(int i = 0; i < 20; ++i)
+  {
+    for(double scale : {0., 1e-6, 0.5, 1.2, 3.})
+    {
+      MotionVecd nu(Vector3d(Vector3d::Random().normalized() * scale), Vector3d::Random());
+      SE3Jacobiand Jr = SE3RightJac(nu);
+      SE3Jacobiand Jl = SE3LeftJac(nu);
+
+      BOOST_CHECK_SMALL((Jr.D() - SO3RightJac(nu.angular())).norm(), 1e-15);
+      BOOST_CHECK_SMALL((Jl.D() - SO3LeftJac(nu.angular())).norm(), 1e-15);
+      // J_r(nu) = J_l(-nu)
+      BOOST_CHECK_SMALL((Jr.matrix() - SE3LeftJac(MotionVecd(-nu)).matrix()).norm(), 1e-15);
+
+      BOOST_CHECK_SMALL((Jr.matrix() - SE3JacFiniteDiff(nu, false)).norm(), 1e-8);
+      BOOST_CHECK_SMALL((Jl.matrix() - SE3JacFiniteDiff(nu, true)).norm(), 1e-8);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SE3JacInvTest)
+{
+  for(double x : {0., 1e-8, 1e-3, 0.5, 1.2, 1.3, 1.5, 1.6, 3.})
+  {
+    double G[6];
+    sva::details::alternatingFactorialFunctions<7>(x * x, G);
+    BOOST_CHECK_SMALL(G[0] - sva::details::SO3JacG1(x), 1e-15);
+    BOOST_CHECK_SMALL(G[1] - sva::details::SO3JacG2(x), 1e-15);
+    // G_N = 1/N! - x^2 G_{N+2}
+    BOOST_CHECK_SMALL(G[3] - (1. / 120 - x * x * G[5]), 1e-15);
+  }
+
+  const double h = 1e-5;
+  for(int i = 0; i < 20; ++i)
+  {
+    for(double scale : {0., 1e-6, 0.5, 1.2, 1.5, 3.})
+    {
+      MotionVecd nu(Vector3d(Vector3d::Random().normalized() * scale), Vector3d::Random());
+      MotionVecd dnu(Vector3d::Random(), Vector3d::Random());
+      SE3Jacobiand JrInv = SE3RightJacInv(nu);
+      SE3Jacobiand JlInv = SE3LeftJacInv(nu);
+
+      BOOST_CHECK_SMALL((JrInv.matrix() * SE3RightJac(nu).matrix() - Matrix6d::Identity()).norm(), 1e-14);
+      BOOST_CHECK_SMALL((JlInv.matrix() * SE3LeftJac(nu).matrix() - Matrix6d::Identity()).norm(), 1e-14);
+      BOOST_CHECK_SMALL((JrInv.D() - SO3RightJacInv(nu.angular())).norm(), 1e-14);
+      BOOST_CHECK_SMALL((JlInv.D() - SO3RightJacInv(nu.angular()).transpose()).norm(), 1e-14);
+      BOOST_CHECK_SMALL((JrInv.matrix() - SE3LeftJacInv(MotionVecd(-nu)).matrix()).norm(), 1e-15);
+
+      Matrix6d JrInvDotFD =
+          (SE3RightJacInv(MotionVecd(nu + h * dnu)).matrix() - SE3RightJacInv(MotionVecd(nu - h * dnu)).matrix())
+          / (2 * h);
+      Matrix6d JlInvDotFD =
+          (SE3LeftJacInv(MotionVecd(nu + h * dnu)).matrix() - SE3LeftJacInv(MotionVecd(nu - h * dnu)).matrix())
+          / (2 * h);
+      BOOST_CHECK_SMALL((SE3RightJacInvDot(nu, dnu).matrix() - JrInvDotFD).norm(), 1e-8);
+      BOOST_CHECK_SMALL((SE3LeftJacInvDot(nu, dnu).matrix() - JlInvDotFD).norm(), 1e-8);
+      if(scale > 0)
+      {
+        BOOST_CHECK_SMALL(
+            (SE3RightJacInvDot(nu, dnu).D() - SO3RightJacInvDot<double>(nu.angular(), dnu.angular())).norm(), 1e-12);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SE3JacobianOperators)
+{
+  MotionVecd nu(Vector3d::Random(), Vector3d::Random());
+  MotionVecd mv(Vector3d::Random(), Vector3d::Random());
+  ForceVecd fv(Vector3d::Random(), Vector3d::Random());
+  SE3Jacobiand J1 = SE3RightJac(nu);
+  SE3Jacobiand J2 = SE3LeftJac(mv);
+
+  BOOST_CHECK_SMALL(((J1 * mv).vector() - J1.matrix() * mv.vector()).norm(), 1e-14);
+  BOOST_CHECK_SMALL((J1.transMul(fv).vector() - J1.matrix().transpose() * fv.vector()).norm(), 1e-14);
+  BOOST_CHECK_SMALL(((J1 * J2).matrix() - J1.matrix() * J2.matrix()).norm(), 1e-14);
+  BOOST_CHECK_EQUAL(SE3Jacobiand::Identity().matrix(), Matrix6d::Identity());
+  SE3Jacobian<float> J1f = J1.cast<float>();
+  BOOST_CHECK_EQUAL(J1f.D(), Matrix3f(J1.D().cast<float>()));
+  BOOST_CHECK_EQUAL(J1f.L(), Matrix3f(J1.L().cast<float>()));
+}
+
+namespace
+{
+
+/// @return exp(dx)*X.
+PTransformd perturb(const PTransformd & X, const MotionVecd & dx)
+{
+  return exp(dx) * X;
+}
+
+/// Central finite differences of a PTransform valued function of a PTransform.
+template<typename F>
+Matrix6d PTransformJacFiniteDiff(const F & f, const PTransformd & X)
+{
+  const double h = 1e-5;
+  PTransformd fInv = f(X).inv();
+  Matrix6d J;
+  for(int i = 0; i < 6; ++i)
+  {
+    MotionVecd dx(Vector6d(h * Vector6d::Unit(i)));
+    J.col(i) = (transformVelocity(PTransformd(f(perturb(X, dx)) * fInv)).vector()
+                - transformVelocity(PTransformd(f(perturb(X, -dx)) * fInv)).vector())
+               / (2 * h);
+  }
+  return J;
+}
+
+/// Central finite differences of a vector valued function of a PTransform.
+template<typename F>
+Matrix6d VecJacFiniteDiff(const F & f, const PTransformd & X)
+{
+  const double h = 1e-5;
+  Matrix6d J;
+  for(int i = 0; i < 6; ++i)
+  {
+    MotionVecd dx(Vector6d(h * Vector6d::Unit(i)));
+    J.col(i) = (f(perturb(X, dx)) - f(perturb(X, -dx))) / (2 * h);
+  }
+  return J;
+}
+
+PTransformd randomPTransform(double angle)
+{
+  return PTransformd(AngleAxisd(angle, Vector3d::Random().normalized()).toRotationMatrix(), Vector3d::Random());
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(OperatorJacobianTest)
+{
+  for(int i = 0; i < 20; ++i)
+  {
+    PTransformd X1 = randomPTransform(2.);
+    PTransformd X2 = randomPTransform(1.);
+    MotionVecd mv(Vector3d::Random(), Vector3d::Random());
+    ForceVecd fv(Vector3d::Random(), Vector3d::Random());
+
+    BinaryJacobian<SE3Jacobiand> J = mulJacobian(X1, X2);
+    BOOST_CHECK_EQUAL(J.first, SE3Jacobiand::Identity());
+    BOOST_CHECK_SMALL((J.second.matrix() - X1.matrix()).norm(), 1e-15);
+    BOOST_CHECK_SMALL(
+        (J.first.matrix() - PTransformJacFiniteDiff([&](const PTransformd & X) { return PTransformd(X * X2); }, X1))
+            .norm(),
+        1e-8);
+    BOOST_CHECK_SMALL(
+        (J.second.matrix() - PTransformJacFiniteDiff([&](const PTransformd & X) { return PTransformd(X1 * X); }, X2))
+            .norm(),
+        1e-8);
+
+    BOOST_CHECK_SMALL(
+        (invJacobian(X1).matrix() - PTransformJacFiniteDiff([](const PTransformd & X) { return X.inv(); }, X1)).norm(),
+        1e-8);
+
+    BOOST_CHECK_SMALL(
+        (mulJacobian(X1, mv).matrix()
+         - VecJacFiniteDiff([&](const PTransformd & X) { return Vector6d((X * mv).vector()); }, X1))
+            .norm(),
+        1e-8);
+    BOOST_CHECK_SMALL(
+        (invMulJacobian(X1, mv).matrix()
+         - VecJacFiniteDiff([&](const PTransformd & X) { return Vector6d(X.invMul(mv).vector()); }, X1))
+            .norm(),
+        1e-8);
+    BOOST_CHECK_SMALL(
+        (dualMulJacobian(X1, fv).matrix()
+         - VecJacFiniteDiff([&](const PTransformd & X) { return Vector6d(X.dualMul(fv).vector()); }, X1))
+            .norm(),
+        1e-8);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TransformErrorJacobianTest)
+{
+  for(int i = 0; i < 20; ++i)
+  {
+    for(double angle : {0., 1e-6, 0.5, 2.})
+    {
+      PTransformd X_a_b = randomPTransform(1.);
+      PTransformd X_a_c = PTransformd(randomPTransform(angle).rotation(), Vector3d::Random()) * X_a_b;
+
+      BinaryJacobian<BlockDiagJacobiand> J = transformErrorJacobian(X_a_b, X_a_c);
+      Matrix6d J1 = VecJacFiniteDiff(
+          [&](const PTransformd & X) { return Vector6d(transformError(X, X_a_c).vector()); }, X_a_b);
+      Matrix6d J2 = VecJacFiniteDiff(
+          [&](const PTransformd & X) { return Vector6d(transformError(X_a_b, X).vector()); }, X_a_c);
+      BOOST_CHECK_SMALL((J.first.matrix() - J1).norm(), 1e-8);
+      BOOST_CHECK_SMALL((J.second.matrix() - J2).norm(), 1e-8);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(InterpolateJacobianTest)
+{
+  for(int i = 0; i < 20; ++i)
+  {
+    for(double angle : {0., 1e-6, 0.5, 2.})
+    {
+      for(double t : {0., 0.3, 0.5, 1.})
+      {
+        PTransformd from = randomPTransform(1.);
+        PTransformd to = PTransformd(randomPTransform(angle).rotation(), Vector3d::Random()) * from;
+
+        BinaryJacobian<BlockDiagJacobiand> J = interpolateJacobian(from, to, t);
+        Matrix6d J1 = PTransformJacFiniteDiff([&](const PTransformd & X) { return interpolate(X, to, t); }, from);
+        Matrix6d J2 = PTransformJacFiniteDiff([&](const PTransformd & X) { return interpolate(from, X, t); }, to);
+        BOOST_CHECK_SMALL((J.first.matrix() - J1).norm(), 1e-8);
+        BOOST_CHECK_SMALL((J.second.matrix() - J2).norm(), 1e-8);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(BlockDiagJacobianOperators)
+{
+  BlockDiagJacobiand J1(Matrix3d::Random(), Matrix3d::Random());
+  BlockDiagJacobiand J2(Matrix3d::Random(), Matrix3d::Random());
+  MotionVecd mv(Vector3d::Random(), Vector3d::Random());
+  ForceVecd fv(Vector3d::Random(), Vector3d::Random());
+
+  BOOST_CHECK_SMALL(((J1 * mv).vector() - J1.matrix() * mv.vector()).norm(), 1e-14);
+  BOOST_CHECK_SMALL((J1.transMul(fv).vector() - J1.matrix().transpose() * fv.vector()).norm(), 1e-14);
+  BOOST_CHECK_SMALL(((J1 * J2).matrix() - J1.matrix() * J2.matrix()).norm(), 1e-14);
+  BOOST_CHECK_EQUAL(BlockDiagJacobiand::Identity().matrix(), Matrix6d::Identity());
+  BlockDiagJacobian<float> J1f = J1.cast<float>();
+  BOOST_CHECK_EQUAL(J1f.angular(), Matrix3f(J1.angular().cast<float>()));
+}
+
+BOOST_AUTO_TEST_CASE(ForceCrossJacobianOperators)
+{
+  ForceCrossJacobiand J(Vector3d::Random(), Vector3d::Random());
+  MotionVecd mv(Vector3d::Random(), Vector3d::Random());
+
+  BOOST_CHECK_SMALL(((J * mv).vector() - J.matrix() * mv.vector()).norm(), 1e-14);
+  BOOST_CHECK_SMALL((J.transMul(mv).vector() - J.matrix().transpose() * mv.vector()).norm(), 1e-14);
+  BOOST_CHECK_SMALL(((J * mv).vector() + mv.crossDual(ForceVecd(J.couple(), J.force())).vector()).norm(), 1e-14);
+  ForceCrossJacobian<float> Jf = J.cast<float>();
+  BOOST_CHECK_EQUAL(Jf.force(), Vector3f(J.force().cast<float>()));
+}
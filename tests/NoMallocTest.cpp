@@ -0,0 +1,495 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#define EIGEN_RUNTIME_NO_MALLOC
+
+// includes
+// std
+#include <cmath>
+#include <functional>
+#include <iostream>
+
+// boost
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE NoMalloc test
+#include <boost/test/unit_test.hpp>
+
+// SpaceVecAlg
+#include <SpaceVecAlg/Conversions.h>
+#include <SpaceVecAlg/SpaceVecAlg>
+
+#include "TestUtils.h"
+
+// Every operator that does not return a dynamic size object must not allocate.
+// Eigen asserts as soon as a malloc happens while set_is_malloc_allowed(false).
+
+const double TOL = 1e-8;
+
+typedef Eigen::Matrix<double, 6, Eigen::Dynamic> Matrix6Xd;
+typedef Eigen::Matrix<double, 6, Eigen::Dynamic, Eigen::ColMajor, 6, 8> Matrix6XMax8d;
+typedef Eigen::Matrix<double, 6, 3> Matrix63d;
+
+/**
+ * Call the Matrix6X version of every operator with malloc disabled and check
+ * each column against the MotionVec or ForceVec version.
+ */
+template<typename Derived>
+void checkMatrix6X(Eigen::MatrixBase<Derived> & in, Eigen::MatrixBase<Derived> & out)
+{
+  using namespace sva;
+  in.setRandom();
+  MotionVecd mv(Eigen::Vector6d::Random());
+  RBInertiad rbI(randomRBInertia());
+  ABInertiad abI(randomABInertia());
+  PTransformd pt(randomPTransform());
+  QTransformd qt(randomPTransform());
+  RotationTransformd rt(randomPTransform().rotation());
+  TranslationTransformd tt(randomPTransform().translation());
+  RotZTransformd rz(0.7);
+
+  auto checkMotion = [&in, &out](const std::function<MotionVecd(const MotionVecd &)> & op) {
+    for(Eigen::Index i = 0; i < in.cols(); ++i)
+    {
+      BOOST_CHECK_SMALL((op(MotionVecd(in.col(i))).vector() - out.col(i)).norm(), TOL);
+    }
+  };
+  auto checkForce = [&in, &out](const std::function<ForceVecd(const ForceVecd &)> & op) {
+    for(Eigen::Index i = 0; i < in.cols(); ++i)
+    {
+      BOOST_CHECK_SMALL((op(ForceVecd(in.col(i))).vector() - out.col(i)).norm(), TOL);
+    }
+  };
+  auto checkMotionToForce = [&in, &out](const std::function<ForceVecd(const MotionVecd &)> & op) {
+    for(Eigen::Index i = 0; i < in.cols(); ++i)
+    {
+      BOOST_CHECK_SMALL((op(MotionVecd(in.col(i))).vector() - out.col(i)).norm(), TOL);
+    }
+  };
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  mv.cross(in, out);
+  Eigen::internal::set_is_malloc_allowed(true);
+  checkMotion([&mv](const MotionVecd & m) { return mv.cross(m); });
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  mv.crossDual(in, out);
+  Eigen::internal::set_is_malloc_allowed(true);
+  checkForce([&mv](const ForceVecd & f) { return mv.crossDual(f); });
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  rbI.mul(in, out);
+  Eigen::internal::set_is_malloc_allowed(true);
+  checkMotionToForce([&rbI](const MotionVecd & m) { return rbI * m; });
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  abI.mul(in, out);
+  Eigen::internal::set_is_malloc_allowed(true);
+  checkMotionToForce([&abI](const MotionVecd & m) { return abI * m; });
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  pt.mul(in, out);
+  Eigen::internal::set_is_malloc_allowed(true);
+  checkMotion([&pt](const MotionVecd & m) { return pt * m; });
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  pt.invMul(in, out);
+  Eigen::internal::set_is_malloc_allowed(true);
+  checkMotion([&pt](const MotionVecd & m) { return pt.invMul(m); });
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  pt.dualMul(in, out);
+  Eigen::internal::set_is_malloc_allowed(true);
+  checkForce([&pt](const ForceVecd & f) { return pt.dualMul(f); });
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  pt.transMul(in, out);
+  Eigen::internal::set_is_malloc_allowed(true);
+  checkForce([&pt](const ForceVecd & f) { return pt.transMul(f); });
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  qt.mul(in, out);
+  Eigen::internal::set_is_malloc_allowed(true);
+  checkMotion([&qt](const MotionVecd & m) { return qt * m; });
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  qt.invMul(in, out);
+  Eigen::internal::set_is_malloc_allowed(true);
+  checkMotion([&qt](const MotionVecd & m) { return qt.invMul(m); });
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  qt.dualMul(in, out);
+  Eigen::internal::set_is_malloc_allowed(true);
+  checkForce([&qt](const ForceVecd & f) { return qt.dualMul(f); });
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  qt.transMul(in, out);
+  Eigen::internal::set_is_malloc_allowed(true);
+  checkForce([&qt](const ForceVecd & f) { return qt.transMul(f); });
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  rt.mul(in, out);
+  Eigen::internal::set_is_malloc_allowed(true);
+  checkMotion([&rt](const MotionVecd & m) { return rt * m; });
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  rt.invMul(in, out);
+  Eigen::internal::set_is_malloc_allowed(true);
+  checkMotion([&rt](const MotionVecd & m) { return rt.invMul(m); });
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  rt.dualMul(in, out);
+  Eigen::internal::set_is_malloc_allowed(true);
+  checkForce([&rt](const ForceVecd & f) { return rt.dualMul(f); });
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  rt.transMul(in, out);
+  Eigen::internal::set_is_malloc_allowed(true);
+  checkForce([&rt](const ForceVecd & f) { return rt.transMul(f); });
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  tt.mul(in, out);
+  Eigen::internal::set_is_malloc_allowed(true);
+  checkMotion([&tt](const MotionVecd & m) { return tt * m; });
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  tt.invMul(in, out);
+  Eigen::internal::set_is_malloc_allowed(true);
+  checkMotion([&tt](const MotionVecd & m) { return tt.invMul(m); });
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  tt.dualMul(in, out);
+  Eigen::internal::set_is_malloc_allowed(true);
+  checkForce([&tt](const ForceVecd & f) { return tt.dualMul(f); });
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  tt.transMul(in, out);
+  Eigen::internal::set_is_malloc_allowed(true);
+  checkForce([&tt](const ForceVecd & f) { return tt.transMul(f); });
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  rz.mul(in, out);
+  Eigen::internal::set_is_malloc_allowed(true);
+  checkMotion([&rz](const MotionVecd & m) { return rz * m; });
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  rz.invMul(in, out);
+  Eigen::internal::set_is_malloc_allowed(true);
+  checkMotion([&rz](const MotionVecd & m) { return rz.invMul(m); });
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  rz.dualMul(in, out);
+  Eigen::internal::set_is_malloc_allowed(true);
+  checkForce([&rz](const ForceVecd & f) { return rz.dualMul(f); });
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  rz.transMul(in, out);
+  Eigen::internal::set_is_malloc_allowed(true);
+  checkForce([&rz](const ForceVecd & f) { return rz.transMul(f); });
+}
+
+BOOST_AUTO_TEST_CASE(VectorNoMalloc)
+{
+  using namespace sva;
+  using namespace Eigen;
+  MotionVecd mv1(Vector6d::Random()), mv2(Vector6d::Random()), mvRes;
+  ForceVecd fv1(Vector6d::Random()), fv2(Vector6d::Random()), fvRes;
+  ImpedanceVecd iv1(Vector6d::Random()), iv2(Vector6d::Random()), ivRes;
+  AdmittanceVecd av1(Vector6d::Random()), av2(Vector6d::Random()), avRes;
+  double d = 0.;
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  mvRes = mv1 + mv2;
+  mvRes = mv1 - mv2;
+  mvRes = -mv1;
+  mvRes = 2. * mv1;
+  mvRes = mv1 * 2.;
+  mvRes = mv1 / 2.;
+  mvRes += mv1;
+  mvRes -= mv2;
+  mvRes *= 2.;
+  mvRes /= 2.;
+  mvRes = mv1.cross(mv2);
+  fvRes = mv1.crossDual(fv1);
+  d += mv1.dot(fv1);
+
+  fvRes = fv1 + fv2;
+  fvRes = fv1 - fv2;
+  fvRes = -fv1;
+  fvRes = 2. * fv1;
+  fvRes = fv1 * 2.;
+  fvRes = fv1 / 2.;
+  fvRes += fv1;
+  fvRes -= fv2;
+  fvRes *= 2.;
+  fvRes /= 2.;
+
+  ivRes = iv1 + iv2;
+  ivRes = 2. * iv1;
+  ivRes = iv1 / 2.;
+  ivRes += iv1;
+  ivRes *= 2.;
+  ivRes /= 2.;
+  fvRes = iv1 * mv1;
+  fvRes = mv1 * iv1;
+
+  avRes = av1 + av2;
+  avRes = 2. * av1;
+  avRes = av1 / 2.;
+  avRes += av1;
+  avRes *= 2.;
+  avRes /= 2.;
+  mvRes = av1 * fv1;
+  mvRes = fv1 * av1;
+  Eigen::internal::set_is_malloc_allowed(true);
+
+  BOOST_CHECK(std::isfinite(d));
+}
+
+BOOST_AUTO_TEST_CASE(InertiaNoMalloc)
+{
+  using namespace sva;
+  using namespace Eigen;
+  RBInertiad rb1(randomRBInertia()), rb2(randomRBInertia()), rbRes;
+  ABInertiad ab1(randomABInertia()), ab2(randomABInertia()), abRes;
+  MotionVecd mv(Vector6d::Random());
+  ForceVecd fvRes;
+  Matrix3d m3;
+  Matrix6d m6;
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  rbRes = rb1 + rb2;
+  rbRes = rb1 - rb2;
+  rbRes = -rb1;
+  rbRes = 2. * rb1;
+  rbRes += rb1;
+  rbRes -= rb2;
+  fvRes = rb1 * mv;
+  m3 = rb1.inertia();
+  m6 = rb1.matrix();
+  m3 = inertiaToOrigin(m3, rb1.mass(), rb1.momentum(), Matrix3d::Identity().eval());
+
+  abRes = ab1 + ab2;
+  abRes = ab1 - ab2;
+  abRes = -ab1;
+  abRes = 2. * ab1;
+  abRes += ab1;
+  abRes -= ab2;
+  abRes = ab1 + rb1;
+  fvRes = ab1 * mv;
+  m3 = ab1.massMatrix();
+  m3 = ab1.inertia();
+  m6 = ab1.matrix();
+  Eigen::internal::set_is_malloc_allowed(true);
+}
+
+BOOST_AUTO_TEST_CASE(PTransformNoMalloc)
+{
+  using namespace sva;
+  using namespace Eigen;
+  PTransformd pt1(randomPTransform()), pt2(randomPTransform()), ptRes;
+  QTransformd qt1(randomPTransform()), qt2(randomPTransform()), qtRes;
+  RotationTransformd rt1(pt1.rotation()), rt2(pt2.rotation()), rtRes;
+  TranslationTransformd tt1(pt1.translation()), tt2(pt2.translation()), ttRes;
+  MotionVecd mv(Vector6d::Random()), mvRes;
+  ForceVecd fv(Vector6d::Random()), fvRes;
+  RBInertiad rbI(randomRBInertia()), rbRes;
+  ABInertiad abI(randomABInertia()), abRes;
+  Vector3d v3;
+  Matrix3d m3;
+  Matrix4d m4;
+  Matrix6d m6;
+  conversions::affine3_t<double> aff;
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  ptRes = pt1 * pt2;
+  ptRes = pt1.inv();
+  m6 = pt1.matrix();
+  m6 = pt1.dualMatrix();
+  mvRes = pt1 * mv;
+  v3 = pt1.angularMul(mv);
+  v3 = pt1.linearMul(mv);
+  mvRes = pt1.invMul(mv);
+  v3 = pt1.angularInvMul(mv);
+  v3 = pt1.linearInvMul(mv);
+  fvRes = pt1.dualMul(fv);
+  v3 = pt1.coupleDualMul(fv);
+  v3 = pt1.forceDualMul(fv);
+  fvRes = pt1.transMul(fv);
+  v3 = pt1.coupleTransMul(fv);
+  v3 = pt1.forceTransMul(fv);
+  rbRes = pt1.dualMul(rbI);
+  rbRes = pt1.transMul(rbI);
+  abRes = pt1.dualMul(abI);
+  abRes = pt1.transMul(abI);
+
+  qtRes = qt1 * qt2;
+  qtRes = qt1.inv();
+  ptRes = PTransformd(qt1);
+  qtRes = QTransformd(pt1);
+  mvRes = qt1 * mv;
+  mvRes = qt1.invMul(mv);
+  fvRes = qt1.dualMul(fv);
+  fvRes = qt1.transMul(fv);
+
+  rtRes = rt1 * rt2;
+  rtRes = rt1.inv();
+  ptRes = rt1 * pt1;
+  ptRes = pt1 * rt1;
+  ptRes = rt1 * tt1;
+  ptRes = tt1 * rt1;
+  mvRes = rt1 * mv;
+  mvRes = rt1.invMul(mv);
+  fvRes = rt1.dualMul(fv);
+  fvRes = rt1.transMul(fv);
+  rbRes = rt1.dualMul(rbI);
+  rbRes = rt1.transMul(rbI);
+  abRes = rt1.dualMul(abI);
+  abRes = rt1.transMul(abI);
+
+  ttRes = tt1 * tt2;
+  ttRes = tt1.inv();
+  ptRes = tt1 * pt1;
+  ptRes = pt1 * tt1;
+  mvRes = tt1 * mv;
+  mvRes = tt1.invMul(mv);
+  fvRes = tt1.dualMul(fv);
+  fvRes = tt1.transMul(fv);
+  rbRes = tt1.dualMul(rbI);
+  rbRes = tt1.transMul(rbI);
+  abRes = tt1.dualMul(abI);
+  abRes = tt1.transMul(abI);
+
+  RotYTransformd ry(0.3), ry2(-1.2), ryRes;
+  ryRes = ry * ry2;
+  ryRes = ry.inv();
+  ptRes = ry * pt1;
+  ptRes = pt1 * ry;
+  mvRes = ry * mv;
+  mvRes = ry.invMul(mv);
+  fvRes = ry.dualMul(fv);
+  fvRes = ry.transMul(fv);
+  rbRes = ry.dualMul(rbI);
+  rbRes = ry.transMul(rbI);
+  abRes = ry.dualMul(abI);
+  abRes = ry.transMul(abI);
+
+  m3 = RotX(0.5);
+  m3 = RotY(0.5);
+  m3 = RotZ(0.5);
+  v3 = rotationError(pt1.rotation(), pt2.rotation());
+  v3 = rotationVelocity(pt1.rotation());
+  mvRes = transformError(pt1, pt2);
+  mvRes = transformVelocity(pt1);
+  ptRes = exp(mv);
+  ptRes = interpolate(pt1, pt2, 0.3);
+
+  m4 = conversions::toHomogeneous(pt1);
+  ptRes = conversions::fromHomogeneous(m4);
+  aff = conversions::toAffine(pt1);
+  ptRes = conversions::fromAffine(aff);
+  Eigen::internal::set_is_malloc_allowed(true);
+}
+
+BOOST_AUTO_TEST_CASE(MathFuncNoMalloc)
+{
+  using namespace sva;
+  using namespace Eigen;
+  Vector3d u(Vector3d::Random()), du(Vector3d::Random());
+  Matrix3d m3;
+  SE3Jacobiand jac;
+  double d = 0.;
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  for(double x : {0., 1e-9, 1e-4, 0.5, 3.})
+  {
+    d += details::SO3JacF2(x) + details::dSO3JacF2(x) + sinc(x) + sinc_inv(x);
+    d += details::SO3JacG1(x) + details::SO3JacG2(x);
+    m3 = SO3RightJacInv<double>(x * u);
+    m3 = SO3RightJacInvDot<double>(x * u, du);
+    m3 = SO3RightJac<double>(x * u);
+    m3 = SO3LeftJac<double>(x * u);
+    jac = SE3RightJac(MotionVecd(x * u, du));
+    jac = SE3LeftJac(MotionVecd(x * u, du));
+    jac = SE3RightJacInv(MotionVecd(x * u, du));
+    jac = SE3LeftJacInv(MotionVecd(x * u, du));
+    jac = SE3RightJacInvDot(MotionVecd(x * u, du), MotionVecd(du, u));
+    jac = SE3LeftJacInvDot(MotionVecd(x * u, du), MotionVecd(du, u));
+  }
+  Eigen::internal::set_is_malloc_allowed(true);
+
+  BOOST_CHECK(std::isfinite(d));
+}
+
+BOOST_AUTO_TEST_CASE(Matrix6XNoMalloc)
+{
+  // the columns counts span the coefficient based and the blocked Eigen products
+  for(Eigen::Index cols : {1, 2, 7, 64, 300})
+  {
+    Matrix6Xd in(6, cols), out(6, cols);
+    checkMatrix6X(in, out);
+  }
+
+  Matrix6XMax8d inMax(6, 5), outMax(6, 5);
+  checkMatrix6X(inMax, outMax);
+
+  Matrix63d inFixed, outFixed;
+  checkMatrix6X(inFixed, outFixed);
+
+  Eigen::Matrix6d in6, out6;
+  checkMatrix6X(in6, out6);
+}
+
+BOOST_AUTO_TEST_CASE(BatchNoMalloc)
+{
+  using namespace sva;
+  using namespace Eigen;
+  const Eigen::Index size = 37;
+  PTransformBatchd ptb1(size), ptb2(size), ptbRes(size);
+  MotionVecBatchd mvb1(size), mvb2(size), mvbRes(size);
+  ForceVecBatchd fvb(size), fvbRes(size);
+  VectorXd dot(size);
+  Matrix<double, Dynamic, 3> w(size, 3);
+  Matrix<double, Dynamic, 18> jac(size, 18);
+  for(Eigen::Index i = 0; i < size; ++i)
+  {
+    ptb1.set(i, randomPTransform());
+    ptb2.set(i, randomPTransform());
+    mvb1.set(i, MotionVecd(Vector6d::Random()));
+    mvb2.set(i, MotionVecd(Vector6d::Random()));
+    fvb.set(i, ForceVecd(Vector6d::Random()));
+  }
+  PTransformd pt(randomPTransform());
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  ptb1.mul(ptb2, ptbRes);
+  ptb1.mul(pt, ptbRes);
+  ptb1.inv(ptbRes);
+  ptb1.mul(mvb1, mvbRes);
+  ptb1.invMul(mvb1, mvbRes);
+  ptb1.dualMul(fvb, fvbRes);
+  ptb1.transMul(fvb, fvbRes);
+  pt.mul(mvb1, mvbRes);
+  pt.invMul(mvb1, mvbRes);
+  pt.dualMul(fvb, fvbRes);
+  pt.transMul(fvb, fvbRes);
+  mvb1.cross(mvb2, mvbRes);
+  mvb1.crossDual(fvb, fvbRes);
+  mvb1.dot(fvb, dot);
+  rotationVelocity(ptb1, w);
+  transformVelocity(ptb1, mvbRes);
+  transformError(ptb1, ptb2, mvbRes);
+  exp(mvb1, ptbRes);
+  SE3RightJac(mvb1, jac);
+  SE3LeftJac(mvb1, jac);
+  SE3RightJacInv(mvb1, jac);
+  SE3LeftJacInv(mvb1, jac);
+  SE3RightJacInvDot(mvb1, mvb2, jac);
+  SE3LeftJacInvDot(mvb1, mvb2, jac);
+  Eigen::internal::set_is_malloc_allowed(true);
+
+  for(Eigen::Index i = 0; i < size; ++i)
+  {
+    BOOST_CHECK_SMALL(dot(i) - mvb1[i].dot(fvb[i]), TOL);
+  }
+}
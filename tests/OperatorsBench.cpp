@@ -0,0 +1,360 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+// Micro-benchmarks of the SpaceVecAlg operators.
+//
+// Each benchmark cycles over a pool of random inputs so the compiler can not
+// fold the computation and the branches (e.g. small angle paths) are not
+// always taken in the same way. Times are reported in ns per operation.
+// Use --benchmark_out=result.json --benchmark_out_format=json to get a result
+// file that can be compared across commits with the Google Benchmark compare.py tool.
+
+// includes
+// std
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// benchmark
+#include <benchmark/benchmark.h>
+
+// SpaceVecAlg
+#include <SpaceVecAlg/CompressedPTransforms.h>
+#include <SpaceVecAlg/Conversions.h>
+#include <SpaceVecAlg/SpaceVecAlg>
+
+#include "TestUtils.h"
+
+namespace
+{
+
+typedef Eigen::Matrix<double, 6, Eigen::Dynamic> Matrix6Xd;
+
+/// Number of inputs of each type, must be a power of 2.
+constexpr std::size_t poolSize = 256;
+/// Number of columns of the Matrix6Xd inputs.
+constexpr int nrCols = 40;
+
+/// Random inputs shared by all the benchmarks.
+struct Data
+{
+  Data()
+  {
+    using namespace Eigen;
+    using namespace sva;
+    for(std::size_t i = 0; i < poolSize; ++i)
+    {
+      mv.push_back(MotionVecd(Vector6d::Random()));
+      fv.push_back(ForceVecd(Vector6d::Random()));
+      iv.push_back(ImpedanceVecd(Vector6d::Random()));
+      av.push_back(AdmittanceVecd(Vector6d::Random()));
+      rbI.push_back(randomRBInertia());
+      abI.push_back(randomABInertia());
+      pt.push_back(randomPTransform());
+      qt.push_back(QTransformd(pt.back()));
+      rt.push_back(RotationTransformd(pt.back().rotation()));
+      tt.push_back(TranslationTransformd(pt.back().translation()));
+      mat6X.push_back(Matrix6Xd::Random(6, nrCols));
+      mat6XRes.push_back(Matrix6Xd(6, nrCols));
+      // angles in [0, pi], a quarter of them below 1e-3 to exercise the small angle paths
+      const double scale = (i % 4 == 0) ? 1e-3 : 3.14159;
+      angle.push_back(scale * (1. + Vector2d::Random()(0)) / 2.);
+      vec3.push_back(scale * Vector3d::Random().normalized() * (1. + Vector2d::Random()(0)) / 2.);
+      rot.push_back(pt.back().rotation());
+      tw.push_back(MotionVecd(vec3.back(), Vector3d::Random()));
+      hom.push_back(conversions::toHomogeneous(pt.back()));
+      aff.push_back(conversions::toAffine(pt.back()));
+    }
+    mvBatch = MotionVecBatchd(mv);
+    mvBatchRes = MotionVecBatchd(mv.size());
+    fvBatch = ForceVecBatchd(fv);
+    fvBatchRes = ForceVecBatchd(fv.size());
+    ptBatch = PTransformBatchd(pt);
+    std::vector<PTransformd> ptNext(pt.begin() + 1, pt.end());
+    ptNext.push_back(pt.front());
+    ptBatchNext = PTransformBatchd(ptNext);
+    rotVelBatch.resize(static_cast<Eigen::Index>(poolSize), 3);
+    twBatch = MotionVecBatchd(tw);
+    ptBatchRes = PTransformBatchd(pt.size());
+    jacBatch.resize(static_cast<Eigen::Index>(poolSize), 18);
+    // smooth trajectory, as the pose histories stored in CompressedPTransforms
+    const MotionVecd nu(Vector3d::Random() * 1e-2, Vector3d::Random() * 1e-3);
+    ptSmooth.push_back(pt.front());
+    for(std::size_t i = 1; i < poolSize; ++i)
+    {
+      ptSmooth.push_back(exp(nu) * ptSmooth.back());
+    }
+    cpt.push_back(ptSmooth);
+    cptCoarse.push_back(ptSmooth);
+    ptRes.resize(poolSize);
+  }
+
+  std::vector<sva::MotionVecd> mv;
+  std::vector<sva::ForceVecd> fv;
+  std::vector<sva::ImpedanceVecd> iv;
+  std::vector<sva::AdmittanceVecd> av;
+  std::vector<sva::RBInertiad> rbI;
+  std::vector<sva::ABInertiad> abI;
+  std::vector<sva::PTransformd> pt;
+  std::vector<sva::QTransformd> qt;
+  std::vector<sva::RotationTransformd> rt;
+  std::vector<sva::TranslationTransformd> tt;
+  std::vector<Matrix6Xd> mat6X;
+  std::vector<Matrix6Xd> mat6XRes;
+  std::vector<double> angle;
+  std::vector<Eigen::Vector3d> vec3;
+  std::vector<Eigen::Matrix3d> rot;
+  std::vector<sva::MotionVecd> tw;
+  std::vector<Eigen::Matrix4d> hom;
+  std::vector<sva::conversions::affine3_t<double>> aff;
+  sva::MotionVecBatchd mvBatch, mvBatchRes;
+  sva::ForceVecBatchd fvBatch, fvBatchRes;
+  sva::PTransformBatchd ptBatch, ptBatchNext, ptBatchRes;
+  Eigen::Matrix<double, Eigen::Dynamic, 3> rotVelBatch;
+  sva::MotionVecBatchd twBatch;
+  Eigen::Matrix<double, Eigen::Dynamic, 18> jacBatch;
+  std::vector<sva::PTransformd> ptSmooth;
+  sva::CompressedPTransformsd cpt, cptRes;
+  // rotations stored in 32 bits
+  sva::CompressedPTransformsd cptCoarse{1e-5, 1e-2};
+  std::vector<sva::PTransformd> ptRes;
+};
+
+Data & data()
+{
+  static Data d;
+  return d;
+}
+
+} // namespace
+
+/**
+ * Define and register the benchmark name that evaluates expr and stores it in
+ * a variable of type type. expr can use d (Data), i and j, two different
+ * indexes in the input pools.
+ */
+#define SVA_BENCH(name, type, expr)                        \
+  static void name(benchmark::State & state)               \
+  {                                                        \
+    Data & d = data();                                     \
+    std::size_t i = 0;                                     \
+    for(auto _ : state)                                    \
+    {                                                      \
+      const std::size_t j = (i + 1) & (poolSize - 1);      \
+      type res = expr;                                     \
+      benchmark::DoNotOptimize(res);                       \
+      i = j;                                               \
+    }                                                      \
+    state.SetItemsProcessed(state.iterations());           \
+  }                                                        \
+  BENCHMARK(name)->Unit(benchmark::kNanosecond)
+
+/// Same as SVA_BENCH for statements that write their result in d.
+#define SVA_BENCH_STMT(name, stmt)                         \
+  static void name(benchmark::State & state)               \
+  {                                                        \
+    Data & d = data();                                     \
+    std::size_t i = 0;                                     \
+    for(auto _ : state)                                    \
+    {                                                      \
+      const std::size_t j = (i + 1) & (poolSize - 1);      \
+      stmt;                                                \
+      benchmark::ClobberMemory();                          \
+      i = j;                                               \
+    }                                                      \
+    state.SetItemsProcessed(state.iterations());           \
+  }                                                        \
+  BENCHMARK(name)->Unit(benchmark::kNanosecond)
+
+using namespace sva;
+
+// MotionVec
+SVA_BENCH(MotionVec_add, MotionVecd, d.mv[i] + d.mv[j]);
+SVA_BENCH(MotionVec_sub, MotionVecd, d.mv[i] - d.mv[j]);
+SVA_BENCH(MotionVec_neg, MotionVecd, -d.mv[i]);
+SVA_BENCH(MotionVec_scalarMul, MotionVecd, d.angle[j] * d.mv[i]);
+SVA_BENCH(MotionVec_scalarDiv, MotionVecd, d.mv[i] / (1. + d.angle[j]));
+SVA_BENCH(MotionVec_cross, MotionVecd, d.mv[i].cross(d.mv[j]));
+SVA_BENCH(MotionVec_crossDual, ForceVecd, d.mv[i].crossDual(d.fv[j]));
+SVA_BENCH(MotionVec_dot, double, d.mv[i].dot(d.fv[j]));
+SVA_BENCH_STMT(MotionVec_cross_Matrix6X, d.mv[i].cross(d.mat6X[j], d.mat6XRes[i]));
+SVA_BENCH_STMT(MotionVec_crossDual_Matrix6X, d.mv[i].crossDual(d.mat6X[j], d.mat6XRes[i]));
+
+// ForceVec
+SVA_BENCH(ForceVec_add, ForceVecd, d.fv[i] + d.fv[j]);
+SVA_BENCH(ForceVec_sub, ForceVecd, d.fv[i] - d.fv[j]);
+SVA_BENCH(ForceVec_neg, ForceVecd, -d.fv[i]);
+SVA_BENCH(ForceVec_scalarMul, ForceVecd, d.angle[j] * d.fv[i]);
+SVA_BENCH(ForceVec_scalarDiv, ForceVecd, d.fv[i] / (1. + d.angle[j]));
+
+// ImpedanceVec and AdmittanceVec
+SVA_BENCH(ImpedanceVec_MotionVec, ForceVecd, d.iv[i] * d.mv[j]);
+SVA_BENCH(AdmittanceVec_ForceVec, MotionVecd, d.av[i] * d.fv[j]);
+
+// RBInertia
+SVA_BENCH(RBInertia_add, RBInertiad, d.rbI[i] + d.rbI[j]);
+SVA_BENCH(RBInertia_sub, RBInertiad, d.rbI[i] - d.rbI[j]);
+SVA_BENCH(RBInertia_scalarMul, RBInertiad, d.angle[j] * d.rbI[i]);
+SVA_BENCH(RBInertia_inertia, Eigen::Matrix3d, d.rbI[i].inertia());
+SVA_BENCH(RBInertia_matrix, Eigen::Matrix6d, d.rbI[i].matrix());
+SVA_BENCH(RBInertia_MotionVec, ForceVecd, d.rbI[i] * d.mv[j]);
+SVA_BENCH_STMT(RBInertia_Matrix6X, d.rbI[i].mul(d.mat6X[j], d.mat6XRes[i]));
+SVA_BENCH(inertiaToOrigin, Eigen::Matrix3d, inertiaToOrigin(d.rot[i], d.angle[j], d.vec3[j], d.rot[j]));
+
+// ABInertia
+SVA_BENCH(ABInertia_add, ABInertiad, d.abI[i] + d.abI[j]);
+SVA_BENCH(ABInertia_sub, ABInertiad, d.abI[i] - d.abI[j]);
+SVA_BENCH(ABInertia_scalarMul, ABInertiad, d.angle[j] * d.abI[i]);
+SVA_BENCH(ABInertia_RBInertia, ABInertiad, d.abI[i] + d.rbI[j]);
+SVA_BENCH(ABInertia_matrix, Eigen::Matrix6d, d.abI[i].matrix());
+SVA_BENCH(ABInertia_MotionVec, ForceVecd, d.abI[i] * d.mv[j]);
+SVA_BENCH_STMT(ABInertia_Matrix6X, d.abI[i].mul(d.mat6X[j], d.mat6XRes[i]));
+
+// PTransform
+SVA_BENCH(PTransform_PTransform, PTransformd, d.pt[i] * d.pt[j]);
+SVA_BENCH(PTransform_PTransform_PTransform, PTransformd, d.pt[i] * d.pt[j] * d.pt[i]);
+SVA_BENCH(PTransform_PTransform_MotionVec, MotionVecd, d.pt[i] * d.pt[j] * d.mv[i]);
+SVA_BENCH(compose_PTransform_MotionVec, MotionVecd, compose(d.pt[i], d.pt[j]) * d.mv[i]);
+SVA_BENCH(compose_PTransform_PTransform_MotionVec, MotionVecd, compose(d.pt[i], d.pt[j]) * d.pt[i] * d.mv[i]);
+SVA_BENCH(PTransform_inv, PTransformd, d.pt[i].inv());
+SVA_BENCH(PTransform_matrix, Eigen::Matrix6d, d.pt[i].matrix());
+SVA_BENCH(PTransform_dualMatrix, Eigen::Matrix6d, d.pt[i].dualMatrix());
+SVA_BENCH(PTransform_MotionVec, MotionVecd, d.pt[i] * d.mv[j]);
+SVA_BENCH(PTransform_angularMul, Eigen::Vector3d, d.pt[i].angularMul(d.mv[j]));
+SVA_BENCH(PTransform_linearMul, Eigen::Vector3d, d.pt[i].linearMul(d.mv[j]));
+SVA_BENCH(PTransform_invMul_MotionVec, MotionVecd, d.pt[i].invMul(d.mv[j]));
+SVA_BENCH(PTransform_angularInvMul, Eigen::Vector3d, d.pt[i].angularInvMul(d.mv[j]));
+SVA_BENCH(PTransform_linearInvMul, Eigen::Vector3d, d.pt[i].linearInvMul(d.mv[j]));
+SVA_BENCH(PTransform_dualMul_ForceVec, ForceVecd, d.pt[i].dualMul(d.fv[j]));
+SVA_BENCH(PTransform_coupleDualMul, Eigen::Vector3d, d.pt[i].coupleDualMul(d.fv[j]));
+SVA_BENCH(PTransform_forceDualMul, Eigen::Vector3d, d.pt[i].forceDualMul(d.fv[j]));
+SVA_BENCH(PTransform_transMul_ForceVec, ForceVecd, d.pt[i].transMul(d.fv[j]));
+SVA_BENCH(PTransform_coupleTransMul, Eigen::Vector3d, d.pt[i].coupleTransMul(d.fv[j]));
+SVA_BENCH(PTransform_forceTransMul, Eigen::Vector3d, d.pt[i].forceTransMul(d.fv[j]));
+SVA_BENCH(PTransform_dualMul_RBInertia, RBInertiad, d.pt[i].dualMul(d.rbI[j]));
+SVA_BENCH(PTransform_transMul_RBInertia, RBInertiad, d.pt[i].transMul(d.rbI[j]));
+SVA_BENCH(PTransform_dualMul_ABInertia, ABInertiad, d.pt[i].dualMul(d.abI[j]));
+SVA_BENCH(PTransform_transMul_ABInertia, ABInertiad, d.pt[i].transMul(d.abI[j]));
+SVA_BENCH_STMT(PTransform_mul_Matrix6X, d.pt[i].mul(d.mat6X[j], d.mat6XRes[i]));
+SVA_BENCH_STMT(PTransform_invMul_Matrix6X, d.pt[i].invMul(d.mat6X[j], d.mat6XRes[i]));
+SVA_BENCH_STMT(PTransform_dualMul_Matrix6X, d.pt[i].dualMul(d.mat6X[j], d.mat6XRes[i]));
+SVA_BENCH_STMT(PTransform_transMul_Matrix6X, d.pt[i].transMul(d.mat6X[j], d.mat6XRes[i]));
+SVA_BENCH_STMT(PTransform_mul_MotionVecBatch, d.pt[i].mul(d.mvBatch, d.mvBatchRes));
+SVA_BENCH_STMT(PTransform_invMul_MotionVecBatch, d.pt[i].invMul(d.mvBatch, d.mvBatchRes));
+SVA_BENCH_STMT(PTransform_dualMul_ForceVecBatch, d.pt[i].dualMul(d.fvBatch, d.fvBatchRes));
+SVA_BENCH_STMT(PTransform_transMul_ForceVecBatch, d.pt[i].transMul(d.fvBatch, d.fvBatchRes));
+
+// QTransform
+SVA_BENCH(QTransform_QTransform, QTransformd, d.qt[i] * d.qt[j]);
+SVA_BENCH(QTransform_MotionVec, MotionVecd, d.qt[i] * d.mv[j]);
+SVA_BENCH(QTransform_PTransform, PTransformd, PTransformd(d.qt[i]));
+
+// RotationTransform
+SVA_BENCH(RotationTransform_PTransform, PTransformd, d.rt[i] * d.pt[j]);
+SVA_BENCH(RotationTransform_MotionVec, MotionVecd, d.rt[i] * d.mv[j]);
+SVA_BENCH(RotationTransform_transMul_ForceVec, ForceVecd, d.rt[i].transMul(d.fv[j]));
+SVA_BENCH(RotationTransform_transMul_RBInertia, RBInertiad, d.rt[i].transMul(d.rbI[j]));
+SVA_BENCH(RotationTransform_transMul_ABInertia, ABInertiad, d.rt[i].transMul(d.abI[j]));
+SVA_BENCH_STMT(RotationTransform_mul_Matrix6X, d.rt[i].mul(d.mat6X[j], d.mat6XRes[i]));
+
+// TranslationTransform
+SVA_BENCH(TranslationTransform_PTransform, PTransformd, d.tt[i] * d.pt[j]);
+SVA_BENCH(TranslationTransform_MotionVec, MotionVecd, d.tt[i] * d.mv[j]);
+SVA_BENCH(TranslationTransform_transMul_ForceVec, ForceVecd, d.tt[i].transMul(d.fv[j]));
+SVA_BENCH(TranslationTransform_transMul_RBInertia, RBInertiad, d.tt[i].transMul(d.rbI[j]));
+SVA_BENCH(TranslationTransform_dualMul_ABInertia, ABInertiad, d.tt[i].dualMul(d.abI[j]));
+SVA_BENCH(TranslationTransform_transMul_ABInertia, ABInertiad, d.tt[i].transMul(d.abI[j]));
+SVA_BENCH_STMT(TranslationTransform_mul_Matrix6X, d.tt[i].mul(d.mat6X[j], d.mat6XRes[i]));
+
+// AxisRotationTransform
+SVA_BENCH(RotXTransform_PTransform, PTransformd, RotXTransformd(d.angle[i]) * d.pt[j]);
+SVA_BENCH(PTransform_RotZTransform, PTransformd, d.pt[j] * RotZTransformd(d.angle[i]));
+SVA_BENCH(RotX_PTransform, PTransformd, PTransformd(RotX(d.angle[i])) * d.pt[j]);
+SVA_BENCH(RotXTransform_MotionVec, MotionVecd, RotXTransformd(d.angle[i]) * d.mv[j]);
+SVA_BENCH_STMT(RotXTransform_mul_Matrix6X, RotXTransformd(d.angle[i]).mul(d.mat6X[j], d.mat6XRes[i]));
+
+// PTransform free functions
+SVA_BENCH(RotX, Eigen::Matrix3d, RotX(d.angle[i]));
+SVA_BENCH(RotY, Eigen::Matrix3d, RotY(d.angle[i]));
+SVA_BENCH(RotZ, Eigen::Matrix3d, RotZ(d.angle[i]));
+SVA_BENCH(rotationError, Eigen::Vector3d, rotationError(d.rot[i], d.rot[j]));
+SVA_BENCH(rotationVelocity, Eigen::Vector3d, rotationVelocity(d.rot[i]));
+SVA_BENCH(transformError, MotionVecd, transformError(d.pt[i], d.pt[j]));
+SVA_BENCH(transformVelocity, MotionVecd, transformVelocity(d.pt[i]));
+SVA_BENCH(interpolate, PTransformd, interpolate(d.pt[i], d.pt[j], d.angle[i] / 3.14159));
+SVA_BENCH(exp, PTransformd, exp(d.tw[i]));
+SVA_BENCH(SE3RightJac, SE3Jacobiand, SE3RightJac(d.tw[i]));
+SVA_BENCH(SE3LeftJac, SE3Jacobiand, SE3LeftJac(d.tw[i]));
+SVA_BENCH(SE3RightJacInv, SE3Jacobiand, SE3RightJacInv(d.tw[i]));
+SVA_BENCH(SE3RightJacInvDot, SE3Jacobiand, SE3RightJacInvDot(d.tw[i], d.mv[j]));
+SVA_BENCH(SE3Jacobian_MotionVec, MotionVecd, SE3RightJac(d.tw[i]) * d.mv[j]);
+
+// Tangent space Jacobians of the operators
+SVA_BENCH(mulJacobian_PTransform, BinaryJacobian<SE3Jacobiand>, mulJacobian(d.pt[i], d.pt[j]));
+SVA_BENCH(mulJacobian_MotionVec, SE3Jacobiand, mulJacobian(d.pt[i], d.mv[j]));
+SVA_BENCH(invMulJacobian_MotionVec, SE3Jacobiand, invMulJacobian(d.pt[i], d.mv[j]));
+SVA_BENCH(dualMulJacobian_ForceVec, ForceCrossJacobiand, dualMulJacobian(d.pt[i], d.fv[j]));
+SVA_BENCH(transformErrorJacobian, BinaryJacobian<BlockDiagJacobiand>, transformErrorJacobian(d.pt[i], d.pt[j]));
+SVA_BENCH(interpolateJacobian,
+          BinaryJacobian<BlockDiagJacobiand>,
+          interpolateJacobian(d.pt[i], d.pt[j], d.angle[i] / 3.14159));
+
+// Whole pool versions of rotationVelocity, transformVelocity and transformError,
+// the _loop benchmarks call the single transformation version on each element
+// and the _batch benchmarks call the PTransformBatch version
+SVA_BENCH_STMT(rotationVelocity_loop, for(std::size_t k = 0; k < poolSize; ++k) {
+  d.rotVelBatch.row(static_cast<Eigen::Index>(k)) = rotationVelocity(d.rot[k]).transpose();
+});
+SVA_BENCH_STMT(rotationVelocity_batch, rotationVelocity(d.ptBatch, d.rotVelBatch));
+SVA_BENCH_STMT(transformVelocity_loop, for(std::size_t k = 0; k < poolSize; ++k) {
+  d.mvBatchRes.set(static_cast<Eigen::Index>(k), transformVelocity(d.pt[k]));
+});
+SVA_BENCH_STMT(transformVelocity_batch, transformVelocity(d.ptBatch, d.mvBatchRes));
+SVA_BENCH_STMT(transformError_loop, for(std::size_t k = 0; k < poolSize; ++k) {
+  d.mvBatchRes.set(static_cast<Eigen::Index>(k), transformError(d.pt[k], d.pt[(k + 1) & (poolSize - 1)]));
+});
+SVA_BENCH_STMT(transformError_batch, transformError(d.ptBatch, d.ptBatchNext, d.mvBatchRes));
+
+// Whole pool versions of exp, SE3RightJac and SE3RightJacInvDot
+SVA_BENCH_STMT(exp_loop, for(std::size_t k = 0; k < poolSize; ++k) {
+  d.ptBatchRes.set(static_cast<Eigen::Index>(k), exp(d.tw[k]));
+});
+SVA_BENCH_STMT(exp_batch, exp(d.twBatch, d.ptBatchRes));
+SVA_BENCH_STMT(SE3RightJac_loop, for(std::size_t k = 0; k < poolSize; ++k) {
+  const SE3Jacobiand J = SE3RightJac(d.tw[k]);
+  d.jacBatch.row(static_cast<Eigen::Index>(k)).head<9>() = J.D().transpose().reshaped();
+  d.jacBatch.row(static_cast<Eigen::Index>(k)).tail<9>() = J.L().transpose().reshaped();
+});
+SVA_BENCH_STMT(SE3RightJac_batch, SE3RightJac(d.twBatch, d.jacBatch));
+SVA_BENCH_STMT(SE3RightJacInvDot_loop, for(std::size_t k = 0; k < poolSize; ++k) {
+  const SE3Jacobiand J = SE3RightJacInvDot(d.tw[k], d.mv[k]);
+  d.jacBatch.row(static_cast<Eigen::Index>(k)).head<9>() = J.D().transpose().reshaped();
+  d.jacBatch.row(static_cast<Eigen::Index>(k)).tail<9>() = J.L().transpose().reshaped();
+});
+SVA_BENCH_STMT(SE3RightJacInvDot_batch, SE3RightJacInvDot(d.twBatch, d.mvBatch, d.jacBatch));
+
+// Whole pool encoding and decoding of CompressedPTransforms, the _copy
+// benchmark is the copy of the uncompressed transformations
+SVA_BENCH_STMT(CompressedPTransforms_copy, std::copy(d.ptSmooth.begin(), d.ptSmooth.end(), d.ptRes.begin()));
+SVA_BENCH_STMT(CompressedPTransforms_encode, d.cptRes.clear(); d.cptRes.push_back(d.ptSmooth));
+SVA_BENCH_STMT(CompressedPTransforms_decode, d.cpt.decode(0, poolSize, d.ptRes.data()));
+SVA_BENCH_STMT(CompressedPTransforms_decode_coarse, d.cptCoarse.decode(0, poolSize, d.ptRes.data()));
+
+// MathFunc
+SVA_BENCH(SO3JacF2, double, details::SO3JacF2(d.angle[i]));
+SVA_BENCH(dSO3JacF2, double, details::dSO3JacF2(d.angle[i]));
+SVA_BENCH(sinc, double, sinc(d.angle[i]));
+SVA_BENCH(sinc_inv, double, sinc_inv(d.angle[i]));
+SVA_BENCH(SO3JacG2, double, details::SO3JacG2(d.angle[i]));
+SVA_BENCH(SO3RightJac, Eigen::Matrix3d, SO3RightJac(d.vec3[i]));
+SVA_BENCH(SO3RightJacInv, Eigen::Matrix3d, SO3RightJacInv(d.vec3[i]));
+SVA_BENCH(SO3RightJacInvDot, Eigen::Matrix3d, SO3RightJacInvDot(d.vec3[i], d.vec3[j]));
+
+// Conversions
+SVA_BENCH(fromHomogeneous, PTransformd, conversions::fromHomogeneous(d.hom[i]));
+SVA_BENCH(toHomogeneous, Eigen::Matrix4d, conversions::toHomogeneous(d.pt[i]));
+SVA_BENCH(fromAffine, PTransformd, conversions::fromAffine(d.aff[i]));
+SVA_BENCH(toAffine, conversions::affine3_t<double>, conversions::toAffine(d.pt[i]));
+
+BENCHMARK_MAIN();
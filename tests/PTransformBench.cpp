@@ -46,6 +46,44 @@ BOOST_AUTO_TEST_CASE(PTransfromd_PTransformd)
   std::cout << std::endl;
 }
 
+BOOST_AUTO_TEST_CASE(QTransfromd_QTransformd)
+{
+  using namespace sva;
+
+  const std::size_t size = 10000000;
+  std::vector<QTransformd> qt1(size, QTransformd::Identity());
+  std::vector<QTransformd> qt2(size, QTransformd::Identity());
+  std::vector<QTransformd> qtRes(size);
+
+  std::cout << "QTransform vs QTransform (" << sizeof(QTransformd) << " bytes vs " << sizeof(PTransformd)
+            << " bytes for PTransform)" << std::endl;
+  {
+    boost::timer::auto_cpu_timer t;
+    for(std::size_t i = 0; i < size; ++i)
+    {
+      qtRes[i] = qt1[i] * qt2[i];
+    }
+  }
+  std::cout << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(PTransfromBatchd_PTransformBatchd)
+{
+  using namespace sva;
+
+  const std::size_t size = 10000000;
+  PTransformBatchd pt1 = PTransformBatchd::Identity(size);
+  PTransformBatchd pt2 = PTransformBatchd::Identity(size);
+  PTransformBatchd ptRes(size);
+
+  std::cout << "PTransformBatch vs PTransformBatch" << std::endl;
+  {
+    boost::timer::auto_cpu_timer t;
+    pt1.mul(pt2, ptRes);
+  }
+  std::cout << std::endl;
+}
+
 BOOST_AUTO_TEST_CASE(PTransfromd_MotionVec)
 {
   using namespace sva;
@@ -66,6 +104,43 @@ BOOST_AUTO_TEST_CASE(PTransfromd_MotionVec)
   std::cout << std::endl;
 }
 
+BOOST_AUTO_TEST_CASE(QTransfromd_MotionVec)
+{
+  using namespace sva;
+
+  const std::size_t size = 10000000;
+  std::vector<QTransformd> qt1(size, QTransformd::Identity());
+  std::vector<MotionVecd> mv(size, MotionVecd(Eigen::Vector6d::Random()));
+  std::vector<MotionVecd> mvRes(size);
+
+  std::cout << "QTransform vs MotionVec" << std::endl;
+  {
+    boost::timer::auto_cpu_timer t;
+    for(std::size_t i = 0; i < size; ++i)
+    {
+      mvRes[i] = qt1[i] * mv[i];
+    }
+  }
+  std::cout << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(PTransfromBatchd_MotionVecBatchd)
+{
+  using namespace sva;
+
+  const std::size_t size = 10000000;
+  PTransformBatchd pt1 = PTransformBatchd::Identity(size);
+  MotionVecBatchd mv(size, MotionVecd(Eigen::Vector6d::Random()));
+  MotionVecBatchd mvRes(size);
+
+  std::cout << "PTransformBatch vs MotionVecBatch" << std::endl;
+  {
+    boost::timer::auto_cpu_timer t;
+    pt1.mul(mv, mvRes);
+  }
+  std::cout << std::endl;
+}
+
 BOOST_AUTO_TEST_CASE(PTransfromd_MotionEigen)
 {
   using namespace sva;
@@ -211,3 +286,83 @@ BOOST_AUTO_TEST_CASE(PTransfromd_trans_ForceVec)
   }
   std::cout << std::endl;
 }
+
+BOOST_AUTO_TEST_CASE(PTransfromd_Jacobian)
+{
+  using namespace sva;
+
+  const std::size_t size = 10000;
+  const std::size_t repeat = 100;
+  const std::size_t cols = 40;
+  std::vector<PTransformd> pt1(size, PTransformd(Eigen::Quaterniond(Eigen::Vector4d::Random()).normalized(),
+                                                 Eigen::Vector3d::Random()));
+  std::vector<Matrix6Xd> jac(size, Matrix6Xd::Random(6, cols));
+  std::vector<Matrix6Xd> jacRes(size, Matrix6Xd(6, cols));
+
+  std::cout << "PTransform vs Jacobian (generic kernels)" << std::endl;
+  {
+    boost::timer::auto_cpu_timer t;
+    for(std::size_t r = 0; r < repeat; ++r)
+    {
+      for(std::size_t i = 0; i < size; ++i)
+      {
+        sva_internal::ptransformMul(pt1[i], jac[i], jacRes[i], std::false_type());
+      }
+    }
+  }
+  std::cout << std::endl;
+
+  std::cout << "PTransform vs Jacobian (SIMD kernels "
+            << (sva_internal::has_simd_kernels<Matrix6Xd>::value ? "enabled" : "disabled") << ")" << std::endl;
+  {
+    boost::timer::auto_cpu_timer t;
+    for(std::size_t r = 0; r < repeat; ++r)
+    {
+      for(std::size_t i = 0; i < size; ++i)
+      {
+        pt1[i].mul(jac[i], jacRes[i]);
+      }
+    }
+  }
+  std::cout << std::endl;
+
+  std::cout << "PTransform as matrix vs Jacobian" << std::endl;
+  {
+    boost::timer::auto_cpu_timer t;
+    for(std::size_t r = 0; r < repeat; ++r)
+    {
+      for(std::size_t i = 0; i < size; ++i)
+      {
+        jacRes[i].noalias() = pt1[i].matrix() * jac[i];
+      }
+    }
+  }
+  std::cout << std::endl;
+
+  std::cout << "PTransform transMul vs Jacobian (generic kernels)" << std::endl;
+  {
+    boost::timer::auto_cpu_timer t;
+    for(std::size_t r = 0; r < repeat; ++r)
+    {
+      for(std::size_t i = 0; i < size; ++i)
+      {
+        sva_internal::ptransformTransMul(pt1[i], jac[i], jacRes[i], std::false_type());
+      }
+    }
+  }
+  std::cout << std::endl;
+
+  std::cout << "PTransform transMul vs Jacobian (SIMD kernels "
+            << (sva_internal::has_simd_kernels<Matrix6Xd>::value ? "enabled" : "disabled") << ")" << std::endl;
+  {
+    boost::timer::auto_cpu_timer t;
+    for(std::size_t r = 0; r < repeat; ++r)
+    {
+      for(std::size_t i = 0; i < size; ++i)
+      {
+        pt1[i].transMul(jac[i], jacRes[i]);
+      }
+    }
+  }
+  std::cout << std::endl;
+}
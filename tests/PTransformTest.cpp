@@ -501,3 +501,219 @@ BOOST_AUTO_TEST_CASE(rotationVelocityTest)
     check_exact_pi_rotation(u);
   }
 }
+
+BOOST_AUTO_TEST_CASE(PTransformMatrix6XTest)
+{
+  using namespace Eigen;
+  using namespace sva;
+
+  PTransformd pt(Quaterniond(Vector4d::Random()).normalized(), Vector3d::Random());
+  Matrix6d pt6d = pt.matrix();
+  Matrix6d ptInv6d = pt.inv().matrix();
+  Matrix6d ptDual6d = pt.dualMatrix();
+  Matrix6d ptTrans6d = pt6d.transpose();
+
+  // a jacobian sized input
+  Matrix6Xd jac = Matrix6Xd::Random(6, 40);
+  Matrix6Xd resMul(6, 40), resInvMul(6, 40), resDualMul(6, 40), resTransMul(6, 40);
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  pt.mul(jac, resMul);
+  pt.invMul(jac, resInvMul);
+  pt.dualMul(jac, resDualMul);
+  pt.transMul(jac, resTransMul);
+  Eigen::internal::set_is_malloc_allowed(true);
+
+  BOOST_CHECK_SMALL((resMul - pt6d * jac).norm(), TOL);
+  BOOST_CHECK_SMALL((resInvMul - ptInv6d * jac).norm(), TOL);
+  BOOST_CHECK_SMALL((resDualMul - ptDual6d * jac).norm(), TOL);
+  BOOST_CHECK_SMALL((resTransMul - ptTrans6d * jac).norm(), TOL);
+
+  // block of a larger matrix, the columns are not contiguous
+  MatrixXd big = MatrixXd::Random(10, 40);
+  MatrixXd bigRes = MatrixXd::Zero(10, 40);
+  Block<MatrixXd, 6, Dynamic> blockIn(big, 2, 0, 6, 40);
+  Block<MatrixXd, 6, Dynamic> blockRes(bigRes, 2, 0, 6, 40);
+  pt.mul(blockIn, blockRes);
+  BOOST_CHECK_SMALL((bigRes.middleRows<6>(2) - pt6d * big.middleRows<6>(2)).norm(), TOL);
+  BOOST_CHECK_EQUAL(bigRes.topRows<2>().norm(), 0.);
+  BOOST_CHECK_EQUAL(bigRes.bottomRows<2>().norm(), 0.);
+  pt.transMul(blockIn, blockRes);
+  BOOST_CHECK_SMALL((bigRes.middleRows<6>(2) - ptTrans6d * big.middleRows<6>(2)).norm(), TOL);
+  BOOST_CHECK_EQUAL(bigRes.topRows<2>().norm(), 0.);
+  BOOST_CHECK_EQUAL(bigRes.bottomRows<2>().norm(), 0.);
+
+  // non unit inner stride
+  typedef Map<Matrix6Xd, 0, Stride<Dynamic, Dynamic>> StridedMap;
+  VectorXd inData = VectorXd::Random(2 * 6 * 5);
+  VectorXd resData = VectorXd::Zero(2 * 6 * 5);
+  StridedMap stridedIn(inData.data(), 6, 5, Stride<Dynamic, Dynamic>(12, 2));
+  StridedMap stridedRes(resData.data(), 6, 5, Stride<Dynamic, Dynamic>(12, 2));
+  pt.dualMul(stridedIn, stridedRes);
+  BOOST_CHECK_SMALL((Matrix6Xd(stridedRes) - ptDual6d * Matrix6Xd(stridedIn)).norm(), TOL);
+}
+
+BOOST_AUTO_TEST_CASE(PTransformProductTest)
+{
+  using namespace Eigen;
+  using namespace sva;
+
+  PTransformd X_a_b(Quaterniond(Vector4d::Random()).normalized(), Vector3d::Random());
+  PTransformd X_b_c(Quaterniond(Vector4d::Random()).normalized(), Vector3d::Random());
+  PTransformd X_c_d(Quaterniond(Vector4d::Random()).normalized(), Vector3d::Random());
+  PTransformd X_d_e(Quaterniond(Vector4d::Random()).normalized(), Vector3d::Random());
+  Matrix6d m_a_d = X_c_d.matrix() * X_b_c.matrix() * X_a_b.matrix();
+  Matrix6d m_a_e = X_d_e.matrix() * m_a_d;
+  MotionVecd mv(Vector6d::Random());
+  ForceVecd fv(Vector6d::Random());
+  RBInertiad rbI(2., Vector3d::Random(), Matrix3d::Identity());
+
+  // operator* evaluates the product so its result is a PTransform
+  BOOST_CHECK_SMALL(((X_c_d * X_b_c).translation() - PTransformd(X_c_d * X_b_c).translation()).norm(), TOL);
+  BOOST_CHECK_SMALL(((X_c_d * X_b_c * X_a_b).matrix() - m_a_d).norm(), TOL);
+  BOOST_CHECK_SMALL(((X_b_c * X_a_b).dualMul(rbI).matrix() - X_b_c.dualMul(X_a_b.dualMul(rbI)).matrix()).norm(),
+                    TOL);
+  BOOST_CHECK_SMALL(transformError(X_a_b * X_b_c, X_a_b * X_b_c).vector().norm(), TOL);
+  BOOST_CHECK_SMALL((interpolate(X_a_b * X_b_c, X_a_b * X_b_c, 0.5).matrix() - (X_a_b * X_b_c).matrix()).norm(),
+                    TOL);
+
+  PTransformd X_a_d, X_a_e;
+  MotionVecd mvRes1, mvRes2;
+  ForceVecd fvRes1, fvRes2;
+  Eigen::internal::set_is_malloc_allowed(false);
+  X_a_d = compose(X_c_d, X_b_c) * X_a_b;
+  X_a_e = compose(X_d_e, X_c_d) * compose(X_b_c, X_a_b);
+  mvRes1 = compose(X_c_d, X_b_c) * X_a_b * mv;
+  mvRes2 = (compose(X_c_d, X_b_c) * X_a_b).invMul(mv);
+  fvRes1 = (compose(X_c_d, X_b_c) * X_a_b).dualMul(fv);
+  fvRes2 = (compose(X_c_d, X_b_c) * X_a_b).transMul(fv);
+  Eigen::internal::set_is_malloc_allowed(true);
+
+  BOOST_CHECK_SMALL((X_a_d.matrix() - m_a_d).norm(), TOL);
+  BOOST_CHECK_SMALL((X_a_e.matrix() - m_a_e).norm(), TOL);
+  BOOST_CHECK_SMALL(((X_d_e * compose(X_c_d, X_b_c) * X_a_b).eval().matrix() - m_a_e).norm(), TOL);
+  BOOST_CHECK_SMALL((mvRes1.vector() - m_a_d * mv.vector()).norm(), TOL);
+  BOOST_CHECK_SMALL((mvRes2.vector() - m_a_d.inverse() * mv.vector()).norm(), TOL);
+  BOOST_CHECK_SMALL((fvRes1.vector() - m_a_d.inverse().transpose() * fv.vector()).norm(), TOL);
+  BOOST_CHECK_SMALL((fvRes2.vector() - m_a_d.transpose() * fv.vector()).norm(), TOL);
+  BOOST_CHECK_SMALL(((compose(X_c_d, X_b_c) * X_a_b).inv().matrix() - m_a_d.inverse()).norm(), TOL);
+  BOOST_CHECK(compose(X_c_d, X_b_c) * X_a_b == X_a_d);
+
+  // the product owns its factors, it can outlive temporaries
+  auto prod = compose(X_c_d, PTransformd(X_b_c)) * PTransformd(X_a_b);
+  BOOST_CHECK_SMALL(((prod * mv).vector() - m_a_d * mv.vector()).norm(), TOL);
+
+  // Matrix6X are transformed by the evaluated product
+  Matrix6Xd jac = Matrix6Xd::Random(6, 10);
+  Matrix6Xd res(6, 10);
+  (compose(X_c_d, X_b_c) * X_a_b).mul(jac, res);
+  BOOST_CHECK_SMALL((res - m_a_d * jac).norm(), TOL);
+  (compose(X_c_d, X_b_c) * X_a_b).transMul(jac, res);
+  BOOST_CHECK_SMALL((res - m_a_d.transpose() * jac).norm(), TOL);
+
+  // the assigned transform can be one of the factors
+  PTransformd X = X_a_b;
+  X = compose(X_b_c, X);
+  BOOST_CHECK_SMALL((X.matrix() - X_b_c.matrix() * X_a_b.matrix()).norm(), TOL);
+  X = X_a_b;
+  X = compose(X, X_b_c) * X;
+  BOOST_CHECK_SMALL((X.matrix() - X_a_b.matrix() * X_b_c.matrix() * X_a_b.matrix()).norm(), TOL);
+}
+
+template<typename Transform>
+void testSpecializedTransform(const Transform & X)
+{
+  using namespace Eigen;
+  using namespace sva;
+
+  const PTransformd pt = X.ptransform();
+  PTransformd Xp(Quaterniond(Vector4d::Random()).normalized(), Vector3d::Random());
+  MotionVecd mv(Vector6d::Random());
+  ForceVecd fv(Vector6d::Random());
+  Matrix3d I, H, M;
+  I << 1., 2., 3., 2., 5., 6., 3., 6., 9.;
+  H = Matrix3d::Random();
+  M << 4., 1., 2., 1., 5., 3., 2., 3., 6.;
+  RBInertiad rbI(3., Vector3d::Random(), I);
+  ABInertiad abI(M, H, I);
+
+  BOOST_CHECK_SMALL((X.matrix() - pt.matrix()).norm(), TOL);
+  BOOST_CHECK_SMALL((X.dualMatrix() - pt.dualMatrix()).norm(), TOL);
+  BOOST_CHECK_SMALL(((X * Xp).matrix() - (pt * Xp).matrix()).norm(), TOL);
+  BOOST_CHECK_SMALL(((Xp * X).matrix() - (Xp * pt).matrix()).norm(), TOL);
+  BOOST_CHECK_SMALL(((X * X).matrix() - (pt * pt).matrix()).norm(), TOL);
+  BOOST_CHECK_SMALL((X.inv().matrix() - pt.inv().matrix()).norm(), TOL);
+
+  BOOST_CHECK_SMALL(((X * mv).vector() - (pt * mv).vector()).norm(), TOL);
+  BOOST_CHECK_SMALL((X.invMul(mv).vector() - pt.invMul(mv).vector()).norm(), TOL);
+  BOOST_CHECK_SMALL((X.dualMul(fv).vector() - pt.dualMul(fv).vector()).norm(), TOL);
+  BOOST_CHECK_SMALL((X.transMul(fv).vector() - pt.transMul(fv).vector()).norm(), TOL);
+
+  BOOST_CHECK_SMALL((X.dualMul(rbI).matrix() - pt.dualMul(rbI).matrix()).norm(), TOL);
+  BOOST_CHECK_SMALL((X.transMul(rbI).matrix() - pt.transMul(rbI).matrix()).norm(), TOL);
+  BOOST_CHECK(isUpperNull(X.dualMul(rbI).lowerTriangularInertia()));
+  BOOST_CHECK(isUpperNull(X.transMul(rbI).lowerTriangularInertia()));
+  BOOST_CHECK_SMALL((X.dualMul(abI).matrix() - pt.dualMul(abI).matrix()).norm(), TOL);
+  BOOST_CHECK_SMALL((X.transMul(abI).matrix() - pt.transMul(abI).matrix()).norm(), TOL);
+
+  Matrix6Xd jac = Matrix6Xd::Random(6, 10);
+  Matrix6Xd res(6, 10);
+  X.mul(jac, res);
+  BOOST_CHECK_SMALL((res - pt.matrix() * jac).norm(), TOL);
+  X.invMul(jac, res);
+  BOOST_CHECK_SMALL((res - pt.matrix().inverse() * jac).norm(), TOL);
+  X.dualMul(jac, res);
+  BOOST_CHECK_SMALL((res - pt.dualMatrix() * jac).norm(), TOL);
+  X.transMul(jac, res);
+  BOOST_CHECK_SMALL((res - pt.matrix().transpose() * jac).norm(), TOL);
+}
+
+BOOST_AUTO_TEST_CASE(RotationTranslationTransformTest)
+{
+  using namespace Eigen;
+  using namespace sva;
+
+  RotationTransformd R(Quaterniond(Vector4d::Random()).normalized());
+  TranslationTransformd T(Vector3d::Random());
+  testSpecializedTransform(R);
+  testSpecializedTransform(T);
+
+  BOOST_CHECK_SMALL(((R * T).matrix() - R.matrix() * T.matrix()).norm(), TOL);
+  BOOST_CHECK_SMALL(((T * R).matrix() - T.matrix() * R.matrix()).norm(), TOL);
+  BOOST_CHECK(RotationTransformd::Identity().ptransform() == PTransformd::Identity());
+  BOOST_CHECK(TranslationTransformd::Identity().ptransform() == PTransformd::Identity());
+  BOOST_CHECK(R.cast<float>().rotation().isApprox(R.rotation().cast<float>()));
+  BOOST_CHECK(T * T.inv() == TranslationTransformd::Identity());
+
+  // transformError only applies the rotation part of X_a_b
+  PTransformd X_a_b(Quaterniond(Vector4d::Random()).normalized(), Vector3d::Random());
+  PTransformd X_a_c(Quaterniond(Vector4d::Random()).normalized(), Vector3d::Random());
+  PTransformd X_b_c = X_a_c * X_a_b.inv();
+  BOOST_CHECK_SMALL(
+      (transformError(X_a_b, X_a_c).vector()
+       - (PTransformd(Matrix3d(X_a_b.rotation().transpose())) * transformVelocity(X_b_c)).vector())
+          .norm(),
+      TOL);
+}
+
+BOOST_AUTO_TEST_CASE(AxisRotationTransformTest)
+{
+  using namespace Eigen;
+  using namespace sva;
+
+  const double theta = 0.7, theta2 = -1.9;
+  RotXTransformd Rx(theta);
+  RotYTransformd Ry(theta);
+  RotZTransformd Rz(theta);
+  BOOST_CHECK_SMALL((Rx.rotation() - RotX(theta)).norm(), TOL);
+  BOOST_CHECK_SMALL((Ry.rotation() - RotY(theta)).norm(), TOL);
+  BOOST_CHECK_SMALL((Rz.rotation() - RotZ(theta)).norm(), TOL);
+  testSpecializedTransform(Rx);
+  testSpecializedTransform(Ry);
+  testSpecializedTransform(Rz);
+
+  BOOST_CHECK_SMALL(((Rx * RotXTransformd(theta2)).rotation() - RotX(theta + theta2)).norm(), TOL);
+  BOOST_CHECK_SMALL(((Rz * Rz.inv()).rotation() - Matrix3d::Identity()).norm(), TOL);
+  BOOST_CHECK(RotYTransformd::Identity().ptransform() == PTransformd::Identity());
+  BOOST_CHECK_SMALL((Ry.rotationTransform().matrix() - Ry.matrix()).norm(), TOL);
+}
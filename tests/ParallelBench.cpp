@@ -0,0 +1,148 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+// Scaling of the parallel batch operations with the number of threads.
+//
+// Each benchmark runs a batch operation of a few hundred thousands elements
+// on a ThreadPool of 1 to hardware_concurrency threads, the pool is created
+// outside of the timed loop. The serial operation is the 0 threads case.
+// Times are reported per batch and the items per second counter gives the
+// throughput in elements per second.
+
+// includes
+// std
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// benchmark
+#include <benchmark/benchmark.h>
+
+// SpaceVecAlg
+#include <SpaceVecAlg/ParallelBatch.h>
+#include <SpaceVecAlg/SpaceVecAlg>
+
+namespace
+{
+
+/// Number of elements of the batches.
+constexpr std::size_t batchSize = 1 << 18;
+
+/// Random batches shared by all the benchmarks.
+struct Data
+{
+  Data()
+  {
+    using namespace Eigen;
+    using namespace sva;
+    std::vector<PTransformd> pts2;
+    std::vector<MotionVecd> mvs;
+    std::vector<ForceVecd> fvs;
+    for(std::size_t i = 0; i < batchSize; ++i)
+    {
+      pts.push_back(PTransformd(Quaterniond(Vector4d::Random()).normalized(), Vector3d::Random()));
+      pts2.push_back(PTransformd(Quaterniond(Vector4d::Random()).normalized(), Vector3d::Random()));
+      mvs.push_back(MotionVecd(Vector6d::Random()));
+      fvs.push_back(ForceVecd(Vector6d::Random()));
+    }
+    ptb1 = PTransformBatchd(pts);
+    ptb2 = PTransformBatchd(pts2);
+    mvb = MotionVecBatchd(mvs);
+    fvb = ForceVecBatchd(fvs);
+    rbI = std::vector<RBInertiad>(batchSize, RBInertiad(1., Vector3d::Random(), Matrix3d::Identity()));
+  }
+
+  std::vector<sva::PTransformd> pts;
+  sva::PTransformBatchd ptb1, ptb2;
+  sva::MotionVecBatchd mvb;
+  sva::ForceVecBatchd fvb;
+  std::vector<sva::RBInertiad> rbI;
+};
+
+Data & data()
+{
+  static Data d;
+  return d;
+}
+
+/// Thread counts from 0 (serial) to hardware_concurrency.
+void threadArgs(benchmark::internal::Benchmark * b)
+{
+  const int maxThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  for(int t = 0; t <= maxThreads; t = (t == 0 ? 1 : 2 * t))
+  {
+    b->Arg(t);
+  }
+  if(maxThreads & (maxThreads - 1))
+  {
+    b->Arg(maxThreads);
+  }
+}
+
+} // namespace
+
+/**
+ * Define the benchmark name that computes serial (0 threads) or par with
+ * state.range(0) threads. serial and par can use d (Data) and pool.
+ */
+#define SVA_PARALLEL_BENCH(name, serial, par)                                             \
+  void BM_##name(benchmark::State & state)                                                \
+  {                                                                                       \
+    using namespace sva;                                                                  \
+    Data & d = data();                                                                    \
+    const unsigned nrThreads = static_cast<unsigned>(state.range(0));                     \
+    ThreadPool pool(std::max(1u, nrThreads));                                             \
+    for(auto _ : state)                                                                   \
+    {                                                                                     \
+      if(nrThreads == 0)                                                                  \
+      {                                                                                   \
+        serial;                                                                           \
+      }                                                                                   \
+      else                                                                                \
+      {                                                                                   \
+        par;                                                                              \
+      }                                                                                   \
+    }                                                                                     \
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * batchSize));   \
+  }                                                                                       \
+  BENCHMARK(BM_##name)->Apply(threadArgs)->UseRealTime()
+
+namespace
+{
+sva::PTransformBatchd ptRes;
+sva::MotionVecBatchd mvRes;
+sva::ForceVecBatchd fvRes;
+std::vector<sva::RBInertiad> rbIRes(batchSize);
+
+/// X.dualMul(I), the inertias have no batch type and use the std::transform like overload.
+struct DualMul
+{
+  sva::RBInertiad operator()(const sva::PTransformd & X, const sva::RBInertiad & I) const
+  {
+    return X.dualMul(I);
+  }
+};
+} // namespace
+
+SVA_PARALLEL_BENCH(PTransformBatch_mul,
+                   d.ptb1.mul(d.ptb2, ptRes),
+                   parallelTransform(pool, BatchMul(), d.ptb1, d.ptb2, ptRes));
+SVA_PARALLEL_BENCH(PTransformBatch_inv, d.ptb1.inv(ptRes), parallelTransform(pool, BatchInv(), d.ptb1, ptRes));
+SVA_PARALLEL_BENCH(PTransformBatch_mul_MotionVecBatch,
+                   d.ptb1.mul(d.mvb, mvRes),
+                   parallelTransform(pool, BatchMul(), d.ptb1, d.mvb, mvRes));
+SVA_PARALLEL_BENCH(PTransformBatch_dualMul_ForceVecBatch,
+                   d.ptb1.dualMul(d.fvb, fvRes),
+                   parallelTransform(pool, BatchDualMul(), d.ptb1, d.fvb, fvRes));
+SVA_PARALLEL_BENCH(transformError_Batch,
+                   transformError(d.ptb1, d.ptb2, mvRes),
+                   parallelTransform(pool, BatchTransformError(), d.ptb1, d.ptb2, mvRes));
+SVA_PARALLEL_BENCH(exp_Batch, exp(d.mvb, ptRes), parallelTransform(pool, BatchExp(), d.mvb, ptRes));
+SVA_PARALLEL_BENCH(PTransform_dualMul_RBInertia,
+                   std::transform(d.pts.begin(), d.pts.end(), d.rbI.begin(), rbIRes.begin(), DualMul()),
+                   parallelTransform(pool, d.pts.begin(), d.pts.end(), d.rbI.begin(), rbIRes.begin(), DualMul()));
+
+BENCHMARK_MAIN();
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+// includes
+// std
+#include <iostream>
+
+// boost
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE QTransform test
+#include <boost/math/constants/constants.hpp>
+#include <boost/test/unit_test.hpp>
+
+// SpaceVecAlg
+#include <SpaceVecAlg/SpaceVecAlg>
+
+const double TOL = 1e-10;
+
+sva::QTransformd randomQTransform()
+{
+  using namespace Eigen;
+  return sva::QTransformd(Quaterniond(Vector4d::Random()).normalized(), Vector3d::Random());
+}
+
+template<typename Vec>
+bool isClose(const Vec & v1, const Vec & v2)
+{
+  return (v1.vector() - v2.vector()).array().abs().maxCoeff() < TOL;
+}
+
+bool isClose(const sva::PTransformd & pt1, const sva::PTransformd & pt2)
+{
+  return (pt1.matrix() - pt2.matrix()).array().abs().maxCoeff() < TOL;
+}
+
+BOOST_AUTO_TEST_CASE(QTransformConversionTest)
+{
+  using namespace Eigen;
+  using namespace sva;
+
+  Quaterniond q(Vector4d::Random().normalized());
+  Vector3d r(Vector3d::Random());
+
+  QTransformd qt(q, r);
+  PTransformd pt(q, r);
+
+  BOOST_CHECK_EQUAL(qt.rotation().coeffs(), q.coeffs());
+  BOOST_CHECK_EQUAL(qt.translation(), r);
+  BOOST_CHECK_SMALL((qt.matrix() - pt.matrix()).array().abs().maxCoeff(), TOL);
+  BOOST_CHECK_SMALL((qt.dualMatrix() - pt.dualMatrix()).array().abs().maxCoeff(), TOL);
+
+  // QTransform -> PTransform -> QTransform
+  BOOST_CHECK(isClose(qt.ptransform(), pt));
+  BOOST_CHECK(isClose(PTransformd(qt), pt));
+  QTransformd qtBack(pt);
+  BOOST_CHECK(isClose(qtBack.ptransform(), pt));
+  BOOST_CHECK_SMALL(qtBack.rotation().angularDistance(q), TOL);
+  BOOST_CHECK_SMALL((qtBack.translation() - r).norm(), TOL);
+
+  // rotation matrix constructors
+  BOOST_CHECK(isClose(QTransformd(pt.rotation(), r).ptransform(), pt));
+  BOOST_CHECK(isClose(QTransformd(pt.rotation()).ptransform(), PTransformd(pt.rotation())));
+  BOOST_CHECK(isClose(QTransformd(q).ptransform(), PTransformd(q)));
+  BOOST_CHECK(isClose(QTransformd(r).ptransform(), PTransformd(r)));
+  BOOST_CHECK(isClose(QTransformd::Identity().ptransform(), PTransformd::Identity()));
+
+  // cast
+  QTransform<float> qtf = qt.cast<float>();
+  BOOST_CHECK_EQUAL(qtf.rotation().coeffs(), q.coeffs().cast<float>());
+  BOOST_CHECK_EQUAL(qtf.translation(), r.cast<float>());
+
+  BOOST_CHECK(qt == qt);
+  BOOST_CHECK(qt != QTransformd::Identity());
+
+  // QTransform footprint must stay smaller than PTransform
+  BOOST_CHECK_EQUAL(sizeof(QTransformd), 7 * sizeof(double));
+  BOOST_CHECK_LT(sizeof(QTransformd), sizeof(PTransformd));
+}
+
+BOOST_AUTO_TEST_CASE(QTransformOperatorsTest)
+{
+  using namespace Eigen;
+  using namespace sva;
+
+  QTransformd qt1 = randomQTransform();
+  QTransformd qt2 = randomQTransform();
+  PTransformd pt1(qt1), pt2(qt2);
+
+  // X*X, X^-1
+  BOOST_CHECK(isClose((qt1 * qt2).ptransform(), pt1 * pt2));
+  BOOST_CHECK(isClose(qt1.inv().ptransform(), pt1.inv()));
+  BOOST_CHECK(isClose((qt1 * qt1.inv()).ptransform(), PTransformd::Identity()));
+
+  // motion and force vectors
+  MotionVecd mv(Vector6d::Random());
+  ForceVecd fv(Vector6d::Random());
+
+  BOOST_CHECK(isClose(qt1 * mv, pt1 * mv));
+  BOOST_CHECK(isClose(qt1.invMul(mv), pt1.invMul(mv)));
+  BOOST_CHECK(isClose(qt1.dualMul(fv), pt1.dualMul(fv)));
+  BOOST_CHECK(isClose(qt1.transMul(fv), pt1.transMul(fv)));
+
+  // Matrix6X
+  Matrix<double, 6, Dynamic> mat(Matrix<double, 6, Dynamic>::Random(6, 10));
+  Matrix<double, 6, Dynamic> res(6, 10), resP(6, 10);
+  qt1.mul(mat, res);
+  pt1.mul(mat, resP);
+  BOOST_CHECK_SMALL((res - resP).array().abs().maxCoeff(), TOL);
+  qt1.invMul(mat, res);
+  pt1.invMul(mat, resP);
+  BOOST_CHECK_SMALL((res - resP).array().abs().maxCoeff(), TOL);
+  qt1.dualMul(mat, res);
+  pt1.dualMul(mat, resP);
+  BOOST_CHECK_SMALL((res - resP).array().abs().maxCoeff(), TOL);
+  qt1.transMul(mat, res);
+  pt1.transMul(mat, resP);
+  BOOST_CHECK_SMALL((res - resP).array().abs().maxCoeff(), TOL);
+
+  // inertia
+  Matrix3d I;
+  I << 1., 2., 3., 2., 1., 4., 3., 4., 1.;
+  RBInertiad rbI(3., Vector3d::Random(), I);
+  BOOST_CHECK_SMALL((qt1.dualMul(rbI).matrix() - pt1.dualMul(rbI).matrix()).array().abs().maxCoeff(), TOL);
+  BOOST_CHECK_SMALL((qt1.transMul(rbI).matrix() - pt1.transMul(rbI).matrix()).array().abs().maxCoeff(), TOL);
+  ABInertiad abI(I, 2. * I, 3. * I);
+  BOOST_CHECK_SMALL((qt1.dualMul(abI).matrix() - pt1.dualMul(abI).matrix()).array().abs().maxCoeff(), TOL);
+  BOOST_CHECK_SMALL((qt1.transMul(abI).matrix() - pt1.transMul(abI).matrix()).array().abs().maxCoeff(), TOL);
+
+  // interpolation
+  for(double t : {0., 0.25, 0.5, 1.})
+  {
+    BOOST_CHECK(isClose(interpolate(qt1, qt2, t).ptransform(), interpolate(pt1, pt2, t)));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(QTransformErrorTest)
+{
+  using namespace Eigen;
+  using namespace sva;
+  const double pi = boost::math::constants::pi<double>();
+
+  for(int i = 0; i < 100; ++i)
+  {
+    QTransformd qt1 = randomQTransform();
+    QTransformd qt2 = randomQTransform();
+    PTransformd pt1(qt1), pt2(qt2);
+
+    BOOST_CHECK(isClose(transformVelocity(qt1), transformVelocity(pt1)));
+    BOOST_CHECK(isClose(transformError(qt1, qt2), transformError(pt1, pt2)));
+  }
+
+  // the quaternion sign must not change the rotation vector
+  Quaterniond q(Vector4d::Random().normalized());
+  Quaterniond qNeg(-q.coeffs());
+  BOOST_CHECK_SMALL((rotationVelocity(q) - rotationVelocity(qNeg)).norm(), TOL);
+
+  // small angles
+  for(double angle : {0., 1e-12, 1e-6, 1e-3})
+  {
+    Vector3d axis(Vector3d::Random().normalized());
+    Quaterniond qs(AngleAxisd(angle, axis));
+    BOOST_CHECK_SMALL((rotationVelocity(qs) - rotationVelocity(qs.toRotationMatrix())).norm(), TOL);
+    BOOST_CHECK_SMALL((rotationVelocity(qs) + angle * axis).norm(), TOL);
+  }
+
+  // angles close to pi
+  for(double angle : {pi - 1e-3, pi - 1e-6, pi})
+  {
+    Vector3d axis(Vector3d::Random().normalized());
+    Quaterniond qs(AngleAxisd(angle, axis));
+    Vector3d w = rotationVelocity(qs);
+    BOOST_CHECK_SMALL(std::abs(w.norm() - angle), 1e-8);
+    BOOST_CHECK_SMALL((AngleAxisd(-w.norm(), w.normalized()).toRotationMatrix() - qs.toRotationMatrix()).norm(), 1e-8);
+  }
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+// Random inputs shared by the tests and the benchmarks.
+
+// includes
+// std
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// SpaceVecAlg
+#include <SpaceVecAlg/SpaceVecAlg>
+
+/// @return Transformation with a random rotation and a translation in [-1, 1]^3.
+inline sva::PTransformd randomPTransform()
+{
+  using namespace Eigen;
+  return sva::PTransformd(Quaterniond(Vector4d::Random()).normalized(), Vector3d::Random());
+}
+
+/// @return size random transformations, see randomPTransform.
+inline std::vector<sva::PTransformd> randomPTransforms(std::size_t size)
+{
+  std::vector<sva::PTransformd> pts(size);
+  for(auto & pt : pts)
+  {
+    pt = randomPTransform();
+  }
+  return pts;
+}
+
+/// @return Physically consistent inertia with a mass in [1, 2] and a positive definite rotational inertia.
+inline sva::RBInertiad randomRBInertia()
+{
+  using namespace Eigen;
+  double mass = 1. + std::abs(Vector2d::Random()(0));
+  Vector3d com(Vector3d::Random());
+  Matrix3d A(Matrix3d::Random());
+  Matrix3d Ic = A * A.transpose() + 0.1 * Matrix3d::Identity();
+  return sva::RBInertiad(mass, mass * com, sva::inertiaToOrigin(Ic, mass, com, Matrix3d::Identity().eval()));
+}
+
+/// @return Articulated body inertia with positive definite mass matrix and inertia.
+inline sva::ABInertiad randomABInertia()
+{
+  using namespace Eigen;
+  Matrix3d A(Matrix3d::Random());
+  Matrix3d B(Matrix3d::Random());
+  return sva::ABInertiad(A * A.transpose() + Matrix3d::Identity(), Matrix3d::Random(),
+                         B * B.transpose() + Matrix3d::Identity());
+}
@@ -0,0 +1,304 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+// includes
+// std
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// boost
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Trajectory test
+#include <boost/test/unit_test.hpp>
+
+// SpaceVecAlg
+#include <SpaceVecAlg/SpaceVecAlg>
+#include <SpaceVecAlg/Trajectory.h>
+#include <SpaceVecAlg/TrajectoryStream.h>
+
+#include "TestUtils.h"
+
+const double TOL = 1e-10;
+
+// not a multiple of the kernel block size to check the tail handling
+const std::size_t SIZE = 150;
+
+const char * PATH = "TrajectoryTest.svatraj";
+
+BOOST_AUTO_TEST_CASE(TrajectoryWriteReadTest)
+{
+  using namespace sva;
+
+  std::vector<PTransformd> pts = randomPTransforms(SIZE);
+
+  {
+    TrajectoryWriter<PTransformd> writer(PATH);
+    BOOST_REQUIRE(writer.isOpen());
+    BOOST_CHECK(writer.write(pts[0]));
+    BOOST_CHECK(writer.write(pts.data() + 1, 9));
+    BOOST_CHECK(writer.writeBatch(PTransformBatchd(std::vector<PTransformd>(pts.begin() + 10, pts.end()))));
+    BOOST_CHECK_EQUAL(writer.size(), SIZE);
+    BOOST_CHECK(writer.close());
+  }
+
+  MappedTrajectory<PTransformd> traj(PATH);
+  BOOST_REQUIRE(traj.isOpen());
+  BOOST_CHECK_EQUAL(traj.header().version, trajectoryFormatVersion);
+  BOOST_CHECK_EQUAL(traj.header().sampleSize, sizeof(PTransformd));
+  BOOST_REQUIRE_EQUAL(traj.size(), SIZE);
+  for(std::size_t i = 0; i < SIZE; ++i)
+  {
+    BOOST_CHECK_EQUAL(traj[i], pts[i]);
+  }
+  BOOST_CHECK_EQUAL(std::distance(traj.begin(), traj.end()), SIZE);
+
+  // the file can not be read as another sample type
+  MappedTrajectory<MotionVecd> wrongType;
+  BOOST_CHECK(!wrongType.open(PATH));
+  BOOST_CHECK(!wrongType.isOpen());
+  MappedTrajectory<PTransform<float>> wrongScalar;
+  BOOST_CHECK(!wrongScalar.open(PATH));
+
+  traj.close();
+  BOOST_CHECK(!traj.isOpen());
+  BOOST_CHECK(!traj.open("TrajectoryTest.missing"));
+
+  // a newer version or a truncated file is rejected
+  {
+    std::FILE * f = std::fopen(PATH, "r+b");
+    BOOST_REQUIRE(f != nullptr);
+    TrajectoryHeader header;
+    BOOST_REQUIRE_EQUAL(std::fread(&header, sizeof(header), 1, f), 1);
+    header.version = trajectoryFormatVersion + 1;
+    std::fseek(f, 0, SEEK_SET);
+    std::fwrite(&header, sizeof(header), 1, f);
+    std::fclose(f);
+    BOOST_CHECK(!traj.open(PATH));
+
+    f = std::fopen(PATH, "r+b");
+    header.version = trajectoryFormatVersion;
+    header.size = SIZE + 1;
+    std::fwrite(&header, sizeof(header), 1, f);
+    std::fclose(f);
+    BOOST_CHECK(!traj.open(PATH));
+  }
+
+  std::remove(PATH);
+}
+
+BOOST_AUTO_TEST_CASE(TrajectoryViewTest)
+{
+  using namespace Eigen;
+  using namespace sva;
+
+  std::vector<PTransformd> pts(SIZE);
+  std::vector<MotionVecd> mvs(SIZE);
+  std::vector<ForceVecd> fvs(SIZE);
+  for(std::size_t i = 0; i < SIZE; ++i)
+  {
+    pts[i] = randomPTransform();
+    mvs[i] = MotionVecd(Vector6d::Random());
+    fvs[i] = ForceVecd(Vector6d::Random());
+  }
+
+  TrajectoryWriter<PTransformd> writer(PATH);
+  writer.write(pts);
+  writer.close();
+  MappedTrajectory<PTransformd> traj(PATH);
+  BOOST_REQUIRE(traj.isOpen());
+  const TrajectoryView<PTransformd> & X = traj.view();
+
+  // structure of arrays lanes
+  for(std::size_t i = 0; i < SIZE; ++i)
+  {
+    BOOST_CHECK_EQUAL(X.lane(3 * 2 + 1)(i), pts[i].rotation()(1, 2));
+    BOOST_CHECK_EQUAL(X.lane(9 + 2)(i), pts[i].translation()(2));
+    BOOST_CHECK_EQUAL(X.lanes()(i, 4), pts[i].rotation()(1, 1));
+  }
+  TrajectoryView<PTransformd> seg = traj.view(10, 20);
+  BOOST_CHECK_EQUAL(seg.size(), 20);
+  BOOST_CHECK_EQUAL(seg[0], pts[10]);
+
+  // conversion to the batch types
+  PTransformBatchd ptb;
+  toBatch(X, ptb);
+  MotionVecBatchd mvb;
+  toBatch(TrajectoryView<MotionVecd>(mvs.data(), SIZE), mvb);
+  ForceVecBatchd fvb;
+  toBatch(TrajectoryView<ForceVecd>(fvs.data(), SIZE), fvb);
+  BOOST_REQUIRE_EQUAL(ptb.size(), SIZE);
+  for(std::size_t i = 0; i < SIZE; ++i)
+  {
+    BOOST_CHECK_EQUAL(ptb[i], pts[i]);
+    BOOST_CHECK_EQUAL(mvb[i], mvs[i]);
+    BOOST_CHECK_EQUAL(fvb[i], fvs[i]);
+  }
+
+  // batch operators on the mapped transformations
+  MotionVecBatchd mvMul, mvInvMul;
+  ForceVecBatchd fvDualMul, fvTransMul;
+  mul(X, mvb, mvMul);
+  invMul(X, mvb, mvInvMul);
+  dualMul(X, fvb, fvDualMul);
+  transMul(X, fvb, fvTransMul);
+  for(std::size_t i = 0; i < SIZE; ++i)
+  {
+    BOOST_CHECK_SMALL((mvMul[i] - pts[i] * mvs[i]).vector().norm(), TOL);
+    BOOST_CHECK_SMALL((mvInvMul[i] - pts[i].invMul(mvs[i])).vector().norm(), TOL);
+    BOOST_CHECK_SMALL((fvDualMul[i] - pts[i].dualMul(fvs[i])).vector().norm(), TOL);
+    BOOST_CHECK_SMALL((fvTransMul[i] - pts[i].transMul(fvs[i])).vector().norm(), TOL);
+  }
+
+  traj.close();
+  std::remove(PATH);
+}
+
+BOOST_AUTO_TEST_CASE(TrajectoryStreamRawTest)
+{
+  using namespace Eigen;
+  using namespace sva;
+
+  // chunks of 64 samples, the last one is shorter
+  const std::size_t chunkSize = 64;
+  std::vector<RBInertiad> rbIs(SIZE);
+  for(auto & rbI : rbIs)
+  {
+    rbI = RBInertiad(std::abs(Vector3d::Random()(0)) + 1., Vector3d::Random(), Matrix3d::Random());
+  }
+
+  TrajectoryStreamWriter<RBInertiad> writer;
+  BOOST_REQUIRE(writer.open(PATH, TrajectoryEncoding::Raw, 0., chunkSize));
+  BOOST_CHECK(writer.write(rbIs[0]));
+  BOOST_CHECK(writer.write(rbIs.data() + 1, SIZE - 1));
+  BOOST_CHECK_EQUAL(writer.size(), SIZE);
+  BOOST_CHECK(writer.close());
+
+  TrajectoryStreamReader<RBInertiad> reader(PATH, chunkSize);
+  BOOST_REQUIRE(reader.isOpen());
+  BOOST_CHECK_EQUAL(reader.size(), SIZE);
+  std::size_t i = 0;
+  for(TrajectoryView<RBInertiad> chunk = reader.next(); !chunk.empty(); chunk = reader.next())
+  {
+    BOOST_CHECK(chunk.size() <= chunkSize);
+    for(const RBInertiad & rbI : chunk)
+    {
+      BOOST_REQUIRE(i < SIZE);
+      BOOST_CHECK_EQUAL(rbI, rbIs[i++]);
+    }
+  }
+  BOOST_CHECK_EQUAL(i, SIZE);
+  BOOST_CHECK(!reader.error());
+  BOOST_CHECK(reader.next().empty());
+  reader.close();
+
+  // a raw stream is also a mapped trajectory
+  MappedTrajectory<RBInertiad> traj(PATH);
+  BOOST_REQUIRE(traj.isOpen());
+  BOOST_REQUIRE_EQUAL(traj.size(), SIZE);
+  BOOST_CHECK_EQUAL(traj[SIZE - 1], rbIs[SIZE - 1]);
+  traj.close();
+
+  // wrong sample type
+  TrajectoryStreamReader<MotionVecd> wrongType;
+  BOOST_CHECK(!wrongType.open(PATH));
+  BOOST_CHECK(!wrongType.isOpen());
+  std::remove(PATH);
+}
+
+BOOST_AUTO_TEST_CASE(TrajectoryStreamQuantizedDeltaTest)
+{
+  using namespace Eigen;
+  using namespace sva;
+
+  const double step = 1e-6;
+  const std::size_t chunkSize = 64;
+
+  // slowly varying poses and wrenches
+  std::vector<PTransformd> pts(SIZE);
+  std::vector<ForceVecd> fvs(SIZE);
+  const MotionVecd nu(Vector6d::Random() * 1e-2);
+  pts[0] = randomPTransform();
+  fvs[0] = ForceVecd(Vector6d::Random());
+  for(std::size_t i = 1; i < SIZE; ++i)
+  {
+    pts[i] = sva::exp(nu) * pts[i - 1];
+    fvs[i] = fvs[i - 1] + ForceVecd(Vector6d::Random() * 1e-3);
+  }
+
+  {
+    TrajectoryStreamWriter<PTransformd> writer(PATH, TrajectoryEncoding::QuantizedDelta, step, chunkSize);
+    BOOST_REQUIRE(writer.isOpen());
+    BOOST_CHECK(writer.write(pts));
+  }
+
+  // the encoded file is smaller and can not be mapped
+  MappedTrajectory<PTransformd> traj;
+  BOOST_CHECK(!traj.open(PATH));
+  std::FILE * f = std::fopen(PATH, "rb");
+  std::fseek(f, 0, SEEK_END);
+  const long bytes = std::ftell(f);
+  std::fclose(f);
+  BOOST_CHECK(bytes < static_cast<long>(sizeof(TrajectoryHeader) + SIZE * sizeof(PTransformd) / 2));
+
+  TrajectoryStreamReader<PTransformd> reader(PATH);
+  BOOST_REQUIRE(reader.isOpen());
+  BOOST_CHECK(reader.header().encoding == static_cast<std::uint32_t>(TrajectoryEncoding::QuantizedDelta));
+  std::size_t i = 0;
+  for(TrajectoryView<PTransformd> chunk = reader.next(); !chunk.empty(); chunk = reader.next())
+  {
+    BOOST_CHECK_EQUAL(chunk.size(), std::min(chunkSize, SIZE - i));
+    // the first sample of a chunk is exact
+    BOOST_CHECK_EQUAL(chunk[0], pts[i]);
+    for(const PTransformd & pt : chunk)
+    {
+      BOOST_REQUIRE(i < SIZE);
+      BOOST_CHECK_SMALL((pt.rotation() - pts[i].rotation()).array().abs().maxCoeff(), step / 2. + 1e-12);
+      BOOST_CHECK_SMALL((pt.translation() - pts[i].translation()).array().abs().maxCoeff(), step / 2. + 1e-12);
+      ++i;
+    }
+  }
+  BOOST_CHECK_EQUAL(i, SIZE);
+  BOOST_CHECK(!reader.error());
+  reader.close();
+
+  TrajectoryStreamWriter<ForceVecd> fvWriter(PATH, TrajectoryEncoding::QuantizedDelta, step, chunkSize);
+  fvWriter.write(fvs);
+  BOOST_CHECK(fvWriter.close());
+  TrajectoryStreamReader<ForceVecd> fvReader(PATH);
+  BOOST_REQUIRE(fvReader.isOpen());
+  i = 0;
+  for(TrajectoryView<ForceVecd> chunk = fvReader.next(); !chunk.empty(); chunk = fvReader.next())
+  {
+    for(const ForceVecd & fv : chunk)
+    {
+      BOOST_REQUIRE(i < SIZE);
+      BOOST_CHECK_SMALL((fv - fvs[i++]).vector().array().abs().maxCoeff(), step / 2. + 1e-12);
+    }
+  }
+  BOOST_CHECK_EQUAL(i, SIZE);
+  fvReader.close();
+
+  // truncated chunk data is a read error
+  {
+    std::FILE * tf = std::fopen(PATH, "r+b");
+    TrajectoryHeader header;
+    BOOST_REQUIRE_EQUAL(std::fread(&header, sizeof(header), 1, tf), 1);
+    sva::sva_internal::TrajectoryChunkHeader chunk;
+    BOOST_REQUIRE_EQUAL(std::fread(&chunk, sizeof(chunk), 1, tf), 1);
+    chunk.bytes -= 1;
+    std::fseek(tf, sizeof(header), SEEK_SET);
+    std::fwrite(&chunk, sizeof(chunk), 1, tf);
+    std::fclose(tf);
+  }
+  BOOST_REQUIRE(fvReader.open(PATH));
+  BOOST_CHECK(fvReader.next().empty());
+  BOOST_CHECK(fvReader.error());
+  fvReader.close();
+
+  std::remove(PATH);
+}